@@ -0,0 +1,504 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include "myaccuracy.hpp"
+#include "mybenchmark.hpp"
+#include "mylie.hpp"
+#include "mymatrix.hpp"
+#include "myrotation.hpp"
+
+// Differential accuracy of Vector3, Matrix2/3/4, SO3 and rotation conversions against Eigen in double.
+// usage: accuracy_eigen [name filter] [json path] [inputs per class]
+// Every operation runs on randomized and adversarial input classes, the same scalar
+// inputs are widened to double and handed to Eigen, and the errors are reported in
+// units in the last place of scalar (see myaccuracy.hpp) next to the median time of
+// the mymath and Eigen (scalar) versions on the "random" class, so that an optimization
+// can be judged on both speed and accuracy.
+// Inputs an operation refuses by its own predicate, e.g. isInversed() of a tiny matrix,
+// are counted as rejected, results that are not finite count as failures.
+
+typedef Eigen::Matrix<double, 3, 1> DVector3;
+typedef Eigen::Matrix<scalar, 3, 1> EVector3;
+
+static const double PI_D = 3.14159265358979323846;
+/** @brief inputs timed per benchmark, a power of two. */
+static const size_t TABLE = 64;
+static const size_t MASK = TABLE - 1;
+
+static std::mt19937 rng(20220402);
+
+static scalar uniform(double lo, double hi) {
+    return static_cast<scalar>(std::uniform_real_distribution<double>(lo, hi)(rng));
+}
+
+/** @brief magnitude of an input class. */
+static double magnitude(const std::string& input) {
+    if (input == "huge") return 1e8;
+    if (input == "tiny") return 1e-8;
+    return 1;
+}
+
+/** @brief N x N matrix, near-singular ones have a last row combined of the others plus noise. */
+template <typename M, int N>
+static M randomMatrix(const std::string& input) {
+    M a;
+    for (int k = 0; k < N * N; ++k) a[k] = uniform(-1, 1);
+    if (input == "near-singular") {
+        double w[N];
+        for (int r = 0; r < N - 1; ++r) w[r] = uniform(-1, 1);
+        for (int c = 0; c < N; ++c) {
+            double v = 1e-4 * uniform(-1, 1);
+            for (int r = 0; r < N - 1; ++r) v += w[r] * a[c * N + r];
+            a[c * N + N - 1] = static_cast<scalar>(v);
+        }
+    }
+    const double s = magnitude(input);
+    for (int k = 0; k < N * N; ++k) a[k] = static_cast<scalar>(a[k] * s);
+    return a;
+}
+
+template <typename M, int N>
+static Eigen::Matrix<double, N, N> widen(const M& a) {
+    Eigen::Matrix<double, N, N> d;
+    for (int k = 0; k < N * N; ++k) d.data()[k] = a[k];
+    return d;
+}
+
+static DVector3 widen(const Vector3& v) {
+    return DVector3(v.x, v.y, v.z);
+}
+
+static Vector3 randomVector(double s) {
+    return Vector3(uniform(-s, s), uniform(-s, s), uniform(-s, s));
+}
+
+/** @brief axis and angle in degree of a rotation input class. */
+static void randomRotation(const std::string& input, Vector3& axis, scalar& angle) {
+    do {
+        axis = randomVector(1);
+    } while (axis.length() < 0.1f);
+    angle = uniform(-180, 180);
+    if (input == "small-angle") angle = uniform(-1e-1, 1e-1);
+    if (input == "unnormalized-axis") axis *= (rng() & 1) ? 1e3f : 1e-3f;
+}
+
+/** @brief call op, count the input as rejected if it throws. */
+template <typename F>
+static bool attempt(AccuracyReport& report, const std::string& name, const std::string& input, F op) {
+    try {
+        op();
+        return true;
+    } catch (const char*) {
+        report.reject(name, input);
+        return false;
+    }
+}
+
+template <typename M, int N>
+static void checkMatrix(AccuracyReport& report, BenchmarkSuite& suite, const std::string& type, size_t count) {
+    typedef Eigen::Matrix<double, N, N> DMatrix;
+    typedef Eigen::Matrix<scalar, N, N> EMatrix;
+    const std::string det = type + "::getDeterminant";
+    const std::string inv = type + "::computeInverse";
+    const std::string mul = type + "::matmul";
+    static const char* INPUTS[] = {"random", "near-singular", "huge", "tiny"};
+    for (const char* input : INPUTS) {
+        for (size_t i = 0; i < count; ++i) {
+            const M a = randomMatrix<M, N>(input);
+            const M b = randomMatrix<M, N>("random");
+            const DMatrix da = widen<M, N>(a), db = widen<M, N>(b);
+            if (suite.isSelected(det)) {
+                const scalar d = a.getDeterminant();
+                const double rd = da.determinant();
+                report.add(det, input, &d, &rd, 1, i);
+            }
+            if (suite.isSelected(inv)) {
+                // the absolute MYEPSILON test of isInversed() refuses tiny and near-singular matrices
+                M r;
+                if (!a.isInversed()) {
+                    report.reject(inv, input);
+                } else if (attempt(report, inv, input, [&]() { r = a.computeInverse(); })) {
+                    const DMatrix rr = da.inverse();
+                    report.add(inv, input, r.constData(), rr.data(), N * N, i);
+                }
+            }
+            if (suite.isSelected(mul)) {
+                const M r = a.matmul(b);
+                const DMatrix rr = da * db;
+                report.add(mul, input, r.constData(), rr.data(), N * N, i);
+            }
+        }
+    }
+
+    std::vector<M> mine;
+    std::vector<EMatrix> theirs;
+    for (size_t i = 0; i < TABLE; ++i) {
+        mine.push_back(randomMatrix<M, N>("random"));
+        theirs.push_back(Eigen::Map<const EMatrix>(mine.back().constData()));
+    }
+    suite.run(det, "mymath", [&](size_t i) { doNotOptimize(mine[i & MASK].getDeterminant()); });
+    suite.run(det, "eigen", [&](size_t i) { doNotOptimize(theirs[i & MASK].determinant()); });
+    suite.run(inv, "mymath", [&](size_t i) { doNotOptimize(mine[i & MASK].computeInverse()); });
+    suite.run(inv, "eigen", [&](size_t i) { doNotOptimize(EMatrix(theirs[i & MASK].inverse())); });
+    suite.run(mul, "mymath", [&](size_t i) { doNotOptimize(mine[i & MASK].matmul(mine[(i + 1) & MASK])); });
+    suite.run(mul, "eigen", [&](size_t i) { doNotOptimize(EMatrix(theirs[i & MASK] * theirs[(i + 1) & MASK])); });
+}
+
+/** @brief rigid (with setRotationMatrix) or affine (with a random 3x3 block) 4x4 matrix. */
+static Matrix4 randomTransform(bool rigid) {
+    Vector3 axis;
+    scalar angle;
+    randomRotation("random", axis, angle);
+    Matrix3 r;
+    r.setRotationMatrix(axis, angle, DEG);
+    if (!rigid) r = randomMatrix<Matrix3, 3>("random");
+    Matrix4 m = r.toHomogenous();
+    m.translate(randomVector(10));
+    return m;
+}
+
+static void checkTransform(AccuracyReport& report, BenchmarkSuite& suite, size_t count) {
+    typedef Eigen::Matrix<double, 4, 4> DMatrix;
+    typedef Eigen::Matrix<scalar, 4, 4> EMatrix;
+    typedef Eigen::Transform<scalar, 3, Eigen::Affine> EAffine;
+    const std::string euclid = "Matrix4::computeEuclideanInverse";
+    const std::string affine = "Matrix4::computeAffineInverse";
+    const std::string rotate = "Matrix4::rotate";
+    for (size_t i = 0; i < count; ++i) {
+        // the reference is the exact inverse of the rounded input, not of the ideal transform
+        const Matrix4 e = randomTransform(true), a = randomTransform(false);
+        Matrix4 r;
+        if (suite.isSelected(euclid) && attempt(report, euclid, "rigid", [&]() { r = e.computeEuclideanInverse(); })) {
+            const DMatrix rr = widen<Matrix4, 4>(e).inverse();
+            report.add(euclid, "rigid", r.constData(), rr.data(), 16, i);
+        }
+        if (suite.isSelected(affine) && a.isInversed() &&
+            attempt(report, affine, "affine", [&]() { r = a.computeAffineInverse(); })) {
+            const DMatrix rr = widen<Matrix4, 4>(a).inverse();
+            report.add(affine, "affine", r.constData(), rr.data(), 16, i);
+        }
+        if (suite.isSelected(rotate)) {
+            Vector3 axis;
+            scalar angle;
+            randomRotation("random", axis, angle);
+            r = a;
+            r.rotate(angle, axis);
+            Eigen::Matrix<double, 4, 4> rot = Eigen::Matrix<double, 4, 4>::Identity();
+            rot.block<3, 3>(0, 0) = Eigen::AngleAxisd(angle * PI_D / 180, widen(axis).normalized()).toRotationMatrix();
+            const DMatrix rr = rot * widen<Matrix4, 4>(a);
+            report.add(rotate, "affine", r.constData(), rr.data(), 16, i);
+        }
+    }
+
+    std::vector<Matrix4> rigid, general;
+    std::vector<EAffine> erigid, egeneral;
+    for (size_t i = 0; i < TABLE; ++i) {
+        rigid.push_back(randomTransform(true));
+        general.push_back(randomTransform(false));
+        erigid.push_back(EAffine(Eigen::Map<const EMatrix>(rigid.back().constData())));
+        egeneral.push_back(EAffine(Eigen::Map<const EMatrix>(general.back().constData())));
+    }
+    const Vector3 axis(0.3f, -0.5f, 0.8f);
+    const EVector3 eaxis = EVector3(axis.x, axis.y, axis.z).normalized();
+    suite.run(euclid, "mymath", [&](size_t i) { doNotOptimize(rigid[i & MASK].computeEuclideanInverse()); });
+    suite.run(euclid, "eigen", [&](size_t i) { doNotOptimize(erigid[i & MASK].inverse(Eigen::Isometry)); });
+    suite.run(affine, "mymath", [&](size_t i) { doNotOptimize(general[i & MASK].computeAffineInverse()); });
+    suite.run(affine, "eigen", [&](size_t i) { doNotOptimize(egeneral[i & MASK].inverse(Eigen::Affine)); });
+    suite.run(rotate, "mymath", [&](size_t i) {
+        Matrix4 m = general[i & MASK];
+        doNotOptimize(m.rotate(static_cast<scalar>(i & MASK), axis));
+    });
+    suite.run(rotate, "eigen", [&](size_t i) {
+        EAffine m = egeneral[i & MASK];
+        doNotOptimize(m.prerotate(Eigen::AngleAxis<scalar>(static_cast<scalar>(i & MASK) * static_cast<scalar>(PI_D / 180), eaxis)));
+    });
+}
+
+static void checkRotation(AccuracyReport& report, BenchmarkSuite& suite, size_t count) {
+    const std::string set = "Matrix3::setRotationMatrix";
+    const std::string angle2 = "Matrix2::getAngle";
+    static const char* INPUTS[] = {"random", "small-angle", "unnormalized-axis"};
+    for (const char* input : INPUTS) {
+        for (size_t i = 0; i < count; ++i) {
+            Vector3 axis;
+            scalar angle;
+            randomRotation(input, axis, angle);
+            if (suite.isSelected(set)) {
+                Matrix3 r;
+                r.setRotationMatrix(axis, angle, DEG);
+                const Eigen::Matrix3d rr = Eigen::AngleAxisd(angle * PI_D / 180, widen(axis).normalized()).toRotationMatrix();
+                report.add(set, input, r.constData(), rr.data(), 9, i);
+            }
+            if (suite.isSelected(angle2) && (std::string(input) != "unnormalized-axis")) {
+                const scalar c = static_cast<scalar>(std::cos(angle * PI_D / 180));
+                const scalar s = static_cast<scalar>(std::sin(angle * PI_D / 180));
+                const Matrix2 m(c, s, -s, c);
+                scalar r = 0;
+                if (!m.isRotationMatrix()) {
+                    report.reject(angle2, input);
+                } else if (attempt(report, angle2, input, [&]() { r = m.getAngle(RAD); })) {
+                    const double rr = std::atan2(static_cast<double>(s), static_cast<double>(c));
+                    report.add(angle2, input, &r, &rr, 1, i);
+                }
+            }
+        }
+    }
+
+    std::vector<Vector3> axes;
+    std::vector<EVector3> eaxes;
+    for (size_t i = 0; i < TABLE; ++i) {
+        scalar angle;
+        axes.push_back(Vector3());
+        randomRotation("random", axes.back(), angle);
+        eaxes.push_back(EVector3(axes.back().x, axes.back().y, axes.back().z));
+    }
+    suite.run(set, "mymath", [&](size_t i) {
+        Matrix3 r;
+        r.setRotationMatrix(axes[i & MASK], static_cast<scalar>(i & MASK), DEG);
+        doNotOptimize(r);
+    });
+    suite.run(set, "eigen", [&](size_t i) {
+        const scalar a = static_cast<scalar>(i & MASK) * static_cast<scalar>(PI_D / 180);
+        doNotOptimize(Eigen::AngleAxis<scalar>(a, eaxes[i & MASK].normalized()).toRotationMatrix());
+    });
+}
+
+/** @brief rotation vector of a rotation input class, near-pi ones lose their sign ambiguity to rounding. */
+static Vector3 randomRotationVector(const std::string& input) {
+    Vector3 axis;
+    do {
+        axis = randomVector(1);
+    } while (axis.length() < 0.1f);
+    axis.normalize();
+    double angle = uniform(-PI_D, PI_D);
+    if (input == "small-angle") angle = uniform(-1e-3, 1e-3);
+    if (input == "near-pi") angle = PI_D - uniform(0, 1e-3);
+    return axis * static_cast<scalar>(angle);
+}
+
+static void checkLie(AccuracyReport& report, BenchmarkSuite& suite, size_t count) {
+    const std::string exp = "SO3::exp";
+    const std::string log = "SO3::log";
+    static const char* INPUTS[] = {"random", "small-angle", "near-pi"};
+    for (const char* input : INPUTS) {
+        for (size_t i = 0; i < count; ++i) {
+            const Vector3 w = randomRotationVector(input);
+            const DVector3 dw = widen(w);
+            const SO3 r = SO3::exp(w);
+            if (suite.isSelected(exp)) {
+                const double angle = dw.norm();
+                const Eigen::Matrix3d rr = (angle > 0) ? Eigen::AngleAxisd(angle, dw / angle).toRotationMatrix()
+                                                       : Eigen::Matrix3d::Identity();
+                report.add(exp, input, r.matrix().constData(), rr.data(), 9, i);
+            }
+            if (suite.isSelected(log)) {
+                // the reference is the log of the rounded matrix, w and -w are the same rotation at pi
+                const Vector3 l = r.log();
+                const Eigen::AngleAxisd aa(widen<Matrix3, 3>(r.matrix()));
+                DVector3 rr = aa.axis() * aa.angle();
+                if (rr.dot(widen(l)) < 0) rr = -rr;
+                report.add(log, input, &l.x, rr.data(), 3, i);
+            }
+        }
+    }
+
+    std::vector<Vector3> mine;
+    std::vector<EVector3> theirs;
+    std::vector<SO3> rotations;
+    std::vector<Eigen::Matrix<scalar, 3, 3>> erotations;
+    for (size_t i = 0; i < TABLE; ++i) {
+        mine.push_back(randomRotationVector("random"));
+        theirs.push_back(EVector3(mine.back().x, mine.back().y, mine.back().z));
+        rotations.push_back(SO3::exp(mine.back()));
+        erotations.push_back(Eigen::Map<const Eigen::Matrix<scalar, 3, 3>>(rotations.back().matrix().constData()));
+    }
+    suite.run(exp, "mymath", [&](size_t i) { doNotOptimize(SO3::exp(mine[i & MASK])); });
+    suite.run(exp, "eigen", [&](size_t i) {
+        const EVector3& w = theirs[i & MASK];
+        const scalar angle = w.norm();
+        doNotOptimize(Eigen::AngleAxis<scalar>(angle, w / angle).toRotationMatrix());
+    });
+    suite.run(log, "mymath", [&](size_t i) { doNotOptimize(rotations[i & MASK].log()); });
+    suite.run(log, "eigen", [&](size_t i) {
+        const Eigen::AngleAxis<scalar> aa(erotations[i & MASK]);
+        doNotOptimize(EVector3(aa.axis() * aa.angle()));
+    });
+}
+
+/** @brief rotation of Euler angles in double, R_first(a) * R_second(b) * R_third(c). */
+static Eigen::Matrix3d eulerReference(const Vector3& angles, EULERORDER order) {
+    static const int AXES[12][3] = {
+        {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0},
+        {0, 1, 0}, {0, 2, 0}, {1, 0, 1}, {1, 2, 1}, {2, 0, 2}, {2, 1, 2}};
+    const DVector3 a = widen(angles);
+    Eigen::Matrix3d r = Eigen::Matrix3d::Identity();
+    for (int j = 0; j < 3; ++j) r = r * Eigen::AngleAxisd(a[j], DVector3::Unit(AXES[order][j])).toRotationMatrix();
+    return r;
+}
+
+/** @brief Euler angles of an input class, the orders cycle with i, near-lock puts b within 1e-3 rad of gimbal lock. */
+static Vector3 randomEuler(const std::string& input, EULERORDER order) {
+    const bool proper = (order >= EULER_XYX);
+    double b = proper ? uniform(0, PI_D) : uniform(-PI_D / 2, PI_D / 2);
+    if (input == "near-lock") {
+        const double lock = proper ? ((uniform(0, 1) < 0.5) ? 0 : PI_D) : ((uniform(0, 1) < 0.5) ? -PI_D / 2 : PI_D / 2);
+        b = lock + ((lock > 0) ? -1 : 1) * uniform(0, 1e-3);
+    }
+    return Vector3(uniform(-PI_D, PI_D), static_cast<scalar>(b), uniform(-PI_D, PI_D));
+}
+
+static void checkEuler(AccuracyReport& report, BenchmarkSuite& suite, size_t count) {
+    const std::string toRotation = "eulerToRotation";
+    const std::string toEuler = "rotationToEuler";
+    const std::string toQuaternion = "rotationToQuaternion";
+    static const char* INPUTS[] = {"random", "near-lock"};
+    for (const char* input : INPUTS) {
+        for (size_t i = 0; i < count; ++i) {
+            const EULERORDER order = static_cast<EULERORDER>(i % 12);
+            const Vector3 angles = randomEuler(input, order);
+            const Matrix3 r = eulerToRotation(angles, order);
+            if (suite.isSelected(toRotation)) {
+                const Eigen::Matrix3d rr = eulerReference(angles, order);
+                report.add(toRotation, input, r.constData(), rr.data(), 9, i);
+            }
+            if (suite.isSelected(toEuler)) {
+                // angles are not unique at the lock, compare the rotation they give to the input
+                const Matrix3 back = eulerToRotation(rotationToEuler(r, order), order);
+                report.add(toEuler, input, back.constData(), widen<Matrix3, 3>(r).data(), 9, i);
+            }
+            if (suite.isSelected(toQuaternion)) {
+                const Vector4 q = rotationToQuaternion(r);
+                Eigen::Quaterniond rq(widen<Matrix3, 3>(r));
+                if (rq.w() < 0) rq.coeffs() = -rq.coeffs();
+                report.add(toQuaternion, input, &q.x, rq.coeffs().data(), 4, i);
+            }
+        }
+    }
+
+    std::vector<Vector3> angles;
+    std::vector<Matrix3> rotations;
+    std::vector<Eigen::Matrix<scalar, 3, 3>> erotations;
+    for (size_t i = 0; i < TABLE; ++i) {
+        angles.push_back(randomEuler("random", EULER_ZYX));
+        rotations.push_back(eulerToRotation(angles.back(), EULER_ZYX));
+        erotations.push_back(Eigen::Map<const Eigen::Matrix<scalar, 3, 3>>(rotations.back().constData()));
+    }
+    suite.run(toRotation, "mymath", [&](size_t i) { doNotOptimize(eulerToRotation(angles[i & MASK], EULER_ZYX)); });
+    suite.run(toRotation, "eigen", [&](size_t i) {
+        const Vector3& a = angles[i & MASK];
+        doNotOptimize(Eigen::Matrix<scalar, 3, 3>((Eigen::AngleAxis<scalar>(a.x, EVector3::UnitZ()) *
+                                                   Eigen::AngleAxis<scalar>(a.y, EVector3::UnitY()) *
+                                                   Eigen::AngleAxis<scalar>(a.z, EVector3::UnitX())).toRotationMatrix()));
+    });
+    suite.run(toEuler, "mymath", [&](size_t i) { doNotOptimize(rotationToEuler(rotations[i & MASK], EULER_ZYX)); });
+    suite.run(toEuler, "eigen", [&](size_t i) { doNotOptimize(EVector3(erotations[i & MASK].eulerAngles(2, 1, 0))); });
+    suite.run(toQuaternion, "mymath", [&](size_t i) { doNotOptimize(rotationToQuaternion(rotations[i & MASK])); });
+    suite.run(toQuaternion, "eigen", [&](size_t i) {
+        doNotOptimize(Eigen::Quaternion<scalar>(erotations[i & MASK]));
+    });
+}
+
+static void checkVector(AccuracyReport& report, BenchmarkSuite& suite, size_t count) {
+    const std::string len = "Vector3::length";
+    const std::string dot = "Vector3::dot";
+    const std::string cross = "Vector3::cross";
+    const std::string norm = "Vector3::normalized";
+    const std::string ang = "Vector3::angle";
+    static const char* INPUTS[] = {"random", "huge", "tiny", "near-parallel", "near-antiparallel"};
+    for (const char* input : INPUTS) {
+        const std::string in = input;
+        const double s = magnitude(in);
+        for (size_t i = 0; i < count; ++i) {
+            const Vector3 a = randomVector(s);
+            Vector3 b = randomVector(s);
+            if (in == "near-parallel") b = a + randomVector(1e-4);
+            if (in == "near-antiparallel") b = -a + randomVector(1e-4);
+            const DVector3 da = widen(a), db = widen(b);
+            if (suite.isSelected(len)) {
+                const scalar r = a.length();
+                const double rr = da.norm();
+                report.add(len, in, &r, &rr, 1, i);
+            }
+            if (suite.isSelected(dot)) {
+                const scalar r = a.dot(b);
+                const double rr = da.dot(db);
+                report.add(dot, in, &r, &rr, 1, i);
+            }
+            if (suite.isSelected(cross)) {
+                const Vector3 r = a.cross(b);
+                const DVector3 rr = da.cross(db);
+                report.add(cross, in, &r.x, rr.data(), 3, i);
+            }
+            if (suite.isSelected(norm)) {
+                Vector3 r;
+                if (a.length() < MYEPSILON) {
+                    report.reject(norm, in);
+                } else if (attempt(report, norm, in, [&]() { r = a.normalized(); })) {
+                    const DVector3 rr = da.normalized();
+                    report.add(norm, in, &r.x, rr.data(), 3, i);
+                }
+            }
+            if (suite.isSelected(ang)) {
+                scalar r = 0;
+                if (a.length() * b.length() < MYEPSILON) {
+                    report.reject(ang, in);
+                } else if (attempt(report, ang, in, [&]() { r = a.angle(b, RAD); })) {
+                    // atan2 of |a x b| and a.b keeps the reference exact near 0 and pi
+                    const double rr = std::atan2(da.cross(db).norm(), da.dot(db));
+                    report.add(ang, in, &r, &rr, 1, i);
+                }
+            }
+        }
+    }
+
+    std::vector<Vector3> mine;
+    std::vector<EVector3> theirs;
+    for (size_t i = 0; i < TABLE; ++i) {
+        mine.push_back(randomVector(1) + Vector3(0.1f, 0, 0));
+        theirs.push_back(EVector3(mine.back().x, mine.back().y, mine.back().z));
+    }
+    suite.run(len, "mymath", [&](size_t i) { doNotOptimize(mine[i & MASK].length()); });
+    suite.run(len, "eigen", [&](size_t i) { doNotOptimize(theirs[i & MASK].norm()); });
+    suite.run(dot, "mymath", [&](size_t i) { doNotOptimize(mine[i & MASK].dot(mine[(i + 1) & MASK])); });
+    suite.run(dot, "eigen", [&](size_t i) { doNotOptimize(theirs[i & MASK].dot(theirs[(i + 1) & MASK])); });
+    suite.run(cross, "mymath", [&](size_t i) { doNotOptimize(mine[i & MASK].cross(mine[(i + 1) & MASK])); });
+    suite.run(cross, "eigen", [&](size_t i) { doNotOptimize(EVector3(theirs[i & MASK].cross(theirs[(i + 1) & MASK]))); });
+    suite.run(norm, "mymath", [&](size_t i) { doNotOptimize(mine[i & MASK].normalized()); });
+    suite.run(norm, "eigen", [&](size_t i) { doNotOptimize(EVector3(theirs[i & MASK].normalized())); });
+    suite.run(ang, "mymath", [&](size_t i) { doNotOptimize(mine[i & MASK].angle(mine[(i + 1) & MASK], RAD)); });
+    suite.run(ang, "eigen", [&](size_t i) {
+        const EVector3& a = theirs[i & MASK];
+        const EVector3& b = theirs[(i + 1) & MASK];
+        doNotOptimize(std::acos(a.dot(b) / (a.norm() * b.norm())));
+    });
+}
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite(11, 10, 1);
+    if (argc > 1) suite.setFilter(argv[1]);
+    const std::string json = (argc > 2) ? argv[2] : "accuracy_eigen.json";
+    const size_t count = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 20000;
+
+    AccuracyReport report;
+    checkVector(report, suite, count);
+    checkRotation(report, suite, count);
+    checkMatrix<Matrix2, 2>(report, suite, "Matrix2", count);
+    checkMatrix<Matrix3, 3>(report, suite, "Matrix3", count);
+    checkMatrix<Matrix4, 4>(report, suite, "Matrix4", count);
+    checkTransform(report, suite, count);
+    checkLie(report, suite, count);
+    checkEuler(report, suite, count);
+
+    report.printTable(stdout, &suite.getResults());
+    report.writeJSON(json, &suite.getResults());
+    printf("wrote %s\n", json.c_str());
+    return 0;
+}
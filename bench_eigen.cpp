@@ -0,0 +1,1113 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include "mybatch.hpp"
+#include "mybenchmark.hpp"
+#include "myisa.hpp"
+#include "mymatrix.hpp"
+#include "mymatrixn.hpp"
+#include "myparallel.hpp"
+
+// Every public Vector2/3/4 and Matrix2/3/4 operation against the equivalent Eigen code.
+// usage: bench_eigen [name filter] [json path] [samples] [perf]
+// The ratio column is mymath median / eigen median, below 1 means mymath is faster.
+// "perf" adds hardware counters: cycles per element, IPC, cache and branch misses per
+// operation, which tell compute bound (high IPC), latency bound (low IPC, few misses)
+// and bandwidth bound (many cache misses) kernels apart.
+// MYMATH_ISA=scalar|sse2|avx2|avx512 picks the variant of the batch kernels.
+
+typedef Eigen::Matrix<scalar, 2, 1> EVector2;
+typedef Eigen::Matrix<scalar, 3, 1> EVector3;
+typedef Eigen::Matrix<scalar, 4, 1> EVector4;
+typedef Eigen::Matrix<scalar, 2, 2> EMatrix2;
+typedef Eigen::Matrix<scalar, 3, 3> EMatrix3;
+typedef Eigen::Matrix<scalar, 4, 4> EMatrix4;
+typedef Eigen::Transform<scalar, 3, Eigen::Affine> EAffine3;
+
+/** @brief inputs are picked out of tables of this size, a power of two. */
+static const size_t TABLE = 64;
+static const size_t MASK = TABLE - 1;
+static const scalar PI_S = static_cast<scalar>(3.14159265358979323846);
+
+static std::mt19937 rng(20220401);
+
+static scalar uniform(scalar lo, scalar hi) {
+    return std::uniform_real_distribution<scalar>(lo, hi)(rng);
+}
+
+template <typename Mine, typename Theirs>
+struct Table {
+    std::vector<Mine> mine;
+    std::vector<Theirs> theirs;
+};
+
+static Table<Vector2, EVector2> randomVector2() {
+    Table<Vector2, EVector2> t;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Vector2 v(uniform(-1, 1), uniform(-1, 1));
+        v.x += (v.x < 0) ? -0.1f : 0.1f;
+        t.mine.push_back(v);
+        t.theirs.push_back(EVector2(v.x, v.y));
+    }
+    return t;
+}
+
+static Table<Vector3, EVector3> randomVector3() {
+    Table<Vector3, EVector3> t;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Vector3 v(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1));
+        v.x += (v.x < 0) ? -0.1f : 0.1f;
+        t.mine.push_back(v);
+        t.theirs.push_back(EVector3(v.x, v.y, v.z));
+    }
+    return t;
+}
+
+static Table<Vector4, EVector4> randomVector4() {
+    Table<Vector4, EVector4> t;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Vector4 v(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), uniform(-1, 1));
+        v.x += (v.x < 0) ? -0.1f : 0.1f;
+        t.mine.push_back(v);
+        t.theirs.push_back(EVector4(v.x, v.y, v.z, v.w));
+    }
+    return t;
+}
+
+/** @brief copy a column major matrix into Eigen, which is column major by default too. */
+template <typename E, typename M, int N>
+static E toEigen(const M& m) {
+    E e;
+    for (int k = 0; k < N * N; ++k) e.data()[k] = m[k];
+    return e;
+}
+
+/** @brief well conditioned general matrices, identity plus noise. */
+static Table<Matrix2, EMatrix2> randomMatrix2() {
+    Table<Matrix2, EMatrix2> t;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Matrix2 m;
+        for (int k = 0; k < 4; ++k) m[k] += uniform(-0.3f, 0.3f);
+        t.mine.push_back(m);
+        t.theirs.push_back(toEigen<EMatrix2, Matrix2, 2>(m));
+    }
+    return t;
+}
+
+static Table<Matrix3, EMatrix3> randomMatrix3() {
+    Table<Matrix3, EMatrix3> t;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Matrix3 m;
+        for (int k = 0; k < 9; ++k) m[k] += uniform(-0.3f, 0.3f);
+        t.mine.push_back(m);
+        t.theirs.push_back(toEigen<EMatrix3, Matrix3, 3>(m));
+    }
+    return t;
+}
+
+static Table<Matrix4, EMatrix4> randomMatrix4() {
+    Table<Matrix4, EMatrix4> t;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Matrix4 m;
+        for (int k = 0; k < 16; ++k) m[k] += uniform(-0.3f, 0.3f);
+        t.mine.push_back(m);
+        t.theirs.push_back(toEigen<EMatrix4, Matrix4, 4>(m));
+    }
+    return t;
+}
+
+static Table<Matrix2, EMatrix2> rotationMatrix2() {
+    Table<Matrix2, EMatrix2> t;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Matrix2 m;
+        m.setRotatonMatrix(uniform(-180, 180));
+        t.mine.push_back(m);
+        t.theirs.push_back(toEigen<EMatrix2, Matrix2, 2>(m));
+    }
+    return t;
+}
+
+static Table<Matrix3, EMatrix3> rotationMatrix3() {
+    Table<Matrix3, EMatrix3> t;
+    while (t.mine.size() < TABLE) {
+        Matrix3 m;
+        m.setRotationMatrix(Vector3(uniform(-1, 1), uniform(-1, 1), 1), uniform(-180, 180));
+        if (!m.isRotationMatrix()) continue;
+        t.mine.push_back(m);
+        t.theirs.push_back(toEigen<EMatrix3, Matrix3, 3>(m));
+    }
+    return t;
+}
+
+/** @brief rigid transforms, rotation and translation. */
+static Table<Matrix4, EMatrix4> euclideanMatrix4(bool translated) {
+    Table<Matrix4, EMatrix4> t;
+    while (t.mine.size() < TABLE) {
+        Matrix4 m;
+        m.rotate(uniform(-180, 180), Vector3(uniform(-1, 1), uniform(-1, 1), 1));
+        if (translated) m.translate(uniform(-5, 5), uniform(-5, 5), uniform(-5, 5));
+        if (!m.isRotationMatrix() && !translated) continue;
+        if (!m.isEuclideanMatrix()) continue;
+        t.mine.push_back(m);
+        t.theirs.push_back(toEigen<EMatrix4, Matrix4, 4>(m));
+    }
+    return t;
+}
+
+/** @brief affine transforms, general 3x3 part and translation. */
+static Table<Matrix4, EMatrix4> affineMatrix4() {
+    Table<Matrix4, EMatrix4> t;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Matrix4 m;
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 3; ++r) m(r, c) += uniform(-0.3f, 0.3f);
+        }
+        t.mine.push_back(m);
+        t.theirs.push_back(toEigen<EMatrix4, Matrix4, 4>(m));
+    }
+    return t;
+}
+
+/** @brief run the same operation on both sides, elements is the number of items one operation processes. */
+template <typename Mine, typename Theirs>
+static void compare(BenchmarkSuite& suite, const std::string& name, Mine mine, Theirs theirs, size_t elements = 1) {
+    suite.run(name, "mymath", mine, elements);
+    suite.run(name, "eigen", theirs, elements);
+}
+
+static void benchVector2(BenchmarkSuite& s) {
+    const Table<Vector2, EVector2> a = randomVector2(), b = randomVector2();
+    const std::vector<Vector2>& ma = a.mine;
+    const std::vector<Vector2>& mb = b.mine;
+    const std::vector<EVector2>& ea = a.theirs;
+    const std::vector<EVector2>& eb = b.theirs;
+    std::vector<scalar> k(TABLE);
+    for (scalar& v : k) v = uniform(0.5f, 2);
+
+    compare(s, "Vector2::Vector2(x, y)",
+            [&](size_t i) { doNotOptimize(Vector2(k[i & MASK], k[(i + 1) & MASK])); },
+            [&](size_t i) { doNotOptimize(EVector2(k[i & MASK], k[(i + 1) & MASK])); });
+    compare(s, "Vector2::set",
+            [&](size_t i) { Vector2 v; v.set(k[i & MASK], k[(i + 1) & MASK]); doNotOptimize(v); },
+            [&](size_t i) { EVector2 v; v << k[i & MASK], k[(i + 1) & MASK]; doNotOptimize(v); });
+    compare(s, "Vector2::length",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].length()); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].norm()); });
+    compare(s, "Vector2::distance",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].distance(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize((ea[i & MASK] - eb[i & MASK]).norm()); });
+    compare(s, "Vector2::normalized",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].normalized()); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK].normalized())); });
+    compare(s, "Vector2::normalize",
+            [&](size_t i) { Vector2 v = ma[i & MASK]; v.normalize(); doNotOptimize(v); },
+            [&](size_t i) { EVector2 v = ea[i & MASK]; v.normalize(); doNotOptimize(v); });
+    compare(s, "Vector2::dot",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].dot(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].dot(eb[i & MASK])); });
+    compare(s, "Vector2::equal",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].equal(mb[i & MASK])); },
+            [&](size_t i) {
+                doNotOptimize((ea[i & MASK] - eb[i & MASK]).cwiseAbs().maxCoeff() <= scalar(MYEPSILON));
+            });
+    compare(s, "Vector2::operator-()",
+            [&](size_t i) { doNotOptimize(-ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2(-ea[i & MASK])); });
+    compare(s, "Vector2::operator+",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] + mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK] + eb[i & MASK])); });
+    compare(s, "Vector2::operator+=",
+            [&](size_t i) { Vector2 v = ma[i & MASK]; v += mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector2 v = ea[i & MASK]; v += eb[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector2::operator-",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] - mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK] - eb[i & MASK])); });
+    compare(s, "Vector2::operator-=",
+            [&](size_t i) { Vector2 v = ma[i & MASK]; v -= mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector2 v = ea[i & MASK]; v -= eb[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector2::operator*(Vector2)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK].cwiseProduct(eb[i & MASK]))); });
+    compare(s, "Vector2::operator*=(Vector2)",
+            [&](size_t i) { Vector2 v = ma[i & MASK]; v *= mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector2 v = ea[i & MASK]; v.array() *= eb[i & MASK].array(); doNotOptimize(v); });
+    compare(s, "Vector2::operator*(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK] * k[i & MASK])); });
+    compare(s, "Vector2::operator*=(scalar)",
+            [&](size_t i) { Vector2 v = ma[i & MASK]; v *= k[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector2 v = ea[i & MASK]; v *= k[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector2::operator/(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] / k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK] / k[i & MASK])); });
+    compare(s, "Vector2::operator/=(scalar)",
+            [&](size_t i) { Vector2 v = ma[i & MASK]; v /= k[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector2 v = ea[i & MASK]; v /= k[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector2::operator==",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] == mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK] == eb[i & MASK]); });
+    compare(s, "Vector2::operator!=",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] != mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK] != eb[i & MASK]); });
+    compare(s, "Vector2::operator<",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] < mb[i & MASK]); },
+            [&](size_t i) {
+                const EVector2& u = ea[i & MASK];
+                const EVector2& v = eb[i & MASK];
+                doNotOptimize(std::lexicographical_compare(u.data(), u.data() + 2, v.data(), v.data() + 2));
+            });
+    compare(s, "Vector2::operator[]",
+            [&](size_t i) { doNotOptimize(ma[i & MASK][i & 1]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK][i & 1]); });
+    compare(s, "scalar * Vector2",
+            [&](size_t i) { doNotOptimize(k[i & MASK] * ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2(k[i & MASK] * ea[i & MASK])); });
+}
+
+static void benchVector3(BenchmarkSuite& s) {
+    const Table<Vector3, EVector3> a = randomVector3(), b = randomVector3();
+    const std::vector<Vector3>& ma = a.mine;
+    const std::vector<Vector3>& mb = b.mine;
+    const std::vector<EVector3>& ea = a.theirs;
+    const std::vector<EVector3>& eb = b.theirs;
+    std::vector<scalar> k(TABLE);
+    for (scalar& v : k) v = uniform(0.5f, 2);
+
+    compare(s, "Vector3::Vector3(x, y, z)",
+            [&](size_t i) { doNotOptimize(Vector3(k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK])); },
+            [&](size_t i) { doNotOptimize(EVector3(k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK])); });
+    compare(s, "Vector3::set",
+            [&](size_t i) { Vector3 v; v.set(k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK]); doNotOptimize(v); },
+            [&](size_t i) { EVector3 v; v << k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK]; doNotOptimize(v); });
+    compare(s, "Vector3::length",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].length()); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].norm()); });
+    compare(s, "Vector3::distance",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].distance(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize((ea[i & MASK] - eb[i & MASK]).norm()); });
+    compare(s, "Vector3::angle",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].angle(mb[i & MASK], RAD)); },
+            [&](size_t i) {
+                const EVector3& u = ea[i & MASK];
+                const EVector3& v = eb[i & MASK];
+                doNotOptimize(std::acos(u.dot(v) / (u.norm() * v.norm())));
+            });
+    compare(s, "Vector3::normalized",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].normalized()); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK].normalized())); });
+    compare(s, "Vector3::normalize",
+            [&](size_t i) { Vector3 v = ma[i & MASK]; v.normalize(); doNotOptimize(v); },
+            [&](size_t i) { EVector3 v = ea[i & MASK]; v.normalize(); doNotOptimize(v); });
+    compare(s, "Vector3::dot",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].dot(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].dot(eb[i & MASK])); });
+    compare(s, "Vector3::cross",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].cross(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK].cross(eb[i & MASK]))); });
+    compare(s, "Vector3::equal",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].equal(mb[i & MASK])); },
+            [&](size_t i) {
+                doNotOptimize((ea[i & MASK] - eb[i & MASK]).cwiseAbs().maxCoeff() <= scalar(MYEPSILON));
+            });
+    compare(s, "Vector3::operator-()",
+            [&](size_t i) { doNotOptimize(-ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3(-ea[i & MASK])); });
+    compare(s, "Vector3::operator+",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] + mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK] + eb[i & MASK])); });
+    compare(s, "Vector3::operator+=",
+            [&](size_t i) { Vector3 v = ma[i & MASK]; v += mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector3 v = ea[i & MASK]; v += eb[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector3::operator-",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] - mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK] - eb[i & MASK])); });
+    compare(s, "Vector3::operator-=",
+            [&](size_t i) { Vector3 v = ma[i & MASK]; v -= mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector3 v = ea[i & MASK]; v -= eb[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector3::operator*(Vector3)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK].cwiseProduct(eb[i & MASK]))); });
+    compare(s, "Vector3::operator*=(Vector3)",
+            [&](size_t i) { Vector3 v = ma[i & MASK]; v *= mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector3 v = ea[i & MASK]; v.array() *= eb[i & MASK].array(); doNotOptimize(v); });
+    compare(s, "Vector3::operator*(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK] * k[i & MASK])); });
+    compare(s, "Vector3::operator*=(scalar)",
+            [&](size_t i) { Vector3 v = ma[i & MASK]; v *= k[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector3 v = ea[i & MASK]; v *= k[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector3::operator/(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] / k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK] / k[i & MASK])); });
+    compare(s, "Vector3::operator/=(scalar)",
+            [&](size_t i) { Vector3 v = ma[i & MASK]; v /= k[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector3 v = ea[i & MASK]; v /= k[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector3::operator==",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] == mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK] == eb[i & MASK]); });
+    compare(s, "Vector3::operator!=",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] != mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK] != eb[i & MASK]); });
+    compare(s, "Vector3::operator<",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] < mb[i & MASK]); },
+            [&](size_t i) {
+                const EVector3& u = ea[i & MASK];
+                const EVector3& v = eb[i & MASK];
+                doNotOptimize(std::lexicographical_compare(u.data(), u.data() + 3, v.data(), v.data() + 3));
+            });
+    compare(s, "Vector3::operator[]",
+            [&](size_t i) { doNotOptimize(ma[i & MASK][i % 3]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK][i % 3]); });
+    compare(s, "scalar * Vector3",
+            [&](size_t i) { doNotOptimize(k[i & MASK] * ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3(k[i & MASK] * ea[i & MASK])); });
+}
+
+static void benchVector4(BenchmarkSuite& s) {
+    const Table<Vector4, EVector4> a = randomVector4(), b = randomVector4();
+    const std::vector<Vector4>& ma = a.mine;
+    const std::vector<Vector4>& mb = b.mine;
+    const std::vector<EVector4>& ea = a.theirs;
+    const std::vector<EVector4>& eb = b.theirs;
+    std::vector<scalar> k(TABLE);
+    for (scalar& v : k) v = uniform(0.5f, 2);
+
+    compare(s, "Vector4::Vector4(x, y, z, w)",
+            [&](size_t i) {
+                doNotOptimize(Vector4(k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK], k[(i + 3) & MASK]));
+            },
+            [&](size_t i) {
+                doNotOptimize(EVector4(k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK], k[(i + 3) & MASK]));
+            });
+    compare(s, "Vector4::set",
+            [&](size_t i) {
+                Vector4 v;
+                v.set(k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK], k[(i + 3) & MASK]);
+                doNotOptimize(v);
+            },
+            [&](size_t i) {
+                EVector4 v;
+                v << k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK], k[(i + 3) & MASK];
+                doNotOptimize(v);
+            });
+    compare(s, "Vector4::length",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].length()); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].norm()); });
+    compare(s, "Vector4::distance",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].distance(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize((ea[i & MASK] - eb[i & MASK]).norm()); });
+    compare(s, "Vector4::normalized",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].normalized()); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK].normalized())); });
+    compare(s, "Vector4::normalize",
+            [&](size_t i) { Vector4 v = ma[i & MASK]; v.normalize(); doNotOptimize(v); },
+            [&](size_t i) { EVector4 v = ea[i & MASK]; v.normalize(); doNotOptimize(v); });
+    compare(s, "Vector4::dot",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].dot(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].dot(eb[i & MASK])); });
+    compare(s, "Vector4::equal",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].equal(mb[i & MASK])); },
+            [&](size_t i) {
+                doNotOptimize((ea[i & MASK] - eb[i & MASK]).cwiseAbs().maxCoeff() <= scalar(MYEPSILON));
+            });
+    compare(s, "Vector4::operator-()",
+            [&](size_t i) { doNotOptimize(-ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4(-ea[i & MASK])); });
+    compare(s, "Vector4::operator+",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] + mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK] + eb[i & MASK])); });
+    compare(s, "Vector4::operator+=",
+            [&](size_t i) { Vector4 v = ma[i & MASK]; v += mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector4 v = ea[i & MASK]; v += eb[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector4::operator-",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] - mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK] - eb[i & MASK])); });
+    compare(s, "Vector4::operator-=",
+            [&](size_t i) { Vector4 v = ma[i & MASK]; v -= mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector4 v = ea[i & MASK]; v -= eb[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector4::operator*(Vector4)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK].cwiseProduct(eb[i & MASK]))); });
+    compare(s, "Vector4::operator*=(Vector4)",
+            [&](size_t i) { Vector4 v = ma[i & MASK]; v *= mb[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector4 v = ea[i & MASK]; v.array() *= eb[i & MASK].array(); doNotOptimize(v); });
+    compare(s, "Vector4::operator*(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK] * k[i & MASK])); });
+    compare(s, "Vector4::operator*=(scalar)",
+            [&](size_t i) { Vector4 v = ma[i & MASK]; v *= k[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector4 v = ea[i & MASK]; v *= k[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector4::operator/(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] / k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK] / k[i & MASK])); });
+    compare(s, "Vector4::operator/=(scalar)",
+            [&](size_t i) { Vector4 v = ma[i & MASK]; v /= k[i & MASK]; doNotOptimize(v); },
+            [&](size_t i) { EVector4 v = ea[i & MASK]; v /= k[i & MASK]; doNotOptimize(v); });
+    compare(s, "Vector4::operator==",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] == mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK] == eb[i & MASK]); });
+    compare(s, "Vector4::operator!=",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] != mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK] != eb[i & MASK]); });
+    compare(s, "Vector4::operator<",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] < mb[i & MASK]); },
+            [&](size_t i) {
+                const EVector4& u = ea[i & MASK];
+                const EVector4& v = eb[i & MASK];
+                doNotOptimize(std::lexicographical_compare(u.data(), u.data() + 4, v.data(), v.data() + 4));
+            });
+    compare(s, "Vector4::operator[]",
+            [&](size_t i) { doNotOptimize(ma[i & MASK][i & 3]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK][i & 3]); });
+    compare(s, "scalar * Vector4",
+            [&](size_t i) { doNotOptimize(k[i & MASK] * ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4(k[i & MASK] * ea[i & MASK])); });
+}
+
+static void benchMatrix2(BenchmarkSuite& s) {
+    const Table<Matrix2, EMatrix2> a = randomMatrix2(), b = randomMatrix2(), r = rotationMatrix2();
+    const std::vector<Matrix2>& ma = a.mine;
+    const std::vector<Matrix2>& mb = b.mine;
+    const std::vector<Matrix2>& mr = r.mine;
+    const std::vector<EMatrix2>& ea = a.theirs;
+    const std::vector<EMatrix2>& eb = b.theirs;
+    const std::vector<EMatrix2>& er = r.theirs;
+    const Table<Vector2, EVector2> v = randomVector2();
+    std::vector<scalar> k(TABLE);
+    for (scalar& x : k) x = uniform(0.5f, 2);
+
+    compare(s, "Matrix2::Matrix2()",
+            [&](size_t) { doNotOptimize(Matrix2()); },
+            [&](size_t) { doNotOptimize(EMatrix2(EMatrix2::Identity())); });
+    compare(s, "Matrix2::Matrix2(const scalar*)",
+            [&](size_t i) { doNotOptimize(Matrix2(ma[i & MASK].constData())); },
+            [&](size_t i) { doNotOptimize(EMatrix2(Eigen::Map<const EMatrix2>(ma[i & MASK].constData()))); });
+    compare(s, "Matrix2::setRow",
+            [&](size_t i) { Matrix2 m = ma[i & MASK]; m.setRow(i & 1, v.mine[i & MASK]); doNotOptimize(m); },
+            [&](size_t i) {
+                EMatrix2 m = ea[i & MASK];
+                m.row(i & 1) = v.theirs[i & MASK].transpose();
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix2::setColumn",
+            [&](size_t i) { Matrix2 m = ma[i & MASK]; m.setColumn(i & 1, v.mine[i & MASK]); doNotOptimize(m); },
+            [&](size_t i) { EMatrix2 m = ea[i & MASK]; m.col(i & 1) = v.theirs[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix2::getRow",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getRow(i & 1)); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK].row(i & 1).transpose())); });
+    compare(s, "Matrix2::getColumn",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getColumn(i & 1)); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK].col(i & 1))); });
+    compare(s, "Matrix2::setRotatonMatrix",
+            [&](size_t i) { Matrix2 m; m.setRotatonMatrix(k[i & MASK], RAD); doNotOptimize(m); },
+            [&](size_t i) {
+                doNotOptimize(EMatrix2(Eigen::Rotation2D<scalar>(k[i & MASK]).toRotationMatrix()));
+            });
+    compare(s, "Matrix2::getAngle",
+            [&](size_t i) { doNotOptimize(mr[i & MASK].getAngle(RAD)); },
+            [&](size_t i) { doNotOptimize(Eigen::Rotation2D<scalar>(er[i & MASK]).angle()); });
+    compare(s, "Matrix2::getDeterminant",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getDeterminant()); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].determinant()); });
+    compare(s, "Matrix2::isRotationMatrix",
+            [&](size_t i) { doNotOptimize(mr[i & MASK].isRotationMatrix()); },
+            [&](size_t i) {
+                const EMatrix2& m = er[i & MASK];
+                doNotOptimize((std::abs(m.determinant() - 1) <= MYEPSILON) &&
+                              (m * m.transpose()).isIdentity(static_cast<scalar>(MYEPSILON)));
+            });
+    compare(s, "Matrix2::transposed",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].transposed()); },
+            [&](size_t i) { doNotOptimize(EMatrix2(ea[i & MASK].transpose())); });
+    compare(s, "Matrix2::computeInverse",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].computeInverse()); },
+            [&](size_t i) { doNotOptimize(EMatrix2(ea[i & MASK].inverse())); });
+    compare(s, "Matrix2::inverse",
+            [&](size_t i) { Matrix2 m = ma[i & MASK]; m.inverse(); doNotOptimize(m); },
+            [&](size_t i) { EMatrix2 m = ea[i & MASK]; m = m.inverse().eval(); doNotOptimize(m); });
+    compare(s, "Matrix2::isInversed",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].isInversed()); },
+            [&](size_t i) { doNotOptimize(std::abs(ea[i & MASK].determinant()) >= MYEPSILON); });
+    compare(s, "Matrix2::operator+",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] + mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix2(ea[i & MASK] + eb[i & MASK])); });
+    compare(s, "Matrix2::operator-",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] - mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix2(ea[i & MASK] - eb[i & MASK])); });
+    compare(s, "Matrix2::operator-()",
+            [&](size_t i) { doNotOptimize(-ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix2(-ea[i & MASK])); });
+    compare(s, "Matrix2::matmul",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].matmul(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EMatrix2(ea[i & MASK] * eb[i & MASK])); });
+    compare(s, "Matrix2::operator*(Matrix2)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix2(ea[i & MASK] * eb[i & MASK])); });
+    compare(s, "Matrix2::operator*=(Matrix2)",
+            [&](size_t i) { Matrix2 m = ma[i & MASK]; m *= mb[i & MASK]; doNotOptimize(m); },
+            [&](size_t i) { EMatrix2 m = ea[i & MASK]; m *= eb[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix2::operator*(Vector2)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * v.mine[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2(ea[i & MASK] * v.theirs[i & MASK])); });
+    compare(s, "Vector2 * Matrix2",
+            [&](size_t i) { doNotOptimize(v.mine[i & MASK] * ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector2((v.theirs[i & MASK].transpose() * ea[i & MASK]).transpose())); });
+    compare(s, "Matrix2::operator*(scalar)",
+            [&](size_t i) { Matrix2 m = ma[i & MASK]; doNotOptimize(m * k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix2(ea[i & MASK] * k[i & MASK])); });
+    compare(s, "Matrix2::operator/(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] / k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix2(ea[i & MASK] / k[i & MASK])); });
+    compare(s, "Matrix2::equal",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].equal(mb[i & MASK])); },
+            [&](size_t i) {
+                doNotOptimize((ea[i & MASK] - eb[i & MASK]).cwiseAbs().maxCoeff() <= scalar(MYEPSILON));
+            });
+    compare(s, "Matrix2::operator()",
+            [&](size_t i) { doNotOptimize(ma[i & MASK](i & 1, (i >> 1) & 1)); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK](i & 1, (i >> 1) & 1)); });
+}
+
+static void benchMatrix3(BenchmarkSuite& s) {
+    const Table<Matrix3, EMatrix3> a = randomMatrix3(), b = randomMatrix3(), r = rotationMatrix3();
+    const std::vector<Matrix3>& ma = a.mine;
+    const std::vector<Matrix3>& mb = b.mine;
+    const std::vector<Matrix3>& mr = r.mine;
+    const std::vector<EMatrix3>& ea = a.theirs;
+    const std::vector<EMatrix3>& eb = b.theirs;
+    const std::vector<EMatrix3>& er = r.theirs;
+    const Table<Vector3, EVector3> v = randomVector3();
+    std::vector<scalar> k(TABLE);
+    for (scalar& x : k) x = uniform(0.5f, 2);
+
+    compare(s, "Matrix3::Matrix3()",
+            [&](size_t) { doNotOptimize(Matrix3()); },
+            [&](size_t) { doNotOptimize(EMatrix3(EMatrix3::Identity())); });
+    compare(s, "Matrix3::Matrix3(const scalar*)",
+            [&](size_t i) { doNotOptimize(Matrix3(ma[i & MASK].constData())); },
+            [&](size_t i) { doNotOptimize(EMatrix3(Eigen::Map<const EMatrix3>(ma[i & MASK].constData()))); });
+    compare(s, "Matrix3::setRow",
+            [&](size_t i) { Matrix3 m = ma[i & MASK]; m.setRow(i % 3, v.mine[i & MASK]); doNotOptimize(m); },
+            [&](size_t i) {
+                EMatrix3 m = ea[i & MASK];
+                m.row(i % 3) = v.theirs[i & MASK].transpose();
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix3::setColumn",
+            [&](size_t i) { Matrix3 m = ma[i & MASK]; m.setColumn(i % 3, v.mine[i & MASK]); doNotOptimize(m); },
+            [&](size_t i) { EMatrix3 m = ea[i & MASK]; m.col(i % 3) = v.theirs[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix3::getRow",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getRow(i % 3)); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK].row(i % 3).transpose())); });
+    compare(s, "Matrix3::getColumn",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getColumn(i % 3)); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK].col(i % 3))); });
+    compare(s, "Matrix3::setRotationMatrix",
+            [&](size_t i) { Matrix3 m; m.setRotationMatrix(v.mine[i & MASK], k[i & MASK], RAD); doNotOptimize(m); },
+            [&](size_t i) {
+                doNotOptimize(EMatrix3(
+                    Eigen::AngleAxis<scalar>(k[i & MASK], v.theirs[i & MASK].normalized()).toRotationMatrix()));
+            });
+    compare(s, "Matrix3::toHomogenous",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].toHomogenous()); },
+            [&](size_t i) {
+                EMatrix4 m = EMatrix4::Identity();
+                m.topLeftCorner<3, 3>() = ea[i & MASK];
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix3::getDeterminant",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getDeterminant()); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].determinant()); });
+    compare(s, "Matrix3::isRotationMatrix",
+            [&](size_t i) { doNotOptimize(mr[i & MASK].isRotationMatrix()); },
+            [&](size_t i) {
+                const EMatrix3& m = er[i & MASK];
+                doNotOptimize((std::abs(m.determinant() - 1) <= MYEPSILON) &&
+                              (m * m.transpose()).isIdentity(static_cast<scalar>(MYEPSILON)));
+            });
+    compare(s, "Matrix3::transpose",
+            [&](size_t i) { Matrix3 m = ma[i & MASK]; m.transpose(); doNotOptimize(m); },
+            [&](size_t i) { EMatrix3 m = ea[i & MASK]; m.transposeInPlace(); doNotOptimize(m); });
+    compare(s, "Matrix3::transposed",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].transposed()); },
+            [&](size_t i) { doNotOptimize(EMatrix3(ea[i & MASK].transpose())); });
+    compare(s, "Matrix3::computeInverse",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].computeInverse()); },
+            [&](size_t i) { doNotOptimize(EMatrix3(ea[i & MASK].inverse())); });
+    compare(s, "Matrix3::inverse",
+            [&](size_t i) { Matrix3 m = ma[i & MASK]; m.inverse(); doNotOptimize(m); },
+            [&](size_t i) { EMatrix3 m = ea[i & MASK]; m = m.inverse().eval(); doNotOptimize(m); });
+    compare(s, "Matrix3::isInversed",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].isInversed()); },
+            [&](size_t i) { doNotOptimize(std::abs(ea[i & MASK].determinant()) >= MYEPSILON); });
+    compare(s, "Matrix3::operator+",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] + mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix3(ea[i & MASK] + eb[i & MASK])); });
+    compare(s, "Matrix3::operator+=",
+            [&](size_t i) { Matrix3 m = ma[i & MASK]; m += mb[i & MASK]; doNotOptimize(m); },
+            [&](size_t i) { EMatrix3 m = ea[i & MASK]; m += eb[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix3::operator-",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] - mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix3(ea[i & MASK] - eb[i & MASK])); });
+    compare(s, "Matrix3::operator-()",
+            [&](size_t i) { doNotOptimize(-ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix3(-ea[i & MASK])); });
+    compare(s, "Matrix3::matmul",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].matmul(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EMatrix3(ea[i & MASK] * eb[i & MASK])); });
+    compare(s, "Matrix3::operator*(Matrix3)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix3(ea[i & MASK] * eb[i & MASK])); });
+    compare(s, "Matrix3::operator*=(Matrix3)",
+            [&](size_t i) { Matrix3 m = ma[i & MASK]; m *= mb[i & MASK]; doNotOptimize(m); },
+            [&](size_t i) { EMatrix3 m = ea[i & MASK]; m *= eb[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix3::operator*(Vector3)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * v.mine[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3(ea[i & MASK] * v.theirs[i & MASK])); });
+    compare(s, "Vector3 * Matrix3",
+            [&](size_t i) { doNotOptimize(v.mine[i & MASK] * ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector3((v.theirs[i & MASK].transpose() * ea[i & MASK]).transpose())); });
+    compare(s, "Matrix3::operator*(scalar)",
+            [&](size_t i) { Matrix3 m = ma[i & MASK]; doNotOptimize(m * k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix3(ea[i & MASK] * k[i & MASK])); });
+    compare(s, "Matrix3::operator/(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] / k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix3(ea[i & MASK] / k[i & MASK])); });
+    compare(s, "Matrix3::equal",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].equal(mb[i & MASK])); },
+            [&](size_t i) {
+                doNotOptimize((ea[i & MASK] - eb[i & MASK]).cwiseAbs().maxCoeff() <= scalar(MYEPSILON));
+            });
+    compare(s, "Matrix3::operator()",
+            [&](size_t i) { doNotOptimize(ma[i & MASK](i % 3, (i >> 2) % 3)); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK](i % 3, (i >> 2) % 3)); });
+}
+
+/** @brief Eigen counterpart of Matrix4::setFrustum(). */
+static EMatrix4 eigenFrustum(scalar l, scalar r, scalar b, scalar t, scalar n, scalar f) {
+    EMatrix4 m = EMatrix4::Zero();
+    m(0, 0) = 2 * n / (r - l);
+    m(0, 2) = (r + l) / (r - l);
+    m(1, 1) = 2 * n / (t - b);
+    m(1, 2) = (t + b) / (t - b);
+    m(2, 2) = -(f + n) / (f - n);
+    m(2, 3) = -2 * f * n / (f - n);
+    m(3, 2) = -1;
+    return m;
+}
+
+/** @brief Eigen counterpart of Matrix4::setOrthographic(). */
+static EMatrix4 eigenOrthographic(scalar l, scalar r, scalar b, scalar t, scalar n, scalar f) {
+    EMatrix4 m = EMatrix4::Identity();
+    m(0, 0) = 2 / (r - l);
+    m(0, 3) = -(r + l) / (r - l);
+    m(1, 1) = 2 / (t - b);
+    m(1, 3) = -(t + b) / (t - b);
+    m(2, 2) = -2 / (f - n);
+    m(2, 3) = -(f + n) / (f - n);
+    return m;
+}
+
+/** @brief Eigen counterpart of Matrix4::setLookAt(). */
+static EMatrix4 eigenLookAt(const EVector3& eye, const EVector3& target, const EVector3& up) {
+    const EVector3 f = (target - eye).normalized();
+    const EVector3 s = f.cross(up).normalized();
+    const EVector3 u = s.cross(f);
+    EMatrix4 m = EMatrix4::Identity();
+    m.row(0) << s.transpose(), -s.dot(eye);
+    m.row(1) << u.transpose(), -u.dot(eye);
+    m.row(2) << -f.transpose(), f.dot(eye);
+    return m;
+}
+
+static void benchMatrix4(BenchmarkSuite& s) {
+    const Table<Matrix4, EMatrix4> a = randomMatrix4(), b = randomMatrix4();
+    const Table<Matrix4, EMatrix4> rot = euclideanMatrix4(false), rigid = euclideanMatrix4(true);
+    const Table<Matrix4, EMatrix4> affine = affineMatrix4();
+    const std::vector<Matrix4>& ma = a.mine;
+    const std::vector<Matrix4>& mb = b.mine;
+    const std::vector<EMatrix4>& ea = a.theirs;
+    const std::vector<EMatrix4>& eb = b.theirs;
+    const Table<Vector4, EVector4> v = randomVector4();
+    const Table<Vector3, EVector3> v3 = randomVector3();
+    std::vector<scalar> k(TABLE);
+    for (scalar& x : k) x = uniform(0.5f, 2);
+    Table<Matrix4, EMatrix4> persp, ortho;
+    for (size_t i = 0; i < TABLE; ++i) {
+        Matrix4 p, o;
+        p.setPerspective(uniform(40, 90), uniform(1, 2), uniform(0.1f, 1), uniform(50, 100));
+        o.setOrthographic(-k[i], k[i], -1, 1, 0.5f, 20 * k[i]);
+        persp.mine.push_back(p);
+        persp.theirs.push_back(toEigen<EMatrix4, Matrix4, 4>(p));
+        ortho.mine.push_back(o);
+        ortho.theirs.push_back(toEigen<EMatrix4, Matrix4, 4>(o));
+    }
+
+    compare(s, "Matrix4::Matrix4()",
+            [&](size_t) { doNotOptimize(Matrix4()); },
+            [&](size_t) { doNotOptimize(EMatrix4(EMatrix4::Identity())); });
+    compare(s, "Matrix4::Matrix4(const scalar*)",
+            [&](size_t i) { doNotOptimize(Matrix4(ma[i & MASK].constData())); },
+            [&](size_t i) { doNotOptimize(EMatrix4(Eigen::Map<const EMatrix4>(ma[i & MASK].constData()))); });
+    compare(s, "Matrix4::Matrix4(const Matrix4&)",
+            [&](size_t i) { doNotOptimize(Matrix4(ma[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK])); });
+    compare(s, "Matrix4::setIdentity",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m.setIdentity(); doNotOptimize(m); },
+            [&](size_t i) { EMatrix4 m = ea[i & MASK]; m.setIdentity(); doNotOptimize(m); });
+    compare(s, "Matrix4::setRow",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m.setRow(i & 3, v.mine[i & MASK]); doNotOptimize(m); },
+            [&](size_t i) {
+                EMatrix4 m = ea[i & MASK];
+                m.row(i & 3) = v.theirs[i & MASK].transpose();
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix4::setColumn",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m.setColumn(i & 3, v.mine[i & MASK]); doNotOptimize(m); },
+            [&](size_t i) { EMatrix4 m = ea[i & MASK]; m.col(i & 3) = v.theirs[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix4::getRow",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getRow(i & 3)); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK].row(i & 3).transpose())); });
+    compare(s, "Matrix4::getColumn",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getColumn(i & 3)); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK].col(i & 3))); });
+
+    compare(s, "Matrix4::setFrustum",
+            [&](size_t i) {
+                Matrix4 m;
+                m.setFrustum(-k[i & MASK], k[i & MASK], -1, 1, 0.5f, 50 * k[i & MASK]);
+                doNotOptimize(m);
+            },
+            [&](size_t i) { doNotOptimize(eigenFrustum(-k[i & MASK], k[i & MASK], -1, 1, 0.5f, 50 * k[i & MASK])); });
+    compare(s, "Matrix4::setPerspective",
+            [&](size_t i) {
+                Matrix4 m;
+                m.setPerspective(k[i & MASK], 1.5f, 0.5f, 100, RAD);
+                doNotOptimize(m);
+            },
+            [&](size_t i) {
+                const scalar t = 0.5f * std::tan(k[i & MASK] / 2);
+                doNotOptimize(eigenFrustum(-1.5f * t, 1.5f * t, -t, t, 0.5f, 100));
+            });
+    compare(s, "Matrix4::setOrthographic",
+            [&](size_t i) {
+                Matrix4 m;
+                m.setOrthographic(-k[i & MASK], k[i & MASK], -1, 1, 0.5f, 50 * k[i & MASK]);
+                doNotOptimize(m);
+            },
+            [&](size_t i) {
+                doNotOptimize(eigenOrthographic(-k[i & MASK], k[i & MASK], -1, 1, 0.5f, 50 * k[i & MASK]));
+            });
+    compare(s, "Matrix4::setLookAt",
+            [&](size_t i) {
+                Matrix4 m;
+                m.setLookAt(v3.mine[i & MASK] * 10, v3.mine[(i + 1) & MASK], Vector3(0, 1, 0));
+                doNotOptimize(m);
+            },
+            [&](size_t i) {
+                doNotOptimize(eigenLookAt(v3.theirs[i & MASK] * 10, v3.theirs[(i + 1) & MASK], EVector3(0, 1, 0)));
+            });
+
+    compare(s, "Matrix4::getDeterminant",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].getDeterminant()); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK].determinant()); });
+    compare(s, "Matrix4::isRotationMatrix",
+            [&](size_t i) { doNotOptimize(rot.mine[i & MASK].isRotationMatrix()); },
+            [&](size_t i) {
+                const EMatrix4& m = rot.theirs[i & MASK];
+                const EMatrix3 r = m.topLeftCorner<3, 3>();
+                doNotOptimize(m.row(3).isApprox(EVector4(0, 0, 0, 1).transpose()) &&
+                              m.col(3).head<3>().isZero(static_cast<scalar>(MYEPSILON)) &&
+                              (std::abs(r.determinant() - 1) <= MYEPSILON) &&
+                              (r * r.transpose()).isIdentity(static_cast<scalar>(MYEPSILON)));
+            });
+    compare(s, "Matrix4::isEuclideanMatrix",
+            [&](size_t i) { doNotOptimize(rigid.mine[i & MASK].isEuclideanMatrix()); },
+            [&](size_t i) {
+                const EMatrix4& m = rigid.theirs[i & MASK];
+                doNotOptimize(m.row(3).isApprox(EVector4(0, 0, 0, 1).transpose()) &&
+                              (std::abs(m.topLeftCorner<3, 3>().determinant()) - 1 <= MYEPSILON));
+            });
+    compare(s, "Matrix4::isAffineMatrix",
+            [&](size_t i) { doNotOptimize(affine.mine[i & MASK].isAffineMatrix()); },
+            [&](size_t i) {
+                const EMatrix4& m = affine.theirs[i & MASK];
+                doNotOptimize(m.row(3).isApprox(EVector4(0, 0, 0, 1).transpose()) &&
+                              (std::abs(m.topLeftCorner<3, 3>().determinant()) > MYEPSILON));
+            });
+    compare(s, "Matrix4::isPeojectiveMatrix",
+            [&](size_t i) { doNotOptimize(persp.mine[i & MASK].isPeojectiveMatrix()); },
+            [&](size_t i) {
+                const EMatrix4& m = persp.theirs[i & MASK];
+                doNotOptimize(std::abs(m.topLeftCorner<2, 2>().determinant()) >= MYEPSILON);
+            });
+    compare(s, "Matrix4::transpose",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m.transpose(); doNotOptimize(m); },
+            [&](size_t i) { EMatrix4 m = ea[i & MASK]; m.transposeInPlace(); doNotOptimize(m); });
+    compare(s, "Matrix4::transposed",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].transposed()); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK].transpose())); });
+    compare(s, "Matrix4::computeInverse",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].computeInverse()); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK].inverse())); });
+    compare(s, "Matrix4::inverse",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m.inverse(); doNotOptimize(m); },
+            [&](size_t i) { EMatrix4 m = ea[i & MASK]; m = m.inverse().eval(); doNotOptimize(m); });
+    compare(s, "Matrix4::isInversed",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].isInversed()); },
+            [&](size_t i) { doNotOptimize(std::abs(ea[i & MASK].determinant()) >= MYEPSILON); });
+    compare(s, "Matrix4::computeRotationInverse",
+            [&](size_t i) { doNotOptimize(rot.mine[i & MASK].computeRotationInverse()); },
+            [&](size_t i) { doNotOptimize(EMatrix4(rot.theirs[i & MASK].transpose())); });
+    compare(s, "Matrix4::computeEuclideanInverse",
+            [&](size_t i) { doNotOptimize(rigid.mine[i & MASK].computeEuclideanInverse()); },
+            [&](size_t i) {
+                doNotOptimize(EMatrix4(EAffine3(rigid.theirs[i & MASK]).inverse(Eigen::Isometry).matrix()));
+            });
+    compare(s, "Matrix4::computeAffineInverse",
+            [&](size_t i) { doNotOptimize(affine.mine[i & MASK].computeAffineInverse()); },
+            [&](size_t i) {
+                doNotOptimize(EMatrix4(EAffine3(affine.theirs[i & MASK]).inverse(Eigen::Affine).matrix()));
+            });
+    compare(s, "Matrix4::computeProjectiveInverse",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].computeProjectiveInverse()); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK].inverse())); });
+    compare(s, "Matrix4::computePerspectiveInverse",
+            [&](size_t i) { doNotOptimize(persp.mine[i & MASK].computePerspectiveInverse()); },
+            [&](size_t i) { doNotOptimize(EMatrix4(persp.theirs[i & MASK].inverse())); });
+    compare(s, "Matrix4::computeOrthographicInverse",
+            [&](size_t i) { doNotOptimize(ortho.mine[i & MASK].computeOrthographicInverse()); },
+            [&](size_t i) {
+                doNotOptimize(EMatrix4(EAffine3(ortho.theirs[i & MASK]).inverse(Eigen::Affine).matrix()));
+            });
+
+    compare(s, "Matrix4::translate",
+            [&](size_t i) {
+                Matrix4 m = rigid.mine[i & MASK];
+                m.translate(v3.mine[i & MASK]);
+                doNotOptimize(m);
+            },
+            [&](size_t i) {
+                EAffine3 m(rigid.theirs[i & MASK]);
+                m.pretranslate(v3.theirs[i & MASK]);
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix4::rotate",
+            [&](size_t i) {
+                Matrix4 m = rigid.mine[i & MASK];
+                m.rotate(k[i & MASK] * 90, v3.mine[i & MASK]);
+                doNotOptimize(m);
+            },
+            [&](size_t i) {
+                EAffine3 m(rigid.theirs[i & MASK]);
+                m.prerotate(Eigen::AngleAxis<scalar>(k[i & MASK] * 90 * PI_S / 180, v3.theirs[i & MASK].normalized()));
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix4::rotateX",
+            [&](size_t i) { Matrix4 m = rigid.mine[i & MASK]; m.rotateX(k[i & MASK] * 90); doNotOptimize(m); },
+            [&](size_t i) {
+                EAffine3 m(rigid.theirs[i & MASK]);
+                m.prerotate(Eigen::AngleAxis<scalar>(k[i & MASK] * 90 * PI_S / 180, EVector3::UnitX()));
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix4::rotateY",
+            [&](size_t i) { Matrix4 m = rigid.mine[i & MASK]; m.rotateY(k[i & MASK] * 90); doNotOptimize(m); },
+            [&](size_t i) {
+                EAffine3 m(rigid.theirs[i & MASK]);
+                m.prerotate(Eigen::AngleAxis<scalar>(k[i & MASK] * 90 * PI_S / 180, EVector3::UnitY()));
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix4::rotateZ",
+            [&](size_t i) { Matrix4 m = rigid.mine[i & MASK]; m.rotateZ(k[i & MASK] * 90); doNotOptimize(m); },
+            [&](size_t i) {
+                EAffine3 m(rigid.theirs[i & MASK]);
+                m.prerotate(Eigen::AngleAxis<scalar>(k[i & MASK] * 90 * PI_S / 180, EVector3::UnitZ()));
+                doNotOptimize(m);
+            });
+    compare(s, "Matrix4::scale",
+            [&](size_t i) {
+                Matrix4 m = rigid.mine[i & MASK];
+                m.scale(k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK]);
+                doNotOptimize(m);
+            },
+            [&](size_t i) {
+                EAffine3 m(rigid.theirs[i & MASK]);
+                m.prescale(EVector3(k[i & MASK], k[(i + 1) & MASK], k[(i + 2) & MASK]));
+                doNotOptimize(m);
+            });
+
+    compare(s, "Matrix4::operator+",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] + mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK] + eb[i & MASK])); });
+    compare(s, "Matrix4::operator+=",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m += mb[i & MASK]; doNotOptimize(m); },
+            [&](size_t i) { EMatrix4 m = ea[i & MASK]; m += eb[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix4::operator-",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] - mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK] - eb[i & MASK])); });
+    compare(s, "Matrix4::operator-=",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m -= mb[i & MASK]; doNotOptimize(m); },
+            [&](size_t i) { EMatrix4 m = ea[i & MASK]; m -= eb[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix4::operator-()",
+            [&](size_t i) { doNotOptimize(-ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix4(-ea[i & MASK])); });
+    compare(s, "Matrix4::matmul",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].matmul(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK] * eb[i & MASK])); });
+    compare(s, "Matrix4::operator*(Matrix4)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK] * eb[i & MASK])); });
+    compare(s, "Matrix4::operator*=(Matrix4)",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m *= mb[i & MASK]; doNotOptimize(m); },
+            [&](size_t i) { EMatrix4 m = ea[i & MASK]; m *= eb[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix4::operator*(Vector4)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] * v.mine[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4(ea[i & MASK] * v.theirs[i & MASK])); });
+    compare(s, "Vector4 * Matrix4",
+            [&](size_t i) { doNotOptimize(v.mine[i & MASK] * ma[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EVector4((v.theirs[i & MASK].transpose() * ea[i & MASK]).transpose())); });
+    compare(s, "Matrix4::operator*(scalar)",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; doNotOptimize(m * k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK] * k[i & MASK])); });
+    compare(s, "Matrix4::operator*=(scalar)",
+            [&](size_t i) { Matrix4 m = ma[i & MASK]; m *= k[i & MASK]; doNotOptimize(m); },
+            [&](size_t i) { EMatrix4 m = ea[i & MASK]; m *= k[i & MASK]; doNotOptimize(m); });
+    compare(s, "Matrix4::operator/(scalar)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] / k[i & MASK]); },
+            [&](size_t i) { doNotOptimize(EMatrix4(ea[i & MASK] / k[i & MASK])); });
+    compare(s, "Matrix4::equal",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].equal(mb[i & MASK])); },
+            [&](size_t i) {
+                doNotOptimize((ea[i & MASK] - eb[i & MASK]).cwiseAbs().maxCoeff() <= scalar(MYEPSILON));
+            });
+    compare(s, "Matrix4::operator==",
+            [&](size_t i) { doNotOptimize(ma[i & MASK] == mb[i & MASK]); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK] == eb[i & MASK]); });
+    compare(s, "Matrix4::operator()",
+            [&](size_t i) { doNotOptimize(ma[i & MASK](i & 3, (i >> 2) & 3)); },
+            [&](size_t i) { doNotOptimize(ea[i & MASK](i & 3, (i >> 2) & 3)); });
+}
+
+/** @brief random R x C matrices on both sides, Eigen fixed size needs the aligned allocator. */
+template <int R, int C>
+static void randomMatrixN(std::vector<MatrixN<R, C>>& mine,
+                          std::vector<Eigen::Matrix<scalar, R, C>, Eigen::aligned_allocator<Eigen::Matrix<scalar, R, C>>>& theirs) {
+    for (size_t i = 0; i < TABLE; ++i) {
+        MatrixN<R, C> m;
+        for (int k = 0; k < R * C; ++k) m.data()[k] = uniform(-1, 1);
+        mine.push_back(m);
+        theirs.push_back(Eigen::Map<const Eigen::Matrix<scalar, R, C>>(m.constData()));
+    }
+}
+
+/** @brief pose estimation sizes, 6x6 information matrices and 3x6 Jacobians. */
+static void benchMatrixN(BenchmarkSuite& s) {
+    typedef Eigen::Matrix<scalar, 6, 6> EMatrix6;
+    typedef Eigen::Matrix<scalar, 3, 6> EMatrix36;
+    typedef Eigen::Matrix<scalar, 6, 1> EVector6;
+    std::vector<MatrixN<6, 6>> ma, mb;
+    std::vector<MatrixN<3, 6>> mj;
+    std::vector<VectorN<6>> mv;
+    std::vector<EMatrix6, Eigen::aligned_allocator<EMatrix6>> ea, eb;
+    std::vector<EMatrix36, Eigen::aligned_allocator<EMatrix36>> ej;
+    std::vector<EVector6, Eigen::aligned_allocator<EVector6>> ev;
+    randomMatrixN(ma, ea);
+    randomMatrixN(mb, eb);
+    randomMatrixN(mj, ej);
+    randomMatrixN(mv, ev);
+    // symmetric positive definite, A^T A + I
+    std::vector<MatrixN<6, 6>> mh;
+    std::vector<EMatrix6, Eigen::aligned_allocator<EMatrix6>> eh;
+    for (size_t i = 0; i < TABLE; ++i) {
+        mh.push_back(ma[i].transposeMatmul(ma[i]) + MatrixN<6, 6>::identity());
+        eh.push_back(Eigen::Map<const EMatrix6>(mh.back().constData()));
+    }
+    compare(s, "MatrixN<6,6>::matmul",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].matmul(mb[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EMatrix6(ea[i & MASK] * eb[i & MASK])); });
+    compare(s, "MatrixN<6,6>::matmul(VectorN<6>)",
+            [&](size_t i) { doNotOptimize(ma[i & MASK].matmul(mv[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EVector6(ea[i & MASK] * ev[i & MASK])); });
+    compare(s, "MatrixN<3,6>::transposeMatmul",
+            [&](size_t i) { doNotOptimize(mj[i & MASK].transposeMatmul(mj[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EMatrix6(ej[i & MASK].transpose() * ej[i & MASK])); });
+    compare(s, "CholeskyN<6>::solve",
+            [&](size_t i) { doNotOptimize(CholeskyN<6>(mh[i & MASK]).solve(mv[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EVector6(eh[i & MASK].llt().solve(ev[i & MASK]))); });
+    compare(s, "LDLTN<6>::solve",
+            [&](size_t i) { doNotOptimize(LDLTN<6>(mh[i & MASK]).solve(mv[i & MASK])); },
+            [&](size_t i) { doNotOptimize(EVector6(eh[i & MASK].ldlt().solve(ev[i & MASK]))); });
+}
+
+/** @brief batch kernels, in cache and out of cache sizes, one thread so that the counters see all work. */
+static void benchBatch(BenchmarkSuite& s) {
+    Matrix4 mat;
+    mat.rotate(30, Vector3(1, 2, 3));
+    mat.translate(1, 2, 3);
+    const EMatrix4 emat = toEigen<EMatrix4, Matrix4, 4>(mat);
+    setThreadCount(1);
+    for (size_t n : {size_t(1) << 10, size_t(1) << 22}) {
+        const std::string suffix = "(" + std::to_string(n) + ")";
+        if (!s.isSelected("transformPoints" + suffix) && !s.isSelected("computeBounds" + suffix)) continue;
+        std::vector<Vector3> in(n), out(n);
+        for (Vector3& p : in) p.set(uniform(-10, 10), uniform(-10, 10), uniform(-10, 10));
+        Eigen::Matrix<scalar, 3, Eigen::Dynamic> ein(3, n), eout(3, n);
+        for (size_t i = 0; i < n; ++i) ein.col(i) << in[i].x, in[i].y, in[i].z;
+        compare(s, "transformPoints" + suffix,
+                [&](size_t) { transformPoints(mat, in.data(), n, out.data()); doNotOptimize(out[0]); },
+                [&](size_t) {
+                    eout.noalias() = (emat.topLeftCorner<3, 3>() * ein).colwise() + emat.topRightCorner<3, 1>();
+                    doNotOptimize(eout(0, 0));
+                }, n);
+        compare(s, "computeBounds" + suffix,
+                [&](size_t) { Vector3 lo, hi; computeBounds(in.data(), n, lo, hi); doNotOptimize(lo); doNotOptimize(hi); },
+                [&](size_t) {
+                    EVector3 lo = ein.rowwise().minCoeff(), hi = ein.rowwise().maxCoeff();
+                    doNotOptimize(lo);
+                    doNotOptimize(hi);
+                }, n);
+    }
+    if (s.isSelected("invertMatrices")) {
+        const Table<Matrix4, EMatrix4> t = randomMatrix4();
+        std::vector<Matrix4> out(t.mine.size());
+        std::vector<EMatrix4> eout(t.theirs.size());
+        compare(s, "invertMatrices",
+                [&](size_t) { doNotOptimize(invertMatrices(t.mine.data(), t.mine.size(), out.data())); },
+                [&](size_t) {
+                    for (size_t i = 0; i < t.theirs.size(); ++i) eout[i] = t.theirs[i].inverse();
+                    doNotOptimize(eout[0](0, 0));
+                }, t.mine.size());
+    }
+    setThreadCount(0);
+}
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite((argc > 3) ? std::atoi(argv[3]) : 31);
+    if (argc > 1) suite.setFilter(argv[1]);
+    const std::string json = (argc > 2) ? argv[2] : "bench_eigen.json";
+    if ((argc > 4) && (std::string(argv[4]) == "perf")) suite.enableCounters();
+
+    benchVector2(suite);
+    benchVector3(suite);
+    benchVector4(suite);
+    benchMatrix2(suite);
+    benchMatrix3(suite);
+    benchMatrix4(suite);
+    benchMatrixN(suite);
+    printf("batch kernels: %s\n", getISAName(getISA()));
+    benchBatch(suite);
+
+    suite.printTable(stdout, "eigen");
+    suite.writeJSON(json, "eigen");
+    printf("results written to %s\n", json.c_str());
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "mybatch.hpp"
+#include "myparallel.hpp"
+
+// Scaling of Matrix4 batch transforms over the built-in work-stealing pool.
+// usage: bench_parallel [points] [max threads] [repeats]
+int main(int argc, char** argv) {
+    const size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : (size_t(1) << 24);
+    const unsigned int max_threads = (argc > 2) ? std::atoi(argv[2]) : 64;
+    const int repeats = (argc > 3) ? std::atoi(argv[3]) : 10;
+
+    std::vector<Vector3> in(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        in[i].set(static_cast<scalar>(i % 1000), static_cast<scalar>(i % 777), static_cast<scalar>(i % 555));
+    }
+    Matrix4 mat;
+    mat.rotate(30, Vector3(1, 2, 3));
+    mat.translate(1, 2, 3);
+
+    printf("points %zu, hardware threads %u\n", n, getThreadCount());
+    printf("%8s %12s %12s %10s %10s\n", "threads", "ms", "Mpoints/s", "speedup", "efficiency");
+    double base = 0;
+    for (unsigned int t = 1; t <= max_threads; t *= 2) {
+        setThreadCount(t);
+        transformPoints(mat, in.data(), n, out.data()); // warm up, builds the pool
+        double best = 1e30;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            transformPoints(mat, in.data(), n, out.data());
+            std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+            if (ms.count() < best) best = ms.count();
+        }
+        if (t == 1) base = best;
+        printf("%8u %12.3f %12.1f %10.2f %9.0f%%\n", t, best, n / best * 1e-3, base / best,
+               100.0 * base / best / t);
+    }
+    setThreadCount(0);
+
+    // reductions and nested loops go through the same pool
+    Vector3 lo, hi;
+    auto start = std::chrono::steady_clock::now();
+    computeBounds(out.data(), n, lo, hi);
+    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+    printf("computeBounds %.3f ms, (%g %g %g) - (%g %g %g)\n", ms.count(), lo.x, lo.y, lo.z, hi.x, hi.y, hi.z);
+    return 0;
+}
@@ -35,3 +35,25 @@ enum ANGLEUNIT {
     /** degree */
     DEG
 };
+
+/**
+ *  @brief result of testing a volume against a region (box, frustum...).
+ */
+enum CONTAINMENT {
+    /** completely outside the region */
+    OUTSIDE,
+    /** partially inside the region */
+    INTERSECT,
+    /** completely inside the region */
+    INSIDE
+};
+
+/**
+ *  @brief option for clip space depth range of projection matrices.
+ */
+enum CLIPDEPTH {
+    /** OpenGL convention, z_ndc in [-1, 1] */
+    NEGATIVE_ONE_TO_ONE,
+    /** Direct3D/Vulkan and reversed-Z convention, z_ndc in [0, 1] */
+    ZERO_TO_ONE
+};
@@ -0,0 +1,107 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myaccuracy.hpp
+ *  @brief ULP error statistics of scalar results against double precision references.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-2
+ *  @note element error: |value - reference| in units in the last place of scalar at the
+ *  @note reference, large wherever a result cancels to nearly zero.
+ *  @note norm error: max |value - reference| over the elements of one result in units in
+ *  @note the last place at the largest reference element, the usual measure for matrices.
+ *  @note non-finite results with a finite reference (or the other way round) are counted
+ *  @note as failures and kept out of max and mean.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "mathutils.hpp"
+#include "mybenchmark.hpp"
+
+/**
+ * @brief error of value in units in the last place of scalar at reference.
+ * @return 0 if both are the same non-finite value, infinity if only one is finite.
+ */
+double ulpError(scalar value, double reference);
+
+/**
+ *  @brief UlpStats struct, running maximum and mean of ULP errors.
+ */
+struct UlpStats {
+    /** @brief number of finite errors. */
+    size_t count = 0;
+    /** @brief number of infinite errors. */
+    size_t failures = 0;
+    /** @brief largest finite error. */
+    double max = 0;
+    /** @brief sum of the finite errors. */
+    double sum = 0;
+    /** @brief input index of the largest error. */
+    size_t worst = 0;
+
+    /** @brief add the error of input index. */
+    void add(double ulps, size_t index);
+    /** @brief mean of the finite errors. */
+    double mean() const { return count ? sum / count : 0; }
+};
+
+/**
+ *  @brief AccuracyResult struct, errors of one operation on one input class.
+ */
+struct AccuracyResult {
+    /** @brief operation, the same name as its benchmark, e.g. "Matrix4::computeInverse". */
+    std::string name;
+    /** @brief input class, e.g. "random", "near-singular". */
+    std::string input;
+    /** @brief errors of every element. */
+    UlpStats element;
+    /** @brief errors of every result relative to its largest element. */
+    UlpStats norm;
+    /** @brief inputs the operation refused, e.g. matrices failing isInversed(). */
+    size_t rejected = 0;
+};
+
+/**
+ *  @brief AccuracyReport class, collects AccuracyResult per operation and input class.
+ */
+class AccuracyReport {
+  private:
+    std::vector<AccuracyResult> results;
+
+    /** @brief entry of name and input, created on first use. */
+    AccuracyResult& entry(const std::string& name, const std::string& input);
+
+  protected:
+  public:
+    /**
+     * @brief add one result of n elements.
+     * @param name operation.
+     * @param input input class.
+     * @param values n results.
+     * @param references n double precision references.
+     * @param n number of elements.
+     * @param index input index, reported for the worst error.
+     */
+    void add(const std::string& name, const std::string& input, const scalar* values,
+             const double* references, int n, size_t index);
+    /** @brief count an input the operation refused. */
+    void reject(const std::string& name, const std::string& input) { ++entry(name, input).rejected; }
+    /** @brief results in order of first use. */
+    const std::vector<AccuracyResult>& getResults() const { return results; }
+    /**
+     * @brief print one line per operation and input class.
+     * @param timing benchmark results matched by name, columns are left empty if null.
+     */
+    void printTable(FILE* out = stdout, const std::vector<BenchmarkResult>* timing = nullptr) const;
+    /**
+     * @brief write the results as JSON.
+     * @param timing benchmark results matched by name, added as "<variant>_ns" if not null.
+     * @exception the file cannot be written.
+     */
+    void writeJSON(const std::string& path, const std::vector<BenchmarkResult>* timing = nullptr) const;
+};
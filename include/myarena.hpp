@@ -0,0 +1,220 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myarena.hpp
+ *  @brief monotonic arena, size class pool and per-thread frame arenas for scratch buffers.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-26
+ *  @note memory handed out by an arena is never freed one by one, it is reclaimed at
+ *  @note once by reset() or by rewinding to a mark, destructors are not run, so only
+ *  @note trivially destructible types may be placed in it.
+ *  @note an arena keeps its blocks after reset(), a pipeline that needs the same amount
+ *  @note of scratch every frame stops allocating from the heap after the first frame.
+ *  @note arenas and pools are not thread safe, use one per thread, see getThreadArena().
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ *  @brief Arena class, monotonic allocator over a list of heap blocks.
+ */
+class Arena {
+  private:
+    /** @brief one heap block. */
+    struct Block {
+        unsigned char* data;
+        size_t size;
+    };
+    /** @brief blocks in allocation order, blocks after current are free. */
+    std::vector<Block> blocks;
+    /** @brief index of the block allocations are taken from. */
+    size_t current = 0;
+    /** @brief bytes used in the current block. */
+    size_t offset = 0;
+    /** @brief minimum size of a new block. */
+    size_t block_size;
+    /** @brief number of heap allocations made so far. */
+    size_t heap_allocations = 0;
+    /** @brief number of live ArenaScope objects, used by getThreadArena(). */
+    int scopes = 0;
+
+    friend class ArenaScope;
+    friend Arena& getThreadArena();
+
+  protected:
+  public:
+    /** @brief position in an arena, see mark() and rewind(). */
+    struct Marker {
+        size_t block;
+        size_t offset;
+    };
+
+    /**
+     * @brief constructor, no memory is allocated until the first allocate().
+     * @param blockSize minimum size in bytes of every heap block.
+     */
+    explicit Arena(size_t blockSize = size_t(1) << 20);
+    /** @brief free all blocks. */
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief allocate uninitialized memory.
+     * @param bytes number of bytes.
+     * @param align alignment, power of two.
+     * @return pointer valid until reset(), release() or a rewind() before it.
+     */
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+    /**
+     * @brief allocate n default constructed elements.
+     * @param n number of elements.
+     * @return pointer to n elements.
+     */
+    template <typename T>
+    T* allocate(size_t n) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+        T* p = static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+        for (size_t i = 0; i < n; ++i) new (p + i) T();
+        return p;
+    }
+    /**
+     * @brief allocate n elements without construction, for plain data overwritten anyway.
+     * @param n number of elements.
+     * @return pointer to n elements.
+     */
+    template <typename T>
+    T* allocateUninitialized(size_t n) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /** @brief current position. */
+    Marker mark() const { return Marker{current, offset}; }
+    /** @brief free everything allocated after a mark, the blocks are kept. */
+    void rewind(const Marker& m) {
+        current = m.block;
+        offset = m.offset;
+    }
+    /**
+     * @brief free everything, the blocks are kept.
+     * @note several blocks are merged into one so that the next frame fits in a single block.
+     */
+    void reset();
+    /** @brief free everything and return the blocks to the heap. */
+    void release();
+
+    /** @brief bytes handed out since the last reset(), including alignment padding. */
+    size_t bytesUsed() const;
+    /** @brief bytes held in blocks. */
+    size_t capacity() const;
+    /** @brief number of heap allocations made so far, constant in a steady state. */
+    size_t heapAllocations() const { return heap_allocations; }
+};
+
+/**
+ *  @brief ArenaScope class, rewinds an arena to its position at construction.
+ */
+class ArenaScope {
+  private:
+    Arena& arena;
+    Arena::Marker marker;
+
+  public:
+    /** @brief remember the position of an arena. */
+    explicit ArenaScope(Arena& a) :
+        arena(a), marker(a.mark()) { ++arena.scopes; }
+    /** @brief free everything allocated through the scope. */
+    ~ArenaScope() {
+        arena.rewind(marker);
+        --arena.scopes;
+    }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    /** @see T* Arena::allocate(size_t n) */
+    template <typename T>
+    T* allocate(size_t n) { return arena.allocate<T>(n); }
+    /** @see T* Arena::allocateUninitialized(size_t n) */
+    template <typename T>
+    T* allocateUninitialized(size_t n) { return arena.allocateUninitialized<T>(n); }
+};
+
+/**
+ *  @brief SizeClassPool class, recycles freed buffers by power of two size class.
+ *  @note memory comes from an internal arena, freed buffers go to a free list of their
+ *  @note class and are handed out again, nothing is returned to the heap before reset().
+ */
+class SizeClassPool {
+  private:
+    /** @brief number of classes, class k holds buffers of 16 << k bytes. */
+    static const int CLASSES = 24;
+    Arena arena;
+    /** @brief head of the free list of every class. */
+    void* free_list[CLASSES];
+
+    /** @brief class of a request, CLASSES if too large for any class. */
+    static int sizeClass(size_t bytes);
+
+  public:
+    /** @param blockSize block size of the internal arena. */
+    explicit SizeClassPool(size_t blockSize = size_t(1) << 20);
+
+    /**
+     * @brief allocate a buffer aligned to 16 bytes.
+     * @param bytes number of bytes.
+     */
+    void* allocate(size_t bytes);
+    /**
+     * @brief give a buffer back.
+     * @param p pointer returned by allocate().
+     * @param bytes the size passed to allocate().
+     */
+    void deallocate(void* p, size_t bytes);
+    /** @brief forget every buffer, the arena blocks are kept. */
+    void reset();
+    /** @brief number of heap allocations made so far. */
+    size_t heapAllocations() const { return arena.heapAllocations(); }
+};
+
+/**
+ *  @brief ArenaAllocator class, standard allocator on top of an arena for std::vector etc.
+ *  @note deallocate() does nothing, memory is reclaimed with the arena.
+ */
+template <typename T>
+class ArenaAllocator {
+  public:
+    typedef T value_type;
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena& a) :
+        arena(&a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) :
+        arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& rhs) const { return arena == rhs.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& rhs) const { return arena != rhs.arena; }
+};
+
+/**
+ * @brief arena of the calling thread, used by the batch kernels for their scratch buffers.
+ * @note the arena is reset lazily on first use after nextFrame(), unless a scope is open.
+ */
+Arena& getThreadArena();
+/**
+ * @brief start a new frame, every thread arena is reset on its next use.
+ * @note memory from getThreadArena() of the previous frame must not be used anymore.
+ */
+void nextFrame();
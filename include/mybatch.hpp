@@ -0,0 +1,76 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mybatch.hpp
+ *  @brief batch kernels over arrays of vectors.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-16
+ *  @note kernels work on raw pointers so that the caller owns every buffer.
+ *  @note computeBounds(), transformPoints() and invertMatrices() run the SIMD variant
+ *  @note of the CPU, see myisa.hpp.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mymatrix.hpp"
+
+/**
+ * @brief axis aligned bounding box of a point array, in parallel.
+ * @param points point array.
+ * @param n number of points.
+ * @param boxMin minimum corner, (0, 0, 0) if n is 0.
+ * @param boxMax maximum corner, (0, 0, 0) if n is 0.
+ */
+void computeBounds(const Vector3* points, size_t n, Vector3& boxMin, Vector3& boxMax);
+
+/**
+ * @brief transform points by an affine matrix, in parallel.
+ * @param mat transformation, the last row is assumed to be (0, 0, 0, 1).
+ * @param in n input points.
+ * @param n number of points.
+ * @param out n output points, may alias in.
+ */
+void transformPoints(const Matrix4& mat, const Vector3* in, size_t n, Vector3* out);
+/**
+ * @brief general inverses of a matrix array, in parallel.
+ * @param in n input matrices.
+ * @param n number of matrices.
+ * @param out n inverses, may alias in.
+ * @return number of matrices inverted.
+ * @note singular matrices (|det| < MYEPSILON) are written as NaN instead of throwing.
+ */
+size_t invertMatrices(const Matrix4* in, size_t n, Matrix4* out);
+/**
+ * @brief project points to normalized device coordinates, in parallel.
+ * @param viewProjection matrix mapping world space to clip space.
+ * @param in n input points.
+ * @param n number of points.
+ * @param ndc n output points after the perspective divide, may alias in.
+ * @return number of points in front of the camera (clip w > 0).
+ * @note points with clip w <= 0 are written as (NaN, NaN, NaN).
+ */
+size_t projectPoints(const Matrix4& viewProjection, const Vector3* in, size_t n, Vector3* ndc);
+/**
+ * @brief map normalized device coordinates to pixel coordinates, in parallel.
+ * @param ndc n points in normalized device coordinates.
+ * @param n number of points.
+ * @param width image width in pixels.
+ * @param height image height in pixels.
+ * @param pixels n output pixels, origin at the top left corner, y pointing down.
+ */
+void ndcToPixels(const Vector3* ndc, size_t n, scalar width, scalar height, Vector2* pixels);
+/**
+ * @brief fused projectPoints() and ndcToPixels().
+ * @param viewProjection matrix mapping world space to clip space.
+ * @param in n input points.
+ * @param n number of points.
+ * @param width image width in pixels.
+ * @param height image height in pixels.
+ * @param pixels n output pixels, (NaN, NaN) behind the camera.
+ * @param depth optional n output depths in normalized device coordinates.
+ * @return number of points in front of the camera (clip w > 0).
+ */
+size_t projectToPixels(const Matrix4& viewProjection, const Vector3* in, size_t n,
+                       scalar width, scalar height, Vector2* pixels, scalar* depth = nullptr);
@@ -0,0 +1,206 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mybenchmark.hpp
+ *  @brief micro-benchmark harness, warm-up, repeated samples, statistics and JSON output.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-1
+ *  @note a benchmark body is called with the iteration index, use it to pick inputs out of
+ *  @note a small table so that the compiler cannot fold the operation, and hand every
+ *  @note result to doNotOptimize() so that it cannot be dropped.
+ *  @note every benchmark is warmed up first, then the iteration count of one sample is
+ *  @note doubled until a sample lasts at least the sample time, then the samples are taken.
+ *  @note with counters enabled the Linux hardware counters of the calling thread are read
+ *  @note around all samples of a benchmark, i.e. run multi-threaded kernels on one thread.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief keep a value alive as if it was read by the outside world.
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+}
+
+/**
+ *  @brief hardware events read by PerfCounters.
+ */
+enum PERFEVENT {
+    /** core cycles */
+    PERF_CYCLES,
+    /** retired instructions */
+    PERF_INSTRUCTIONS,
+    /** last level cache misses */
+    PERF_CACHE_MISSES,
+    /** mispredicted branches */
+    PERF_BRANCH_MISSES,
+    /** number of events */
+    PERF_EVENT_COUNT
+};
+
+/**
+ *  @brief PerfCounters class, user space hardware counters of the calling thread (perf_event_open).
+ *  @note counters may be unavailable, e.g. other systems than Linux, containers, virtual
+ *  @note machines or kernel.perf_event_paranoid > 2, single events may be missing too.
+ */
+class PerfCounters {
+  private:
+    /** @brief file descriptor per event, -1 if not opened. */
+    int fds[PERF_EVENT_COUNT];
+    /** @brief position of each event in the group read, -1 if not opened. */
+    int slot[PERF_EVENT_COUNT];
+    /** @brief number of opened events, the first one is the group leader. */
+    int opened = 0;
+    int leader = -1;
+
+  protected:
+  public:
+    /** @brief open the events, failures leave them unavailable. */
+    PerfCounters();
+    /** @brief close the events. */
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /** @brief true if at least one event is counted. */
+    bool isAvailable() const { return leader >= 0; }
+    /** @brief true if an event is counted. */
+    bool hasEvent(PERFEVENT event) const { return slot[event] >= 0; }
+    /** @brief reset and start counting. */
+    void start();
+    /**
+     * @brief stop counting and read.
+     * @param values counts per event scaled up if the kernel multiplexed them, NaN if unavailable.
+     * @return false if nothing was counted.
+     */
+    bool stop(double values[PERF_EVENT_COUNT]);
+};
+
+/**
+ *  @brief BenchmarkResult struct, statistics of one benchmark in nanoseconds per operation.
+ */
+struct BenchmarkResult {
+    /** @brief operation, e.g. "Matrix4::computeInverse". */
+    std::string name;
+    /** @brief implementation, e.g. "mymath" or "eigen". */
+    std::string variant;
+    /** @brief operations per sample. */
+    size_t iterations = 0;
+    /** @brief number of samples. */
+    int samples = 0;
+    /** @brief fastest sample. */
+    double min = 0;
+    /** @brief median sample, the figure compared between variants. */
+    double median = 0;
+    /** @brief mean of the samples. */
+    double mean = 0;
+    /** @brief standard deviation of the samples. */
+    double stddev = 0;
+    /** @brief items processed by one operation, e.g. points of a batch transform. */
+    size_t elements = 1;
+    /** @brief true if the counters below were measured. */
+    bool counters = false;
+    /** @brief cycles per operation, NaN if unavailable. */
+    double cycles = 0;
+    /** @brief instructions per operation, NaN if unavailable. */
+    double instructions = 0;
+    /** @brief last level cache misses per operation, NaN if unavailable. */
+    double cache_misses = 0;
+    /** @brief branch misses per operation, NaN if unavailable. */
+    double branch_misses = 0;
+
+    /** @brief instructions per cycle, NaN if unavailable. */
+    double ipc() const { return instructions / cycles; }
+    /** @brief cycles per element, NaN if unavailable. */
+    double cyclesPerElement() const { return cycles / elements; }
+};
+
+/**
+ *  @brief BenchmarkSuite class, runs benchmarks and keeps their results.
+ */
+class BenchmarkSuite {
+  private:
+    int samples;
+    double warmup_ms;
+    double sample_ms;
+    /** @brief only names containing it are run. */
+    std::string filter;
+    std::vector<BenchmarkResult> results;
+    /** @brief null unless counters are enabled and available. */
+    std::unique_ptr<PerfCounters> perf;
+
+    /**
+     * @brief warm up, calibrate and sample.
+     * @param batch runs the body the given number of times, returns elapsed nanoseconds.
+     * @param elements items processed by one operation.
+     */
+    BenchmarkResult measure(const std::string& name, const std::string& variant,
+                            const std::function<double(size_t)>& batch, size_t elements) const;
+
+  protected:
+  public:
+    /**
+     * @brief Default constructor.
+     * @param samples samples per benchmark, the median is reported.
+     * @param warmupMs milliseconds spent running a benchmark before sampling.
+     * @param sampleMs minimum milliseconds of one sample.
+     */
+    BenchmarkSuite(int samples = 31, double warmupMs = 20, double sampleMs = 2);
+
+    /** @brief run only benchmarks whose name contains filter, all if empty. */
+    void setFilter(const std::string& _filter) { filter = _filter; }
+    /** @brief true if a benchmark of this name would run. */
+    bool isSelected(const std::string& name) const;
+    /**
+     * @brief read hardware counters around the samples of the following benchmarks.
+     * @return false if no counter is available, timings are still taken.
+     */
+    bool enableCounters(bool enable = true);
+
+    /**
+     * @brief run a benchmark unless filtered out.
+     * @param name operation.
+     * @param variant implementation.
+     * @param body void body(size_t i), one operation.
+     * @param elements items processed by one operation.
+     */
+    template <typename F>
+    void run(const std::string& name, const std::string& variant, F body, size_t elements = 1) {
+        if (!isSelected(name)) return;
+        results.push_back(measure(name, variant, [&body](size_t iterations) {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i) body(i);
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }, elements));
+    }
+
+    /** @brief results in running order. */
+    const std::vector<BenchmarkResult>& getResults() const { return results; }
+    /**
+     * @brief print one line per benchmark.
+     * @param baseline variant the others are compared to, e.g. "eigen", no ratio if empty.
+     */
+    void printTable(FILE* out = stdout, const std::string& baseline = "") const;
+    /**
+     * @brief write the results as JSON.
+     * @param path file path.
+     * @param baseline variant the others are compared to, no ratio if empty.
+     * @exception the file cannot be written.
+     */
+    void writeJSON(const std::string& path, const std::string& baseline = "") const;
+};
@@ -0,0 +1,122 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mycamera.hpp
+ *  @brief pinhole camera model, batch projection and depth image rendering.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-20
+ *  @note camera frame follows the computer vision convention, x right, y down,
+ *  @note z forward, which differs from Matrix4::setLookAt() (z backward, y up).
+ *  @note pixel (u, v) covers [u, u + 1) x [v, v + 1), images are row major,
+ *  @note pixel (u, v) is stored at index v * width + u.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mymatrix.hpp"
+
+/**
+ *  @brief PinholeCamera class used for projecting points into an image.
+ */
+class PinholeCamera {
+  private:
+    /** @brief intrinsics | fx s cx |, | 0 fy cy |, | 0 0 1 |. */
+    Matrix3 K;
+    /** @brief extrinsics, transform from world to camera frame. */
+    Matrix4 T_cw;
+    /** @brief image width in pixels. */
+    int width;
+    /** @brief image height in pixels. */
+    int height;
+
+  protected:
+  public:
+    /** @brief side length in pixels of the tiles used by renderDepth(). */
+    static const int TILE_SIZE = 32;
+
+    /**
+     * Create a camera with identity intrinsics and extrinsics and an empty image.
+     * @brief Default constructor.
+     */
+    PinholeCamera();
+    /**
+     * @brief constructor by focal lengths and principal point, extrinsics identity.
+     * @param fx focal length along x in pixels.
+     * @param fy focal length along y in pixels.
+     * @param cx principal point x in pixels.
+     * @param cy principal point y in pixels.
+     * @param width image width in pixels.
+     * @param height image height in pixels.
+     * @exception (width < 0) or (height < 0) or (fx == 0) or (fy == 0)
+     */
+    PinholeCamera(scalar fx, scalar fy, scalar cx, scalar cy, int width, int height);
+    /**
+     * @brief constructor by intrinsics and extrinsics matrices.
+     * @param intrinsics upper triangular 3x3 camera matrix.
+     * @param extrinsics transform from world to camera frame.
+     * @param width image width in pixels.
+     * @param height image height in pixels.
+     * @exception (width < 0) or (height < 0) or intrinsics is not a camera matrix.
+     */
+    PinholeCamera(const Matrix3& intrinsics, const Matrix4& extrinsics, int width, int height);
+
+    /**
+     * @brief set intrinsics.
+     * @param intrinsics upper triangular 3x3 camera matrix with m[8] == 1.
+     * @exception intrinsics is not a camera matrix.
+     */
+    void setIntrinsics(const Matrix3& intrinsics);
+    /** @brief get intrinsics. */
+    const Matrix3& getIntrinsics() const { return K; }
+    /** @brief set extrinsics, transform from world to camera frame. */
+    void setExtrinsics(const Matrix4& extrinsics) { T_cw = extrinsics; }
+    /** @brief get extrinsics, transform from world to camera frame. */
+    const Matrix4& getExtrinsics() const { return T_cw; }
+    /**
+     * @brief set image size.
+     * @exception (width < 0) or (height < 0)
+     */
+    void setImageSize(int width, int height);
+    /** @brief image width in pixels. */
+    int getWidth() const { return width; }
+    /** @brief image height in pixels. */
+    int getHeight() const { return height; }
+
+    /**
+     * @brief project a point in world frame.
+     * @param p point in world frame.
+     * @param pixel output pixel coordinate.
+     * @param depth output z in camera frame.
+     * @return false if the point is not in front of the camera (depth <= 0).
+     */
+    bool project(const Vector3& p, Vector2& pixel, scalar& depth) const;
+    /**
+     * @brief back-project a pixel to a point in camera frame.
+     * @param pixel pixel coordinate.
+     * @param depth z in camera frame.
+     * @return point in camera frame.
+     */
+    Vector3 unproject(const Vector2& pixel, scalar depth) const;
+    /**
+     * @brief batch projection of points in world frame, in parallel.
+     * @param points n points in world frame.
+     * @param n number of points.
+     * @param pixels n output pixel coordinates, (NaN, NaN) behind the camera.
+     * @param depth optional n output z in camera frame.
+     * @return number of points in front of the camera.
+     * @note pixels outside the image are kept, the caller decides about them.
+     */
+    size_t projectPoints(const Vector3* points, size_t n, Vector2* pixels, scalar* depth = nullptr) const;
+    /**
+     * @brief render a z-buffered depth image of points in world frame, in parallel.
+     * @param points n points in world frame.
+     * @param n number of points.
+     * @param depthImage output width * height depths, nearest z per pixel, 0 if no point.
+     * @return number of points inside the image.
+     * @note points are binned by TILE_SIZE x TILE_SIZE tile, each tile is written by
+     *       exactly one task so the depth test needs no atomics, the result is deterministic.
+     */
+    size_t renderDepth(const Vector3* points, size_t n, scalar* depthImage) const;
+};
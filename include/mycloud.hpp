@@ -0,0 +1,204 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mycloud.hpp
+ *  @brief chunked binary point cloud container, streaming writer and memory mapped reader.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-28
+ *  @note file layout, little endian:
+ *  @note | CloudFileHeader | chunk 0 | chunk 1 | ... | CloudChunkInfo[chunk count] |
+ *  @note every chunk payload starts at a multiple of CLOUD_ALIGNMENT from the file start,
+ *  @note AOS chunks hold x y z of every point in turn, SOA chunks hold all x, then all y,
+ *  @note then all z, each array starting at a multiple of CLOUD_ALIGNMENT again.
+ *  @note coordinates are stored with the scalar width of the writer, a reader built with
+ *  @note another scalar width refuses zero-copy views but can still copy with conversion.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "mysoa.hpp"
+
+/**
+ *  @brief Macro alignment in bytes of every payload array, a multiple of any SIMD width.
+ */
+#define CLOUD_ALIGNMENT 64
+
+/**
+ *  @brief option for the payload layout.
+ */
+enum CLOUDLAYOUT {
+    /** array of structures, chunks map to const Vector3* */
+    AOS,
+    /** structure of arrays, chunks map to ConstVector3SoA */
+    SOA
+};
+
+/**
+ *  @brief CloudFileHeader struct, first 64 bytes of a file.
+ */
+struct CloudFileHeader {
+    /** @brief "MYCLOUD" and a zero byte. */
+    char magic[8];
+    /** @brief format version, 1. */
+    uint32_t version;
+    /** @brief CLOUDLAYOUT of every chunk. */
+    uint32_t layout;
+    /** @brief bytes per coordinate, 4 or 8. */
+    uint32_t scalar_size;
+    /** @brief payload alignment, CLOUD_ALIGNMENT. */
+    uint32_t alignment;
+    /** @brief number of points in all chunks. */
+    uint64_t point_count;
+    /** @brief number of chunks. */
+    uint64_t chunk_count;
+    /** @brief file offset of the chunk table. */
+    uint64_t chunk_table;
+    /** @brief reserved, zero. */
+    uint64_t reserved[2];
+};
+
+/**
+ *  @brief CloudChunkInfo struct, one entry of the chunk table.
+ */
+struct CloudChunkInfo {
+    /** @brief file offset of the payload. */
+    uint64_t offset;
+    /** @brief number of points. */
+    uint64_t count;
+    /** @brief index of the first point in the whole cloud. */
+    uint64_t first;
+    /** @brief minimum corner of the points. */
+    double bounds_min[3];
+    /** @brief maximum corner of the points. */
+    double bounds_max[3];
+};
+
+/**
+ *  @brief CloudWriter class, appends chunks to a file without keeping them in memory.
+ */
+class CloudWriter {
+  private:
+    FILE* file = nullptr;
+    CLOUDLAYOUT layout;
+    /** @brief current end of file. */
+    uint64_t position = 0;
+    uint64_t point_count = 0;
+    /** @brief table written by close(). */
+    std::vector<CloudChunkInfo> chunks;
+
+    /** @brief write bytes, exception on failure. */
+    void write(const void* data, size_t bytes);
+    /** @brief pad with zeros up to the next multiple of CLOUD_ALIGNMENT. */
+    void pad();
+    /** @brief start a chunk entry of n points. */
+    CloudChunkInfo& beginChunk(size_t n);
+    /** @brief append a chunk, point i has coordinates x[i * stride], y[i * stride], z[i * stride]. */
+    void writeChunk(const ConstVector3SoA& points, size_t stride);
+
+  public:
+    /**
+     * @brief create or truncate a file and write a provisional header.
+     * @param path file path.
+     * @param layout payload layout.
+     * @exception the file cannot be opened.
+     */
+    CloudWriter(const std::string& path, CLOUDLAYOUT layout = SOA);
+    /** @brief close() if not done yet, errors are only reported on stderr. */
+    ~CloudWriter();
+    CloudWriter(const CloudWriter&) = delete;
+    CloudWriter& operator=(const CloudWriter&) = delete;
+
+    /**
+     * @brief append a chunk.
+     * @param points n points.
+     * @param n number of points, an empty chunk is skipped.
+     * @exception write error.
+     */
+    void writeChunk(const Vector3* points, size_t n);
+    /** @see void writeChunk(const Vector3* points, size_t n) */
+    void writeChunk(const ConstVector3SoA& points);
+    /**
+     * @brief write the chunk table, finish the header and close the file.
+     * @exception write error.
+     */
+    void close();
+    /** @brief number of points written so far. */
+    uint64_t size() const { return point_count; }
+};
+
+/**
+ *  @brief MappedCloud class, read-only memory mapping of a cloud file.
+ *  @note opening only maps the file and checks header and chunk table, payload pages
+ *  @note are read by the operating system when touched.
+ *  @note the accessors other than isOpen() require an open file.
+ */
+class MappedCloud {
+  private:
+    /** @brief start of the mapping. */
+    const unsigned char* base = nullptr;
+    /** @brief bytes mapped. */
+    size_t length = 0;
+    const CloudFileHeader* header = nullptr;
+    const CloudChunkInfo* table = nullptr;
+
+    /** @brief exception if chunk is out of bounds. */
+    const CloudChunkInfo& checkedChunk(size_t chunk) const;
+
+  public:
+    /** @brief empty object, see open(). */
+    MappedCloud() {}
+    /** @brief open a file, see open(). */
+    explicit MappedCloud(const std::string& path) { open(path); }
+    /** @brief unmap. */
+    ~MappedCloud();
+    MappedCloud(const MappedCloud&) = delete;
+    MappedCloud& operator=(const MappedCloud&) = delete;
+
+    /**
+     * @brief map a file, an already open file is closed first.
+     * @param path file path.
+     * @exception the file cannot be mapped, or header or chunk table are invalid.
+     */
+    void open(const std::string& path);
+    /** @brief unmap the file. */
+    void close();
+    /** @brief true if a file is mapped. */
+    bool isOpen() const { return base != nullptr; }
+
+    /** @brief payload layout. */
+    CLOUDLAYOUT getLayout() const { return static_cast<CLOUDLAYOUT>(header->layout); }
+    /** @brief number of points. */
+    uint64_t size() const { return header->point_count; }
+    /** @brief number of chunks. */
+    size_t chunkCount() const { return static_cast<size_t>(header->chunk_count); }
+    /** @brief chunk table entry. */
+    const CloudChunkInfo& getChunk(size_t chunk) const { return checkedChunk(chunk); }
+    /** @brief true if views are possible, i.e. the file scalar width equals sizeof(scalar). */
+    bool isZeroCopy() const { return header->scalar_size == sizeof(scalar); }
+
+    /**
+     * @brief zero-copy view of an AOS chunk.
+     * @exception chunk out of bounds, layout is not AOS or not isZeroCopy().
+     * @return chunk count points inside the mapping.
+     */
+    const Vector3* points(size_t chunk) const;
+    /**
+     * @brief zero-copy view of a SOA chunk.
+     * @exception chunk out of bounds, layout is not SOA or not isZeroCopy().
+     */
+    ConstVector3SoA pointsSoA(size_t chunk) const;
+    /**
+     * @brief copy a chunk in any layout and scalar width.
+     * @param chunk chunk index.
+     * @param out chunk count points.
+     */
+    void copyChunk(size_t chunk, Vector3* out) const;
+    /** @brief ask the operating system to read a chunk ahead of use. */
+    void prefetch(size_t chunk) const;
+};
@@ -0,0 +1,86 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mydepth.hpp
+ *  @brief depth image back-projection to point clouds.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-22
+ *  @note depth images are row major, pixel (u, v) at index v * width + u, and store z
+ *  @note in camera frame, 0 or non finite values mark missing measurements.
+ *  @note the point of pixel (u, v) is depth * ray(u, v), ray has z == 1 and goes
+ *  @note through the pixel center (u + 0.5, v + 0.5).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mycamera.hpp"
+#include "mysoa.hpp"
+
+/**
+ *  @brief DepthBackProjector class, per-pixel ray table of one camera and the conversion kernels.
+ */
+class DepthBackProjector {
+  private:
+    /** @brief intrinsics the table was built for. */
+    Matrix3 K;
+    /** @brief image width of the table. */
+    int width = 0;
+    /** @brief image height of the table. */
+    int height = 0;
+    /** @brief x of the ray of every pixel. */
+    std::vector<scalar> ray_x;
+    /** @brief y of the ray of every pixel. */
+    std::vector<scalar> ray_y;
+    /** @brief scratch, first output index of every row when compacting. */
+    std::vector<size_t> row_offset;
+
+    /** @brief shared implementation of the scalar and 16 bit inputs. */
+    template <typename T>
+    size_t run(const T* depth, scalar depthScale, Vector3SoA out, const Matrix4* camToWorld, bool organized);
+
+  protected:
+  public:
+    /** @brief empty table, call setCamera() before use. */
+    DepthBackProjector() {}
+    /** @brief table of a camera. */
+    explicit DepthBackProjector(const PinholeCamera& camera) { setCamera(camera); }
+
+    /**
+     * @brief make the table match a camera, rebuilt only if intrinsics or image size changed.
+     * @param camera camera, its extrinsics are ignored.
+     * @return true if the table was rebuilt.
+     */
+    bool setCamera(const PinholeCamera& camera);
+    /** @brief image width of the table. */
+    int getWidth() const { return width; }
+    /** @brief image height of the table. */
+    int getHeight() const { return height; }
+    /** @brief number of pixels, the output capacity needed by backProject(). */
+    size_t pixelCount() const { return static_cast<size_t>(width) * height; }
+
+    /**
+     * @brief back-project a depth image, in parallel over rows.
+     * @param depth width * height depths.
+     * @param out caller owned output, out.size must be at least pixelCount().
+     * @param camToWorld optional transform applied in the same pass, e.g. inverse extrinsics.
+     * @param organized true: point of pixel i is written at i, missing ones as NaN,
+     *        false: valid points are packed in row major order.
+     * @exception out.size < pixelCount()
+     * @return number of points written, pixelCount() if organized.
+     */
+    size_t backProject(const scalar* depth, Vector3SoA out, const Matrix4* camToWorld = nullptr,
+                       bool organized = false);
+    /**
+     * @brief back-project a 16 bit depth image, in parallel over rows.
+     * @param depth width * height raw depths, 0 is missing.
+     * @param depthScale factor from raw value to z, e.g. 0.001 for millimeters to meters.
+     * @see size_t backProject(const scalar* depth, Vector3SoA out, const Matrix4* camToWorld,
+     *                         bool organized)
+     */
+    size_t backProject(const uint16_t* depth, scalar depthScale, Vector3SoA out,
+                       const Matrix4* camToWorld = nullptr, bool organized = false);
+};
@@ -0,0 +1,96 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mydeskew.hpp
+ *  @brief motion compensation of spinning lidar scans from per-point timestamps.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-9
+ *  @note a point p captured at time t in the sensor frame becomes
+ *  @note T(t_ref)^{-1} * T(t) * p, the same point in the sensor frame at the reference time,
+ *  @note T(t) is the sensor to world pose, slerp and lerp of a start and end pose or a
+ *  @note TrajectorySpline.
+ *  @note the scan interval is split into buckets, the exact relative transform is computed
+ *  @note once per bucket boundary and points blend the two transforms of their bucket
+ *  @note linearly, so a point costs two dozen multiply-adds whatever the pose source.
+ *  @note the blend deviates from the exact rotation by at most a^2 / 8 * |p| for a
+ *  @note rotation of a radian per bucket, 1e-7 * |p| for 1 rad per scan and 1024 buckets.
+ *  @note times are double, seconds since the epoch resolve 0.2 us, below that the bucket
+ *  @note boundaries and the capture times round independently.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mylie.hpp"
+#include "mysoa.hpp"
+#include "myspline.hpp"
+
+/**
+ *  @brief ScanDeskewer class, bucketed relative transforms of one scan and the in-place kernels.
+ */
+class ScanDeskewer {
+  private:
+    /** @brief number of buckets over the scan interval. */
+    int buckets;
+    /** @brief first time of the scan interval. */
+    double start_time = 0;
+    /** @brief last time of the scan interval. */
+    double end_time = 0;
+    /** @brief per bucket the 3x4 transform at its start and the difference to its end, 24 scalars. */
+    std::vector<scalar> table;
+
+    /** @brief fill the table from buckets + 1 poses at the bucket boundaries. */
+    void build(const SE3* poses, const SE3& reference, double startTime, double endTime);
+
+  protected:
+  public:
+    /**
+     * @brief constructor.
+     * @param buckets number of buckets over the scan interval.
+     * @exception buckets < 1
+     */
+    explicit ScanDeskewer(int buckets = 1024);
+
+    /**
+     * @brief set the motion of a scan by the poses at its start and end.
+     * @param startPose sensor to world pose at startTime.
+     * @param endPose sensor to world pose at endTime.
+     * @param startTime first time of the scan.
+     * @param endTime last time of the scan.
+     * @param referenceTime time of the output frame, usually startTime or endTime.
+     * @exception endTime <= startTime
+     * @note rotations are interpolated on the geodesic (slerp), translations linearly.
+     */
+    void setPoses(const SE3& startPose, const SE3& endPose, double startTime, double endTime, double referenceTime);
+    /**
+     * @see void setPoses(const SE3& startPose, const SE3& endPose, double startTime, double endTime,
+     *                    double referenceTime)
+     * @exception a matrix is not a rigid transformation.
+     */
+    void setPoses(const Matrix4& startPose, const Matrix4& endPose, double startTime, double endTime,
+                  double referenceTime);
+    /**
+     * @brief set the motion of a scan by a trajectory.
+     * @param trajectory sensor to world trajectory.
+     * @param startTime first time of the scan.
+     * @param endTime last time of the scan.
+     * @param referenceTime time of the output frame.
+     * @exception endTime <= startTime, or a time is outside the trajectory.
+     */
+    void setTrajectory(const TrajectorySpline& trajectory, double startTime, double endTime, double referenceTime);
+
+    /**
+     * @brief deskew points in place, in parallel.
+     * @param points n points in the sensor frame at their capture times.
+     * @param times n capture times, in any order.
+     * @param n number of points.
+     * @return number of points with times inside the scan interval, the others are
+     *         corrected with the pose of the closer end.
+     * @exception no poses were set.
+     */
+    size_t deskew(Vector3* points, const double* times, size_t n) const;
+    /** @see size_t deskew(Vector3* points, const double* times, size_t n) const */
+    size_t deskew(Vector3SoA points, const double* times) const;
+};
@@ -0,0 +1,106 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myformat.hpp
+ *  @brief number, vector and matrix formatting into caller buffers, trajectory writers.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-31
+ *  @note the formatters never touch a stream or the locale, they write into [first, last)
+ *  @note and return the end of the written characters, nullptr if the buffer is too small.
+ *  @note no terminating zero is written.
+ *  @note shortest: fewest digits that read back (strtod/strtof) to the same value.
+ *  @note fixed: like printf "%.*f", i.e. std::fixed with std::setprecision().
+ *  @note built as C++17 with <charconv> floating point support std::to_chars() is used,
+ *  @note otherwise fixed output uses exact integer arithmetic whenever the rounding is
+ *  @note unambiguous and snprintf() only for the rest.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "mymatrix.hpp"
+
+/**
+ *  @brief Macro buffer size enough for one number of fixed precision up to 40.
+ */
+#define FORMAT_BUFFER_SIZE 384
+
+/**
+ * @brief write the shortest round-trip representation, e.g. "0.1", "1e+20", "nan".
+ * @param first first character.
+ * @param last one past the last character.
+ * @param value value.
+ * @return end of the written characters, nullptr if the buffer is too small.
+ */
+char* formatShortest(char* first, char* last, double value);
+/** @brief shortest representation that reads back to the same float. */
+char* formatShortest(char* first, char* last, float value);
+/**
+ * @brief write a number with fixed precision, e.g. "-1.500000" for precision 6.
+ * @param first first character.
+ * @param last one past the last character.
+ * @param value value.
+ * @param precision digits after the decimal point, clamped to 0 ... 40.
+ * @return end of the written characters, nullptr if the buffer is too small.
+ */
+char* formatFixed(char* first, char* last, double value, int precision);
+/**
+ * @brief write a scalar, shortest if precision is negative, fixed otherwise.
+ * @see formatShortest(), formatFixed()
+ */
+char* formatScalar(char* first, char* last, scalar value, int precision = -1);
+
+/**
+ * @brief write "(x, y, z)" like operator<<(std::ostream&, const Vector3&).
+ * @param precision negative for shortest, fixed otherwise.
+ * @return end of the written characters, nullptr if the buffer is too small.
+ */
+char* formatVector(char* first, char* last, const Vector2& vec, int precision = -1);
+/** @see char* formatVector(char* first, char* last, const Vector2& vec, int precision) */
+char* formatVector(char* first, char* last, const Vector3& vec, int precision = -1);
+/** @see char* formatVector(char* first, char* last, const Vector2& vec, int precision) */
+char* formatVector(char* first, char* last, const Vector4& vec, int precision = -1);
+
+/**
+ * @brief write rows "[    1.000000     0.000000]\n", the layout of operator<<(std::ostream&, const Matrix4&).
+ * @param precision digits after the decimal point, numbers are right aligned in width 10.
+ * @return end of the written characters, nullptr if the buffer is too small.
+ * @note operator<< stays on the stream and honours its locale, use this for bulk text output.
+ */
+char* formatMatrix(char* first, char* last, const Matrix2& mat2, int precision = 6);
+/** @see char* formatMatrix(char* first, char* last, const Matrix2& mat2, int precision) */
+char* formatMatrix(char* first, char* last, const Matrix3& mat3, int precision = 6);
+/** @see char* formatMatrix(char* first, char* last, const Matrix2& mat2, int precision) */
+char* formatMatrix(char* first, char* last, const Matrix4& mat4, int precision = 6);
+
+/**
+ * @brief write points as "x y z" lines, readable by readPointCloud() as XYZ_FORMAT.
+ * @param path file path.
+ * @param points n points.
+ * @param n number of points.
+ * @param precision negative for shortest, fixed otherwise.
+ * @exception the file cannot be written.
+ */
+void writePoints(const std::string& path, const Vector3* points, size_t n, int precision = -1);
+/**
+ * @brief write a TUM RGB-D trajectory, "timestamp tx ty tz qx qy qz qw" lines.
+ * @param path file path.
+ * @param timestamps n timestamps in seconds, always written with fixed precision 6.
+ * @param poses n camera to world transforms, rotation part must be orthonormal.
+ * @param n number of poses.
+ * @param precision negative for shortest, fixed otherwise.
+ * @exception the file cannot be written.
+ */
+void writeTUM(const std::string& path, const double* timestamps, const Matrix4* poses, size_t n,
+              int precision = -1);
+/**
+ * @brief write a KITTI odometry trajectory, the first three rows of every pose row by row.
+ * @param path file path.
+ * @param poses n camera to world transforms.
+ * @param n number of poses.
+ * @param precision negative for shortest, fixed otherwise.
+ * @exception the file cannot be written.
+ */
+void writeKITTI(const std::string& path, const Matrix4* poses, size_t n, int precision = -1);
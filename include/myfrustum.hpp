@@ -0,0 +1,129 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myfrustum.hpp
+ *  @brief view frustum extracted from a projection matrix, batched culling.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-18
+ *  @note planes are extracted with the Gribb-Hartmann method from the rows of the
+ *  @note column major 4x4 matrix, the clip space depth range is [-1, 1] or [0, 1].
+ *  @note a point p is inside plane (a, b, c, d) if a * p.x + b * p.y + c * p.z + d >= 0.
+ *  @note batch results are bit masks, bit (i % 64) of word (i / 64) belongs to element i.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mymatrix.hpp"
+
+/**
+ *  @brief Frustum class used for visibility tests against a view-projection matrix.
+ */
+class Frustum {
+  private:
+    /** @brief normalized planes, order left, right, bottom, top, near, far. */
+    Vector4 planes[6];
+    /** @brief plane normal x of the 6 planes, SoA copy for the batch loops. */
+    scalar nx[6];
+    /** @brief plane normal y of the 6 planes. */
+    scalar ny[6];
+    /** @brief plane normal z of the 6 planes. */
+    scalar nz[6];
+    /** @brief plane offset of the 6 planes. */
+    scalar nd[6];
+
+  protected:
+  public:
+    /**
+     * Create a frustum which contains everything.
+     * @brief Default constructor.
+     * @see Frustum(const Matrix4& viewProjection, CLIPDEPTH depth)
+     */
+    Frustum();
+    /**
+     * Create a frustum from a view-projection matrix.
+     * @brief constructor by a 4x4 matrix.
+     * @param viewProjection matrix mapping world space to clip space.
+     * @param depth clip space depth range of the projection.
+     * @see void set(const Matrix4& viewProjection, CLIPDEPTH depth)
+     */
+    explicit Frustum(const Matrix4& viewProjection, CLIPDEPTH depth = NEGATIVE_ONE_TO_ONE);
+
+    /**
+     * @brief extract planes from a view-projection matrix.
+     * @param viewProjection matrix mapping world space to clip space.
+     * @param depth clip space depth range, ZERO_TO_ONE for Matrix4::setReversedZPerspective().
+     * @note a degenerated plane (e.g. far plane of an infinite projection) contains everything.
+     * @note with reversed-Z plane 4 is the far plane and plane 5 the near plane.
+     */
+    void set(const Matrix4& viewProjection, CLIPDEPTH depth = NEGATIVE_ONE_TO_ONE);
+    /**
+     * @brief get a plane.
+     * @param index order left, right, bottom, top, near, far.
+     * @exception (index > 5) or (index < 0)
+     * @return plane (a, b, c, d) with unit normal pointing inside.
+     */
+    const Vector4& getPlane(int index) const;
+
+    /** @brief judge whether a point is inside. */
+    bool containsPoint(const Vector3& p) const;
+    /**
+     * @brief classify a sphere.
+     * @param center sphere center.
+     * @param radius sphere radius.
+     * @return OUTSIDE, INTERSECT or INSIDE.
+     */
+    CONTAINMENT classifySphere(const Vector3& center, scalar radius) const;
+    /**
+     * @brief classify an axis aligned box.
+     * @param boxMin minimum corner.
+     * @param boxMax maximum corner.
+     * @return OUTSIDE, INTERSECT or INSIDE.
+     */
+    CONTAINMENT classifyAABB(const Vector3& boxMin, const Vector3& boxMax) const;
+    /**
+     * @brief classify an axis aligned box against a subset of planes, for hierarchies.
+     * @param boxMin minimum corner.
+     * @param boxMax maximum corner.
+     * @param planeMask in: planes to test (bit i for plane i, 0x3f for all),
+     *        out: planes the box straddles, pass it to the children.
+     * @return OUTSIDE, INTERSECT or INSIDE, INSIDE if planeMask becomes 0.
+     */
+    CONTAINMENT classifyAABB(const Vector3& boxMin, const Vector3& boxMax, uint8_t& planeMask) const;
+
+    /**
+     * @brief batch visibility of axis aligned boxes.
+     * @param boxMin n minimum corners.
+     * @param boxMax n maximum corners.
+     * @param n number of boxes.
+     * @param visible output mask of (n + 63) / 64 words, bit set if the box is not OUTSIDE.
+     * @return number of visible boxes.
+     */
+    size_t cullAABBs(const Vector3* boxMin, const Vector3* boxMax, size_t n, uint64_t* visible) const;
+    /**
+     * @brief batch visibility of spheres.
+     * @param center n sphere centers.
+     * @param radius n sphere radii.
+     * @param n number of spheres.
+     * @param visible output mask of (n + 63) / 64 words, bit set if the sphere is not OUTSIDE.
+     * @return number of visible spheres.
+     */
+    size_t cullSpheres(const Vector3* center, const scalar* radius, size_t n, uint64_t* visible) const;
+    /**
+     * @brief hierarchical visibility of a tree of axis aligned boxes.
+     * @param boxMin n minimum corners.
+     * @param boxMax n maximum corners.
+     * @param parent parent index of every node, negative for roots,
+     *        every parent must be stored before its children.
+     * @param n number of nodes.
+     * @param visible output mask of (n + 63) / 64 words, bit set if the node is not OUTSIDE.
+     * @param inside optional output mask of (n + 63) / 64 words, bit set if the node is INSIDE.
+     * @return number of visible nodes.
+     * @note children of OUTSIDE nodes are OUTSIDE and children of INSIDE nodes are INSIDE,
+     *       both without any plane test, the others test only the planes the parent straddles.
+     */
+    size_t cullHierarchy(const Vector3* boxMin, const Vector3* boxMax, const int32_t* parent,
+                         size_t n, uint64_t* visible, uint64_t* inside = nullptr) const;
+};
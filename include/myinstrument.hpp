@@ -0,0 +1,190 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myinstrument.hpp
+ *  @brief opt-in per-thread call, time and error counters of the library hot paths.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-3
+ *  @note compiled in with `-DMYMATH_INSTRUMENT`, otherwise the macros below expand to
+ *  @note nothing and the snapshot stays zero. `-DMYMATH_INSTRUMENT_CYCLES` adds a timer
+ *  @note around every counted call, in TSC ticks on x86 and nanoseconds elsewhere.
+ *  @note every thread counts into its own block, a count is a relaxed load and store of
+ *  @note a thread local counter without lock or shared cache line, getInstrumentSnapshot()
+ *  @note sums the blocks of all threads, blocks of exited threads are folded into a total.
+ *  @note timings are inclusive, e.g. Matrix4::computeInverse includes its isInversed() call.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  @brief counted library operations.
+ */
+enum INSTRUMENTPOINT {
+    /** Matrix4::inverse() */
+    INSTR_MATRIX4_INVERSE,
+    /** Matrix4::computeInverse() */
+    INSTR_MATRIX4_COMPUTE_INVERSE,
+    /** Matrix4::isInversed() */
+    INSTR_MATRIX4_IS_INVERSED,
+    /** Matrix4::matmul() at run time, counted but not timed */
+    INSTR_MATRIX4_MATMUL,
+    /** Vector3::normalized() */
+    INSTR_VECTOR3_NORMALIZED,
+    /** Vector3::normalize() */
+    INSTR_VECTOR3_NORMALIZE,
+    /** number of operations */
+    INSTR_POINT_COUNT
+};
+
+/** @brief error sites counted separately, further sites share the last slot. */
+static const int INSTR_MAX_ERROR_SITES = 256;
+
+/**
+ *  @brief InstrumentCount struct, totals of one operation.
+ */
+struct InstrumentCount {
+    /** @brief operation, e.g. "Matrix4::computeInverse". */
+    std::string name;
+    uint64_t calls = 0;
+    /** @brief time spent in the calls, 0 without MYMATH_INSTRUMENT_CYCLES. */
+    uint64_t ticks = 0;
+};
+
+/**
+ *  @brief InstrumentError struct, thrown errors of one error site.
+ */
+struct InstrumentError {
+    /**
+     * @brief source file and function as printed to stderr, line of the MYMATH_COUNT_ERROR().
+     * @note the count follows the fprintf, so the line is usually one past the printed one.
+     */
+    std::string file;
+    int line = 0;
+    std::string function;
+    uint64_t count = 0;
+};
+
+/**
+ *  @brief InstrumentSnapshot struct, totals of all threads since the last reset.
+ */
+struct InstrumentSnapshot {
+    /** @brief false if the library was built without MYMATH_INSTRUMENT. */
+    bool enabled = false;
+    /** @brief unit of ticks, "tsc", "ns" or "none". */
+    std::string timer;
+    /** @brief one entry per INSTRUMENTPOINT, indexed by it, all zero if not enabled. */
+    std::vector<InstrumentCount> operations;
+    /** @brief error sites hit at least once, in order of first hit. */
+    std::vector<InstrumentError> errors;
+};
+
+/** @brief name of an operation, e.g. "Matrix4::computeInverse". */
+const char* getInstrumentName(INSTRUMENTPOINT point);
+/** @brief sum the counters of all threads. */
+InstrumentSnapshot getInstrumentSnapshot();
+/** @brief start counting from zero, counts of running threads are not lost. */
+void resetInstrumentCounters();
+/** @brief snapshot as JSON. */
+std::string getInstrumentJSON();
+/**
+ * @brief write the snapshot as JSON.
+ * @exception the file cannot be written.
+ */
+void writeInstrumentJSON(const std::string& path);
+
+#ifdef MYMATH_INSTRUMENT
+
+#ifdef MYMATH_INSTRUMENT_CYCLES
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+/**
+ *  @brief InstrumentBlock struct, counters of one thread.
+ *  @note only the owning thread writes, atomics only make the reads of other threads safe.
+ */
+struct InstrumentBlock {
+    std::atomic<uint64_t> calls[INSTR_POINT_COUNT];
+    std::atomic<uint64_t> ticks[INSTR_POINT_COUNT];
+    std::atomic<uint64_t> errors[INSTR_MAX_ERROR_SITES];
+};
+
+/** @brief block of the calling thread, null before its first count. */
+extern thread_local InstrumentBlock* instrument_block;
+/** @brief create and register the block of the calling thread. */
+InstrumentBlock& acquireInstrumentBlock();
+/** @brief slot of an error site, called once per site. */
+int registerInstrumentSite(const char* file, int line, const char* function);
+
+inline InstrumentBlock& getInstrumentBlock() {
+    InstrumentBlock* block = instrument_block;
+    return block ? *block : acquireInstrumentBlock();
+}
+
+/** @brief add to a counter of the calling thread, no read-modify-write needed. */
+inline void bumpInstrumentCounter(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+#ifdef MYMATH_INSTRUMENT_CYCLES
+inline uint64_t getInstrumentTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+#endif
+
+/**
+ *  @brief InstrumentScope class, counts a call and times it until the end of the scope.
+ */
+class InstrumentScope {
+  private:
+    InstrumentBlock& block;
+    INSTRUMENTPOINT point;
+#ifdef MYMATH_INSTRUMENT_CYCLES
+    uint64_t start;
+#endif
+
+  protected:
+  public:
+    explicit InstrumentScope(INSTRUMENTPOINT _point) : block(getInstrumentBlock()), point(_point) {
+        bumpInstrumentCounter(block.calls[point], 1);
+#ifdef MYMATH_INSTRUMENT_CYCLES
+        start = getInstrumentTicks();
+#endif
+    }
+    ~InstrumentScope() {
+#ifdef MYMATH_INSTRUMENT_CYCLES
+        bumpInstrumentCounter(block.ticks[point], getInstrumentTicks() - start);
+#endif
+    }
+    InstrumentScope(const InstrumentScope&) = delete;
+    InstrumentScope& operator=(const InstrumentScope&) = delete;
+};
+
+/** @brief count a call of point, and time it with MYMATH_INSTRUMENT_CYCLES. */
+#define MYMATH_INSTRUMENT_SCOPE(point) InstrumentScope instrument_scope_(point)
+/** @brief count an error at this site, put it right after the fprintf of the error, records its own __LINE__. */
+#define MYMATH_COUNT_ERROR()                                                                       \
+    do {                                                                                           \
+        static const int instrument_site_ = registerInstrumentSite(__FILE__, __LINE__, __FUNCTION__); \
+        bumpInstrumentCounter(getInstrumentBlock().errors[instrument_site_], 1);                   \
+    } while (0)
+
+#else
+
+#define MYMATH_INSTRUMENT_SCOPE(point) ((void)0)
+#define MYMATH_COUNT_ERROR() ((void)0)
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myisa.hpp
+ *  @brief instruction set variants of the batch kernels, selected at run time.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-5
+ *  @note every variant is compiled into the library with function target attributes,
+ *  @note the library itself is built for the baseline ISA and runs on any x86-64 CPU.
+ *  @note the best variant the CPU supports (cpuid) is picked on first use, the
+ *  @note environment variable MYMATH_ISA=scalar|sse2|avx2|avx512 overrides the choice
+ *  @note to test each path on one machine, an unsupported request falls back with a warning.
+ *  @note transformPoints(), computeBounds() and quaternionsToRotations() give bitwise identical
+ *  @note results on every variant, invertMatrices() may differ in the last bits between scalar
+ *  @note and SIMD, rotationsToQuaternions() too, its scalar variant computes in double.
+ *  @note with USING_FLOAT64 or on other architectures only the scalar variant exists.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mymatrix.hpp"
+
+/**
+ *  @brief instruction set levels of the batch kernels, in increasing order.
+ */
+enum ISALEVEL {
+    /** plain C++, always available */
+    ISA_SCALAR,
+    /** SSE2, the x86-64 baseline */
+    ISA_SSE2,
+    /** AVX2, 8 floats per register */
+    ISA_AVX2,
+    /** AVX-512F, 16 floats per register */
+    ISA_AVX512,
+    /** number of levels */
+    ISA_COUNT
+};
+
+/**
+ *  @brief BatchKernels struct, the kernels of one ISALEVEL, called on sub-ranges by mybatch and myrotation.
+ */
+struct BatchKernels {
+    ISALEVEL isa;
+    /** @brief out[i] = mat * in[i] for an affine column major mat, in may equal out. */
+    void (*transform)(const scalar mat[16], const Vector3* in, size_t n, Vector3* out);
+    /** @brief extend boxMin and boxMax by the points, NaN coordinates are ignored. */
+    void (*bounds)(const Vector3* points, size_t n, Vector3& boxMin, Vector3& boxMax);
+    /** @brief general inverses, singular matrices become NaN, returns the number inverted. */
+    size_t (*invert)(const Matrix4* in, size_t n, Matrix4* out);
+    /** @brief rotations of quaternions, |q| < MYEPSILON becomes NaN, returns the number valid. */
+    size_t (*toRotations)(const Vector4* q, size_t n, Matrix3* out);
+    /** @brief quaternions with w >= 0 of rotations, non-finite ones become NaN, returns the number finite. */
+    size_t (*toQuaternions)(const Matrix3* in, size_t n, Vector4* out);
+};
+
+/** @brief name of a level, e.g. "avx2". */
+const char* getISAName(ISALEVEL isa);
+/** @brief true if the CPU and this build support a level. */
+bool isISASupported(ISALEVEL isa);
+/** @brief level of the kernels in use. */
+ISALEVEL getISA();
+/**
+ * @brief use the kernels of a level, e.g. to compare variants in a benchmark.
+ * @return false and no change if the level is not supported.
+ * @note no batch kernel may be running.
+ */
+bool setISA(ISALEVEL isa);
+/** @brief kernels in use, selected on the first call. */
+const BatchKernels& getBatchKernels();
@@ -0,0 +1,324 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myisakernels.hpp
+ *  @brief batch kernels written once over an Ops struct of one SIMD register width.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-5
+ *  @note private to myisa.cpp, which includes this file once per instruction set, inside
+ *  @note a namespace and the target region of that set, so no include guard.
+ *  @note an Ops struct provides the type V of WIDTH floats, load() store() set1() set4()
+ *  @note add() sub() mul() div() min() max() sqrt() selectGreater() and shuffle<IMM>() on
+ *  @note every 128 bits like _mm_shuffle_ps(), load3() store3() between WIDTH packed points
+ *  @note and x y z, and loadColumns() storeColumns() of WIDTH / 4 matrices, one matrix per
+ *  @note 128 bits.
+ *  @note the scalar kernels handle the remainders.
+ */
+
+template <typename O>
+inline void transformKernel(const float* a, const Vector3* in, size_t n, Vector3* out) {
+    typedef typename O::V V;
+    const V m0 = O::set1(a[0]), m1 = O::set1(a[1]), m2 = O::set1(a[2]);
+    const V m4 = O::set1(a[4]), m5 = O::set1(a[5]), m6 = O::set1(a[6]);
+    const V m8 = O::set1(a[8]), m9 = O::set1(a[9]), m10 = O::set1(a[10]);
+    const V m12 = O::set1(a[12]), m13 = O::set1(a[13]), m14 = O::set1(a[14]);
+    size_t i = 0;
+    for (; i + O::WIDTH <= n; i += O::WIDTH) {
+        V x, y, z;
+        O::load3(&in[i].x, x, y, z);
+        // same association as transformScalar(), so the results are bitwise equal
+        const V ox = O::add(O::add(O::add(O::mul(m0, x), O::mul(m4, y)), O::mul(m8, z)), m12);
+        const V oy = O::add(O::add(O::add(O::mul(m1, x), O::mul(m5, y)), O::mul(m9, z)), m13);
+        const V oz = O::add(O::add(O::add(O::mul(m2, x), O::mul(m6, y)), O::mul(m10, z)), m14);
+        O::store3(&out[i].x, ox, oy, oz);
+    }
+    transformScalar(a, in + i, n - i, out + i);
+}
+
+template <typename O>
+inline void boundsKernel(const Vector3* points, size_t n, Vector3& boxMin, Vector3& boxMax) {
+    typedef typename O::V V;
+    const size_t w = O::WIDTH;
+    if (n >= w) {
+        // WIDTH points are three registers, lane k of register r always holds coordinate
+        // (r * WIDTH + k) % 3, so the registers are reduced without shuffles
+        const float inf = std::numeric_limits<float>::infinity();
+        V lo[3] = {O::set1(inf), O::set1(inf), O::set1(inf)};
+        V hi[3] = {O::set1(-inf), O::set1(-inf), O::set1(-inf)};
+        size_t i = 0;
+        for (; i + w <= n; i += w) {
+            const float* p = &points[i].x;
+            for (int r = 0; r < 3; ++r) {
+                const V v = O::load(p + r * w);
+                // point first, a NaN coordinate keeps the bound like boundsScalar()
+                lo[r] = O::min(v, lo[r]);
+                hi[r] = O::max(v, hi[r]);
+            }
+        }
+        float l[3 * O::WIDTH], h[3 * O::WIDTH];
+        for (int r = 0; r < 3; ++r) {
+            O::store(l + r * w, lo[r]);
+            O::store(h + r * w, hi[r]);
+        }
+        float b[6] = {boxMin.x, boxMin.y, boxMin.z, boxMax.x, boxMax.y, boxMax.z};
+        for (size_t k = 0; k < 3 * w; ++k) {
+            b[k % 3] = (l[k] < b[k % 3]) ? l[k] : b[k % 3];
+            b[3 + k % 3] = (h[k] > b[3 + k % 3]) ? h[k] : b[3 + k % 3];
+        }
+        boxMin.set(b[0], b[1], b[2]);
+        boxMax.set(b[3], b[4], b[5]);
+        points += i;
+        n -= i;
+    }
+    boundsScalar(points, n, boxMin, boxMax);
+}
+
+/** @brief 2x2 row major a * b of every 4 lanes. */
+template <typename O>
+inline typename O::V mul2(typename O::V a, typename O::V b) {
+    return O::add(O::mul(a, O::template shuffle<MYISA_SHUFFLE(0, 3, 0, 3)>(b, b)),
+                  O::mul(O::template shuffle<MYISA_SHUFFLE(1, 0, 3, 2)>(a, a),
+                         O::template shuffle<MYISA_SHUFFLE(2, 1, 2, 1)>(b, b)));
+}
+
+/** @brief 2x2 row major a# * b of every 4 lanes. */
+template <typename O>
+inline typename O::V adjMul(typename O::V a, typename O::V b) {
+    return O::sub(O::mul(O::template shuffle<MYISA_SHUFFLE(3, 3, 0, 0)>(a, a), b),
+                  O::mul(O::template shuffle<MYISA_SHUFFLE(1, 1, 2, 2)>(a, a),
+                         O::template shuffle<MYISA_SHUFFLE(2, 3, 0, 1)>(b, b)));
+}
+
+/** @brief 2x2 row major a * b# of every 4 lanes. */
+template <typename O>
+inline typename O::V mulAdj(typename O::V a, typename O::V b) {
+    return O::sub(O::mul(a, O::template shuffle<MYISA_SHUFFLE(3, 0, 3, 0)>(b, b)),
+                  O::mul(O::template shuffle<MYISA_SHUFFLE(1, 0, 3, 2)>(a, a),
+                         O::template shuffle<MYISA_SHUFFLE(2, 1, 2, 1)>(b, b)));
+}
+
+/**
+ * @brief 2x2 blockwise inverse of WIDTH / 4 matrices, one per 128 bits.
+ * @note the blocks A B C D of a matrix are the 2x2 quarters, the inverse is built from
+ * @note the adjugates A# B# C# D# and |M| = |A||D| + |B||C| - tr((A#B)(D#C)).
+ * @note the algorithm is written for rows, on columns it gives the columns of the inverse.
+ */
+template <typename O>
+inline size_t invertKernel(const Matrix4* in, size_t n, Matrix4* out) {
+    typedef typename O::V V;
+    const size_t count = O::WIDTH / 4;
+    const V sign = O::set4(1.f, -1.f, -1.f, 1.f);
+    size_t inverted = 0;
+    size_t i = 0;
+    for (; i + count <= n; i += count) {
+        V c[4];
+        O::loadColumns(in[i].constData(), c);
+        const V a = O::template shuffle<MYISA_SHUFFLE(0, 1, 0, 1)>(c[0], c[1]);
+        const V b = O::template shuffle<MYISA_SHUFFLE(2, 3, 2, 3)>(c[0], c[1]);
+        const V cc = O::template shuffle<MYISA_SHUFFLE(0, 1, 0, 1)>(c[2], c[3]);
+        const V d = O::template shuffle<MYISA_SHUFFLE(2, 3, 2, 3)>(c[2], c[3]);
+        // |A| |B| |C| |D|
+        const V det_sub = O::sub(O::mul(O::template shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(c[0], c[2]),
+                                        O::template shuffle<MYISA_SHUFFLE(1, 3, 1, 3)>(c[1], c[3])),
+                                 O::mul(O::template shuffle<MYISA_SHUFFLE(1, 3, 1, 3)>(c[0], c[2]),
+                                        O::template shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(c[1], c[3])));
+        const V det_a = O::template shuffle<MYISA_SHUFFLE(0, 0, 0, 0)>(det_sub, det_sub);
+        const V det_b = O::template shuffle<MYISA_SHUFFLE(1, 1, 1, 1)>(det_sub, det_sub);
+        const V det_c = O::template shuffle<MYISA_SHUFFLE(2, 2, 2, 2)>(det_sub, det_sub);
+        const V det_d = O::template shuffle<MYISA_SHUFFLE(3, 3, 3, 3)>(det_sub, det_sub);
+        // D#C and A#B
+        const V d_c = adjMul<O>(d, cc);
+        const V a_b = adjMul<O>(a, b);
+        // X# = |D|A - B(D#C), W# = |A|D - C(A#B), Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+        V x = O::sub(O::mul(det_d, a), mul2<O>(b, d_c));
+        V w = O::sub(O::mul(det_a, d), mul2<O>(cc, a_b));
+        V y = O::sub(O::mul(det_b, cc), mulAdj<O>(d, a_b));
+        V z = O::sub(O::mul(det_c, b), mulAdj<O>(a, d_c));
+        // tr((A#B)(D#C)) summed over the lanes of every matrix
+        V tr = O::mul(a_b, O::template shuffle<MYISA_SHUFFLE(0, 2, 1, 3)>(d_c, d_c));
+        tr = O::add(tr, O::template shuffle<MYISA_SHUFFLE(2, 3, 0, 1)>(tr, tr));
+        tr = O::add(tr, O::template shuffle<MYISA_SHUFFLE(1, 0, 3, 2)>(tr, tr));
+        const V det = O::sub(O::add(O::mul(det_a, det_d), O::mul(det_b, det_c)), tr);
+        const V inv = O::div(sign, det);
+        x = O::mul(x, inv);
+        y = O::mul(y, inv);
+        z = O::mul(z, inv);
+        w = O::mul(w, inv);
+        V r[4];
+        r[0] = O::template shuffle<MYISA_SHUFFLE(3, 1, 3, 1)>(x, y);
+        r[1] = O::template shuffle<MYISA_SHUFFLE(2, 0, 2, 0)>(x, y);
+        r[2] = O::template shuffle<MYISA_SHUFFLE(3, 1, 3, 1)>(z, w);
+        r[3] = O::template shuffle<MYISA_SHUFFLE(2, 0, 2, 0)>(z, w);
+        O::storeColumns(out[i].data(), r);
+        float dets[O::WIDTH];
+        O::store(dets, det);
+        for (size_t k = 0; k < count; ++k) {
+            if (std::abs(dets[4 * k]) >= MYEPSILON) {
+                ++inverted;
+            } else {
+                setNaN(out[i + k].data());
+            }
+        }
+    }
+    return inverted + invertScalar(in + i, n - i, out + i);
+}
+
+/**
+ * @brief split WIDTH packed quaternions into x, y, z and w.
+ * @note a 4x4 transpose in every 128 bits, lane 4 * j + k holds quaternion k * WIDTH / 4 + j.
+ */
+template <typename O>
+inline void load4(const float* p, typename O::V& x, typename O::V& y, typename O::V& z, typename O::V& w) {
+    typedef typename O::V V;
+    const size_t w4 = O::WIDTH;
+    const V r0 = O::load(p), r1 = O::load(p + w4), r2 = O::load(p + 2 * w4), r3 = O::load(p + 3 * w4);
+    const V xy0 = O::template shuffle<MYISA_SHUFFLE(0, 1, 0, 1)>(r0, r1);
+    const V zw0 = O::template shuffle<MYISA_SHUFFLE(2, 3, 2, 3)>(r0, r1);
+    const V xy1 = O::template shuffle<MYISA_SHUFFLE(0, 1, 0, 1)>(r2, r3);
+    const V zw1 = O::template shuffle<MYISA_SHUFFLE(2, 3, 2, 3)>(r2, r3);
+    x = O::template shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(xy0, xy1);
+    y = O::template shuffle<MYISA_SHUFFLE(1, 3, 1, 3)>(xy0, xy1);
+    z = O::template shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(zw0, zw1);
+    w = O::template shuffle<MYISA_SHUFFLE(1, 3, 1, 3)>(zw0, zw1);
+}
+
+/** @brief pack x, y, z and w into WIDTH quaternions, the inverse of load4(). */
+template <typename O>
+inline void store4(float* p, typename O::V x, typename O::V y, typename O::V z, typename O::V w) {
+    typedef typename O::V V;
+    const size_t w4 = O::WIDTH;
+    const V xy0 = O::template shuffle<MYISA_SHUFFLE(0, 1, 0, 1)>(x, y);
+    const V zw0 = O::template shuffle<MYISA_SHUFFLE(0, 1, 0, 1)>(z, w);
+    const V xy1 = O::template shuffle<MYISA_SHUFFLE(2, 3, 2, 3)>(x, y);
+    const V zw1 = O::template shuffle<MYISA_SHUFFLE(2, 3, 2, 3)>(z, w);
+    O::store(p, O::template shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(xy0, zw0));
+    O::store(p + w4, O::template shuffle<MYISA_SHUFFLE(1, 3, 1, 3)>(xy0, zw0));
+    O::store(p + 2 * w4, O::template shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(xy1, zw1));
+    O::store(p + 3 * w4, O::template shuffle<MYISA_SHUFFLE(1, 3, 1, 3)>(xy1, zw1));
+}
+
+/** @brief quaternion in lane l of load4() and store4(). */
+template <typename O>
+inline size_t quaternionLane(size_t l) {
+    return (l % 4) * (O::WIDTH / 4) + l / 4;
+}
+
+/**
+ * @brief rotations of WIDTH quaternions at a time, bitwise equal to toRotationsScalar().
+ * @note the nine entries leave the registers through the stack, a 3x3 matrix does not
+ * @note fit the 128 bit lanes.
+ */
+template <typename O>
+inline size_t toRotationsKernel(const Vector4* q, size_t n, Matrix3* out) {
+    typedef typename O::V V;
+    const size_t w4 = O::WIDTH;
+    const V one = O::set1(1.f), two = O::set1(2.f);
+    size_t valid = 0;
+    size_t i = 0;
+    for (; i + w4 <= n; i += w4) {
+        V x, y, z, w;
+        load4<O>(&q[i].x, x, y, z, w);
+        const V n2 = O::add(O::add(O::add(O::mul(x, x), O::mul(y, y)), O::mul(z, z)), O::mul(w, w));
+        const V s = O::div(two, n2);
+        const V sx = O::mul(s, x), sy = O::mul(s, y), sz = O::mul(s, z), sw = O::mul(s, w);
+        const V xx = O::mul(sx, x), yy = O::mul(sy, y), zz = O::mul(sz, z);
+        const V xy = O::mul(sx, y), xz = O::mul(sx, z), yz = O::mul(sy, z);
+        const V wx = O::mul(sw, x), wy = O::mul(sw, y), wz = O::mul(sw, z);
+        V m[9];
+        m[0] = O::sub(O::sub(one, yy), zz);
+        m[1] = O::add(xy, wz);
+        m[2] = O::sub(xz, wy);
+        m[3] = O::sub(xy, wz);
+        m[4] = O::sub(O::sub(one, xx), zz);
+        m[5] = O::add(yz, wx);
+        m[6] = O::add(xz, wy);
+        m[7] = O::sub(yz, wx);
+        m[8] = O::sub(O::sub(one, xx), yy);
+        // a - a is 0 for finite a and NaN otherwise
+        V finite = O::sub(m[0], m[0]);
+        for (int k = 1; k < 9; ++k) finite = O::add(finite, O::sub(m[k], m[k]));
+        float entries[9][O::WIDTH], norms[O::WIDTH], checks[O::WIDTH];
+        for (int k = 0; k < 9; ++k) O::store(entries[k], m[k]);
+        O::store(norms, n2);
+        O::store(checks, finite);
+        for (size_t l = 0; l < w4; ++l) {
+            float* r = out[i + quaternionLane<O>(l)].data();
+            if ((norms[l] >= MYEPSILON * MYEPSILON) && (checks[l] == 0)) {
+                for (int k = 0; k < 9; ++k) r[k] = entries[k][l];
+                ++valid;
+            } else {
+                for (int k = 0; k < 9; ++k) r[k] = std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+    }
+    return valid + toRotationsScalar(q + i, n - i, out + i);
+}
+
+/** @brief (trace > 0) ? vw : ((r00 > r11) && (r00 > r22)) ? vx : (r11 > r22) ? vy : vz per lane. */
+template <typename O>
+inline typename O::V shepperdCase(typename O::V trace, typename O::V r00, typename O::V r11, typename O::V r22,
+                                  typename O::V vw, typename O::V vx, typename O::V vy, typename O::V vz) {
+    const typename O::V yz = O::selectGreater(r11, r22, vy, vz);
+    return O::selectGreater(trace, O::set1(0.f), vw,
+                            O::selectGreater(r00, r11, O::selectGreater(r00, r22, vx, yz), yz));
+}
+
+/**
+ * @brief quaternions of WIDTH rotations at a time, Shepperd's method in float.
+ * @note all four cases are computed and the one of toQuaternionsScalar() is selected, the
+ * @note component found by the square root is t / (2 sqrt(t)), the others are quotients
+ * @note of off-diagonal sums and differences by the same 2 sqrt(t).
+ */
+template <typename O>
+inline size_t toQuaternionsKernel(const Matrix3* in, size_t n, Vector4* out) {
+    typedef typename O::V V;
+    const size_t w4 = O::WIDTH;
+    const V zero = O::set1(0.f), one = O::set1(1.f), two = O::set1(2.f);
+    size_t finite = 0;
+    size_t i = 0;
+    for (; i + w4 <= n; i += w4) {
+        // the nine entries enter the registers through the stack, in the lanes of store4()
+        float entries[9][O::WIDTH];
+        for (size_t l = 0; l < w4; ++l) {
+            const float* m = in[i + quaternionLane<O>(l)].constData();
+            for (int k = 0; k < 9; ++k) entries[k][l] = m[k];
+        }
+        V m[9];
+        for (int k = 0; k < 9; ++k) m[k] = O::load(entries[k]);
+        const V r00 = m[0], r10 = m[1], r20 = m[2];
+        const V r01 = m[3], r11 = m[4], r21 = m[5];
+        const V r02 = m[6], r12 = m[7], r22 = m[8];
+        const V trace = O::add(O::add(r00, r11), r22);
+        const V t = shepperdCase<O>(trace, r00, r11, r22, O::add(trace, one),
+                                    O::sub(O::sub(O::add(one, r00), r11), r22),
+                                    O::sub(O::sub(O::add(one, r11), r00), r22),
+                                    O::sub(O::sub(O::add(one, r22), r00), r11));
+        const V s = O::mul(two, O::sqrt(t));
+        const V a = O::sub(r21, r12), b = O::sub(r02, r20), c = O::sub(r10, r01);
+        const V d = O::add(r01, r10), e = O::add(r02, r20), f = O::add(r12, r21);
+        V x = O::div(shepperdCase<O>(trace, r00, r11, r22, a, t, d, e), s);
+        V y = O::div(shepperdCase<O>(trace, r00, r11, r22, b, d, t, f), s);
+        V z = O::div(shepperdCase<O>(trace, r00, r11, r22, c, e, f, t), s);
+        V w = O::div(shepperdCase<O>(trace, r00, r11, r22, t, a, b, c), s);
+        // the quaternion with w >= 0
+        const V sign = O::selectGreater(zero, w, O::set1(-1.f), one);
+        x = O::mul(sign, x);
+        y = O::mul(sign, y);
+        z = O::mul(sign, z);
+        w = O::mul(sign, w);
+        store4<O>(&out[i].x, x, y, z, w);
+        V check = O::sub(m[0], m[0]);
+        for (int k = 1; k < 9; ++k) check = O::add(check, O::sub(m[k], m[k]));
+        float checks[O::WIDTH];
+        O::store(checks, check);
+        for (size_t l = 0; l < w4; ++l) {
+            if (checks[l] == 0) {
+                ++finite;
+            } else {
+                const float nan = std::numeric_limits<float>::quiet_NaN();
+                out[i + quaternionLane<O>(l)].set(nan, nan, nan, nan);
+            }
+        }
+    }
+    return finite + toQuaternionsScalar(in + i, n - i, out + i);
+}
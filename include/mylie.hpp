@@ -0,0 +1,309 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mylie.hpp
+ *  @brief SO(3) rotations and SE(3) rigid transformations with their exp/log maps and Jacobians.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-7
+ *  @note tangent vectors of SE(3) are ordered (rho, phi), translation part first, and
+ *  @note exp((rho, phi)) = [ exp(phi) | J_l(phi) * rho ], as in Barfoot's book and Sophus.
+ *  @note a left perturbation is exp(delta) * T, a right perturbation T * exp(delta).
+ *  @note exp(), log() and the Jacobians switch to Taylor series for angles below 0.1 rad
+ *  @note and compute their coefficients in double, log() of SO3 stays accurate up to pi.
+ *  @note SO3 keeps its matrix a rotation, only the checked constructors accept a Matrix3
+ *  @note or Matrix4, normalize() removes the drift of long products.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mymatrix.hpp"
+#include "mymatrixn.hpp"
+
+class SE3;
+
+/**
+ *  @brief SO3 class, a 3D rotation stored as its rotation matrix.
+ */
+class SO3 {
+  private:
+    Matrix3 R;
+
+    friend class SE3;
+    friend class TrajectorySpline;
+
+  protected:
+  public:
+    /**
+     * @brief Default constructor, the identity.
+     */
+    SO3() :
+        R(Matrix3::identity()) {
+    }
+    /**
+     * @brief constructor by rotation matrix.
+     * @param mat rotation matrix.
+     * @exception Not a rotation matrix.
+     */
+    explicit SO3(const Matrix3& mat);
+
+    /**
+     * @brief skew symmetric matrix of a vector, hat(w) * v = w x v.
+     * @param w vector.
+     * @return | 0 -z y |, | z 0 -x |, | -y x 0 |.
+     */
+    static Matrix3 hat(const Vector3& w);
+    /**
+     * @brief vector of the skew symmetric part of a matrix, inverse of hat().
+     * @param mat matrix.
+     * @return (m21 - m12, m02 - m20, m10 - m01) / 2.
+     */
+    static Vector3 vee(const Matrix3& mat);
+    /**
+     * @brief exponential map, rotation by |w| radian about w.
+     * @param w rotation vector.
+     * @return rotation.
+     */
+    static SO3 exp(const Vector3& w);
+    /**
+     * @brief rotation about a unit axis, exp(angle * axis) without normalizing the axis.
+     * @param axis unit rotation axis.
+     * @param angle rotation angle in radian.
+     * @return rotation.
+     * @note sin and cos in scalar precision, the cheap path for cached axes.
+     */
+    static SO3 rotation(const Vector3& axis, scalar angle);
+    /**
+     * @brief logarithmic map, inverse of exp().
+     * @return rotation vector with |w| in [0, pi].
+     */
+    Vector3 log() const;
+
+    /**
+     * @brief left Jacobian, exp(w + dw) ~ exp(J_l(w) * dw) * exp(w).
+     * @param w rotation vector.
+     * @return I + (1 - cos t) / t^2 * W + (t - sin t) / t^3 * W^2, W = hat(w), t = |w|.
+     */
+    static Matrix3 leftJacobian(const Vector3& w);
+    /**
+     * @brief inverse of leftJacobian().
+     * @param w rotation vector, |w| < 2 pi.
+     * @return I - W / 2 + (1 / t^2 - (1 + cos t) / (2 t sin t)) * W^2.
+     */
+    static Matrix3 leftJacobianInverse(const Vector3& w);
+    /**
+     * @brief right Jacobian, exp(w + dw) ~ exp(w) * exp(J_r(w) * dw), J_r(w) = J_l(-w).
+     * @param w rotation vector.
+     * @return Jacobian.
+     */
+    static Matrix3 rightJacobian(const Vector3& w);
+    /**
+     * @brief inverse of rightJacobian().
+     * @param w rotation vector, |w| < 2 pi.
+     * @return Jacobian inverse.
+     */
+    static Matrix3 rightJacobianInverse(const Vector3& w);
+
+    /** @brief rotation matrix. */
+    const Matrix3& matrix() const { return R; }
+    /**
+     * @brief inverse rotation, the transposed matrix.
+     * @return inverse.
+     */
+    SO3 inverse() const;
+    /**
+     * @brief adjoint, Ad(R) * w = log(R * exp(w) * R^{-1}), equal to the rotation matrix.
+     * @return adjoint matrix.
+     */
+    const Matrix3& adjoint() const { return R; }
+    /**
+     * @brief in-place operation, re-orthonormalize the matrix after long products.
+     * @note Gram-Schmidt on the first two columns, the third is their cross product.
+     */
+    void normalize();
+
+    /**
+     * @brief composition, this rotation applied after rhs.
+     * @return R * rhs.R
+     */
+    SO3 operator*(const SO3& rhs) const;
+    /** @brief in-place composition, *this = *this * rhs. */
+    SO3& operator*=(const SO3& rhs);
+    /** @brief rotate a vector. */
+    Vector3 operator*(const Vector3& v) const { return R * v; }
+};
+
+/**
+ *  @brief SE3 class, a rigid transformation stored as rotation and translation.
+ */
+class SE3 {
+  private:
+    SO3 R;
+    Vector3 t;
+
+  protected:
+  public:
+    /**
+     * @brief Default constructor, the identity.
+     */
+    SE3() :
+        R(), t(0, 0, 0) {
+    }
+    /**
+     * @brief constructor by rotation and translation.
+     * @param rotation rotation.
+     * @param translation translation, applied after the rotation.
+     */
+    SE3(const SO3& rotation, const Vector3& translation) :
+        R(rotation), t(translation) {
+    }
+    /**
+     * @brief constructor by transformation matrix.
+     * @param mat rigid transformation matrix.
+     * @exception Not a rigid transformation.
+     */
+    explicit SE3(const Matrix4& mat);
+
+    /**
+     * @brief exponential map.
+     * @param xi tangent vector (rho, phi).
+     * @return [ exp(phi) | J_l(phi) * rho ].
+     */
+    static SE3 exp(const VectorN<6>& xi);
+    /**
+     * @brief logarithmic map, inverse of exp().
+     * @return tangent vector (rho, phi) with |phi| in [0, pi].
+     */
+    VectorN<6> log() const;
+
+    /**
+     * @brief left Jacobian, exp(xi + dxi) ~ exp(J_l(xi) * dxi) * exp(xi).
+     * @param xi tangent vector (rho, phi).
+     * @return | J_l(phi) Q(rho, phi) |, | 0 J_l(phi) |, Q from Barfoot (7.86).
+     */
+    static MatrixN<6, 6> leftJacobian(const VectorN<6>& xi);
+    /**
+     * @brief inverse of leftJacobian().
+     * @param xi tangent vector (rho, phi), |phi| < 2 pi.
+     * @return | J_l^{-1} -J_l^{-1} Q J_l^{-1} |, | 0 J_l^{-1} |.
+     */
+    static MatrixN<6, 6> leftJacobianInverse(const VectorN<6>& xi);
+    /**
+     * @brief right Jacobian, exp(xi + dxi) ~ exp(xi) * exp(J_r(xi) * dxi), J_r(xi) = J_l(-xi).
+     * @param xi tangent vector (rho, phi).
+     * @return Jacobian.
+     */
+    static MatrixN<6, 6> rightJacobian(const VectorN<6>& xi);
+    /**
+     * @brief inverse of rightJacobian().
+     * @param xi tangent vector (rho, phi), |phi| < 2 pi.
+     * @return Jacobian inverse.
+     */
+    static MatrixN<6, 6> rightJacobianInverse(const VectorN<6>& xi);
+
+    /** @brief rotation part. */
+    const SO3& rotation() const { return R; }
+    /** @brief translation part. */
+    const Vector3& translation() const { return t; }
+    /**
+     * @brief homogeneous matrix.
+     * @return [ R | t ], [ 0 | 1 ].
+     */
+    Matrix4 matrix() const;
+    /**
+     * @brief inverse transformation by the rigid fast path, no general inverse.
+     * @return [ R^{T} | -R^{T} * t ].
+     */
+    SE3 inverse() const;
+    /**
+     * @brief adjoint, Ad(T) * xi = log(T * exp(xi) * T^{-1}).
+     * @return | R hat(t) * R |, | 0 R |.
+     */
+    MatrixN<6, 6> adjoint() const;
+    /**
+     * @brief apply the adjoint without forming the 6x6 matrix.
+     * @param xi tangent vector (rho, phi).
+     * @return (R * rho + t x (R * phi), R * phi).
+     */
+    VectorN<6> adjoint(const VectorN<6>& xi) const;
+    /** @brief in-place operation, re-orthonormalize the rotation. */
+    void normalize() { R.normalize(); }
+
+    /**
+     * @brief composition, this transformation applied after rhs.
+     * @return [ R * rhs.R | R * rhs.t + t ].
+     */
+    SE3 operator*(const SE3& rhs) const;
+    /** @brief in-place composition, *this = *this * rhs. */
+    SE3& operator*=(const SE3& rhs);
+    /** @brief transform a point, R * p + t. */
+    Vector3 operator*(const Vector3& p) const { return R * p + t; }
+};
+
+/**
+ *  @brief side of a perturbation of a pose.
+ */
+enum PERTURBATION {
+    /** exp(delta) * T, delta in the world frame */
+    PERTURB_LEFT,
+    /** T * exp(delta), delta in the body frame */
+    PERTURB_RIGHT
+};
+
+/**
+ * @brief update poses by tangent increments, in parallel.
+ * @param in n poses.
+ * @param delta n tangent vectors (rho, phi).
+ * @param n number of poses.
+ * @param out n updated poses, may alias in.
+ * @param side left or right perturbation.
+ */
+void perturbPoses(const SE3* in, const VectorN<6>* delta, size_t n, SE3* out, PERTURBATION side = PERTURB_LEFT);
+/**
+ * @brief update rotations by tangent increments, in parallel.
+ * @param in n rotations.
+ * @param delta n rotation vectors.
+ * @param n number of rotations.
+ * @param out n updated rotations, may alias in.
+ * @param side left or right perturbation.
+ */
+void perturbRotations(const SO3* in, const Vector3* delta, size_t n, SO3* out, PERTURBATION side = PERTURB_LEFT);
+/**
+ * @brief exponential maps of tangent vectors, in parallel.
+ * @param xi n tangent vectors (rho, phi).
+ * @param n number of vectors.
+ * @param out n poses.
+ */
+void expPoses(const VectorN<6>* xi, size_t n, SE3* out);
+/**
+ * @brief logarithmic maps of poses, in parallel.
+ * @param in n poses.
+ * @param n number of poses.
+ * @param xi n tangent vectors (rho, phi).
+ */
+void logPoses(const SE3* in, size_t n, VectorN<6>* xi);
+/**
+ * @brief pairwise compositions a[i] * b[i], in parallel.
+ * @param a n poses applied last.
+ * @param b n poses applied first.
+ * @param n number of poses.
+ * @param out n products, may alias a or b.
+ */
+void composePoses(const SE3* a, const SE3* b, size_t n, SE3* out);
+/**
+ * @brief inverses of poses, in parallel.
+ * @param in n poses.
+ * @param n number of poses.
+ * @param out n inverses, may alias in.
+ */
+void invertPoses(const SE3* in, size_t n, SE3* out);
+/**
+ * @brief adjoints of poses applied to tangent vectors, Ad(poses[i]) * xi[i], in parallel.
+ * @param poses n poses.
+ * @param xi n tangent vectors (rho, phi).
+ * @param n number of poses.
+ * @param out n tangent vectors, may alias xi.
+ * @note moves a right perturbation to the left, T * exp(xi) = exp(Ad(T) * xi) * T.
+ */
+void adjointPoses(const SE3* poses, const VectorN<6>* xi, size_t n, VectorN<6>* out);
@@ -14,12 +14,28 @@
  *  @note| 1 3 |....| 1 4 7 |......| 1  5  9 13 |
  *  @note...........| 2 5 8 |......| 2  6 10 14 |
  *  @note..........................| 3  7 11 15 |
+ *  @note constructors, identity(), transposed(), matmul(), matrix-vector products and
+ *  @note the scaling() and translation() builders are constexpr, fixed transforms
+ *  @note like axis swaps or mounting offsets fold at compile time into read-only data:
+ *  @note `constexpr Matrix4 T = Matrix4::translation(0, 0, 1.2f).matmul(Matrix4::scaling(0.001f));`
+ *  @note a MYMATH_INSTRUMENT build counts Matrix4::matmul() calls evaluated at run time if the
+ *  @note compiler tells them apart (__builtin_is_constant_evaluated), otherwise none.
  */
 
 #pragma once
 
 #include "myvector.hpp"
 
+#ifdef MYMATH_INSTRUMENT
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define MYMATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#elif defined(_MSC_VER) && (_MSC_VER >= 1925)
+#define MYMATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
 class Matrix2;
 class Matrix3;
 class Matrix4;
@@ -40,7 +56,8 @@ class Matrix2 {
     * @see Matrix2(const scalar src[4])
     * @see Matrix2(scalar m0, scalar m1, scalar m2, scalar m3)
     */
-    Matrix2();
+    constexpr Matrix2() :
+        m{1, 0, 0, 1} {}
     /**
     * Create a new 2x2 matrix object by pointer.
     * @brief constructor by a scalar pointer.
@@ -48,19 +65,22 @@ class Matrix2 {
     * @see Matrix2()
     * @see Matrix2(scalar m0, scalar m1, scalar m2, scalar m3)
     */
-    Matrix2(const scalar src[4]);
+    constexpr Matrix2(const scalar src[4]) :
+        m{src[0], src[1], src[2], src[3]} {}
     /**
     * Create a new 2x2 matrix object by 4 elements.
     * @brief constructor by 4 scalar elements.
     * @see Matrix2()
     * @see Matrix2(const scalar src[4])
     */
-    Matrix2(scalar m0, scalar m1, scalar m2, scalar m3);
+    constexpr Matrix2(scalar m0, scalar m1, scalar m2, scalar m3) :
+        m{m0, m1, m2, m3} {}
     /**
      * @brief Matrix2 copy constructor, deep copy.
      * @param mat2: Matrix2 object
      */
-    Matrix2(const Matrix2& mat2);
+    constexpr Matrix2(const Matrix2& mat2) :
+        m{mat2.m[0], mat2.m[1], mat2.m[2], mat2.m[3]} {}
 
     /**
      * @brief Matrix2 operator= overloading, deep copy.
@@ -147,6 +167,21 @@ class Matrix2 {
      * @brief in-place operation, set as identity 2x2 matrix.
      */
     void setIdentity();
+    /**
+     * @brief identity 2x2 matrix.
+     * @see void setIdentity()
+     */
+    static constexpr Matrix2 identity() {
+        return Matrix2();
+    }
+    /**
+     * @brief scale matrix.
+     * @param sx scale in (1, 0).
+     * @param sy scale in (0, 1).
+     */
+    static constexpr Matrix2 scaling(scalar sx, scalar sy) {
+        return Matrix2(sx, 0, 0, sy);
+    }
     /**
      * @brief construct rotation matrix by angle.
      * @param angle right-hand direction is positive.
@@ -209,7 +244,7 @@ class Matrix2 {
      * @return transposed Matrix2.
      * @see void transpose()
      */
-    Matrix2 transposed() const {
+    constexpr Matrix2 transposed() const {
         return Matrix2(m[0], m[2], m[1], m[3]);
     }
 
@@ -261,12 +296,18 @@ class Matrix2 {
      * @return result
      * @see Matrix2 operator*(const Matrix2& rhs) const
      */
-    Matrix2 matmul(const Matrix2& rhs) const;
+    constexpr Matrix2 matmul(const Matrix2& rhs) const {
+        return Matrix2(m[0] * rhs.m[0] + m[2] * rhs.m[1], m[1] * rhs.m[0] + m[3] * rhs.m[1],
+                       m[0] * rhs.m[2] + m[2] * rhs.m[3], m[1] * rhs.m[2] + m[3] * rhs.m[3]);
+    }
     /**
      * @brief multiply 2x2 matrix with 2D vector.
      * @see friend Vector2 operator*(const Vector2& vec, const Matrix2& mat2)
      */
-    Vector2 operator*(const Vector2& rhs) const;
+    constexpr Vector2 operator*(const Vector2& rhs) const {
+        return Vector2(m[0] * rhs.x + m[2] * rhs.y,
+                       m[1] * rhs.x + m[3] * rhs.y);
+    }
     /**
      * @brief multiply this 2x2 matrix with another 2x2 matrix.
      * @see Matrix2& operator*=(const Matrix2& rhs)
@@ -412,7 +453,8 @@ class Matrix3 {
     *              scalar m3, scalar m4, scalar m5,
     *              scalar m6, scalar m7, scalar m8)
     */
-    Matrix3();
+    constexpr Matrix3() :
+        m{1, 0, 0, 0, 1, 0, 0, 0, 1} {}
     /**
     * Create a new 3x3 matrix object by pointer.
     * @brief constructor by a scalar pointer.
@@ -422,21 +464,24 @@ class Matrix3 {
     *              scalar m3, scalar m4, scalar m5,
     *              scalar m6, scalar m7, scalar m8)
     */
-    Matrix3(const scalar src[9]);
+    constexpr Matrix3(const scalar src[9]) :
+        m{src[0], src[1], src[2], src[3], src[4], src[5], src[6], src[7], src[8]} {}
     /**
     * Create a new 3x3 matrix object by 9 elements.
     * @brief constructor by 9 scalar elements.
     * @see Matrix3()
     * @see Matrix3(const scalar src[9])
     */
-    Matrix3(scalar m0, scalar m1, scalar m2,  // first column
-            scalar m3, scalar m4, scalar m5,  // second column
-            scalar m6, scalar m7, scalar m8); // third column
+    constexpr Matrix3(scalar m0, scalar m1, scalar m2,  // first column
+                      scalar m3, scalar m4, scalar m5,  // second column
+                      scalar m6, scalar m7, scalar m8) : // third column
+        m{m0, m1, m2, m3, m4, m5, m6, m7, m8} {}
     /**
      * @brief Matrix3 copy constructor, deep copy.
      * @param mat3 Matrix3 object
      */
-    Matrix3(const Matrix3& mat3);
+    constexpr Matrix3(const Matrix3& mat3) :
+        m{mat3.m[0], mat3.m[1], mat3.m[2], mat3.m[3], mat3.m[4], mat3.m[5], mat3.m[6], mat3.m[7], mat3.m[8]} {}
 
     /**
      * @brief Matrix3 operator= overloading, deep copy.
@@ -540,6 +585,22 @@ class Matrix3 {
      * @brief in-place operation, set as identity 3x3 matrix.
      */
     void setIdentity();
+    /**
+     * @brief identity 3x3 matrix.
+     * @see void setIdentity()
+     */
+    static constexpr Matrix3 identity() {
+        return Matrix3();
+    }
+    /**
+     * @brief scale matrix.
+     * @param sx scale in (1, 0, 0).
+     * @param sy scale in (0, 1, 0).
+     * @param sz scale in (0, 0, 1).
+     */
+    static constexpr Matrix3 scaling(scalar sx, scalar sy, scalar sz) {
+        return Matrix3(sx, 0, 0, 0, sy, 0, 0, 0, sz);
+    }
     /**
      * @brief construct rotation matrix by axis-angle utilizing Rodrigues Rotation Formula.
      * @param axis rotation axis.
@@ -602,7 +663,9 @@ class Matrix3 {
      * @return transposed Matrix3.
      * @see void transpose()
      */
-    Matrix3 transposed() const;
+    constexpr Matrix3 transposed() const {
+        return Matrix3(m[0], m[3], m[6], m[1], m[4], m[7], m[2], m[5], m[8]);
+    }
 
     /**
      * @brief in-place operation, compute inversed 3x3 matrix.
@@ -652,12 +715,29 @@ class Matrix3 {
      * @return result
      * @see Matrix3 operator*(const Matrix3& rhs) const
      */
-    Matrix3 matmul(const Matrix3& rhs) const;
+    constexpr Matrix3 matmul(const Matrix3& rhs) const {
+        // | 0 3 6 |   | 0 3 6 |
+        // | 1 4 7 | * | 1 4 7 |
+        // | 2 5 8 |   | 2 5 8 |
+        return Matrix3(m[0] * rhs.m[0] + m[3] * rhs.m[1] + m[6] * rhs.m[2],
+                       m[1] * rhs.m[0] + m[4] * rhs.m[1] + m[7] * rhs.m[2],
+                       m[2] * rhs.m[0] + m[5] * rhs.m[1] + m[8] * rhs.m[2],
+                       m[0] * rhs.m[3] + m[3] * rhs.m[4] + m[6] * rhs.m[5],
+                       m[1] * rhs.m[3] + m[4] * rhs.m[4] + m[7] * rhs.m[5],
+                       m[2] * rhs.m[3] + m[5] * rhs.m[4] + m[8] * rhs.m[5],
+                       m[0] * rhs.m[6] + m[3] * rhs.m[7] + m[6] * rhs.m[8],
+                       m[1] * rhs.m[6] + m[4] * rhs.m[7] + m[7] * rhs.m[8],
+                       m[2] * rhs.m[6] + m[5] * rhs.m[7] + m[8] * rhs.m[8]);
+    }
     /**
      * @brief multiply 3x3 matrix with 3D vector.
      * @see friend Vector3 operator*(const Vector3& vec, const Matrix3& mat3)
      */
-    Vector3 operator*(const Vector3& rhs) const;
+    constexpr Vector3 operator*(const Vector3& rhs) const {
+        return Vector3(m[0] * rhs.x + m[3] * rhs.y + m[6] * rhs.z,
+                       m[1] * rhs.x + m[4] * rhs.y + m[7] * rhs.z,
+                       m[2] * rhs.x + m[5] * rhs.y + m[8] * rhs.z);
+    }
     /**
      * @brief element-wise multiplcation.
      * @see Matrix3& operator*=(const Matrix3& rhs)
@@ -793,6 +873,10 @@ private:
     scalar getCofactor(scalar m0, scalar m1, scalar m2,
                        scalar m3, scalar m4, scalar m5,
                        scalar m6, scalar m7, scalar m8) const;
+#ifdef MYMATH_INSTRUMENT
+    /** @brief count a matmul() evaluated at run time, out of line so that matmul() stays constexpr. */
+    static void countMatmul();
+#endif
 protected:
 public:
     /**
@@ -804,7 +888,8 @@ public:
                    scalar m08, scalar m09, scalar m10, scalar m11,
                    scalar m12, scalar m13, scalar m14, scalar m15)
     */
-    Matrix4();
+    constexpr Matrix4() :
+        m{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1} {}
     /**
     * Create a new 4x4 matrix object by pointer.
     * @brief constructor by a scalar pointer.
@@ -815,22 +900,27 @@ public:
                    scalar m08, scalar m09, scalar m10, scalar m11,
                    scalar m12, scalar m13, scalar m14, scalar m15)
     */
-    Matrix4(const scalar src[16]);
+    constexpr Matrix4(const scalar src[16]) :
+        m{src[0], src[1], src[2], src[3], src[4], src[5], src[6], src[7],
+          src[8], src[9], src[10], src[11], src[12], src[13], src[14], src[15]} {}
     /**
     * Create a new 4x4 matrix object by 16 elements.
     * @brief constructor by 16 scalar elements.
     * @see Matrix4()
     * @see Matrix4(const scalar src[16])
     */
-    Matrix4(scalar m00, scalar m01, scalar m02, scalar m03,
-            scalar m04, scalar m05, scalar m06, scalar m07,
-            scalar m08, scalar m09, scalar m10, scalar m11,
-            scalar m12, scalar m13, scalar m14, scalar m15);
+    constexpr Matrix4(scalar m00, scalar m01, scalar m02, scalar m03,
+                      scalar m04, scalar m05, scalar m06, scalar m07,
+                      scalar m08, scalar m09, scalar m10, scalar m11,
+                      scalar m12, scalar m13, scalar m14, scalar m15) :
+        m{m00, m01, m02, m03, m04, m05, m06, m07, m08, m09, m10, m11, m12, m13, m14, m15} {}
     /**
      * @brief Matrix4 copy constructor, deep copy.
      * @param mat4 Matrix4 object
      */
-    Matrix4(const Matrix4& mat4);
+    constexpr Matrix4(const Matrix4& mat4) :
+        m{mat4.m[0], mat4.m[1], mat4.m[2], mat4.m[3], mat4.m[4], mat4.m[5], mat4.m[6], mat4.m[7],
+          mat4.m[8], mat4.m[9], mat4.m[10], mat4.m[11], mat4.m[12], mat4.m[13], mat4.m[14], mat4.m[15]} {}
 
     /**
      * @brief Matrix4 operator= overloading, deep copy.
@@ -947,6 +1037,127 @@ public:
      * @brief in-place operation, set as identity 4x4 matrix.
      */
     void setIdentity();
+    /**
+     * @brief identity 4x4 matrix.
+     * @see void setIdentity()
+     */
+    static constexpr Matrix4 identity() {
+        return Matrix4();
+    }
+    /**
+     * @brief translation matrix.
+     * @param x translation in the (1, 0, 0) direction.
+     * @param y translation in the (0, 1, 0) direction.
+     * @param z translation in the (0, 0, 1) direction.
+     * @see Matrix4& translate(scalar x, scalar y, scalar z)
+     */
+    static constexpr Matrix4 translation(scalar x, scalar y, scalar z) {
+        return Matrix4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1);
+    }
+    /**
+     * @brief translation matrix.
+     * @param v translation in (1, 0, 0), (0, 1, 0), (0, 0, 1) direction.
+     * @see Matrix4& translate(const Vector3& v)
+     */
+    static constexpr Matrix4 translation(const Vector3& v) {
+        return translation(v.x, v.y, v.z);
+    }
+    /**
+     * @brief scale matrix.
+     * @param sx scale in (1, 0, 0).
+     * @param sy scale in (0, 1, 0).
+     * @param sz scale in (0, 0, 1).
+     * @see Matrix4& scale(scalar sx, scalar sy, scalar sz)
+     */
+    static constexpr Matrix4 scaling(scalar sx, scalar sy, scalar sz) {
+        return Matrix4(sx, 0, 0, 0, 0, sy, 0, 0, 0, 0, sz, 0, 0, 0, 0, 1);
+    }
+    /**
+     * @brief scale matrix.
+     * @param s diagonal value in scale matrix.
+     * @see Matrix4& scale(scalar s)
+     */
+    static constexpr Matrix4 scaling(scalar s) {
+        return scaling(s, s, s);
+    }
+    /**
+     * @brief construct perspective projection matrix by clipping planes at near plane.
+     * @brief right-handed view space looking at (0, 0, -1), clip depth range [-1, 1].
+     * @brief (l, r, b, t denote left, right, bottom, top; n, f denote zNear, zFar)
+     * @brief | 2n/(r-l)     0     (r+l)/(r-l)       0      |
+     * @brief |    0      2n/(t-b) (t+b)/(t-b)       0      |
+     * @brief |    0         0     -(f+n)/(f-n) -2fn/(f-n)  |
+     * @brief |    0         0         -1            0      |
+     * @param left left clipping plane at near plane.
+     * @param right right clipping plane at near plane.
+     * @param bottom bottom clipping plane at near plane.
+     * @param top top clipping plane at near plane.
+     * @param zNear distance to near plane, positive.
+     * @param zFar distance to far plane, positive.
+     * @exception (left == right) or (bottom == top) or (zNear == zFar)
+     * @see Matrix4 computePerspectiveInverse() const
+     */
+    void setFrustum(scalar left, scalar right, scalar bottom, scalar top,
+                    scalar zNear, scalar zFar);
+    /**
+     * @brief construct symmetric perspective projection matrix, clip depth range [-1, 1].
+     * @param fovY vertical field of view.
+     * @param aspect width / height.
+     * @param zNear distance to near plane, positive.
+     * @param zFar distance to far plane, positive.
+     * @param unit degree or radian, degree by default.
+     * @exception (fovY <= 0) or (aspect == 0) or (zNear <= 0) or (zFar <= 0) or (zNear == zFar)
+     * @see void setFrustum(scalar left, scalar right, scalar bottom, scalar top,
+     *                      scalar zNear, scalar zFar)
+     */
+    void setPerspective(scalar fovY, scalar aspect, scalar zNear, scalar zFar,
+                        ANGLEUNIT unit = DEG);
+    /**
+     * @brief construct symmetric perspective projection matrix with far plane at infinity.
+     * @brief clip depth range [-1, 1], the third row is (0, 0, -1, -2n).
+     * @param fovY vertical field of view.
+     * @param aspect width / height.
+     * @param zNear distance to near plane, positive.
+     * @param unit degree or radian, degree by default.
+     * @exception (fovY <= 0) or (aspect == 0) or (zNear <= 0)
+     */
+    void setInfinitePerspective(scalar fovY, scalar aspect, scalar zNear, ANGLEUNIT unit = DEG);
+    /**
+     * @brief construct symmetric reversed-Z perspective projection matrix.
+     * @brief clip depth range [0, 1], near plane maps to 1 and far plane to 0.
+     * @brief the third row is (0, 0, n/(f-n), fn/(f-n)), (0, 0, 0, n) if zFar is infinity.
+     * @param fovY vertical field of view.
+     * @param aspect width / height.
+     * @param zNear distance to near plane, positive.
+     * @param zFar distance to far plane, positive, INFINITY for infinite far plane.
+     * @param unit degree or radian, degree by default.
+     * @exception (fovY <= 0) or (aspect == 0) or (zNear <= 0) or (zNear == zFar)
+     * @see Frustum::set(const Matrix4& viewProjection, CLIPDEPTH depth)
+     */
+    void setReversedZPerspective(scalar fovY, scalar aspect, scalar zNear, scalar zFar,
+                                 ANGLEUNIT unit = DEG);
+    /**
+     * @brief construct orthographic projection matrix, clip depth range [-1, 1].
+     * @brief | 2/(r-l)    0        0     -(r+l)/(r-l) |
+     * @brief |    0    2/(t-b)     0     -(t+b)/(t-b) |
+     * @brief |    0       0    -2/(f-n)  -(f+n)/(f-n) |
+     * @brief |    0       0        0          1       |
+     * @exception (left == right) or (bottom == top) or (zNear == zFar)
+     * @see Matrix4 computeOrthographicInverse() const
+     */
+    void setOrthographic(scalar left, scalar right, scalar bottom, scalar top,
+                         scalar zNear, scalar zFar);
+    /**
+     * @brief construct view matrix, camera at eye looking at target.
+     * @brief the camera looks at (0, 0, -1) with (0, 1, 0) up in view space.
+     * @param eye camera position.
+     * @param target looked at position.
+     * @param up up direction, must not be parallel to target - eye.
+     * @exception |target - eye| < MYEPSILON, or the angle between up and target - eye is
+     *            below 1e-3 rad (or up is zero), the side axis would be undefined.
+     * @note the result is euclidean, invert it with computeEuclideanInverse().
+     */
+    void setLookAt(const Vector3& eye, const Vector3& target, const Vector3& up);
 
     /**
      * @brief get the contiguous address raw data(column-major) m[16].
@@ -1029,7 +1240,12 @@ public:
      * @return transposed Matrix4.
      * @see void transpose()
      */
-    Matrix4 transposed() const;
+    constexpr Matrix4 transposed() const {
+        return Matrix4(m[0], m[4], m[8], m[12],
+                       m[1], m[5], m[9], m[13],
+                       m[2], m[6], m[10], m[14],
+                       m[3], m[7], m[11], m[15]);
+    }
 
 
     /**
@@ -1110,6 +1326,28 @@ public:
      * @return result
      */
     Matrix4 computeProjectiveInverse() const;
+    /**
+     * @brief closed-form inverse of a perspective projection matrix.
+     * @brief works for setFrustum(), setPerspective(), setInfinitePerspective()
+     * @brief and setReversedZPerspective() results.
+     * @brief | a 0 e 0 |^{-1}........| 1/a  0   0   e/a |
+     * @brief | 0 b f 0 |.............|  0  1/b  0   f/b |
+     * @brief | 0 0 c d |......=......|  0   0   0   -1  |
+     * @brief | 0 0 -1 0|.............|  0   0  1/d  c/d |
+     * @exception Not a perspective matrix.
+     * @return result
+     */
+    Matrix4 computePerspectiveInverse() const;
+    /**
+     * @brief closed-form inverse of an orthographic projection (scale and translation) matrix.
+     * @brief | a 0 0 x |^{-1}........| 1/a  0   0  -x/a |
+     * @brief | 0 b 0 y |.............|  0  1/b  0  -y/b |
+     * @brief | 0 0 c z |......=......|  0   0  1/c -z/c |
+     * @brief | 0 0 0 1 |.............|  0   0   0    1  |
+     * @exception Not a orthographic matrix.
+     * @return result
+     */
+    Matrix4 computeOrthographicInverse() const;
 
     /**
      * @brief In-place operation, multiply translation matrix with this matrix.
@@ -1204,12 +1442,30 @@ public:
      * @return result
      * @see Matrix4 operator*(const Matrix4& rhs) const
      */
-    Matrix4 matmul(const Matrix4& rhs) const;
+    constexpr Matrix4 matmul(const Matrix4& rhs) const {
+#if defined(MYMATH_INSTRUMENT) && defined(MYMATH_IS_CONSTANT_EVALUATED)
+        // products folded at compile time are not counted
+        if (!MYMATH_IS_CONSTANT_EVALUATED()) countMatmul();
+#endif
+        Matrix4 ret;
+        for (int j = 0; j < 4; ++j) {
+            for (int i = 0; i < 4; ++i) {
+                ret.m[j * 4 + i] = m[i] * rhs.m[j * 4] + m[4 + i] * rhs.m[j * 4 + 1] +
+                                   m[8 + i] * rhs.m[j * 4 + 2] + m[12 + i] * rhs.m[j * 4 + 3];
+            }
+        }
+        return ret;
+    }
     /**
      * @brief multiply 4x4 matrix with 4D vector.
      * @see friend Vector4 operator*(const Vector4& vec, const Matrix4& mat4)
      */
-    Vector4 operator*(const Vector4& rhs) const;
+    constexpr Vector4 operator*(const Vector4& rhs) const {
+        return Vector4(m[0] * rhs.x + m[4] * rhs.y + m[8] * rhs.z + m[12] * rhs.w,
+                       m[1] * rhs.x + m[5] * rhs.y + m[9] * rhs.z + m[13] * rhs.w,
+                       m[2] * rhs.x + m[6] * rhs.y + m[10] * rhs.z + m[14] * rhs.w,
+                       m[3] * rhs.x + m[7] * rhs.y + m[11] * rhs.z + m[15] * rhs.w);
+    }
     /**
      * @brief element-wise multiplcation.
      * @see Matrix4& operator*=(const Matrix4& rhs)
@@ -0,0 +1,475 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mymatrixn.hpp
+ *  @brief fixed-size R x C matrix and N vector templates with Cholesky and LDLT solvers.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-6
+ *  @note for the small sizes of pose estimation, e.g. 6x6 information matrices,
+ *  @note 6-vectors and 3x6 Jacobians, Matrix2/3/4 stay the types of 2D/3D geometry.
+ *  @note elements are stored in column major like Matrix4, inside the object, nothing
+ *  @note is ever allocated on the heap.
+ *  @note all loops have compile-time bounds, matmul(), transposeMatmul() and solve()
+ *  @note are unrolled completely, so the compiler vectorizes the straight-line code,
+ *  @note matmul() runs down the columns of both operands.
+ *  @note VectorN<N> is MatrixN<N, 1>, a Jacobian J of r(x) is MatrixN<dim r, dim x> and
+ *  @note the normal equations are `H = J.transposeMatmul(J)`, `g = J.transposeMatmul(r)`.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include "mathutils.hpp"
+#include "myinstrument.hpp"
+
+/** @brief unroll a loop with compile-time bounds completely. */
+#define MYMATRIXN_UNROLL _Pragma("GCC unroll 64")
+
+/**
+ *  @brief MatrixN class used for R x C matrices of fixed size.
+ */
+template <int R, int C>
+class MatrixN {
+    static_assert((R > 0) && (C > 0), "MatrixN needs positive dimensions");
+
+  private:
+    /** @brief elements stored in column major. */
+    scalar m[R * C];
+
+  protected:
+  public:
+    /** @brief number of rows. */
+    static constexpr int ROWS = R;
+    /** @brief number of columns. */
+    static constexpr int COLS = C;
+
+    /**
+     * Create a new R x C matrix object, zero by default.
+     * @brief Default constructor.
+     * @note unlike Matrix2/3/4 the default is zero, most of these matrices are not square.
+     */
+    constexpr MatrixN() :
+        m() {}
+    /**
+     * Create a new R x C matrix object by pointer.
+     * @brief constructor by a scalar pointer.
+     * @warning make sure the pointer is an R * C elements array in column major.
+     */
+    explicit MatrixN(const scalar src[R * C]) {
+        for (int i = 0; i < R * C; ++i) m[i] = src[i];
+    }
+
+    /** @brief zero R x C matrix. */
+    static constexpr MatrixN zero() {
+        return MatrixN();
+    }
+    /** @brief identity matrix, R must equal C. */
+    static MatrixN identity() {
+        static_assert(R == C, "identity() of a non-square MatrixN");
+        MatrixN ret;
+        for (int i = 0; i < R; ++i) ret.m[i * R + i] = 1;
+        return ret;
+    }
+
+    /** @brief Return the pointer of the elements in column major. */
+    scalar* data() {
+        return m;
+    }
+    /** @brief Return the const pointer of the elements in column major. */
+    const scalar* constData() const {
+        return m;
+    }
+
+    /**
+     * @brief get element by index in column major.
+     * @exception (index < 0) or (index >= R * C)
+     */
+    scalar operator[](int index) const {
+        if ((index < 0) || (index >= R * C)) {
+            fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
+                    __FILE__, __LINE__, __FUNCTION__);
+            MYMATH_COUNT_ERROR();
+            throw "Index out of bounds!";
+        }
+        return m[index];
+    }
+    /**
+     * @brief get element reference by index in column major.
+     * @exception (index < 0) or (index >= R * C)
+     */
+    scalar& operator[](int index) {
+        if ((index < 0) || (index >= R * C)) {
+            fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
+                    __FILE__, __LINE__, __FUNCTION__);
+            MYMATH_COUNT_ERROR();
+            throw "Index out of bounds!";
+        }
+        return m[index];
+    }
+    /**
+     * @brief get element in row i, column j.
+     * @exception (i, j) out of bounds
+     */
+    scalar operator()(int i, int j) const {
+        if ((i < 0) || (i >= R) || (j < 0) || (j >= C)) {
+            fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
+                    __FILE__, __LINE__, __FUNCTION__);
+            MYMATH_COUNT_ERROR();
+            throw "Index out of bounds!";
+        }
+        return m[j * R + i];
+    }
+    /**
+     * @brief get element reference in row i, column j.
+     * @exception (i, j) out of bounds
+     */
+    scalar& operator()(int i, int j) {
+        if ((i < 0) || (i >= R) || (j < 0) || (j >= C)) {
+            fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
+                    __FILE__, __LINE__, __FUNCTION__);
+            MYMATH_COUNT_ERROR();
+            throw "Index out of bounds!";
+        }
+        return m[j * R + i];
+    }
+
+    /** @brief transposed C x R matrix. */
+    MatrixN<C, R> transposed() const {
+        MatrixN<C, R> ret;
+        scalar* r = ret.data();
+        for (int j = 0; j < C; ++j) {
+            for (int i = 0; i < R; ++i) r[i * C + j] = m[j * R + i];
+        }
+        return ret;
+    }
+
+    /**
+     * @brief matrix multiplication.
+     * @param rhs C x K right hand side.
+     * @return R x K product.
+     */
+    template <int K>
+    MatrixN<R, K> matmul(const MatrixN<C, K>& rhs) const {
+        MatrixN<R, K> ret;
+        scalar* r = ret.data();
+        const scalar* b = rhs.constData();
+        // column j of the product is the columns of this weighted by column j of rhs
+        MYMATRIXN_UNROLL
+        for (int j = 0; j < K; ++j) {
+            scalar col[R];
+            MYMATRIXN_UNROLL
+            for (int i = 0; i < R; ++i) col[i] = m[i] * b[j * C];
+            MYMATRIXN_UNROLL
+            for (int k = 1; k < C; ++k) {
+                const scalar s = b[j * C + k];
+                MYMATRIXN_UNROLL
+                for (int i = 0; i < R; ++i) col[i] += m[k * R + i] * s;
+            }
+            MYMATRIXN_UNROLL
+            for (int i = 0; i < R; ++i) r[j * R + i] = col[i];
+        }
+        return ret;
+    }
+    /**
+     * @brief transpose multiplication, this^T * rhs without forming the transpose.
+     * @param rhs R x K right hand side.
+     * @return C x K product, e.g. J^T J of a Jacobian J.
+     */
+    template <int K>
+    MatrixN<C, K> transposeMatmul(const MatrixN<R, K>& rhs) const {
+        MatrixN<C, K> ret;
+        scalar* r = ret.data();
+        const scalar* b = rhs.constData();
+        // element (i, j) is the dot product of column i of this and column j of rhs
+        MYMATRIXN_UNROLL
+        for (int j = 0; j < K; ++j) {
+            MYMATRIXN_UNROLL
+            for (int i = 0; i < C; ++i) {
+                scalar s = 0;
+                MYMATRIXN_UNROLL
+                for (int k = 0; k < R; ++k) s += m[i * R + k] * b[j * R + k];
+                r[j * C + i] = s;
+            }
+        }
+        return ret;
+    }
+
+    /** @brief dot product, both operands are column vectors of the same size. */
+    scalar dot(const MatrixN& rhs) const {
+        static_assert(C == 1, "dot() of a MatrixN with more than one column");
+        scalar s = 0;
+        for (int i = 0; i < R; ++i) s += m[i] * rhs.m[i];
+        return s;
+    }
+    /** @brief Frobenius norm, the length of a vector. */
+    scalar norm() const {
+        scalar s = 0;
+        for (int i = 0; i < R * C; ++i) s += m[i] * m[i];
+        return std::sqrt(s);
+    }
+
+    /** @brief Determine if the matrix is similar to the other. */
+    bool equal(const MatrixN& rhs, scalar e = MYEPSILON) const {
+        for (int i = 0; i < R * C; ++i) {
+            if (std::abs(m[i] - rhs.m[i]) > e) return false;
+        }
+        return true;
+    }
+
+    /** @brief Binary operator, element-wise addition. */
+    MatrixN operator+(const MatrixN& rhs) const {
+        MatrixN ret(*this);
+        ret += rhs;
+        return ret;
+    }
+    /** @brief Abbr binary operator, element-wise addition. */
+    MatrixN& operator+=(const MatrixN& rhs) {
+        for (int i = 0; i < R * C; ++i) m[i] += rhs.m[i];
+        return *this;
+    }
+    /** @brief Binary operator, element-wise subtraction. */
+    MatrixN operator-(const MatrixN& rhs) const {
+        MatrixN ret(*this);
+        ret -= rhs;
+        return ret;
+    }
+    /** @brief Abbr binary operator, element-wise subtraction. */
+    MatrixN& operator-=(const MatrixN& rhs) {
+        for (int i = 0; i < R * C; ++i) m[i] -= rhs.m[i];
+        return *this;
+    }
+    /** @brief Unary operator, negate the matrix. */
+    MatrixN operator-() const {
+        MatrixN ret;
+        for (int i = 0; i < R * C; ++i) ret.m[i] = -m[i];
+        return ret;
+    }
+    /** @brief Binary operator, matrix times scalar. */
+    MatrixN operator*(scalar s) const {
+        MatrixN ret(*this);
+        ret *= s;
+        return ret;
+    }
+    /** @brief Abbr binary operator, matrix times scalar. */
+    MatrixN& operator*=(scalar s) {
+        for (int i = 0; i < R * C; ++i) m[i] *= s;
+        return *this;
+    }
+
+};
+
+/** @brief N vector, a MatrixN with one column. */
+template <int N>
+using VectorN = MatrixN<N, 1>;
+
+/**
+ *  @brief CholeskyN class, A = L L^T of a symmetric positive definite N x N matrix.
+ *  @note only the lower triangle of A is read.
+ */
+template <int N>
+class CholeskyN {
+  private:
+    /** @brief L in the lower triangle, zero above. */
+    MatrixN<N, N> l;
+    bool ok = false;
+
+  protected:
+  public:
+    CholeskyN() = default;
+    /** @brief decompose a on construction, check isValid() afterwards. */
+    explicit CholeskyN(const MatrixN<N, N>& a) {
+        compute(a);
+    }
+
+    /**
+     * @brief decompose a symmetric matrix.
+     * @return false if a is not positive definite, no solve() is possible then.
+     */
+    bool compute(const MatrixN<N, N>& a) {
+        const scalar* s = a.constData();
+        scalar* r = l.data();
+        ok = false;
+        for (int j = 0; j < N; ++j) {
+            scalar d = s[j * N + j];
+            for (int k = 0; k < j; ++k) d -= r[k * N + j] * r[k * N + j];
+            if (!(d > 0)) return false;
+            const scalar ljj = std::sqrt(d);
+            const scalar inv = 1 / ljj;
+            r[j * N + j] = ljj;
+            for (int i = 0; i < j; ++i) r[j * N + i] = 0;
+            // column j below the diagonal, running down the columns of L
+            for (int i = j + 1; i < N; ++i) r[j * N + i] = s[j * N + i];
+            for (int k = 0; k < j; ++k) {
+                const scalar ljk = r[k * N + j];
+                for (int i = j + 1; i < N; ++i) r[j * N + i] -= r[k * N + i] * ljk;
+            }
+            for (int i = j + 1; i < N; ++i) r[j * N + i] *= inv;
+        }
+        ok = true;
+        return true;
+    }
+    /** @brief true after a successful compute(). */
+    bool isValid() const {
+        return ok;
+    }
+    /** @brief lower triangular factor L. */
+    const MatrixN<N, N>& matrixL() const {
+        return l;
+    }
+
+    /**
+     * @brief solve A x = b.
+     * @param b N x K right hand side, e.g. VectorN<N>.
+     * @return x.
+     * @exception no valid decomposition
+     */
+    template <int K>
+    MatrixN<N, K> solve(const MatrixN<N, K>& b) const {
+        if (!ok) {
+            fprintf(stderr, "File %s, Line %d, Function %s(): Matrix not positive definite.\n",
+                    __FILE__, __LINE__, __FUNCTION__);
+            MYMATH_COUNT_ERROR();
+            throw "Matrix not positive definite!";
+        }
+        MatrixN<N, K> x(b);
+        scalar* v = x.data();
+        const scalar* r = l.constData();
+        MYMATRIXN_UNROLL
+        for (int c = 0; c < K; ++c) {
+            scalar* y = v + c * N;
+            // L y = b, column oriented
+            MYMATRIXN_UNROLL
+            for (int j = 0; j < N; ++j) {
+                y[j] /= r[j * N + j];
+                MYMATRIXN_UNROLL
+                for (int i = j + 1; i < N; ++i) y[i] -= r[j * N + i] * y[j];
+            }
+            // L^T x = y, row i of L^T is column i of L
+            MYMATRIXN_UNROLL
+            for (int i = N - 1; i >= 0; --i) {
+                scalar s = y[i];
+                MYMATRIXN_UNROLL
+                for (int k = i + 1; k < N; ++k) s -= r[i * N + k] * y[k];
+                y[i] = s / r[i * N + i];
+            }
+        }
+        return x;
+    }
+};
+
+/**
+ *  @brief LDLTN class, A = L D L^T of a symmetric N x N matrix without pivoting.
+ *  @note L is unit lower triangular and D diagonal, no square roots are taken, so it
+ *  @note also solves well-conditioned indefinite systems, e.g. gauge-fixed problems.
+ *  @note only the lower triangle of A is read.
+ */
+template <int N>
+class LDLTN {
+  private:
+    /** @brief L below the diagonal, D on the diagonal. */
+    MatrixN<N, N> ld;
+    bool ok = false;
+
+  protected:
+  public:
+    LDLTN() = default;
+    /** @brief decompose a on construction, check isValid() afterwards. */
+    explicit LDLTN(const MatrixN<N, N>& a) {
+        compute(a);
+    }
+
+    /**
+     * @brief decompose a symmetric matrix.
+     * @return false if a pivot of D vanishes relative to the diagonal of a.
+     */
+    bool compute(const MatrixN<N, N>& a) {
+        const scalar* s = a.constData();
+        scalar* r = ld.data();
+        scalar scale = 0;
+        for (int j = 0; j < N; ++j) scale = std::max(scale, std::abs(s[j * N + j]));
+        const scalar tiny = scale * N * std::numeric_limits<scalar>::epsilon();
+        ok = false;
+        for (int j = 0; j < N; ++j) {
+            // w_k = L(j, k) D(k) for the columns left of j
+            scalar w[N];
+            scalar d = s[j * N + j];
+            for (int k = 0; k < j; ++k) {
+                w[k] = r[k * N + j] * r[k * N + k];
+                d -= r[k * N + j] * w[k];
+            }
+            if (!(std::abs(d) > tiny)) return false;
+            r[j * N + j] = d;
+            for (int i = 0; i < j; ++i) r[j * N + i] = 0;
+            for (int i = j + 1; i < N; ++i) r[j * N + i] = s[j * N + i];
+            for (int k = 0; k < j; ++k) {
+                for (int i = j + 1; i < N; ++i) r[j * N + i] -= r[k * N + i] * w[k];
+            }
+            const scalar inv = 1 / d;
+            for (int i = j + 1; i < N; ++i) r[j * N + i] *= inv;
+        }
+        ok = true;
+        return true;
+    }
+    /** @brief true after a successful compute(). */
+    bool isValid() const {
+        return ok;
+    }
+    /** @brief true if every pivot of D is positive, i.e. A is positive definite. */
+    bool isPositive() const {
+        if (!ok) return false;
+        for (int j = 0; j < N; ++j) {
+            if (!(ld.constData()[j * N + j] > 0)) return false;
+        }
+        return true;
+    }
+    /** @brief diagonal D. */
+    VectorN<N> vectorD() const {
+        VectorN<N> d;
+        for (int j = 0; j < N; ++j) d.data()[j] = ld.constData()[j * N + j];
+        return d;
+    }
+
+    /**
+     * @brief solve A x = b.
+     * @param b N x K right hand side, e.g. VectorN<N>.
+     * @return x.
+     * @exception no valid decomposition
+     */
+    template <int K>
+    MatrixN<N, K> solve(const MatrixN<N, K>& b) const {
+        if (!ok) {
+            fprintf(stderr, "File %s, Line %d, Function %s(): Matrix is singular.\n",
+                    __FILE__, __LINE__, __FUNCTION__);
+            MYMATH_COUNT_ERROR();
+            throw "Matrix is singular!";
+        }
+        MatrixN<N, K> x(b);
+        scalar* v = x.data();
+        const scalar* r = ld.constData();
+        MYMATRIXN_UNROLL
+        for (int c = 0; c < K; ++c) {
+            scalar* y = v + c * N;
+            // L z = b, unit diagonal
+            MYMATRIXN_UNROLL
+            for (int j = 0; j < N; ++j) {
+                MYMATRIXN_UNROLL
+                for (int i = j + 1; i < N; ++i) y[i] -= r[j * N + i] * y[j];
+            }
+            MYMATRIXN_UNROLL
+            for (int j = 0; j < N; ++j) y[j] /= r[j * N + j];
+            // L^T x = D^-1 z
+            MYMATRIXN_UNROLL
+            for (int i = N - 1; i >= 0; --i) {
+                scalar s = y[i];
+                MYMATRIXN_UNROLL
+                for (int k = i + 1; k < N; ++k) s -= r[i * N + k] * y[k];
+                y[i] = s;
+            }
+        }
+        return x;
+    }
+};
@@ -0,0 +1,247 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mymorton.hpp
+ *  @brief Morton (Z-order) and Hilbert codes of 3D points, radix sort by code.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-14
+ *  @note bit layout of a code is ...z1y1x1z0y0x0, x occupies the lowest bit of every triple.
+ *  @note 30-bit codes use 10 bits per axis, 63-bit codes use 21 bits per axis.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "myvector.hpp"
+#include "myparallel.hpp"
+
+/**
+ *  @brief Macro max bits per axis of a 30-bit Morton code.
+ */
+#define MORTON30_BITS 10
+
+/**
+ *  @brief Macro max bits per axis of a 63-bit Morton code.
+ */
+#define MORTON63_BITS 21
+
+/**
+ *  @brief option for space filling curve.
+ */
+enum CURVETYPE {
+    /** Z-order curve, cheap to compute */
+    MORTON,
+    /** Hilbert curve, better locality, no jumps between consecutive cells */
+    HILBERT
+};
+
+/**
+ * @brief spread the lowest 10 bits of v so that two zero bits follow each bit.
+ * @param v integer coordinate, bits above 10 are ignored.
+ * @return spreaded value.
+ */
+inline uint32_t mortonSpread10(uint32_t v) {
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ffu;
+    v = (v | (v << 8)) & 0x0300f00fu;
+    v = (v | (v << 4)) & 0x030c30c3u;
+    v = (v | (v << 2)) & 0x09249249u;
+    return v;
+}
+
+/**
+ * @brief inverse of mortonSpread10().
+ * @param v spreaded value.
+ * @return compacted 10 bits integer.
+ */
+inline uint32_t mortonCompact10(uint32_t v) {
+    v &= 0x09249249u;
+    v = (v | (v >> 2)) & 0x030c30c3u;
+    v = (v | (v >> 4)) & 0x0300f00fu;
+    v = (v | (v >> 8)) & 0x030000ffu;
+    v = (v | (v >> 16)) & 0x3ffu;
+    return v;
+}
+
+/**
+ * @brief 30-bit Morton code of (x, y, z).
+ * @param x coordinate in [0, 2^10).
+ * @param y coordinate in [0, 2^10).
+ * @param z coordinate in [0, 2^10).
+ * @return Morton code.
+ * @see void mortonDecode30(uint32_t code, uint32_t& x, uint32_t& y, uint32_t& z)
+ */
+inline uint32_t mortonEncode30(uint32_t x, uint32_t y, uint32_t z) {
+    return mortonSpread10(x) | (mortonSpread10(y) << 1) | (mortonSpread10(z) << 2);
+}
+
+/**
+ * @brief integer coordinates of a 30-bit Morton code.
+ * @see uint32_t mortonEncode30(uint32_t x, uint32_t y, uint32_t z)
+ */
+inline void mortonDecode30(uint32_t code, uint32_t& x, uint32_t& y, uint32_t& z) {
+    x = mortonCompact10(code);
+    y = mortonCompact10(code >> 1);
+    z = mortonCompact10(code >> 2);
+}
+
+/**
+ * @brief spread the lowest 21 bits of v so that two zero bits follow each bit.
+ * @param v integer coordinate, bits above 21 are ignored.
+ * @return spreaded value.
+ */
+inline uint64_t mortonSpread21(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x001f00000000ffffull;
+    v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+    v = (v | (v << 8)) & 0x100f00f00f00f00full;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+/**
+ * @brief inverse of mortonSpread21().
+ * @param v spreaded value.
+ * @return compacted 21 bits integer.
+ */
+inline uint64_t mortonCompact21(uint64_t v) {
+    v &= 0x1249249249249249ull;
+    v = (v | (v >> 2)) & 0x10c30c30c30c30c3ull;
+    v = (v | (v >> 4)) & 0x100f00f00f00f00full;
+    v = (v | (v >> 8)) & 0x001f0000ff0000ffull;
+    v = (v | (v >> 16)) & 0x001f00000000ffffull;
+    v = (v | (v >> 32)) & 0x1fffff;
+    return v;
+}
+
+/**
+ * @brief 63-bit Morton code of (x, y, z).
+ * @param x coordinate in [0, 2^21).
+ * @param y coordinate in [0, 2^21).
+ * @param z coordinate in [0, 2^21).
+ * @return Morton code.
+ * @see void mortonDecode63(uint64_t code, uint32_t& x, uint32_t& y, uint32_t& z)
+ */
+inline uint64_t mortonEncode63(uint32_t x, uint32_t y, uint32_t z) {
+    return mortonSpread21(x) | (mortonSpread21(y) << 1) | (mortonSpread21(z) << 2);
+}
+
+/**
+ * @brief integer coordinates of a 63-bit Morton code.
+ * @see uint64_t mortonEncode63(uint32_t x, uint32_t y, uint32_t z)
+ */
+inline void mortonDecode63(uint64_t code, uint32_t& x, uint32_t& y, uint32_t& z) {
+    x = static_cast<uint32_t>(mortonCompact21(code));
+    y = static_cast<uint32_t>(mortonCompact21(code >> 1));
+    z = static_cast<uint32_t>(mortonCompact21(code >> 2));
+}
+
+/**
+ * @brief Hilbert index of (x, y, z) on a 2^bits grid, Skilling's transpose algorithm.
+ * @param x coordinate in [0, 2^bits).
+ * @param y coordinate in [0, 2^bits).
+ * @param z coordinate in [0, 2^bits).
+ * @param bits bits per axis, range from 1 to 21.
+ * @return Hilbert index in [0, 2^(3 * bits)).
+ * @see void hilbertDecode(uint64_t code, int bits, uint32_t& x, uint32_t& y, uint32_t& z)
+ */
+inline uint64_t hilbertEncode(uint32_t x, uint32_t y, uint32_t z, int bits) {
+    uint32_t X[3] = {x, y, z};
+    // inverse undo, branch-free so that batch loops vectorize
+    for (uint32_t q = uint32_t(1) << (bits - 1); q > 1; q >>= 1) {
+        const uint32_t p = q - 1;
+        for (int i = 0; i < 3; ++i) {
+            const uint32_t set = 0u - ((X[i] & q) ? 1u : 0u);
+            X[0] ^= p & set;
+            const uint32_t t = (X[0] ^ X[i]) & p & ~set;
+            X[0] ^= t;
+            X[i] ^= t;
+        }
+    }
+    // gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    uint32_t t = 0;
+    for (uint32_t q = uint32_t(1) << (bits - 1); q > 1; q >>= 1) {
+        t ^= (q - 1) & (0u - ((X[2] & q) ? 1u : 0u));
+    }
+    X[0] ^= t;
+    X[1] ^= t;
+    X[2] ^= t;
+    // X[0] holds the most significant bit of every triple
+    return mortonSpread21(X[2]) | (mortonSpread21(X[1]) << 1) | (mortonSpread21(X[0]) << 2);
+}
+
+/**
+ * @brief integer coordinates of a Hilbert index.
+ * @see uint64_t hilbertEncode(uint32_t x, uint32_t y, uint32_t z, int bits)
+ */
+void hilbertDecode(uint64_t code, int bits, uint32_t& x, uint32_t& y, uint32_t& z);
+
+/**
+ * @brief compute 63-bit space filling curve codes of points inside a bounding box.
+ * @param points point array.
+ * @param n number of points.
+ * @param boxMin minimum corner of the bounding box, points outside are clamped.
+ * @param boxMax maximum corner of the bounding box.
+ * @param codes output array of n codes.
+ * @param curve MORTON or HILBERT.
+ * @see void computeSpatialCodes30(const Vector3* points, size_t n, const Vector3& boxMin,
+ *                                 const Vector3& boxMax, uint32_t* codes, CURVETYPE curve)
+ */
+void computeSpatialCodes(const Vector3* points, size_t n,
+                         const Vector3& boxMin, const Vector3& boxMax,
+                         uint64_t* codes, CURVETYPE curve = MORTON);
+/**
+ * @brief compute 30-bit space filling curve codes, half the radix sort passes of 63-bit codes.
+ * @see void computeSpatialCodes(const Vector3* points, size_t n, const Vector3& boxMin,
+ *                               const Vector3& boxMax, uint64_t* codes, CURVETYPE curve)
+ */
+void computeSpatialCodes30(const Vector3* points, size_t n,
+                           const Vector3& boxMin, const Vector3& boxMax,
+                           uint32_t* codes, CURVETYPE curve = MORTON);
+
+/**
+ * @brief stable parallel LSD radix sort of keys, 8 bits per pass.
+ * @param keys n keys, sorted in place.
+ * @param perm output array of n indices, perm[k] is the original position of keys[k].
+ * @param n number of keys.
+ * @note passes whose digit is the same for all keys are skipped.
+ * @warning n must be less than 2^32.
+ */
+void radixSortByKey(uint64_t* keys, uint32_t* perm, size_t n);
+/**
+ * @brief 32-bit key version of radixSortByKey().
+ * @see void radixSortByKey(uint64_t* keys, uint32_t* perm, size_t n)
+ */
+void radixSortByKey(uint32_t* keys, uint32_t* perm, size_t n);
+
+/**
+ * @brief reorder an array by a permutation, data[k] = old data[perm[k]].
+ * @param data array of n elements, e.g. points or any attribute attached to them.
+ * @param perm permutation returned by radixSortByKey() or spatialSort().
+ * @param n number of elements.
+ */
+template <typename T>
+void reorderByPermutation(T* data, const uint32_t* perm, size_t n) {
+    std::vector<T> tmp(data, data + n);
+    parallelFor(0, n, 1 << 15, [&](size_t lo, size_t hi) {
+        for (size_t k = lo; k < hi; ++k) {
+            data[k] = tmp[perm[k]];
+        }
+    });
+}
+
+/**
+ * @brief reorder points along a space filling curve over their bounding box.
+ * @param points point array, reordered in place.
+ * @param n number of points.
+ * @param perm resized to n, perm[k] is the original position of points[k],
+ *        pass it to reorderByPermutation() for attached attribute arrays.
+ * @param curve MORTON or HILBERT.
+ */
+void spatialSort(Vector3* points, size_t n, std::vector<uint32_t>& perm, CURVETYPE curve = MORTON);
@@ -0,0 +1,263 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myoctree.hpp
+ *  @brief sparse pointerless octree with per-node level-of-detail representative.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-14
+ *  @note a node at level L is identified by the Morton code of its cell in the
+ *  @note 2^L x 2^L x 2^L grid over the root cube, nodes of every level live in
+ *  @note an array sorted by that code, no child pointers are stored.
+ *  @note the children of node k at level L are nodes (k << 3 | i) at level L + 1,
+ *  @note they are a contiguous run of at most 8 entries of the next level.
+ *  @note points are stored in one array sorted by leaf code, every leaf owns a range.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "myvector.hpp"
+
+/**
+ *  @brief OctreeNode struct holds the level-of-detail representative of a node.
+ */
+struct OctreeNode {
+    /** @brief sum of the points below the node, double to survive billions of points. */
+    double sum[3] = {0, 0, 0};
+    /** @brief number of points below the node. */
+    uint64_t count = 0;
+    /** @brief bit i is set if child i is not empty. */
+    uint8_t children = 0;
+
+    /** @brief centroid of the points below the node. */
+    Vector3 centroid() const {
+        double inv = (count > 0) ? 1.0 / static_cast<double>(count) : 0.0;
+        return Vector3(static_cast<scalar>(sum[0] * inv),
+                       static_cast<scalar>(sum[1] * inv),
+                       static_cast<scalar>(sum[2] * inv));
+    }
+};
+
+/**
+ *  @brief OctreeNodeRecord struct, one node of a level exported in Morton order.
+ */
+struct OctreeNodeRecord {
+    /** @brief Morton code of the node in its level. */
+    uint64_t key;
+    /** @brief centroid of the points below the node. */
+    Vector3 centroid;
+    /** @brief number of points below the node. */
+    uint64_t count;
+};
+
+/**
+ *  @brief OctreeLevel struct, the non-empty nodes of one level sorted by Morton code.
+ */
+struct OctreeLevel {
+    /** @brief Morton codes of the nodes, strictly increasing. */
+    std::vector<uint64_t> keys;
+    /** @brief nodes[i] is the node of keys[i]. */
+    std::vector<OctreeNode> nodes;
+
+    /** @brief index of the first node whose key is not less than key. */
+    size_t lowerBound(uint64_t key) const {
+        return static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+    }
+    /** @brief index of the node of key, keys.size() if the node is empty. */
+    size_t find(uint64_t key) const {
+        size_t i = lowerBound(key);
+        return ((i < keys.size()) && (keys[i] == key)) ? i : keys.size();
+    }
+};
+
+/**
+ *  @brief Octree class used for hierarchical access to large point clouds.
+ */
+class Octree {
+  private:
+    /** @brief minimum corner of the root cube. */
+    Vector3 origin;
+    /** @brief edge length of the root cube. */
+    scalar extent;
+    /** @brief deepest level, leaf cells have edge extent / 2^max_depth. */
+    int max_depth;
+    /** @brief nodes of every level, levels[max_depth] are the leaves. */
+    std::vector<OctreeLevel> levels;
+    /** @brief all points, ordered by leaf Morton code. */
+    std::vector<Vector3> sorted_points;
+    /** @brief points of leaf i are [leaf_start[i], leaf_start[i + 1]), one entry more than leaves. */
+    std::vector<size_t> leaf_start;
+
+    /** @brief leaf Morton code of p, false if p is outside the root cube. */
+    bool leafCode(const Vector3& p, uint64_t& code) const;
+    /** @brief add a point with known leaf code to all nodes on its path. */
+    void insertCode(uint64_t code, const Vector3& p);
+    /** @brief recompute the nodes of a level from the nodes of the next level. */
+    void buildLevel(int level);
+
+    /** @brief recursive traversal used by query(), index is the node position in its level. */
+    template <typename Classifier, typename Callback>
+    void queryNode(int level, size_t index, bool inside, Classifier& classify, int lod,
+                   Callback& callback) const;
+    /** @brief recursive traversal used by queryPoints(). */
+    template <typename Classifier, typename Callback>
+    void queryPointsNode(int level, size_t index, bool inside, Classifier& classify,
+                         Callback& callback) const;
+
+  protected:
+  public:
+    /**
+     * @brief constructor.
+     * @param boundsMin minimum corner of the root cube.
+     * @param boundsSize edge length of the root cube.
+     * @param maxDepth deepest level, range from 0 to 21.
+     * @exception (boundsSize <= 0) or (maxDepth < 0) or (maxDepth > 21)
+     */
+    Octree(const Vector3& boundsMin, scalar boundsSize, int maxDepth = 10);
+
+    /** @brief deepest level. */
+    int getMaxDepth() const { return max_depth; }
+    /** @brief number of points in the tree. */
+    uint64_t size() const;
+    /** @brief number of non-empty nodes at a level. */
+    size_t nodeCount(int level) const;
+    /** @brief remove all points, keep the bounds. */
+    void clear();
+
+    /**
+     * @brief insert one point.
+     * @return false if p is outside the root cube and was not inserted.
+     * @note shifts the arrays behind the point, use the batch insert for many points.
+     */
+    bool insert(const Vector3& p);
+    /**
+     * @brief insert a batch of points, codes are computed and sorted in parallel.
+     * @return number of points inserted, points outside the root cube are skipped.
+     * @note merges the batch into the leaves and rebuilds the inner levels, O(size() + n).
+     * @warning n must be less than 2^32.
+     */
+    size_t insert(const Vector3* points, size_t n);
+    /**
+     * @brief remove one point equal (exact comparison) to p.
+     * @return false if no such point is in the tree.
+     */
+    bool remove(const Vector3& p);
+
+    /** @brief all points ordered by leaf Morton code, points of a leaf in insertion order. */
+    const std::vector<Vector3>& sortedPoints() const { return sorted_points; }
+
+    /**
+     * @brief get a node.
+     * @param level node level.
+     * @param key node Morton code in its level.
+     * @return node pointer, nullptr if the node is empty.
+     */
+    const OctreeNode* getNode(int level, uint64_t key) const;
+    /**
+     * @brief bounding cube of a node.
+     * @param level node level.
+     * @param key node Morton code in its level.
+     * @param boxMin minimum corner.
+     * @param boxMax maximum corner.
+     */
+    void getNodeBounds(int level, uint64_t key, Vector3& boxMin, Vector3& boxMax) const;
+    /**
+     * @brief export all nodes of a level sorted by Morton code.
+     * @param level node level.
+     * @param out cleared then filled with records, contiguous runs are spatially coherent.
+     * @exception (level < 0) or (level > max depth)
+     */
+    void exportLevel(int level, std::vector<OctreeNodeRecord>& out) const;
+
+    /**
+     * @brief visit nodes overlapping a region, stop descending at a level of detail.
+     * @param classify callable classify(boxMin, boxMax) returning CONTAINMENT.
+     * @param lod deepest level visited, clamped to max depth.
+     * @param callback invoked as callback(level, key, node) on overlapping nodes at level lod,
+     *        or at shallower level if the node has no children.
+     * @note children of INSIDE nodes are not classified again.
+     */
+    template <typename Classifier, typename Callback>
+    void query(Classifier&& classify, int lod, Callback&& callback) const {
+        if (lod > max_depth) lod = max_depth;
+        if ((lod < 0) || levels[0].keys.empty()) return;
+        queryNode(0, 0, false, classify, lod, callback);
+    }
+    /**
+     * @brief visit nodes overlapping an axis aligned box.
+     * @see void query(Classifier&& classify, int lod, Callback&& callback) const
+     */
+    template <typename Callback>
+    void queryBox(const Vector3& boxMin, const Vector3& boxMax, int lod, Callback&& callback) const {
+        query(
+            [&](const Vector3& lo, const Vector3& hi) { return classifyBox(boxMin, boxMax, lo, hi); },
+            lod, callback);
+    }
+    /**
+     * @brief visit points inside a region.
+     * @param classify callable classify(boxMin, boxMax) returning CONTAINMENT,
+     *        points of INTERSECT leaves are tested as degenerated boxes.
+     * @param callback invoked as callback(point).
+     */
+    template <typename Classifier, typename Callback>
+    void queryPoints(Classifier&& classify, Callback&& callback) const {
+        if (levels[0].keys.empty()) return;
+        queryPointsNode(0, 0, false, classify, callback);
+    }
+
+    /**
+     * @brief classify box [lo, hi] against box [boxMin, boxMax].
+     * @return INSIDE if [lo, hi] is contained in [boxMin, boxMax].
+     */
+    static CONTAINMENT classifyBox(const Vector3& boxMin, const Vector3& boxMax,
+                                   const Vector3& lo, const Vector3& hi);
+};
+
+template <typename Classifier, typename Callback>
+void Octree::queryNode(int level, size_t index, bool inside, Classifier& classify, int lod,
+                       Callback& callback) const {
+    const uint64_t key = levels[level].keys[index];
+    if (!inside) {
+        Vector3 lo, hi;
+        getNodeBounds(level, key, lo, hi);
+        CONTAINMENT c = classify(lo, hi);
+        if (c == OUTSIDE) return;
+        inside = (c == INSIDE);
+    }
+    const OctreeNode& node = levels[level].nodes[index];
+    if ((level == lod) || (node.children == 0)) {
+        callback(level, key, node);
+        return;
+    }
+    const std::vector<uint64_t>& next = levels[level + 1].keys;
+    for (size_t i = levels[level + 1].lowerBound(key << 3); (i < next.size()) && ((next[i] >> 3) == key); ++i) {
+        queryNode(level + 1, i, inside, classify, lod, callback);
+    }
+}
+
+template <typename Classifier, typename Callback>
+void Octree::queryPointsNode(int level, size_t index, bool inside, Classifier& classify,
+                             Callback& callback) const {
+    const uint64_t key = levels[level].keys[index];
+    if (!inside) {
+        Vector3 lo, hi;
+        getNodeBounds(level, key, lo, hi);
+        CONTAINMENT c = classify(lo, hi);
+        if (c == OUTSIDE) return;
+        inside = (c == INSIDE);
+    }
+    if (level == max_depth) {
+        for (size_t k = leaf_start[index]; k < leaf_start[index + 1]; ++k) {
+            const Vector3& p = sorted_points[k];
+            if (inside || (classify(p, p) != OUTSIDE)) callback(p);
+        }
+        return;
+    }
+    const std::vector<uint64_t>& next = levels[level + 1].keys;
+    for (size_t i = levels[level + 1].lowerBound(key << 3); (i < next.size()) && ((next[i] >> 3) == key); ++i) {
+        queryPointsNode(level + 1, i, inside, classify, callback);
+    }
+}
@@ -0,0 +1,143 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myparallel.hpp
+ *  @brief work-stealing thread pool and the parallel loops shared by the batch kernels.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-12
+ *  @note body(lo, hi) is invoked on disjoint sub-ranges [lo, hi) of [begin, end),
+ *  @note no ordering between sub-ranges is guaranteed.
+ *  @note all loops run on the current Executor, the built-in WorkStealingPool unless
+ *  @note the application installs its own with setExecutor().
+ *  @note loops may be nested, a waiting thread executes pending work meanwhile.
+ *  @note a loop does not allocate from the heap once the pool queues reached their
+ *  @note working size: bodies are passed by reference, never copied into std::function
+ *  @note storage, and the partials of parallelReduce() live in getThreadArena().
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#include "myarena.hpp"
+
+/**
+ *  @brief Executor interface, the extension point for application thread pools.
+ */
+class Executor {
+  public:
+    virtual ~Executor() {}
+    /** @brief number of threads that may run a loop body at the same time. */
+    virtual unsigned int concurrency() const = 0;
+    /**
+     * @brief run body over [begin, end) splitted into chunks of at least grain elements.
+     * @note must return only after every chunk finished, and rethrow an exception of body.
+     */
+    virtual void parallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)>& body) = 0;
+};
+
+/**
+ *  @brief WorkStealingPool class, the built-in Executor.
+ *  @note every worker owns a deque, it pops its newest task and steals the oldest task
+ *  @note of the others, ranges are split in halves lazily so that idle workers steal
+ *  @note big pieces while busy ones run small ones without synchronization.
+ */
+class WorkStealingPool : public Executor {
+  private:
+    /** @brief shared state of the workers. */
+    struct State;
+    std::unique_ptr<State> state;
+
+  protected:
+  public:
+    /**
+     * @brief start the workers.
+     * @param threads total thread count including the calling thread, 0 means hardware concurrency.
+     */
+    explicit WorkStealingPool(unsigned int threads = 0);
+    /** @brief stop and join the workers, no loop may be running. */
+    ~WorkStealingPool();
+
+    unsigned int concurrency() const;
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t, size_t)>& body);
+};
+
+/**
+ * @brief install an application executor.
+ * @param executor executor used by all loops, nullptr restores the built-in pool.
+ * @note the caller keeps ownership, executor must outlive its use, no loop may be running.
+ */
+void setExecutor(Executor* executor);
+/** @brief current executor. */
+Executor& getExecutor();
+
+/**
+ * @brief get the number of threads used by parallelFor().
+ * @return thread count, hardware concurrency by default.
+ */
+unsigned int getThreadCount();
+/**
+ * @brief set the number of threads of the built-in pool.
+ * @param n thread count, 0 means hardware concurrency.
+ * @note the pool is rebuilt on the next loop, no loop may be running.
+ */
+void setThreadCount(unsigned int n);
+
+/**
+ * @brief run body over [begin, end) splitted into chunks of at least grain elements.
+ * @param begin first index.
+ * @param end one past the last index.
+ * @param grain minimum number of elements handled by one call of body.
+ * @param body callable invoked as body(lo, hi).
+ * @exception the first exception thrown by body is rethrown in the calling thread.
+ */
+void parallelFor(size_t begin, size_t end, size_t grain,
+                 const std::function<void(size_t, size_t)>& body);
+/**
+ * @see void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body)
+ * @note a lambda is wrapped by reference, a std::function holds a reference_wrapper without allocating.
+ */
+template <typename Body>
+void parallelFor(size_t begin, size_t end, size_t grain, const Body& body) {
+    parallelFor(begin, end, grain, std::function<void(size_t, size_t)>(std::cref(body)));
+}
+
+/**
+ * @brief reduce [begin, end) in parallel, deterministic for any thread count.
+ * @param begin first index.
+ * @param end one past the last index.
+ * @param grain elements per block, every block produces one partial result.
+ * @param identity initial value of every partial result.
+ * @param map callable invoked as map(lo, hi, partial) on the blocks, accumulates into partial.
+ * @param combine callable invoked as combine(a, b), returns the combination of partials.
+ * @return identity combined with the partials in block order.
+ * @note T must be trivially destructible, the partials are taken from getThreadArena().
+ */
+template <typename T, typename Map, typename Combine>
+T parallelReduce(size_t begin, size_t end, size_t grain, const T& identity, Map map, Combine combine) {
+    static_assert(std::is_trivially_destructible<T>::value, "partials are arena memory");
+    if (end <= begin) return identity;
+    if (grain == 0) grain = 1;
+    // fixed blocks, so the combination order does not depend on the schedule
+    const size_t blocks = (end - begin + grain - 1) / grain;
+    ArenaScope scratch(getThreadArena());
+    T* partial = scratch.allocateUninitialized<T>(blocks);
+    for (size_t blk = 0; blk < blocks; ++blk) new (partial + blk) T(identity);
+    parallelFor(0, blocks, 1, [&](size_t first, size_t last) {
+        for (size_t blk = first; blk < last; ++blk) {
+            const size_t lo = begin + blk * grain;
+            const size_t hi = (end - lo > grain) ? lo + grain : end;
+            map(lo, hi, partial[blk]);
+        }
+    });
+    T result = identity;
+    for (size_t blk = 0; blk < blocks; ++blk) {
+        result = combine(result, partial[blk]);
+    }
+    return result;
+}
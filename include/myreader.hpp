@@ -0,0 +1,63 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myreader.hpp
+ *  @brief streaming vertex reader for PLY, XYZ and OBJ point cloud files.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-30
+ *  @note files are read in chunks, the lines of an ASCII chunk are split into pieces
+ *  @note at line boundaries and parsed in parallel into scratch arrays that are copied
+ *  @note to the output at the end, binary PLY vertices are converted (and byte swapped
+ *  @note if needed) straight into the output.
+ *  @note XYZ: one point per line, the first three numbers separated by blanks, commas
+ *  @note or semicolons, lines not starting with three numbers are skipped.
+ *  @note OBJ: "v x y z" lines, everything else is skipped.
+ *  @note PLY: x, y and z properties of the "vertex" element, ascii and binary formats,
+ *  @note elements before "vertex" must not have list properties in binary files.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "mysoa.hpp"
+
+/**
+ *  @brief option for the file format.
+ */
+enum POINTFORMAT {
+    /** guess from the file extension, .ply, .obj, anything else is XYZ */
+    AUTO_FORMAT,
+    /** whitespace or comma separated text */
+    XYZ_FORMAT,
+    /** Stanford polygon file */
+    PLY_FORMAT,
+    /** Wavefront object file */
+    OBJ_FORMAT
+};
+
+/**
+ * @brief parse a decimal floating point number, e.g. "-1.5e3", "nan", "inf".
+ * @param first first character.
+ * @param last one past the last character.
+ * @param value output value.
+ * @return pointer past the number, nullptr if no number starts at first.
+ * @note exact for up to 19 significant digits with decimal exponent up to 22, other
+ *       numbers fall back to strtod() of the whole token with '.' as the decimal point,
+ *       whatever the locale, "nan" and "inf" are parsed without strtod().
+ */
+const char* parseScalar(const char* first, const char* last, scalar& value);
+
+/**
+ * @brief read the vertices of a point cloud file.
+ * @param path file path.
+ * @param out resized to the number of points.
+ * @param format file format.
+ * @exception the file cannot be read or is not a valid PLY file.
+ * @return number of points.
+ */
+size_t readPointCloud(const std::string& path, Vector3SoABuffer& out, POINTFORMAT format = AUTO_FORMAT);
+/** @see size_t readPointCloud(const std::string& path, Vector3SoABuffer& out, POINTFORMAT format) */
+size_t readPointCloud(const std::string& path, std::vector<Vector3>& out, POINTFORMAT format = AUTO_FORMAT);
@@ -0,0 +1,203 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myrotation.hpp
+ *  @brief conversions between rotation matrices, Euler angles, quaternions, axis-angle and rotation vectors.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-10
+ *  @note angles are in radian, quaternions are Vector4 (x, y, z, w) with w the real part,
+ *  @note the order of Eigen's coeffs() and of TUM trajectories, q and -q are the same rotation.
+ *  @note Euler angles (a, b, c) of order EULER_XYZ are R = Rx(a) * Ry(b) * Rz(c), intrinsic
+ *  @note rotations about the moving axes, the same matrix as extrinsic rotations z, y, x about
+ *  @note the fixed axes, e.g. yaw, pitch, roll of aerospace are EULER_ZYX (yaw, pitch, roll).
+ *  @note rotationToEuler() returns a, c in [-pi, pi] and b in [-pi/2, pi/2] for Tait-Bryan
+ *  @note orders, b in [0, pi] for proper Euler orders. at gimbal lock (cos b = 0, or sin b = 0
+ *  @note for proper orders) only a +- c is defined, c is set to 0 and a carries the rotation.
+ *  @note the scalar conversions throw on zero quaternions and axes, the batch conversions
+ *  @note write NaN instead and return the number of valid results, like mybatch.
+ *  @note rotationsToQuaternions() and quaternionsToRotations() run the SIMD variant of the
+ *  @note CPU, see myisa.hpp, the Euler and rotation vector batches are scalar per rotation,
+ *  @note their sin, cos and atan2 calls are libm calls.
+ *  @note rotation vectors to and from matrices are SO3::exp() and SO3::log() of mylie.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mymatrix.hpp"
+
+/**
+ *  @brief axis orders of Euler angles, R = R_first(a) * R_second(b) * R_third(c).
+ */
+enum EULERORDER {
+    /** Tait-Bryan orders, three distinct axes */
+    EULER_XYZ,
+    EULER_XZY,
+    EULER_YXZ,
+    EULER_YZX,
+    EULER_ZXY,
+    EULER_ZYX,
+    /** proper Euler orders, the first axis repeated */
+    EULER_XYX,
+    EULER_XZX,
+    EULER_YXY,
+    EULER_YZY,
+    EULER_ZXZ,
+    EULER_ZYZ
+};
+
+/**
+ * @brief rotation matrix of Euler angles.
+ * @param angles (a, b, c) in radian.
+ * @param order axis order.
+ * @return R_first(a) * R_second(b) * R_third(c).
+ */
+Matrix3 eulerToRotation(const Vector3& angles, EULERORDER order);
+/**
+ * @brief Euler angles of a rotation matrix, inverse of eulerToRotation().
+ * @param rot rotation matrix.
+ * @param order axis order.
+ * @return (a, b, c) in radian, c = 0 at gimbal lock.
+ * @note the third angle is recovered from the first, so a + c stays accurate near gimbal lock.
+ */
+Vector3 rotationToEuler(const Matrix3& rot, EULERORDER order);
+/**
+ * @brief quaternion of Euler angles, the product of three half angle quaternions.
+ * @param angles (a, b, c) in radian.
+ * @param order axis order.
+ * @return unit quaternion (x, y, z, w).
+ */
+Vector4 eulerToQuaternion(const Vector3& angles, EULERORDER order);
+/**
+ * @brief Euler angles of a quaternion.
+ * @param q quaternion (x, y, z, w), need not be unit.
+ * @param order axis order.
+ * @return (a, b, c) in radian.
+ * @exception |q| < MYEPSILON
+ */
+Vector3 quaternionToEuler(const Vector4& q, EULERORDER order);
+
+/**
+ * @brief quaternion of a rotation matrix, Shepperd's method in double.
+ * @param rot rotation matrix.
+ * @return unit quaternion (x, y, z, w) with w >= 0.
+ */
+Vector4 rotationToQuaternion(const Matrix3& rot);
+/**
+ * @brief rotation matrix of a quaternion.
+ * @param q quaternion (x, y, z, w), normalized first.
+ * @return rotation matrix.
+ * @exception |q| < MYEPSILON
+ */
+Matrix3 quaternionToRotation(const Vector4& q);
+
+/**
+ * @brief quaternion of a rotation about an axis.
+ * @param axis rotation axis, normalized first.
+ * @param angle rotation angle in radian.
+ * @return unit quaternion (x, y, z, w).
+ * @exception |axis| < MYEPSILON
+ * @note the rotation of Matrix3::setRotationMatrix(axis, angle, RAD).
+ */
+Vector4 axisAngleToQuaternion(const Vector3& axis, scalar angle);
+/**
+ * @brief axis and angle of a quaternion.
+ * @param q quaternion (x, y, z, w), need not be unit.
+ * @param axis output unit axis, (1, 0, 0) for the identity.
+ * @param angle output angle in [0, pi].
+ * @exception |q| < MYEPSILON
+ */
+void quaternionToAxisAngle(const Vector4& q, Vector3& axis, scalar& angle);
+/**
+ * @brief axis and angle of a rotation matrix, through its quaternion so the axis stays accurate near pi.
+ * @param rot rotation matrix.
+ * @param axis output unit axis, (1, 0, 0) for the identity.
+ * @param angle output angle in [0, pi], for Matrix3::setRotationMatrix(axis, angle, RAD).
+ */
+void rotationToAxisAngle(const Matrix3& rot, Vector3& axis, scalar& angle);
+
+/**
+ * @brief quaternion of a rotation vector, rotation by |w| radian about w.
+ * @param w rotation vector.
+ * @return unit quaternion (x, y, z, w).
+ */
+Vector4 rotationVectorToQuaternion(const Vector3& w);
+/**
+ * @brief rotation vector of a quaternion, inverse of rotationVectorToQuaternion().
+ * @param q quaternion (x, y, z, w), need not be unit.
+ * @return rotation vector with |w| in [0, pi], by atan2 so it is accurate at any angle.
+ * @exception |q| < MYEPSILON
+ */
+Vector3 quaternionToRotationVector(const Vector4& q);
+
+/**
+ * @brief rotation matrices of Euler angles, in parallel.
+ * @param angles n Euler angles.
+ * @param n number of rotations.
+ * @param order axis order.
+ * @param out n rotation matrices.
+ * @return number of finite results, NaN angles give NaN matrices.
+ */
+size_t eulerToRotations(const Vector3* angles, size_t n, EULERORDER order, Matrix3* out);
+/**
+ * @brief Euler angles of rotation matrices, in parallel.
+ * @param in n rotation matrices.
+ * @param n number of rotations.
+ * @param order axis order.
+ * @param out n Euler angles.
+ * @return number of finite results, NaN matrices give NaN angles.
+ */
+size_t rotationsToEuler(const Matrix3* in, size_t n, EULERORDER order, Vector3* out);
+/**
+ * @brief quaternions of Euler angles, in parallel.
+ * @param angles n Euler angles.
+ * @param n number of rotations.
+ * @param order axis order.
+ * @param out n unit quaternions.
+ * @return number of finite results.
+ */
+size_t eulerToQuaternions(const Vector3* angles, size_t n, EULERORDER order, Vector4* out);
+/**
+ * @brief Euler angles of quaternions, in parallel.
+ * @param q n quaternions.
+ * @param n number of rotations.
+ * @param order axis order.
+ * @param out n Euler angles.
+ * @return number of valid results, quaternions with |q| < MYEPSILON give NaN.
+ */
+size_t quaternionsToEuler(const Vector4* q, size_t n, EULERORDER order, Vector3* out);
+/**
+ * @brief quaternions of rotation matrices, in parallel.
+ * @param in n rotation matrices.
+ * @param n number of rotations.
+ * @param out n unit quaternions with w >= 0.
+ * @return number of finite results.
+ * @note the SIMD variants compute in float, rotationToQuaternion() in double, results may
+ * @note differ in the last bits.
+ */
+size_t rotationsToQuaternions(const Matrix3* in, size_t n, Vector4* out);
+/**
+ * @brief rotation matrices of quaternions, in parallel.
+ * @param q n quaternions.
+ * @param n number of rotations.
+ * @param out n rotation matrices.
+ * @return number of valid results, quaternions with |q| < MYEPSILON give NaN.
+ */
+size_t quaternionsToRotations(const Vector4* q, size_t n, Matrix3* out);
+/**
+ * @brief quaternions of rotation vectors, in parallel.
+ * @param w n rotation vectors.
+ * @param n number of rotations.
+ * @param out n unit quaternions.
+ * @return number of finite results.
+ */
+size_t rotationVectorsToQuaternions(const Vector3* w, size_t n, Vector4* out);
+/**
+ * @brief rotation vectors of quaternions, in parallel.
+ * @param q n quaternions.
+ * @param n number of rotations.
+ * @param out n rotation vectors.
+ * @return number of valid results, quaternions with |q| < MYEPSILON give NaN.
+ */
+size_t quaternionsToRotationVectors(const Vector4* q, size_t n, Vector3* out);
@@ -0,0 +1,137 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mysoa.hpp
+ *  @brief structure of arrays storage of 3D points for streaming kernels.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-22
+ *  @note Vector3SoA is a non-owning view, Vector3SoABuffer owns the memory and keeps
+ *  @note its capacity across resize() calls, Vector3SoAPool recycles buffers between
+ *  @note frames so that a steady stream does not allocate.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "myvector.hpp"
+
+/**
+ *  @brief Vector3SoA struct, view of n points stored as three scalar arrays.
+ */
+struct Vector3SoA {
+    /** @brief x coordinates. */
+    scalar* x = nullptr;
+    /** @brief y coordinates. */
+    scalar* y = nullptr;
+    /** @brief z coordinates. */
+    scalar* z = nullptr;
+    /** @brief number of points. */
+    size_t size = 0;
+
+    /** @brief empty view. */
+    Vector3SoA() {}
+    /** @brief view of three caller owned arrays of n scalars. */
+    Vector3SoA(scalar* _x, scalar* _y, scalar* _z, size_t n) :
+        x(_x), y(_y), z(_z), size(n) {}
+
+    /** @brief get point i. */
+    Vector3 get(size_t i) const { return Vector3(x[i], y[i], z[i]); }
+    /** @brief set point i. */
+    void set(size_t i, const Vector3& p) {
+        x[i] = p.x;
+        y[i] = p.y;
+        z[i] = p.z;
+    }
+};
+
+/**
+ *  @brief ConstVector3SoA struct, read-only view of n points stored as three scalar arrays.
+ */
+struct ConstVector3SoA {
+    /** @brief x coordinates. */
+    const scalar* x = nullptr;
+    /** @brief y coordinates. */
+    const scalar* y = nullptr;
+    /** @brief z coordinates. */
+    const scalar* z = nullptr;
+    /** @brief number of points. */
+    size_t size = 0;
+
+    /** @brief empty view. */
+    ConstVector3SoA() {}
+    /** @brief view of three arrays of n scalars. */
+    ConstVector3SoA(const scalar* _x, const scalar* _y, const scalar* _z, size_t n) :
+        x(_x), y(_y), z(_z), size(n) {}
+    /** @brief read-only view of a mutable view. */
+    ConstVector3SoA(const Vector3SoA& v) :
+        x(v.x), y(v.y), z(v.z), size(v.size) {}
+
+    /** @brief get point i. */
+    Vector3 get(size_t i) const { return Vector3(x[i], y[i], z[i]); }
+};
+
+/**
+ *  @brief Vector3SoABuffer class, owning storage behind a Vector3SoA.
+ */
+class Vector3SoABuffer {
+  private:
+    /** @brief one block of 3 * capacity scalars, x then y then z. */
+    std::unique_ptr<scalar[]> storage;
+    /** @brief number of points the block can hold. */
+    size_t capacity = 0;
+    /** @brief number of points in use. */
+    size_t count = 0;
+
+  protected:
+  public:
+    /** @brief empty buffer. */
+    Vector3SoABuffer() {}
+    /** @brief buffer of n points. */
+    explicit Vector3SoABuffer(size_t n) { resize(n); }
+    /** @brief take the storage of a buffer, which is left empty with no capacity. */
+    Vector3SoABuffer(Vector3SoABuffer&& buffer) noexcept;
+    /** @brief release the own storage and take that of a buffer, which is left empty with no capacity. */
+    Vector3SoABuffer& operator=(Vector3SoABuffer&& buffer) noexcept;
+
+    /**
+     * @brief set the number of points, memory is only allocated when n exceeds the capacity.
+     * @note contents are not preserved when the buffer grows.
+     */
+    void resize(size_t n);
+    /** @brief number of points in use. */
+    size_t size() const { return count; }
+    /** @brief number of points the buffer can hold without allocating. */
+    size_t getCapacity() const { return capacity; }
+    /** @brief view of the points in use, invalidated by a growing resize(). */
+    Vector3SoA view() {
+        return Vector3SoA(storage.get(), storage.get() + capacity, storage.get() + 2 * capacity, count);
+    }
+};
+
+/**
+ *  @brief Vector3SoAPool class, thread safe free list of buffers.
+ */
+class Vector3SoAPool {
+  private:
+    /** @brief buffers ready for reuse. */
+    std::vector<Vector3SoABuffer> free_list;
+    /** @brief guards free_list. */
+    std::mutex pool_mutex;
+
+  protected:
+  public:
+    /**
+     * @brief take a buffer of n points, a released one is reused if any.
+     * @param n number of points.
+     * @return buffer with size() == n.
+     */
+    Vector3SoABuffer acquire(size_t n);
+    /** @brief give a buffer back for reuse. */
+    void release(Vector3SoABuffer&& buffer);
+    /** @brief number of buffers ready for reuse. */
+    size_t available();
+};
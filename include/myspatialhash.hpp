@@ -0,0 +1,194 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myspatialhash.hpp
+ *  @brief uniform grid / spatial hash over dynamic 3D point sets.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-12
+ *  @note points are quantized into cubic cells of edge cellSize, cells are hashed into
+ *  @note a power-of-two bucket table and the points are counting-sorted by bucket, so
+ *  @note every bucket is a contiguous run of sortedPoints().
+ *  @note different cells may share a bucket, queries filter them by cell coordinates.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "myvector.hpp"
+
+/**
+ *  @brief integer coordinates of a grid cell.
+ */
+struct GridCell {
+    /** @brief cell index along (1, 0, 0). */
+    int32_t x;
+    /** @brief cell index along (0, 1, 0). */
+    int32_t y;
+    /** @brief cell index along (0, 0, 1). */
+    int32_t z;
+
+    bool operator==(const GridCell& rhs) const {
+        return (x == rhs.x) && (y == rhs.y) && (z == rhs.z);
+    }
+};
+
+/**
+ *  @brief SpatialHashGrid class used for fixed-radius neighbor search on moving points.
+ */
+class SpatialHashGrid {
+  private:
+    /** @brief edge length of a cell. */
+    scalar cell_size;
+    /** @brief 1 / cell_size. */
+    scalar inv_cell_size;
+    /** @brief number of buckets, power of two. */
+    size_t table_size = 0;
+    /** @brief number of points in the grid. */
+    size_t num_points = 0;
+
+    /** @brief per-bucket point count, reused as scatter cursor. */
+    std::unique_ptr<std::atomic<uint32_t>[]> bucket_count;
+    /** @brief per-bucket list head for concurrent insertion, -1 for empty. */
+    std::unique_ptr<std::atomic<int32_t>[]> bucket_head;
+    /** @brief bucket_start[b] is the first sorted slot of bucket b, table_size + 1 entries. */
+    std::vector<uint32_t> bucket_start;
+
+    /** @brief scratch, bucket of every input point. */
+    std::vector<uint32_t> point_bucket;
+    /** @brief scratch, cell of every input point. */
+    std::vector<GridCell> point_cell;
+    /** @brief scratch, input points of concurrent insertion. */
+    std::vector<Vector3> point_input;
+    /** @brief scratch, linked list of concurrent insertion. */
+    std::vector<int32_t> point_next;
+
+    /** @brief points ordered by bucket. */
+    std::vector<Vector3> sorted_points;
+    /** @brief cells ordered by bucket. */
+    std::vector<GridCell> sorted_cells;
+    /** @brief original indices ordered by bucket. */
+    std::vector<uint32_t> sorted_indices;
+
+    /** @brief grow bucket table to hold n points, clear the counters. */
+    void prepareTable(size_t n);
+    /** @brief exclusive prefix sum of bucket_count into bucket_start. */
+    void computeBucketStart();
+    /** @brief sort indices inside every bucket and gather points, cells. */
+    void finalizeBuckets(const Vector3* points);
+
+  protected:
+  public:
+    /**
+     * @brief constructor.
+     * @param cellSize edge length of a cell, usually the query radius.
+     * @exception cellSize <= 0
+     */
+    explicit SpatialHashGrid(scalar cellSize = 1.f);
+
+    /**
+     * @brief set the edge length of a cell, takes effect at next build.
+     * @exception cellSize <= 0
+     */
+    void setCellSize(scalar cellSize);
+    /** @brief edge length of a cell. */
+    scalar getCellSize() const { return cell_size; }
+    /** @brief number of points in the grid. */
+    size_t size() const { return num_points; }
+    /** @brief number of hash buckets. */
+    size_t bucketCount() const { return table_size; }
+
+    /**
+     * @brief rebuild the grid from scratch, in parallel.
+     * @param points point array.
+     * @param n number of points.
+     * @note buffers are kept between builds, rebuilding a same-sized set reuses them.
+     */
+    void build(const Vector3* points, size_t n);
+    /** @brief rebuild the grid from a vector of points. */
+    void build(const std::vector<Vector3>& points) { build(points.data(), points.size()); }
+
+    /**
+     * @brief start lock-free insertion mode, drop current content.
+     * @param capacity upper bound (exclusive) of the indices to be inserted.
+     * @see void insertConcurrent(uint32_t index, const Vector3& p)
+     * @see void endConcurrentInsert()
+     */
+    void beginConcurrentInsert(size_t capacity);
+    /**
+     * @brief insert a point, lock-free and safe to call from several threads.
+     * @param index point index, every index in [0, capacity) must be inserted once.
+     * @param p point position.
+     * @warning no bound check, index must be less than capacity.
+     */
+    void insertConcurrent(uint32_t index, const Vector3& p);
+    /**
+     * @brief leave insertion mode and compact buckets into the sorted layout.
+     * @warning all insertConcurrent() calls must have returned.
+     */
+    void endConcurrentInsert();
+
+    /** @brief cell containing p. */
+    GridCell cellOf(const Vector3& p) const {
+        return GridCell{static_cast<int32_t>(std::floor(p.x * inv_cell_size)),
+                        static_cast<int32_t>(std::floor(p.y * inv_cell_size)),
+                        static_cast<int32_t>(std::floor(p.z * inv_cell_size))};
+    }
+    /** @brief bucket of cell c. */
+    size_t bucketOf(const GridCell& c) const {
+        uint32_t h = (static_cast<uint32_t>(c.x) * 73856093u)
+                     ^ (static_cast<uint32_t>(c.y) * 19349663u)
+                     ^ (static_cast<uint32_t>(c.z) * 83492791u);
+        return h & (table_size - 1);
+    }
+
+    /** @brief points ordered by bucket, cache-friendly iteration. */
+    const std::vector<Vector3>& sortedPoints() const { return sorted_points; }
+    /** @brief sortedIndices()[k] is the original index of sortedPoints()[k]. */
+    const std::vector<uint32_t>& sortedIndices() const { return sorted_indices; }
+
+    /**
+     * @brief visit every point within radius of q.
+     * @param q query position.
+     * @param radius search radius.
+     * @param callback invoked as callback(index, point, squared distance), index is original.
+     * @note radius <= cellSize visits 27 cells, larger radius visits more cells.
+     */
+    template <typename Callback>
+    void forEachNeighbor(const Vector3& q, scalar radius, Callback&& callback) const {
+        if (num_points == 0) return;
+        const scalar r2 = radius * radius;
+        const GridCell lo = cellOf(Vector3(q.x - radius, q.y - radius, q.z - radius));
+        const GridCell hi = cellOf(Vector3(q.x + radius, q.y + radius, q.z + radius));
+        GridCell c;
+        for (c.z = lo.z; c.z <= hi.z; ++c.z) {
+            for (c.y = lo.y; c.y <= hi.y; ++c.y) {
+                for (c.x = lo.x; c.x <= hi.x; ++c.x) {
+                    const size_t b = bucketOf(c);
+                    const uint32_t end = bucket_start[b + 1];
+                    for (uint32_t k = bucket_start[b]; k < end; ++k) {
+                        if (!(sorted_cells[k] == c)) continue;
+                        const Vector3& p = sorted_points[k];
+                        const scalar dx = p.x - q.x;
+                        const scalar dy = p.y - q.y;
+                        const scalar dz = p.z - q.z;
+                        const scalar d2 = dx * dx + dy * dy + dz * dz;
+                        if (d2 <= r2) callback(sorted_indices[k], p, d2);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief collect the original indices of all points within radius of q.
+     * @param q query position.
+     * @param radius search radius.
+     * @param out cleared then filled with indices, in no particular order.
+     */
+    void radiusSearch(const Vector3& q, scalar radius, std::vector<uint32_t>& out) const;
+};
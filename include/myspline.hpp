@@ -0,0 +1,115 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myspline.hpp
+ *  @brief continuous-time trajectory, a uniform cubic B-spline on SO(3) x R^3.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-8
+ *  @note control point k sits at time t0 + k * dt, the spline approximates the control
+ *  @note points (it does not pass through them) and is defined on [t0 + dt, t0 + (n - 2) * dt].
+ *  @note the rotation is the cumulative spline R_{k-1} * prod_j exp(B_j(u) * log(R_{k+j-2}^{-1} R_{k+j-1})),
+ *  @note the translation a cubic B-spline of the control positions (split representation),
+ *  @note both are C2 continuous.
+ *  @note every segment caches its first rotation, the axes and angles of its three relative
+ *  @note rotations and the polynomial of its translation, so an evaluation costs three
+ *  @note sin/cos pairs and three 3x3 products and never allocates.
+ *  @note times are double, seconds since the epoch would lose milliseconds in float.
+ *  @note times are located relative to the cached first valid time, so getStartTime() and
+ *  @note getEndTime() are inside the spline even for epoch-scale start times.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mylie.hpp"
+
+/**
+ *  @brief TrajectorySpline class, poses at arbitrary times from uniformly spaced control poses.
+ */
+class TrajectorySpline {
+  private:
+    /** @brief cached coefficients of the segment between control points k and k + 1. */
+    struct Segment {
+        /** @brief rotation of control point k - 1. */
+        SO3 rotation;
+        /** @brief unit axes of the relative rotations of control points k - 1 .. k + 2. */
+        Vector3 axis[3];
+        /** @brief angles of the relative rotations. */
+        scalar angle[3];
+        /** @brief translation c0 + c1 * u + c2 * u^2 + c3 * u^3. */
+        Vector3 coefficient[4];
+    };
+
+    std::vector<Segment> segments;
+    double t0;
+    double dt;
+    /** @brief first and last valid time and 1 / dt, cached so that the bounds are exact. */
+    double start_time;
+    double end_time;
+    double inv_dt;
+
+    void build(const SE3* controlPoints, size_t n);
+    /** @brief spline parameter x in [0, segments] of a time, false outside [start_time, end_time]. */
+    bool locate(double time, double& x) const;
+    /** @brief pose at u in [0, 1] of a segment, velocities if not null. */
+    static SE3 evaluateSegment(const Segment& s, scalar u, scalar invDt,
+                               Vector3* angularVelocity, Vector3* linearVelocity);
+
+  protected:
+  public:
+    /**
+     * @brief constructor by control poses.
+     * @param controlPoints n control poses, body to world.
+     * @param n number of control poses.
+     * @param startTime time of the first control pose.
+     * @param interval time between two control poses.
+     * @exception (n < 4) or (interval <= 0)
+     */
+    TrajectorySpline(const SE3* controlPoints, size_t n, double startTime, double interval);
+    /**
+     * @brief constructor by rigid transformation matrices, e.g. keyframe poses.
+     * @param controlPoints n control poses, body to world.
+     * @param n number of control poses.
+     * @param startTime time of the first control pose.
+     * @param interval time between two control poses.
+     * @exception (n < 4) or (interval <= 0) or a matrix is not a rigid transformation.
+     */
+    TrajectorySpline(const Matrix4* controlPoints, size_t n, double startTime, double interval);
+
+    /** @brief first time of the spline, startTime + interval. */
+    double getStartTime() const { return start_time; }
+    /** @brief last time of the spline, startTime + (n - 2) * interval. */
+    double getEndTime() const { return end_time; }
+    /** @brief number of segments, n - 3. */
+    size_t getSegmentCount() const { return segments.size(); }
+
+    /**
+     * @brief pose at a time.
+     * @param time time in [getStartTime(), getEndTime()].
+     * @return pose, body to world.
+     * @exception Time out of range.
+     */
+    SE3 evaluate(double time) const;
+    /**
+     * @brief pose and velocities at a time.
+     * @param time time in [getStartTime(), getEndTime()].
+     * @param angularVelocity output angular velocity in body frame.
+     * @param linearVelocity output velocity of the origin in world frame.
+     * @return pose, body to world.
+     * @exception Time out of range.
+     */
+    SE3 evaluate(double time, Vector3& angularVelocity, Vector3& linearVelocity) const;
+    /**
+     * @brief poses and optional velocities at many times, in parallel.
+     * @param times n times, sorted times run segment by segment with the coefficients in registers.
+     * @param n number of times.
+     * @param poses n output poses, NaN outside [getStartTime(), getEndTime()].
+     * @param angularVelocity optional n angular velocities in body frame.
+     * @param linearVelocity optional n velocities in world frame.
+     * @return number of times inside the spline.
+     */
+    size_t evaluate(const double* times, size_t n, SE3* poses,
+                    Vector3* angularVelocity = nullptr, Vector3* linearVelocity = nullptr) const;
+};
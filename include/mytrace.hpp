@@ -0,0 +1,103 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file mytrace.hpp
+ *  @brief scoped tracing spans in per-thread ring buffers, written as Chrome trace-event JSON.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-4
+ *  @note recording is off until startTracing(), a span costs one relaxed load then.
+ *  @note every thread writes into its own single-producer ring buffer without locks,
+ *  @note flushTrace() drains all buffers into a file that chrome://tracing and
+ *  @note ui.perfetto.dev open, so it may be called periodically while threads keep
+ *  @note recording. a full buffer drops new spans and counts them, flush more often
+ *  @note or raise TRACE_BUFFER_EVENTS then.
+ *  @note span names must be string literals or otherwise outlive the next flush.
+ *  @note the batch APIs (mybatch, VoxelGridFilter, DepthBackProjector, SpatialHashGrid,
+ *  @note readPointCloud) and every parallelFor() task emit spans when the library is
+ *  @note built with `-DMYMATH_TRACE`, user code can emit spans in any build.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** @brief spans buffered per thread between two flushes, a power of two. */
+static const size_t TRACE_BUFFER_EVENTS = size_t(1) << 16;
+
+/** @brief recording flag, read on every span. */
+extern std::atomic<bool> trace_enabled;
+
+/** @brief start recording spans. */
+void startTracing();
+/** @brief stop recording spans, recorded spans stay until flushed. */
+void stopTracing();
+/** @brief true while recording. */
+inline bool isTracing() {
+    return trace_enabled.load(std::memory_order_relaxed);
+}
+/**
+ * @brief name the calling thread in the trace, e.g. "decoder".
+ * @note threads of the built-in pool are named "mymath worker <i>".
+ */
+void setTraceThreadName(const std::string& name);
+/**
+ * @brief write the spans recorded since the last flush as Chrome trace-event JSON.
+ * @return number of spans written.
+ * @exception the file cannot be written.
+ */
+size_t flushTrace(const std::string& path);
+/** @brief spans dropped on full buffers since the start of the process. */
+uint64_t getTraceDropped();
+
+/** @brief nanoseconds of the trace clock, zero at its first use. */
+uint64_t getTraceTime();
+/**
+ * @brief record a finished span of the calling thread.
+ * @param name span name, must outlive the next flush.
+ * @param start getTraceTime() at the beginning.
+ * @param end getTraceTime() at the end.
+ * @param count items processed, shown as args.n in the trace if not 0.
+ */
+void recordTraceSpan(const char* name, uint64_t start, uint64_t end, uint64_t count);
+
+/**
+ *  @brief TraceSpan class, records the span from construction to end() or destruction.
+ */
+class TraceSpan {
+  private:
+    const char* name;
+    uint64_t count;
+    uint64_t start;
+    bool active;
+
+  protected:
+  public:
+    /**
+     * @param _name span name, must outlive the next flush.
+     * @param _count items processed, shown as args.n in the trace if not 0.
+     */
+    explicit TraceSpan(const char* _name, uint64_t _count = 0) :
+        name(_name), count(_count), start(0), active(isTracing()) {
+        if (active) start = getTraceTime();
+    }
+    ~TraceSpan() { end(); }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    /** @brief end the span before the end of the scope. */
+    void end() {
+        if (!active) return;
+        active = false;
+        recordTraceSpan(name, start, getTraceTime(), count);
+    }
+};
+
+#ifdef MYMATH_TRACE
+/** @brief span over the rest of the scope, processing count items. */
+#define MYMATH_TRACE_SPAN(name, count) TraceSpan trace_span_(name, count)
+#else
+#define MYMATH_TRACE_SPAN(name, count) ((void)0)
+#endif
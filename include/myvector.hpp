@@ -31,14 +31,14 @@ struct Vector2 {
      *  @brief Default constructor.
      *  @see Vector2(scalar _x, scalar _y)
      */
-    Vector2() :
+    constexpr Vector2() :
           x(0), y(0){};
     /**
      *  Create a new 2D vector object (_x, _y).
      *  @brief Default constructor.
      *  @see Vector2()
      */
-    Vector2(scalar _x, scalar _y) :
+    constexpr Vector2(scalar _x, scalar _y) :
         x(_x), y(_y){};
 
     /** @brief Set member variables x,y. */
@@ -189,14 +189,14 @@ struct Vector3 {
      *  @brief Default constructor.
      *  @see Vector3(scalar _x, scalar _y)
      */
-    Vector3() :
+    constexpr Vector3() :
         x(0), y(0), z(0){};
     /**
      *  Create a new 3D vector object (_x, _y, _z).
      *  @brief Default constructor.
      *  @see Vector3()
      */
-    Vector3(scalar _x, scalar _y, scalar _z) :
+    constexpr Vector3(scalar _x, scalar _y, scalar _z) :
         x(_x), y(_y), z(_z){};
 
     /** @brief Set member variables x,y,z. */
@@ -359,14 +359,14 @@ struct Vector4 {
      *  @brief Default constructor.
      *  @see Vector4(scalar _x, scalar _y, scalar _z, scalar _w)
      */
-    Vector4() :
+    constexpr Vector4() :
         x(0), y(0), z(0), w(0){};
     /**
      *  Create a new 4D vector object (_x, _y, _z, _w).
      *  @brief Default constructor.
      *  @see Vector4()
      */
-    Vector4(scalar _x, scalar _y, scalar _z, scalar _w) :
+    constexpr Vector4(scalar _x, scalar _y, scalar _z, scalar _w) :
         x(_x), y(_y), z(_z), w(_w){};
 
     /** @brief Set member variables x,y,z,w. */
@@ -0,0 +1,131 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file myvoxel.hpp
+ *  @brief voxel grid downsampling of point clouds.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-3-24
+ *  @note voxel (i, j, k) is [i, i + 1) x [j, j + 1) x [k, k + 1) times the voxel size, the
+ *  @note grid is anchored at the origin, so a point falls into the same voxel whatever the
+ *  @note rest of the cloud. points are sorted by the 63-bit Morton code of their voxel,
+ *  @note counted from the lowest voxel of the cloud, with the parallel radix sort, and
+ *  @note every run of equal codes is reduced to one point.
+ *  @note the output is in Morton order of the voxels, deterministic for any thread count.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "myarena.hpp"
+#include "myvector.hpp"
+
+/**
+ *  @brief option for the point kept per voxel.
+ */
+enum VOXELREDUCE {
+    /** mean of the points of the voxel */
+    CENTROID,
+    /** point with the smallest input index */
+    FIRST_POINT,
+    /** pseudo random point, reproducible for a given seed */
+    RANDOM_POINT
+};
+
+/**
+ *  @brief VoxelGridFilter class, keeps its buffers between calls to avoid reallocation.
+ */
+class VoxelGridFilter {
+  private:
+    /** @brief edge length of a voxel. */
+    scalar voxel_size;
+    /** @brief reduction of a voxel. */
+    VOXELREDUCE reduce;
+    /** @brief seed of RANDOM_POINT. */
+    uint64_t seed;
+    /** @brief input indices sorted by voxel. */
+    std::vector<uint32_t> perm;
+    /** @brief voxel v holds perm[voxel_start[v] .. voxel_start[v + 1]). */
+    std::vector<uint32_t> voxel_start;
+    /** @brief input index of the point kept per voxel, first point for CENTROID. */
+    std::vector<uint32_t> representative;
+    /** @brief scratch voxel codes. */
+    std::vector<uint64_t> codes;
+
+    /** @brief sort the points by voxel and find the voxels, returns the voxel count. */
+    size_t group(const Vector3* points, size_t n);
+    /** @brief pick the representatives and write one point per voxel. */
+    void reduceVoxels(const Vector3* points, Vector3* out);
+
+  protected:
+  public:
+    /**
+     * @brief constructor.
+     * @param voxelSize edge length of a voxel.
+     * @param mode reduction of a voxel.
+     * @param seed seed of RANDOM_POINT.
+     * @exception voxelSize <= 0
+     */
+    explicit VoxelGridFilter(scalar voxelSize, VOXELREDUCE mode = CENTROID, uint64_t seed = 0);
+
+    /** @brief edge length of a voxel. */
+    scalar getVoxelSize() const { return voxel_size; }
+    /** @brief reduction of a voxel. */
+    VOXELREDUCE getMode() const { return reduce; }
+
+    /**
+     * @brief downsample a point cloud, in parallel.
+     * @param points n finite points.
+     * @param n number of points, less than 2^32.
+     * @param out cleared then filled with one point per non-empty voxel.
+     * @exception the bounding box spans more than 2^21 voxels along an axis.
+     * @return number of voxels.
+     */
+    size_t filter(const Vector3* points, size_t n, std::vector<Vector3>& out);
+    /**
+     * @brief downsample a point cloud into arena memory, in parallel.
+     * @param points n finite points.
+     * @param n number of points, less than 2^32.
+     * @param arena arena the output is allocated from, e.g. getThreadArena().
+     * @param count output number of voxels.
+     * @exception the bounding box spans more than 2^21 voxels along an axis.
+     * @return count points, valid as long as the arena memory.
+     */
+    const Vector3* filter(const Vector3* points, size_t n, Arena& arena, size_t& count);
+
+    /** @brief number of voxels of the last filter(). */
+    size_t voxelCount() const { return representative.size(); }
+    /** @brief input index of the point kept per voxel by the last filter(). */
+    const std::vector<uint32_t>& getRepresentatives() const { return representative; }
+    /**
+     * @brief input indices of the points of a voxel of the last filter().
+     * @param voxel voxel index.
+     * @param count output number of points.
+     * @return pointer to count input indices in ascending order.
+     */
+    const uint32_t* voxelPoints(size_t voxel, size_t& count) const {
+        count = voxel_start[voxel + 1] - voxel_start[voxel];
+        return perm.data() + voxel_start[voxel];
+    }
+
+    /**
+     * @brief reduce a per-point attribute the same way as the last filter(), in parallel.
+     * @param attributes n * dim scalars of the points passed to filter(), point major.
+     * @param dim number of scalars per point.
+     * @param out resized to voxelCount() * dim, mean for CENTROID, the representative's otherwise.
+     */
+    void filterAttribute(const scalar* attributes, size_t dim, std::vector<scalar>& out) const;
+    /**
+     * @brief copy the attribute of the representative of every voxel, any type.
+     * @param attributes n attributes of the points passed to filter().
+     * @param out voxelCount() outputs.
+     */
+    template <typename T>
+    void gatherAttribute(const T* attributes, T* out) const {
+        for (size_t v = 0; v < representative.size(); ++v) {
+            out[v] = attributes[representative[v]];
+        }
+    }
+};
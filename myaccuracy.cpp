@@ -0,0 +1,121 @@
+#include "myaccuracy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/** @brief spacing of scalar at |x|, the smallest subnormal at zero. */
+static double ulpAt(double x) {
+    const scalar largest = std::numeric_limits<scalar>::max();
+    const scalar a = static_cast<scalar>(std::min(std::fabs(x), static_cast<double>(largest)));
+    if (a == largest) return static_cast<double>(a) - std::nextafter(a, scalar(0));
+    return static_cast<double>(std::nextafter(a, largest)) - a;
+}
+
+double ulpError(scalar value, double reference) {
+    const double v = static_cast<double>(value);
+    if (!std::isfinite(reference) || !std::isfinite(v)) {
+        if (std::isnan(reference) && std::isnan(v)) return 0;
+        return (v == reference) ? 0 : std::numeric_limits<double>::infinity();
+    }
+    return std::fabs(v - reference) / ulpAt(reference);
+}
+
+void UlpStats::add(double ulps, size_t index) {
+    if (!std::isfinite(ulps)) {
+        ++failures;
+        return;
+    }
+    if ((count == 0) || (ulps > max)) {
+        max = ulps;
+        worst = index;
+    }
+    sum += ulps;
+    ++count;
+}
+
+AccuracyResult& AccuracyReport::entry(const std::string& name, const std::string& input) {
+    for (AccuracyResult& r : results) {
+        if ((r.name == name) && (r.input == input)) return r;
+    }
+    results.push_back(AccuracyResult());
+    results.back().name = name;
+    results.back().input = input;
+    return results.back();
+}
+
+void AccuracyReport::add(const std::string& name, const std::string& input, const scalar* values,
+                         const double* references, int n, size_t index) {
+    AccuracyResult& r = entry(name, input);
+    double largest = 0, worst = 0;
+    bool finite = true;
+    for (int i = 0; i < n; ++i) {
+        const double ulps = ulpError(values[i], references[i]);
+        r.element.add(ulps, index);
+        finite &= std::isfinite(ulps);
+        if (std::isfinite(references[i])) {
+            largest = std::max(largest, std::fabs(references[i]));
+            worst = std::max(worst, std::fabs(static_cast<double>(values[i]) - references[i]));
+        }
+    }
+    r.norm.add(finite ? worst / ulpAt(largest) : std::numeric_limits<double>::infinity(), index);
+}
+
+/** @brief median nanoseconds of name and variant, NaN if not measured. */
+static double timingOf(const std::vector<BenchmarkResult>* timing, const std::string& name,
+                       const std::string& variant) {
+    if (timing) {
+        for (const BenchmarkResult& b : *timing) {
+            if ((b.name == name) && (b.variant == variant)) return b.median;
+        }
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+void AccuracyReport::printTable(FILE* out, const std::vector<BenchmarkResult>* timing) const {
+    fprintf(out, "%-34s %-14s %12s %10s %10s %10s %8s %8s %10s %10s\n", "operation", "input", "max ulp",
+            "mean ulp", "max norm", "mean norm", "failures", "rejected", "mymath ns", "eigen ns");
+    for (const AccuracyResult& r : results) {
+        fprintf(out, "%-34s %-14s %12.4g %10.3g %10.3g %10.3g %8zu %8zu %10.3f %10.3f\n", r.name.c_str(),
+                r.input.c_str(), r.element.max, r.element.mean(), r.norm.max, r.norm.mean(), r.norm.failures,
+                r.rejected, timingOf(timing, r.name, "mymath"), timingOf(timing, r.name, "eigen"));
+    }
+}
+
+/** @brief write ", \"key\": value" unless value is NaN. */
+static void writeNumber(FILE* file, const char* key, double value) {
+    if (!std::isnan(value)) fprintf(file, ", \"%s\": %.6g", key, value);
+}
+
+static void writeStats(FILE* file, const char* key, const UlpStats& s) {
+    fprintf(file, ", \"%s\": {\"count\": %zu, \"failures\": %zu, \"max\": %.6g, \"mean\": %.6g, \"worst_input\": %zu}",
+            key, s.count, s.failures, s.max, s.mean(), s.worst);
+}
+
+void AccuracyReport::writeJSON(const std::string& path, const std::vector<BenchmarkResult>* timing) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot open %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        throw "Cannot open file!";
+    }
+    fprintf(file, "{\n  \"scalar_bytes\": %zu,\n  \"accuracy\": [", sizeof(scalar));
+    for (size_t i = 0; i < results.size(); ++i) {
+        const AccuracyResult& r = results[i];
+        // names and input classes are plain identifiers, no escaping needed
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"input\": \"%s\"", (i > 0) ? "," : "", r.name.c_str(),
+                r.input.c_str());
+        writeStats(file, "element_ulp", r.element);
+        writeStats(file, "norm_ulp", r.norm);
+        fprintf(file, ", \"rejected\": %zu", r.rejected);
+        writeNumber(file, "mymath_ns", timingOf(timing, r.name, "mymath"));
+        writeNumber(file, "eigen_ns", timingOf(timing, r.name, "eigen"));
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    if (fclose(file) != 0) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Write error on %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        throw "Write error!";
+    }
+}
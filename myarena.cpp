@@ -0,0 +1,125 @@
+#include "myarena.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+/** @brief round up to a multiple of a power of two. */
+static inline size_t alignUp(size_t v, size_t align) {
+    return (v + align - 1) & ~(align - 1);
+}
+
+Arena::Arena(size_t blockSize) :
+    block_size(blockSize) {
+}
+
+Arena::~Arena() {
+    release();
+}
+
+void* Arena::allocate(size_t bytes, size_t align) {
+    if (align < alignof(std::max_align_t)) align = alignof(std::max_align_t);
+    // blocks come from operator new, aligned to max_align_t, larger alignments need padding
+    while (current < blocks.size()) {
+        Block& b = blocks[current];
+        size_t start = alignUp(reinterpret_cast<uintptr_t>(b.data) + offset, align) - reinterpret_cast<uintptr_t>(b.data);
+        if (start + bytes <= b.size) {
+            offset = start + bytes;
+            return b.data + start;
+        }
+        ++current;
+        offset = 0;
+    }
+    size_t size = bytes + align;
+    if (size < block_size) size = block_size;
+    if (!blocks.empty() && (size < 2 * blocks.back().size)) size = 2 * blocks.back().size;
+    unsigned char* data = static_cast<unsigned char*>(::operator new(size));
+    ++heap_allocations;
+    blocks.push_back(Block{data, size});
+    current = blocks.size() - 1;
+    size_t start = alignUp(reinterpret_cast<uintptr_t>(data), align) - reinterpret_cast<uintptr_t>(data);
+    offset = start + bytes;
+    return data + start;
+}
+
+void Arena::reset() {
+    if (blocks.size() > 1) {
+        size_t total = capacity();
+        for (Block& b : blocks) ::operator delete(b.data);
+        blocks.clear();
+        blocks.push_back(Block{static_cast<unsigned char*>(::operator new(total)), total});
+        ++heap_allocations;
+    }
+    current = 0;
+    offset = 0;
+}
+
+void Arena::release() {
+    for (Block& b : blocks) ::operator delete(b.data);
+    blocks.clear();
+    current = 0;
+    offset = 0;
+}
+
+size_t Arena::bytesUsed() const {
+    size_t used = 0;
+    for (size_t i = 0; (i < current) && (i < blocks.size()); ++i) used += blocks[i].size;
+    return used + offset;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const Block& b : blocks) total += b.size;
+    return total;
+}
+
+SizeClassPool::SizeClassPool(size_t blockSize) :
+    arena(blockSize) {
+    std::memset(free_list, 0, sizeof(free_list));
+}
+
+int SizeClassPool::sizeClass(size_t bytes) {
+    int k = 0;
+    while ((k < CLASSES) && ((size_t(16) << k) < bytes)) ++k;
+    return k;
+}
+
+void* SizeClassPool::allocate(size_t bytes) {
+    int k = sizeClass(bytes);
+    if (k == CLASSES) return arena.allocate(bytes, 16);
+    if (free_list[k]) {
+        void* p = free_list[k];
+        free_list[k] = *static_cast<void**>(p);
+        return p;
+    }
+    return arena.allocate(size_t(16) << k, 16);
+}
+
+void SizeClassPool::deallocate(void* p, size_t bytes) {
+    int k = sizeClass(bytes);
+    if ((p == nullptr) || (k == CLASSES)) return;
+    *static_cast<void**>(p) = free_list[k];
+    free_list[k] = p;
+}
+
+void SizeClassPool::reset() {
+    std::memset(free_list, 0, sizeof(free_list));
+    arena.reset();
+}
+
+static std::atomic<uint64_t> g_frame(0);
+
+Arena& getThreadArena() {
+    static thread_local Arena arena;
+    static thread_local uint64_t frame = 0;
+    const uint64_t now = g_frame.load(std::memory_order_relaxed);
+    if ((frame != now) && (arena.scopes == 0)) {
+        arena.reset();
+        frame = now;
+    }
+    return arena;
+}
+
+void nextFrame() {
+    g_frame.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+#include "mybatch.hpp"
+#include "myisa.hpp"
+#include "myparallel.hpp"
+#include "mytrace.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <vector>
+
+/** @brief elements handled by one parallel task. */
+static const size_t BATCH_GRAIN = 1 << 14;
+
+void computeBounds(const Vector3* points, size_t n, Vector3& boxMin, Vector3& boxMax) {
+    MYMATH_TRACE_SPAN("computeBounds", n);
+    if (n == 0) {
+        boxMin.set(0, 0, 0);
+        boxMax.set(0, 0, 0);
+        return;
+    }
+    struct Box {
+        Vector3 lo, hi;
+    };
+    const scalar inf = std::numeric_limits<scalar>::infinity();
+    const Box empty = {Vector3(inf, inf, inf), Vector3(-inf, -inf, -inf)};
+    const BatchKernels& kernels = getBatchKernels();
+    Box box = parallelReduce(size_t(0), n, BATCH_GRAIN, empty,
+        [&](size_t lo, size_t hi, Box& b) { kernels.bounds(points + lo, hi - lo, b.lo, b.hi); },
+        [](const Box& a, const Box& b) {
+            return Box{Vector3(std::min(a.lo.x, b.lo.x), std::min(a.lo.y, b.lo.y), std::min(a.lo.z, b.lo.z)),
+                       Vector3(std::max(a.hi.x, b.hi.x), std::max(a.hi.y, b.hi.y), std::max(a.hi.z, b.hi.z))};
+        });
+    boxMin = box.lo;
+    boxMax = box.hi;
+}
+
+void transformPoints(const Matrix4& mat, const Vector3* in, size_t n, Vector3* out) {
+    MYMATH_TRACE_SPAN("transformPoints", n);
+    const scalar* a = mat.constData();
+    const BatchKernels& kernels = getBatchKernels();
+    parallelFor(0, n, BATCH_GRAIN, [&](size_t lo, size_t hi) { kernels.transform(a, in + lo, hi - lo, out + lo); });
+}
+
+size_t invertMatrices(const Matrix4* in, size_t n, Matrix4* out) {
+    MYMATH_TRACE_SPAN("invertMatrices", n);
+    const BatchKernels& kernels = getBatchKernels();
+    // a matrix is 16 points worth of work
+    return parallelReduce(size_t(0), n, BATCH_GRAIN / 16, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        total += kernels.invert(in + lo, hi - lo, out + lo);
+    }, std::plus<size_t>());
+}
+
+/** @brief clip space transform with perspective divide, false if the point is behind. */
+static inline bool projectOne(const scalar* a, const Vector3& p, scalar& x, scalar& y, scalar& z) {
+    const scalar w = a[3] * p.x + a[7] * p.y + a[11] * p.z + a[15];
+    if (!(w > 0)) {
+        x = y = z = std::numeric_limits<scalar>::quiet_NaN();
+        return false;
+    }
+    const scalar inv_w = 1 / w;
+    x = (a[0] * p.x + a[4] * p.y + a[8] * p.z + a[12]) * inv_w;
+    y = (a[1] * p.x + a[5] * p.y + a[9] * p.z + a[13]) * inv_w;
+    z = (a[2] * p.x + a[6] * p.y + a[10] * p.z + a[14]) * inv_w;
+    return true;
+}
+
+size_t projectPoints(const Matrix4& viewProjection, const Vector3* in, size_t n, Vector3* ndc) {
+    MYMATH_TRACE_SPAN("projectPoints", n);
+    const scalar* a = viewProjection.constData();
+    return parallelReduce(size_t(0), n, BATCH_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            scalar x, y, z;
+            count += projectOne(a, in[i], x, y, z);
+            ndc[i].set(x, y, z);
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
+
+void ndcToPixels(const Vector3* ndc, size_t n, scalar width, scalar height, Vector2* pixels) {
+    MYMATH_TRACE_SPAN("ndcToPixels", n);
+    const scalar sx = width * 0.5f;
+    const scalar sy = height * 0.5f;
+    parallelFor(0, n, BATCH_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            pixels[i].set((ndc[i].x + 1) * sx, (1 - ndc[i].y) * sy);
+        }
+    });
+}
+
+size_t projectToPixels(const Matrix4& viewProjection, const Vector3* in, size_t n,
+                       scalar width, scalar height, Vector2* pixels, scalar* depth) {
+    MYMATH_TRACE_SPAN("projectToPixels", n);
+    const scalar* a = viewProjection.constData();
+    const scalar sx = width * 0.5f;
+    const scalar sy = height * 0.5f;
+    return parallelReduce(size_t(0), n, BATCH_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            scalar x, y, z;
+            count += projectOne(a, in[i], x, y, z);
+            pixels[i].set((x + 1) * sx, (1 - y) * sy);
+            if (depth) depth[i] = z;
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
@@ -0,0 +1,242 @@
+#include "mybenchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+/** @brief open one user space event of the calling thread, -1 on failure. */
+static int openEvent(uint64_t config, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = (group < 0) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+}
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        fds[e] = -1;
+        slot[e] = -1;
+    }
+#ifdef __linux__
+    static const uint64_t CONFIG[PERF_EVENT_COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        fds[e] = openEvent(CONFIG[e], leader);
+        if (fds[e] < 0) continue;
+        if (leader < 0) leader = fds[e];
+        slot[e] = opened++;
+    }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if (fds[e] >= 0) close(fds[e]);
+    }
+#endif
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+    if (leader < 0) return;
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+bool PerfCounters::stop(double values[PERF_EVENT_COUNT]) {
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) values[e] = std::numeric_limits<double>::quiet_NaN();
+#ifdef __linux__
+    if (leader < 0) return false;
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // nr, time enabled, time running, one value per event
+    uint64_t data[3 + PERF_EVENT_COUNT];
+    const ssize_t bytes = read(leader, data, sizeof(data));
+    if ((bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) || (data[2] == 0)) return false;
+    const double scale = static_cast<double>(data[1]) / static_cast<double>(data[2]);
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if ((slot[e] >= 0) && (static_cast<uint64_t>(slot[e]) < data[0])) values[e] = data[3 + slot[e]] * scale;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+BenchmarkSuite::BenchmarkSuite(int _samples, double warmupMs, double sampleMs) :
+    samples(std::max(1, _samples)), warmup_ms(warmupMs), sample_ms(sampleMs) {}
+
+bool BenchmarkSuite::isSelected(const std::string& name) const {
+    return filter.empty() || (name.find(filter) != std::string::npos);
+}
+
+bool BenchmarkSuite::enableCounters(bool enable) {
+    perf.reset();
+    if (!enable) return false;
+    perf.reset(new PerfCounters());
+    if (!perf->isAvailable()) {
+        perf.reset();
+        fprintf(stderr, "File %s, Line %d, Function %s(): Hardware counters unavailable, timing only.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        return false;
+    }
+    return true;
+}
+
+BenchmarkResult BenchmarkSuite::measure(const std::string& name, const std::string& variant,
+                                        const std::function<double(size_t)>& batch, size_t elements) const {
+    // calibrate the sample size while warming up
+    size_t iterations = 1;
+    double spent = 0;
+    for (;;) {
+        const double ns = batch(iterations);
+        spent += ns;
+        if ((ns >= sample_ms * 1e6) && (spent >= warmup_ms * 1e6)) break;
+        if (ns < sample_ms * 1e6) iterations *= 2;
+    }
+
+    BenchmarkResult r;
+    std::vector<double> per_op(samples);
+    double events[PERF_EVENT_COUNT];
+    if (perf) perf->start();
+    for (int s = 0; s < samples; ++s) per_op[s] = batch(iterations) / iterations;
+    if (perf && perf->stop(events)) {
+        const double ops = static_cast<double>(iterations) * samples;
+        r.counters = true;
+        r.cycles = events[PERF_CYCLES] / ops;
+        r.instructions = events[PERF_INSTRUCTIONS] / ops;
+        r.cache_misses = events[PERF_CACHE_MISSES] / ops;
+        r.branch_misses = events[PERF_BRANCH_MISSES] / ops;
+    }
+    std::sort(per_op.begin(), per_op.end());
+
+    r.name = name;
+    r.variant = variant;
+    r.elements = std::max<size_t>(1, elements);
+    r.iterations = iterations;
+    r.samples = samples;
+    r.min = per_op.front();
+    r.median = (samples % 2) ? per_op[samples / 2] : 0.5 * (per_op[samples / 2 - 1] + per_op[samples / 2]);
+    for (double t : per_op) r.mean += t;
+    r.mean /= samples;
+    for (double t : per_op) r.stddev += (t - r.mean) * (t - r.mean);
+    r.stddev = (samples > 1) ? std::sqrt(r.stddev / (samples - 1)) : 0;
+    return r;
+}
+
+/** @brief median of the baseline variant of the same name, 0 if none. */
+static double baselineMedian(const std::vector<BenchmarkResult>& results, const BenchmarkResult& r,
+                             const std::string& baseline) {
+    if (baseline.empty() || (r.variant == baseline)) return 0;
+    for (const BenchmarkResult& b : results) {
+        if ((b.name == r.name) && (b.variant == baseline)) return b.median;
+    }
+    return 0;
+}
+
+void BenchmarkSuite::printTable(FILE* out, const std::string& baseline) const {
+    bool counters = false;
+    for (const BenchmarkResult& r : results) counters |= r.counters;
+    fprintf(out, "%-40s %-8s %12s %12s %10s %8s", "benchmark", "variant", "median ns", "min ns", "stddev", "ratio");
+    if (counters) fprintf(out, " %10s %6s %10s %10s", "cyc/elem", "IPC", "llc-miss", "br-miss");
+    fprintf(out, "\n");
+    for (const BenchmarkResult& r : results) {
+        const double base = baselineMedian(results, r, baseline);
+        fprintf(out, "%-40s %-8s %12.3f %12.3f %10.3f", r.name.c_str(), r.variant.c_str(), r.median, r.min, r.stddev);
+        if (base > 0) {
+            fprintf(out, " %8.2f", r.median / base);
+        } else {
+            fprintf(out, " %8s", "");
+        }
+        if (r.counters) {
+            fprintf(out, " %10.2f %6.2f %10.3f %10.3f", r.cyclesPerElement(), r.ipc(), r.cache_misses, r.branch_misses);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+/** @brief write ", \"key\": value" unless value is NaN, which JSON cannot hold. */
+static void writeNumber(FILE* file, const char* key, double value) {
+    if (!std::isnan(value)) fprintf(file, ", \"%s\": %.6g", key, value);
+}
+
+/** @brief write a string literal, escaping quotes, backslashes and control characters. */
+static void writeString(FILE* file, const std::string& s) {
+    fputc('"', file);
+    for (char c : s) {
+        if ((c == '"') || (c == '\\')) {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            fprintf(file, "\\u%04x", static_cast<unsigned char>(c));
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+void BenchmarkSuite::writeJSON(const std::string& path, const std::string& baseline) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot open %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        throw "Cannot open file!";
+    }
+    fprintf(file, "{\n  \"context\": {\n    \"samples\": %d,\n    \"warmup_ms\": %g,\n    \"sample_ms\": %g,\n",
+            samples, warmup_ms, sample_ms);
+    fprintf(file, "    \"counters\": %s,\n", perf ? "true" : "false");
+    fprintf(file, "    \"baseline\": ");
+    writeString(file, baseline);
+#ifdef __VERSION__
+    fprintf(file, ",\n    \"compiler\": ");
+    writeString(file, __VERSION__);
+#endif
+    fprintf(file, "\n  },\n  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        fprintf(file, "%s\n    {\"name\": ", (i > 0) ? "," : "");
+        writeString(file, r.name);
+        fprintf(file, ", \"variant\": ");
+        writeString(file, r.variant);
+        fprintf(file, ", \"iterations\": %zu, \"samples\": %d, \"median_ns\": %.6g, \"min_ns\": %.6g, "
+                      "\"mean_ns\": %.6g, \"stddev_ns\": %.6g",
+                r.iterations, r.samples, r.median, r.min, r.mean, r.stddev);
+        fprintf(file, ", \"elements\": %zu", r.elements);
+        const double base = baselineMedian(results, r, baseline);
+        if (base > 0) writeNumber(file, "ratio", r.median / base);
+        if (r.counters) {
+            writeNumber(file, "cycles_per_op", r.cycles);
+            writeNumber(file, "instructions_per_op", r.instructions);
+            writeNumber(file, "ipc", r.ipc());
+            writeNumber(file, "cycles_per_element", r.cyclesPerElement());
+            writeNumber(file, "cache_misses_per_op", r.cache_misses);
+            writeNumber(file, "branch_misses_per_op", r.branch_misses);
+        }
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    if (fclose(file) != 0) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Write error on %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        throw "Write error!";
+    }
+}
@@ -0,0 +1,187 @@
+#include "mycamera.hpp"
+#include "myarena.hpp"
+#include "myparallel.hpp"
+#include "myinstrument.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/** @brief points handled by one parallel task. */
+static const size_t CAMERA_GRAIN = 1 << 14;
+
+PinholeCamera::PinholeCamera() :
+    width(0), height(0) {
+}
+
+PinholeCamera::PinholeCamera(scalar fx, scalar fy, scalar cx, scalar cy, int width, int height) {
+    setIntrinsics(Matrix3(fx, 0, 0, 0, fy, 0, cx, cy, 1));
+    setImageSize(width, height);
+}
+
+PinholeCamera::PinholeCamera(const Matrix3& intrinsics, const Matrix4& extrinsics, int width, int height) :
+    T_cw(extrinsics) {
+    setIntrinsics(intrinsics);
+    setImageSize(width, height);
+}
+
+void PinholeCamera::setIntrinsics(const Matrix3& intrinsics) {
+    if ((std::abs(intrinsics[1]) > MYEPSILON) || (std::abs(intrinsics[2]) > MYEPSILON)
+        || (std::abs(intrinsics[5]) > MYEPSILON) || (std::abs(intrinsics[8] - 1) > MYEPSILON)
+        || (std::abs(intrinsics[0]) < MYEPSILON) || (std::abs(intrinsics[4]) < MYEPSILON)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Not a camera matrix.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Not a camera matrix.";
+    }
+    K = intrinsics;
+}
+
+void PinholeCamera::setImageSize(int width, int height) {
+    if ((width < 0) || (height < 0)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Invalid image size.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid image size!";
+    }
+    this->width = width;
+    this->height = height;
+}
+
+bool PinholeCamera::project(const Vector3& p, Vector2& pixel, scalar& depth) const {
+    const scalar* t = T_cw.constData();
+    const scalar x = t[0] * p.x + t[4] * p.y + t[8] * p.z + t[12];
+    const scalar y = t[1] * p.x + t[5] * p.y + t[9] * p.z + t[13];
+    depth = t[2] * p.x + t[6] * p.y + t[10] * p.z + t[14];
+    if (!(depth > 0)) {
+        pixel.set(std::numeric_limits<scalar>::quiet_NaN(), std::numeric_limits<scalar>::quiet_NaN());
+        return false;
+    }
+    const scalar inv_z = 1 / depth;
+    pixel.set(K[0] * x * inv_z + K[3] * y * inv_z + K[6], K[4] * y * inv_z + K[7]);
+    return true;
+}
+
+Vector3 PinholeCamera::unproject(const Vector2& pixel, scalar depth) const {
+    const scalar y = (pixel.y - K[7]) / K[4];
+    const scalar x = (pixel.x - K[6] - K[3] * y) / K[0];
+    return Vector3(x * depth, y * depth, depth);
+}
+
+size_t PinholeCamera::projectPoints(const Vector3* points, size_t n, Vector2* pixels, scalar* depth) const {
+    // fold intrinsics into the first two rows, u = (P0 . p) / z, v = (P1 . p) / z
+    const scalar* t = T_cw.constData();
+    const scalar fx = K[0], s = K[3], cx = K[6], fy = K[4], cy = K[7];
+    scalar P0[4], P1[4], P2[4];
+    for (int c = 0; c < 4; ++c) {
+        P0[c] = fx * t[c * 4] + s * t[c * 4 + 1] + cx * t[c * 4 + 2];
+        P1[c] = fy * t[c * 4 + 1] + cy * t[c * 4 + 2];
+        P2[c] = t[c * 4 + 2];
+    }
+    const scalar nan = std::numeric_limits<scalar>::quiet_NaN();
+    return parallelReduce(size_t(0), n, CAMERA_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        // branch-free so that the loop vectorizes
+        for (size_t i = lo; i < hi; ++i) {
+            const Vector3& p = points[i];
+            const scalar u = P0[0] * p.x + P0[1] * p.y + P0[2] * p.z + P0[3];
+            const scalar v = P1[0] * p.x + P1[1] * p.y + P1[2] * p.z + P1[3];
+            const scalar z = P2[0] * p.x + P2[1] * p.y + P2[2] * p.z + P2[3];
+            const bool front = z > 0;
+            const scalar inv_z = 1 / z;
+            pixels[i].set(front ? u * inv_z : nan, front ? v * inv_z : nan);
+            if (depth) depth[i] = z;
+            count += front;
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
+
+size_t PinholeCamera::renderDepth(const Vector3* points, size_t n, scalar* depthImage) const {
+    if ((width == 0) || (height == 0)) return 0;
+    const size_t tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t tiles = tiles_x * tiles_y;
+    const uint32_t NONE = UINT32_MAX;
+
+    // pass 1: tile and pixel of every point, NONE if outside the image
+    ArenaScope scratch(getThreadArena());
+    Vector2* pixels = scratch.allocateUninitialized<Vector2>(n);
+    scalar* z = scratch.allocateUninitialized<scalar>(n);
+    uint32_t* tile_of = scratch.allocateUninitialized<uint32_t>(n);
+    projectPoints(points, n, pixels, z);
+    const scalar w = static_cast<scalar>(width), h = static_cast<scalar>(height);
+    parallelFor(0, n, CAMERA_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            const Vector2& px = pixels[i];
+            // NaN pixels of points behind the camera fail every comparison
+            if ((px.x >= 0) && (px.x < w) && (px.y >= 0) && (px.y < h)) {
+                const size_t u = static_cast<size_t>(px.x);
+                const size_t v = static_cast<size_t>(px.y);
+                tile_of[i] = static_cast<uint32_t>((v / TILE_SIZE) * tiles_x + u / TILE_SIZE);
+            } else {
+                tile_of[i] = NONE;
+            }
+        }
+    });
+
+    // pass 2: counting sort of point indices by tile, fixed partition keeps it stable
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(getThreadCount(), (n + CAMERA_GRAIN - 1) / CAMERA_GRAIN));
+    size_t* hist = scratch.allocate<size_t>(chunks * tiles);
+    parallelFor(0, chunks, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            size_t* hc = hist + c * tiles;
+            const size_t end = (c + 1) * n / chunks;
+            for (size_t i = c * n / chunks; i < end; ++i) {
+                if (tile_of[i] != NONE) ++hc[tile_of[i]];
+            }
+        }
+    });
+    size_t* tile_start = scratch.allocateUninitialized<size_t>(tiles + 1);
+    size_t offset = 0;
+    for (size_t t = 0; t < tiles; ++t) {
+        tile_start[t] = offset;
+        for (size_t c = 0; c < chunks; ++c) {
+            size_t count = hist[c * tiles + t];
+            hist[c * tiles + t] = offset;
+            offset += count;
+        }
+    }
+    tile_start[tiles] = offset;
+    uint32_t* order = scratch.allocateUninitialized<uint32_t>(offset);
+    parallelFor(0, chunks, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            size_t* hc = hist + c * tiles;
+            const size_t end = (c + 1) * n / chunks;
+            for (size_t i = c * n / chunks; i < end; ++i) {
+                if (tile_of[i] != NONE) order[hc[tile_of[i]]++] = static_cast<uint32_t>(i);
+            }
+        }
+    });
+
+    // pass 3: every tile is cleared, splatted and finalized by its owner only
+    const scalar empty = std::numeric_limits<scalar>::infinity();
+    parallelFor(0, tiles, 1, [&](size_t first, size_t last) {
+        for (size_t t = first; t < last; ++t) {
+            const size_t u0 = (t % tiles_x) * TILE_SIZE, v0 = (t / tiles_x) * TILE_SIZE;
+            const size_t u1 = std::min<size_t>(u0 + TILE_SIZE, width);
+            const size_t v1 = std::min<size_t>(v0 + TILE_SIZE, height);
+            for (size_t v = v0; v < v1; ++v) {
+                std::fill(depthImage + v * width + u0, depthImage + v * width + u1, empty);
+            }
+            for (size_t k = tile_start[t]; k < tile_start[t + 1]; ++k) {
+                const uint32_t i = order[k];
+                const size_t pix = static_cast<size_t>(pixels[i].y) * width + static_cast<size_t>(pixels[i].x);
+                depthImage[pix] = std::min(depthImage[pix], z[i]);
+            }
+            for (size_t v = v0; v < v1; ++v) {
+                for (size_t u = u0; u < u1; ++u) {
+                    if (depthImage[v * width + u] == empty) depthImage[v * width + u] = 0;
+                }
+            }
+        }
+    });
+    return offset;
+}
@@ -0,0 +1,318 @@
+#include "mycloud.hpp"
+#include "myinstrument.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(CloudFileHeader) == 64, "CloudFileHeader must be 64 bytes");
+static_assert(sizeof(CloudChunkInfo) == 72, "CloudChunkInfo must be 72 bytes");
+static_assert(sizeof(Vector3) == 3 * sizeof(scalar), "Vector3 must be packed for zero-copy views");
+
+static const char CLOUD_MAGIC[8] = {'M', 'Y', 'C', 'L', 'O', 'U', 'D', 0};
+static const uint32_t CLOUD_VERSION = 1;
+/** @brief points transposed per write() call of a SOA chunk. */
+static const size_t CLOUD_BATCH = 4096;
+
+/** @brief round up to a multiple of CLOUD_ALIGNMENT. */
+static inline uint64_t alignPayload(uint64_t v) {
+    return (v + CLOUD_ALIGNMENT - 1) & ~uint64_t(CLOUD_ALIGNMENT - 1);
+}
+
+CloudWriter::CloudWriter(const std::string& path, CLOUDLAYOUT layout) :
+    layout(layout) {
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot open %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        MYMATH_COUNT_ERROR();
+        throw "Cannot open file!";
+    }
+    CloudFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    write(&header, sizeof(header));
+}
+
+CloudWriter::~CloudWriter() {
+    if (file) {
+        try {
+            close();
+        } catch (...) {
+            // already reported by close()
+        }
+    }
+}
+
+void CloudWriter::write(const void* data, size_t bytes) {
+    if (fwrite(data, 1, bytes, file) != bytes) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Write error.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Write error!";
+    }
+    position += bytes;
+}
+
+void CloudWriter::pad() {
+    static const unsigned char zeros[CLOUD_ALIGNMENT] = {0};
+    write(zeros, static_cast<size_t>(alignPayload(position) - position));
+}
+
+CloudChunkInfo& CloudWriter::beginChunk(size_t n) {
+    pad();
+    CloudChunkInfo info;
+    info.offset = position;
+    info.count = n;
+    info.first = point_count;
+    for (int k = 0; k < 3; ++k) {
+        info.bounds_min[k] = INFINITY;
+        info.bounds_max[k] = -INFINITY;
+    }
+    chunks.push_back(info);
+    point_count += n;
+    return chunks.back();
+}
+
+void CloudWriter::writeChunk(const Vector3* points, size_t n) {
+    writeChunk(ConstVector3SoA(&points->x, &points->y, &points->z, n), 3);
+}
+
+void CloudWriter::writeChunk(const ConstVector3SoA& points) {
+    writeChunk(points, 1);
+}
+
+void CloudWriter::writeChunk(const ConstVector3SoA& points, size_t stride) {
+    const size_t n = points.size;
+    if (n == 0) return;
+    CloudChunkInfo& info = beginChunk(n);
+    const scalar* axis[3] = {points.x, points.y, points.z};
+    for (size_t i = 0; i < n; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            const double v = axis[k][i * stride];
+            info.bounds_min[k] = std::min(info.bounds_min[k], v);
+            info.bounds_max[k] = std::max(info.bounds_max[k], v);
+        }
+    }
+    if ((layout == AOS) && (stride == 3)) {
+        write(points.x, n * sizeof(Vector3));
+        return;
+    }
+    // gather through a small buffer, the chunk itself is never copied as a whole
+    scalar buffer[3 * CLOUD_BATCH];
+    if (layout == AOS) {
+        for (size_t lo = 0; lo < n; lo += CLOUD_BATCH) {
+            const size_t cnt = std::min(CLOUD_BATCH, n - lo);
+            for (size_t i = 0; i < cnt; ++i) {
+                for (int k = 0; k < 3; ++k) buffer[3 * i + k] = axis[k][(lo + i) * stride];
+            }
+            write(buffer, 3 * cnt * sizeof(scalar));
+        }
+        return;
+    }
+    for (int k = 0; k < 3; ++k) {
+        if (k > 0) pad();
+        if (stride == 1) {
+            write(axis[k], n * sizeof(scalar));
+            continue;
+        }
+        for (size_t lo = 0; lo < n; lo += CLOUD_BATCH) {
+            const size_t cnt = std::min(CLOUD_BATCH, n - lo);
+            for (size_t i = 0; i < cnt; ++i) buffer[i] = axis[k][(lo + i) * stride];
+            write(buffer, cnt * sizeof(scalar));
+        }
+    }
+}
+
+void CloudWriter::close() {
+    if (!file) return;
+    FILE* f = file;
+    try {
+        pad();
+        CloudFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, CLOUD_MAGIC, sizeof(CLOUD_MAGIC));
+        header.version = CLOUD_VERSION;
+        header.layout = layout;
+        header.scalar_size = sizeof(scalar);
+        header.alignment = CLOUD_ALIGNMENT;
+        header.point_count = point_count;
+        header.chunk_count = chunks.size();
+        header.chunk_table = position;
+        if (!chunks.empty()) write(chunks.data(), chunks.size() * sizeof(CloudChunkInfo));
+        if (fseek(f, 0, SEEK_SET) != 0) {
+            fprintf(stderr, "File %s, Line %d, Function %s(): Seek error.\n",
+                    __FILE__, __LINE__, __FUNCTION__);
+            MYMATH_COUNT_ERROR();
+            throw "Seek error!";
+        }
+        write(&header, sizeof(header));
+    } catch (...) {
+        fclose(f);
+        file = nullptr;
+        throw;
+    }
+    file = nullptr;
+    if (fclose(f) != 0) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Write error.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Write error!";
+    }
+}
+
+MappedCloud::~MappedCloud() {
+    close();
+}
+
+void MappedCloud::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot open %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        MYMATH_COUNT_ERROR();
+        throw "Cannot open file!";
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (static_cast<uint64_t>(st.st_size) < sizeof(CloudFileHeader))) {
+        ::close(fd);
+        fprintf(stderr, "File %s, Line %d, Function %s(): Not a cloud file.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Not a cloud file!";
+    }
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot map %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        MYMATH_COUNT_ERROR();
+        throw "Cannot map file!";
+    }
+    base = static_cast<const unsigned char*>(p);
+    length = static_cast<size_t>(st.st_size);
+    header = reinterpret_cast<const CloudFileHeader*>(base);
+
+    // validate everything a view may touch, so that views need only an index check
+    bool valid = (std::memcmp(header->magic, CLOUD_MAGIC, sizeof(CLOUD_MAGIC)) == 0)
+                 && (header->version == CLOUD_VERSION) && (header->layout <= SOA)
+                 && ((header->scalar_size == 4) || (header->scalar_size == 8))
+                 && (header->alignment == CLOUD_ALIGNMENT) && (header->chunk_table % 8 == 0)
+                 && (header->chunk_table <= length)
+                 && (header->chunk_count <= (length - header->chunk_table) / sizeof(CloudChunkInfo));
+    if (valid) {
+        table = reinterpret_cast<const CloudChunkInfo*>(base + header->chunk_table);
+        uint64_t total = 0;
+        for (uint64_t c = 0; valid && (c < header->chunk_count); ++c) {
+            const CloudChunkInfo& info = table[c];
+            // range check the offset and count before any sum, so that nothing can wrap
+            valid = (info.offset % CLOUD_ALIGNMENT == 0) && (info.first == total)
+                    && (info.offset <= header->chunk_table) && (info.count < (uint64_t(1) << 56));
+            if (!valid) break;
+            // payload size from the aligned offset, x y z with the planes aligned for SOA
+            const uint64_t bytes = info.count * header->scalar_size;
+            const uint64_t size = (header->layout == AOS) ? 3 * bytes
+                                                          : alignPayload(alignPayload(bytes) + bytes) + bytes;
+            valid = (size <= header->chunk_table - info.offset);
+            total += info.count;
+        }
+        valid = valid && (total == header->point_count);
+    }
+    if (!valid) {
+        close();
+        fprintf(stderr, "File %s, Line %d, Function %s(): Not a cloud file.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Not a cloud file!";
+    }
+}
+
+void MappedCloud::close() {
+    if (base) munmap(const_cast<unsigned char*>(base), length);
+    base = nullptr;
+    length = 0;
+    header = nullptr;
+    table = nullptr;
+}
+
+const CloudChunkInfo& MappedCloud::checkedChunk(size_t chunk) const {
+    if (!base || (chunk >= header->chunk_count)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Index out of bounds!";
+    }
+    return table[chunk];
+}
+
+const Vector3* MappedCloud::points(size_t chunk) const {
+    const CloudChunkInfo& info = checkedChunk(chunk);
+    if ((header->layout != AOS) || !isZeroCopy()) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): No AOS view of this file.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "No AOS view of this file!";
+    }
+    return reinterpret_cast<const Vector3*>(base + info.offset);
+}
+
+ConstVector3SoA MappedCloud::pointsSoA(size_t chunk) const {
+    const CloudChunkInfo& info = checkedChunk(chunk);
+    if ((header->layout != SOA) || !isZeroCopy()) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): No SOA view of this file.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "No SOA view of this file!";
+    }
+    const uint64_t bytes = info.count * sizeof(scalar);
+    const uint64_t oy = alignPayload(info.offset + bytes);
+    const uint64_t oz = alignPayload(oy + bytes);
+    return ConstVector3SoA(reinterpret_cast<const scalar*>(base + info.offset),
+                           reinterpret_cast<const scalar*>(base + oy),
+                           reinterpret_cast<const scalar*>(base + oz), static_cast<size_t>(info.count));
+}
+
+/** @brief read coordinate i of an array of float or double. */
+static inline scalar loadScalar(const unsigned char* p, uint32_t width, size_t i) {
+    if (width == 4) return static_cast<scalar>(reinterpret_cast<const float*>(p)[i]);
+    return static_cast<scalar>(reinterpret_cast<const double*>(p)[i]);
+}
+
+void MappedCloud::copyChunk(size_t chunk, Vector3* out) const {
+    const CloudChunkInfo& info = checkedChunk(chunk);
+    const uint32_t width = header->scalar_size;
+    const size_t n = static_cast<size_t>(info.count);
+    const unsigned char* p = base + info.offset;
+    if (header->layout == AOS) {
+        if (isZeroCopy()) {
+            std::memcpy(out, p, n * sizeof(Vector3));
+            return;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            out[i].set(loadScalar(p, width, 3 * i), loadScalar(p, width, 3 * i + 1), loadScalar(p, width, 3 * i + 2));
+        }
+        return;
+    }
+    const uint64_t bytes = info.count * width;
+    const unsigned char* py = base + alignPayload(info.offset + bytes);
+    const unsigned char* pz = base + alignPayload(alignPayload(info.offset + bytes) + bytes);
+    for (size_t i = 0; i < n; ++i) {
+        out[i].set(loadScalar(p, width, i), loadScalar(py, width, i), loadScalar(pz, width, i));
+    }
+}
+
+void MappedCloud::prefetch(size_t chunk) const {
+    const CloudChunkInfo& info = checkedChunk(chunk);
+    // madvise needs a page aligned start
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(base + info.offset) & ~(page - 1);
+    const uint64_t bytes = 3 * alignPayload(info.count * header->scalar_size);
+    const uintptr_t end = std::min(reinterpret_cast<uintptr_t>(base + info.offset + bytes),
+                                   reinterpret_cast<uintptr_t>(base + length));
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+}
@@ -0,0 +1,118 @@
+#include "mydepth.hpp"
+#include "myparallel.hpp"
+#include "myinstrument.hpp"
+#include "mytrace.hpp"
+
+#include <limits>
+
+/** @brief rows handled by one parallel task. */
+static const size_t ROW_GRAIN = 8;
+
+bool DepthBackProjector::setCamera(const PinholeCamera& camera) {
+    const Matrix3& intrinsics = camera.getIntrinsics();
+    bool same = (camera.getWidth() == width) && (camera.getHeight() == height);
+    for (int i = 0; same && (i < 9); ++i) {
+        same = (intrinsics[i] == K[i]);
+    }
+    if (same && !ray_x.empty()) return false;
+
+    K = intrinsics;
+    width = camera.getWidth();
+    height = camera.getHeight();
+    ray_x.resize(pixelCount());
+    ray_y.resize(pixelCount());
+    row_offset.resize(height + 1);
+    // invert | fx s cx |, | 0 fy cy | for the pixel centers
+    const scalar fx = K[0], s = K[3], cx = K[6], fy = K[4], cy = K[7];
+    parallelFor(0, height, ROW_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t v = lo; v < hi; ++v) {
+            const scalar y = (static_cast<scalar>(v) + 0.5f - cy) / fy;
+            scalar* rx = ray_x.data() + v * width;
+            scalar* ry = ray_y.data() + v * width;
+            for (int u = 0; u < width; ++u) {
+                rx[u] = (static_cast<scalar>(u) + 0.5f - cx - s * y) / fx;
+                ry[u] = y;
+            }
+        }
+    });
+    return true;
+}
+
+template <typename T>
+size_t DepthBackProjector::run(const T* depth, scalar depthScale, Vector3SoA out,
+                               const Matrix4* camToWorld, bool organized) {
+    const size_t pixels = pixelCount();
+    MYMATH_TRACE_SPAN("DepthBackProjector::backProject", pixels);
+    if (out.size < pixels) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Output buffer too small.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Output buffer too small!";
+    }
+    const scalar inf = std::numeric_limits<scalar>::infinity();
+    const scalar nan = std::numeric_limits<scalar>::quiet_NaN();
+    Matrix4 identity;
+    const scalar* t = (camToWorld ? camToWorld : &identity)->constData();
+    const bool transform = (camToWorld != nullptr);
+
+    if (organized) {
+        parallelFor(0, height, ROW_GRAIN, [&](size_t lo, size_t hi) {
+            for (size_t i = lo * width; i < hi * width; ++i) {
+                // branch-free so that the row vectorizes
+                const scalar d = static_cast<scalar>(depth[i]) * depthScale;
+                const bool valid = (d > 0) && (d < inf);
+                const scalar z = valid ? d : nan;
+                const scalar x = ray_x[i] * z, y = ray_y[i] * z;
+                if (transform) {
+                    out.x[i] = t[0] * x + t[4] * y + t[8] * z + t[12];
+                    out.y[i] = t[1] * x + t[5] * y + t[9] * z + t[13];
+                    out.z[i] = t[2] * x + t[6] * y + t[10] * z + t[14];
+                } else {
+                    out.x[i] = x;
+                    out.y[i] = y;
+                    out.z[i] = z;
+                }
+            }
+        });
+        return pixels;
+    }
+
+    // compact: count per row, scan, then every row writes its own output range
+    parallelFor(0, height, ROW_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t v = lo; v < hi; ++v) {
+            size_t count = 0;
+            for (size_t i = v * width; i < (v + 1) * width; ++i) {
+                const scalar d = static_cast<scalar>(depth[i]) * depthScale;
+                count += (d > 0) && (d < inf);
+            }
+            row_offset[v + 1] = count;
+        }
+    });
+    row_offset[0] = 0;
+    for (int v = 0; v < height; ++v) row_offset[v + 1] += row_offset[v];
+    parallelFor(0, height, ROW_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t v = lo; v < hi; ++v) {
+            size_t k = row_offset[v];
+            for (size_t i = v * width; i < (v + 1) * width; ++i) {
+                const scalar z = static_cast<scalar>(depth[i]) * depthScale;
+                if (!((z > 0) && (z < inf))) continue;
+                const scalar x = ray_x[i] * z, y = ray_y[i] * z;
+                out.x[k] = t[0] * x + t[4] * y + t[8] * z + t[12];
+                out.y[k] = t[1] * x + t[5] * y + t[9] * z + t[13];
+                out.z[k] = t[2] * x + t[6] * y + t[10] * z + t[14];
+                ++k;
+            }
+        }
+    });
+    return row_offset[height];
+}
+
+size_t DepthBackProjector::backProject(const scalar* depth, Vector3SoA out, const Matrix4* camToWorld,
+                                       bool organized) {
+    return run(depth, scalar(1), out, camToWorld, organized);
+}
+
+size_t DepthBackProjector::backProject(const uint16_t* depth, scalar depthScale, Vector3SoA out,
+                                       const Matrix4* camToWorld, bool organized) {
+    return run(depth, depthScale, out, camToWorld, organized);
+}
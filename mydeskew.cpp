@@ -0,0 +1,162 @@
+#include "mydeskew.hpp"
+#include "myinstrument.hpp"
+#include "myparallel.hpp"
+#include "mytrace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+/** @brief points handled by one parallel task. */
+static const size_t DESKEW_GRAIN = 1 << 14;
+/** @brief scalars per bucket, the 3x4 transform at its start and the difference to its end. */
+static const int DESKEW_STRIDE = 24;
+
+ScanDeskewer::ScanDeskewer(int buckets) :
+    buckets(buckets) {
+    if (buckets < 1) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Bucket count %d is not positive.\n",
+                __FILE__, __LINE__, __FUNCTION__, buckets);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid bucket count!";
+    }
+}
+
+/** @brief exception unless startTime < endTime. */
+static void checkInterval(double startTime, double endTime) {
+    if (!(startTime < endTime)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Scan interval [%f, %f] is empty.\n",
+                __FILE__, __LINE__, __FUNCTION__, startTime, endTime);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid scan interval!";
+    }
+}
+
+/** @brief slerp and lerp between two poses, s = 0 at a and 1 at b, the relative rotation by unit axis and angle. */
+static SE3 interpolate(const SE3& a, const SE3& b, const Vector3& axis, scalar angle, double s) {
+    const scalar f = static_cast<scalar>(s);
+    return SE3(a.rotation() * SO3::rotation(axis, angle * f), a.translation() * (1 - f) + b.translation() * f);
+}
+
+void ScanDeskewer::setPoses(const SE3& startPose, const SE3& endPose, double startTime, double endTime,
+                            double referenceTime) {
+    checkInterval(startTime, endTime);
+    const Vector3 w = (startPose.rotation().inverse() * endPose.rotation()).log();
+    const scalar angle = w.length();
+    const Vector3 axis = (angle > 0) ? w * (1 / angle) : Vector3(0, 0, 0);
+    std::vector<SE3> poses(buckets + 1);
+    for (int k = 0; k <= buckets; ++k) poses[k] = interpolate(startPose, endPose, axis, angle, double(k) / buckets);
+    const SE3 reference = interpolate(startPose, endPose, axis, angle,
+                                      (referenceTime - startTime) / (endTime - startTime));
+    build(poses.data(), reference, startTime, endTime);
+}
+
+void ScanDeskewer::setPoses(const Matrix4& startPose, const Matrix4& endPose, double startTime, double endTime,
+                            double referenceTime) {
+    setPoses(SE3(startPose), SE3(endPose), startTime, endTime, referenceTime);
+}
+
+void ScanDeskewer::setTrajectory(const TrajectorySpline& trajectory, double startTime, double endTime,
+                                 double referenceTime) {
+    checkInterval(startTime, endTime);
+    if ((startTime < trajectory.getStartTime()) || (endTime > trajectory.getEndTime())) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Scan interval [%f, %f] is outside the trajectory.\n",
+                __FILE__, __LINE__, __FUNCTION__, startTime, endTime);
+        MYMATH_COUNT_ERROR();
+        throw "Time out of range!";
+    }
+    // the boundaries are sorted, evaluate() walks them segment by segment
+    std::vector<double> times(buckets + 1);
+    for (int k = 0; k <= buckets; ++k) times[k] = startTime + (endTime - startTime) * k / buckets;
+    times[buckets] = endTime;
+    std::vector<SE3> poses(buckets + 1);
+    if (trajectory.evaluate(times.data(), times.size(), poses.data()) != times.size()) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): A bucket boundary is outside the trajectory.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Time out of range!";
+    }
+    const SE3 reference = trajectory.evaluate(referenceTime);
+    build(poses.data(), reference, startTime, endTime);
+}
+
+void ScanDeskewer::build(const SE3* poses, const SE3& reference, double startTime, double endTime) {
+    const SE3 inv = reference.inverse();
+    table.resize(static_cast<size_t>(buckets) * DESKEW_STRIDE);
+    scalar next[12];
+    for (int k = 0; k <= buckets; ++k) {
+        const SE3 rel = inv * poses[k];
+        const scalar* r = rel.rotation().matrix().constData();
+        const Vector3& t = rel.translation();
+        const scalar m[12] = {r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8], t.x, t.y, t.z};
+        if (k > 0) {
+            scalar* e = &table[(k - 1) * DESKEW_STRIDE];
+            for (int j = 0; j < 12; ++j) e[12 + j] = m[j] - next[j];
+        }
+        if (k < buckets) std::copy(m, m + 12, &table[k * DESKEW_STRIDE]);
+        std::copy(m, m + 12, next);
+    }
+    start_time = startTime;
+    end_time = endTime;
+}
+
+/** @brief deskew points [lo, hi) of an AOS or SOA view, returns the number inside the interval. */
+template <typename Points>
+static size_t deskewRange(const scalar* table, int buckets, double startTime, double scale,
+                          Points& points, const double* times, size_t lo, size_t hi) {
+    size_t count = 0;
+    for (size_t i = lo; i < hi; ++i) {
+        double s = (times[i] - startTime) * scale;
+        count += (s >= 0) && (s <= buckets);
+        // clamp, NaN times take the start
+        if (!(s > 0)) s = 0;
+        if (s > buckets) s = buckets;
+        const int k = std::min(static_cast<int>(s), buckets - 1);
+        const scalar f = static_cast<scalar>(s - k);
+        const scalar* e = table + k * DESKEW_STRIDE;
+        scalar m[12];
+        for (int j = 0; j < 12; ++j) m[j] = e[j] + f * e[12 + j];
+        const Vector3 p = points.get(i);
+        points.set(i, Vector3(m[0] * p.x + m[3] * p.y + m[6] * p.z + m[9],
+                              m[1] * p.x + m[4] * p.y + m[7] * p.z + m[10],
+                              m[2] * p.x + m[5] * p.y + m[8] * p.z + m[11]));
+    }
+    return count;
+}
+
+/** @brief Vector3 array with the accessors of Vector3SoA. */
+struct Vector3AoS {
+    Vector3* p;
+
+    Vector3 get(size_t i) const { return p[i]; }
+    void set(size_t i, const Vector3& v) { p[i] = v; }
+};
+
+/** @brief exception if no poses were set. */
+static void checkTable(const std::vector<scalar>& table) {
+    if (table.empty()) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): No poses set.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "No poses set!";
+    }
+}
+
+size_t ScanDeskewer::deskew(Vector3* points, const double* times, size_t n) const {
+    MYMATH_TRACE_SPAN("ScanDeskewer::deskew", n);
+    checkTable(table);
+    const double scale = buckets / (end_time - start_time);
+    Vector3AoS view = {points};
+    return parallelReduce(size_t(0), n, DESKEW_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        total += deskewRange(table.data(), buckets, start_time, scale, view, times, lo, hi);
+    }, std::plus<size_t>());
+}
+
+size_t ScanDeskewer::deskew(Vector3SoA points, const double* times) const {
+    MYMATH_TRACE_SPAN("ScanDeskewer::deskew", points.size);
+    checkTable(table);
+    const double scale = buckets / (end_time - start_time);
+    return parallelReduce(size_t(0), points.size, DESKEW_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        total += deskewRange(table.data(), buckets, start_time, scale, points, times, lo, hi);
+    }, std::plus<size_t>());
+}
@@ -0,0 +1,271 @@
+#include "myformat.hpp"
+#include "myparallel.hpp"
+#include "myinstrument.hpp"
+#include "myrotation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if (__cplusplus >= 201703L) && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+#define MYFORMAT_TO_CHARS
+#endif
+
+/** @brief rows formatted by one parallel task of the writers. */
+static const size_t ROWS_PER_BLOCK = 4096;
+/** @brief blocks formatted before they are written, bounds the text held in memory. */
+static const size_t WRITE_BATCH = 16;
+
+/** @brief copy [src, src + len) to first, nullptr if it does not fit. */
+static inline char* copyChars(char* first, char* last, const char* src, size_t len) {
+    if (!first || (static_cast<size_t>(last - first) < len)) return nullptr;
+    std::memcpy(first, src, len);
+    return first + len;
+}
+
+static inline char* putChar(char* first, char* last, char c) {
+    if (!first || (first == last)) return nullptr;
+    *first = c;
+    return first + 1;
+}
+
+#ifndef MYFORMAT_TO_CHARS
+/** @brief snprintf() through a local buffer, the result is cut if longer than FORMAT_BUFFER_SIZE. */
+template <typename T>
+static inline int printTo(char (&buffer)[FORMAT_BUFFER_SIZE], const char* format, int precision, T value) {
+    const int len = snprintf(buffer, FORMAT_BUFFER_SIZE, format, precision, value);
+    return std::min(len, FORMAT_BUFFER_SIZE - 1);
+}
+#endif
+
+char* formatShortest(char* first, char* last, double value) {
+#ifdef MYFORMAT_TO_CHARS
+    const std::to_chars_result r = std::to_chars(first, last, value);
+    return (r.ec == std::errc()) ? r.ptr : nullptr;
+#else
+    // the nearest 15 digit decimal is the shortest one if any of at most 15 digits reads back,
+    // longer ones are tried until the value reads back, subnormals hold fewer digits and
+    // start from one
+    const bool subnormal = (value != 0) && (std::fabs(value) < std::numeric_limits<double>::min());
+    char buffer[FORMAT_BUFFER_SIZE];
+    int len = 0;
+    for (int precision = subnormal ? 1 : 15; precision <= 17; ++precision) {
+        len = printTo(buffer, "%.*g", precision, value);
+        if (!std::isfinite(value) || (strtod(buffer, nullptr) == value)) break;
+    }
+    return copyChars(first, last, buffer, len);
+#endif
+}
+
+char* formatShortest(char* first, char* last, float value) {
+#ifdef MYFORMAT_TO_CHARS
+    const std::to_chars_result r = std::to_chars(first, last, value);
+    return (r.ec == std::errc()) ? r.ptr : nullptr;
+#else
+    const bool subnormal = (value != 0) && (std::fabs(value) < std::numeric_limits<float>::min());
+    char buffer[FORMAT_BUFFER_SIZE];
+    int len = 0;
+    for (int precision = subnormal ? 1 : 6; precision <= 9; ++precision) {
+        len = printTo(buffer, "%.*g", precision, static_cast<double>(value));
+        if (!std::isfinite(value) || (strtof(buffer, nullptr) == value)) break;
+    }
+    return copyChars(first, last, buffer, len);
+#endif
+}
+
+char* formatFixed(char* first, char* last, double value, int precision) {
+    precision = std::max(0, std::min(precision, 40));
+#ifdef MYFORMAT_TO_CHARS
+    const std::to_chars_result r = std::to_chars(first, last, value, std::chars_format::fixed, precision);
+    return (r.ec == std::errc()) ? r.ptr : nullptr;
+#else
+    static const double POW10[16] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                     1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    if (std::isfinite(value) && (precision < 16)) {
+        // scaled carries a relative error of at most 2^-53, the rounding is unambiguous
+        // unless the fraction is that close to one half
+        const double scaled = std::fabs(value) * POW10[precision];
+        if (scaled < 4503599627370496.0) {
+            const double whole = std::floor(scaled);
+            const double fraction = scaled - whole;
+            if (std::fabs(fraction - 0.5) > scaled * 2.3e-16 + 1e-300) {
+                uint64_t digits = static_cast<uint64_t>(whole) + (fraction > 0.5 ? 1 : 0);
+                char buffer[48];
+                char* p = buffer + sizeof(buffer);
+                for (int i = 0; i < precision; ++i, digits /= 10) *--p = static_cast<char>('0' + digits % 10);
+                if (precision > 0) *--p = '.';
+                do {
+                    *--p = static_cast<char>('0' + digits % 10);
+                    digits /= 10;
+                } while (digits > 0);
+                if (std::signbit(value)) *--p = '-';
+                return copyChars(first, last, p, buffer + sizeof(buffer) - p);
+            }
+        }
+    }
+    char buffer[FORMAT_BUFFER_SIZE];
+    const int len = printTo(buffer, "%.*f", precision, value);
+    return copyChars(first, last, buffer, len);
+#endif
+}
+
+char* formatScalar(char* first, char* last, scalar value, int precision) {
+    if (!first) return nullptr;
+    if (precision < 0) return formatShortest(first, last, value);
+    return formatFixed(first, last, static_cast<double>(value), precision);
+}
+
+/** @brief write "(v[0], v[1], ...)". */
+static char* formatTuple(char* first, char* last, const scalar* v, int n, int precision) {
+    first = putChar(first, last, '(');
+    for (int i = 0; i < n; ++i) {
+        if (i > 0) {
+            first = putChar(first, last, ',');
+            first = putChar(first, last, ' ');
+        }
+        first = formatScalar(first, last, v[i], precision);
+    }
+    return putChar(first, last, ')');
+}
+
+char* formatVector(char* first, char* last, const Vector2& vec, int precision) {
+    const scalar v[2] = {vec.x, vec.y};
+    return formatTuple(first, last, v, 2, precision);
+}
+
+char* formatVector(char* first, char* last, const Vector3& vec, int precision) {
+    const scalar v[3] = {vec.x, vec.y, vec.z};
+    return formatTuple(first, last, v, 3, precision);
+}
+
+char* formatVector(char* first, char* last, const Vector4& vec, int precision) {
+    const scalar v[4] = {vec.x, vec.y, vec.z, vec.w};
+    return formatTuple(first, last, v, 4, precision);
+}
+
+/** @brief write a column major n x n matrix, fixed numbers right aligned in width 10. */
+static char* formatSquare(char* first, char* last, const scalar* m, int n, int precision) {
+    char number[FORMAT_BUFFER_SIZE];
+    for (int r = 0; r < n; ++r) {
+        first = putChar(first, last, '[');
+        for (int c = 0; c < n; ++c) {
+            if (c > 0) first = putChar(first, last, ' ');
+            const char* end = formatFixed(number, number + sizeof(number), m[c * n + r], precision);
+            const size_t len = end - number;
+            for (size_t pad = len; pad < 10; ++pad) first = putChar(first, last, ' ');
+            first = copyChars(first, last, number, len);
+        }
+        first = putChar(first, last, ']');
+        first = putChar(first, last, '\n');
+    }
+    return first;
+}
+
+char* formatMatrix(char* first, char* last, const Matrix2& mat2, int precision) {
+    const scalar m[4] = {mat2[0], mat2[1], mat2[2], mat2[3]};
+    return formatSquare(first, last, m, 2, precision);
+}
+
+char* formatMatrix(char* first, char* last, const Matrix3& mat3, int precision) {
+    return formatSquare(first, last, mat3.constData(), 3, precision);
+}
+
+char* formatMatrix(char* first, char* last, const Matrix4& mat4, int precision) {
+    return formatSquare(first, last, mat4.constData(), 4, precision);
+}
+
+/**
+ * @brief format n rows in parallel blocks and write them in order.
+ * @param RowBytes upper bound of the length of one row.
+ * @param row char* row(char* first, char* last, size_t i), writes row i.
+ * @note a row is formatted on the stack and appended to the text of its block, the block
+ * @note buffers only grow to the written length and are reused by every batch, so the
+ * @note peak memory is WRITE_BATCH blocks of text whatever the thread count.
+ */
+template <size_t RowBytes, typename RowFormatter>
+static void writeRows(const std::string& path, size_t n, RowFormatter row) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot open %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        MYMATH_COUNT_ERROR();
+        throw "Cannot open file!";
+    }
+    const size_t blocks = (n + ROWS_PER_BLOCK - 1) / ROWS_PER_BLOCK;
+    std::vector<std::vector<char>> text(std::min(WRITE_BATCH, blocks));
+    bool ok = true;
+    for (size_t b0 = 0; ok && (b0 < blocks); b0 += WRITE_BATCH) {
+        const size_t b1 = std::min(blocks, b0 + WRITE_BATCH);
+        parallelFor(b0, b1, 1, [&](size_t lo, size_t hi) {
+            char line[RowBytes];
+            for (size_t b = lo; b < hi; ++b) {
+                std::vector<char>& out = text[b - b0];
+                out.clear();
+                const size_t first = b * ROWS_PER_BLOCK;
+                const size_t last = std::min(n, first + ROWS_PER_BLOCK);
+                for (size_t i = first; i < last; ++i) {
+                    char* end = row(line, line + RowBytes, i);
+                    out.insert(out.end(), line, end);
+                }
+            }
+        });
+        for (size_t b = b0; ok && (b < b1); ++b) {
+            ok = (fwrite(text[b - b0].data(), 1, text[b - b0].size(), file) == text[b - b0].size());
+        }
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Write error on %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        MYMATH_COUNT_ERROR();
+        throw "Write error!";
+    }
+}
+
+/** @brief write values separated by blanks and a newline. */
+static inline char* formatLine(char* first, char* last, const scalar* v, int n, int precision) {
+    for (int i = 0; i < n; ++i) {
+        if (i > 0) first = putChar(first, last, ' ');
+        first = formatScalar(first, last, v[i], precision);
+    }
+    return putChar(first, last, '\n');
+}
+
+void writePoints(const std::string& path, const Vector3* points, size_t n, int precision) {
+    writeRows<3 * FORMAT_BUFFER_SIZE>(path, n, [&](char* first, char* last, size_t i) {
+        const scalar v[3] = {points[i].x, points[i].y, points[i].z};
+        return formatLine(first, last, v, 3, precision);
+    });
+}
+
+void writeTUM(const std::string& path, const double* timestamps, const Matrix4* poses, size_t n,
+              int precision) {
+    writeRows<8 * FORMAT_BUFFER_SIZE>(path, n, [&](char* first, char* last, size_t i) {
+        const Matrix4& p = poses[i];
+        const Vector4 q = rotationToQuaternion(Matrix3(p[0], p[1], p[2], p[4], p[5], p[6], p[8], p[9], p[10]));
+        const scalar v[7] = {p[12], p[13], p[14], q.x, q.y, q.z, q.w};
+        first = formatFixed(first, last, timestamps[i], 6);
+        first = putChar(first, last, ' ');
+        return formatLine(first, last, v, 7, precision);
+    });
+}
+
+void writeKITTI(const std::string& path, const Matrix4* poses, size_t n, int precision) {
+    writeRows<12 * FORMAT_BUFFER_SIZE>(path, n, [&](char* first, char* last, size_t i) {
+        const Matrix4& p = poses[i];
+        const scalar v[12] = {p[0], p[4], p[8], p[12],
+                              p[1], p[5], p[9], p[13],
+                              p[2], p[6], p[10], p[14]};
+        return formatLine(first, last, v, 12, precision);
+    });
+}
@@ -0,0 +1,198 @@
+#include "myfrustum.hpp"
+#include "myparallel.hpp"
+#include "myinstrument.hpp"
+
+#include <algorithm>
+#include <vector>
+
+/** @brief mask words handled by one parallel task. */
+static const size_t CULL_GRAIN = 256;
+
+Frustum::Frustum() {
+    for (int i = 0; i < 6; ++i) {
+        planes[i].set(0, 0, 0, 1);
+        nx[i] = ny[i] = nz[i] = 0;
+        nd[i] = 1;
+    }
+}
+
+Frustum::Frustum(const Matrix4& viewProjection, CLIPDEPTH depth) {
+    set(viewProjection, depth);
+}
+
+void Frustum::set(const Matrix4& viewProjection, CLIPDEPTH depth) {
+    const Vector4 r0 = viewProjection.getRow(0);
+    const Vector4 r1 = viewProjection.getRow(1);
+    const Vector4 r2 = viewProjection.getRow(2);
+    const Vector4 r3 = viewProjection.getRow(3);
+    planes[0] = r3 + r0; // left
+    planes[1] = r3 - r0; // right
+    planes[2] = r3 + r1; // bottom
+    planes[3] = r3 - r1; // top
+    planes[4] = (depth == ZERO_TO_ONE) ? r2 : r3 + r2; // near
+    planes[5] = r3 - r2; // far
+    for (int i = 0; i < 6; ++i) {
+        scalar len = Vector3(planes[i].x, planes[i].y, planes[i].z).length();
+        if (len < MYEPSILON) {
+            planes[i].set(0, 0, 0, 1);
+        } else {
+            planes[i] /= len;
+        }
+        nx[i] = planes[i].x;
+        ny[i] = planes[i].y;
+        nz[i] = planes[i].z;
+        nd[i] = planes[i].w;
+    }
+}
+
+const Vector4& Frustum::getPlane(int index) const {
+    if ((index > 5) || (index < 0)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Index out of bounds!";
+    }
+    return planes[index];
+}
+
+bool Frustum::containsPoint(const Vector3& p) const {
+    for (int i = 0; i < 6; ++i) {
+        if (nx[i] * p.x + ny[i] * p.y + nz[i] * p.z + nd[i] < 0) return false;
+    }
+    return true;
+}
+
+CONTAINMENT Frustum::classifySphere(const Vector3& center, scalar radius) const {
+    CONTAINMENT ret = INSIDE;
+    for (int i = 0; i < 6; ++i) {
+        scalar dist = nx[i] * center.x + ny[i] * center.y + nz[i] * center.z + nd[i];
+        if (dist < -radius) return OUTSIDE;
+        if (dist < radius) ret = INTERSECT;
+    }
+    return ret;
+}
+
+CONTAINMENT Frustum::classifyAABB(const Vector3& boxMin, const Vector3& boxMax) const {
+    uint8_t mask = 0x3f;
+    return classifyAABB(boxMin, boxMax, mask);
+}
+
+CONTAINMENT Frustum::classifyAABB(const Vector3& boxMin, const Vector3& boxMax, uint8_t& planeMask) const {
+    // center / half extent form: the box reaches r = |n| . e along the plane normal
+    const scalar cx = (boxMin.x + boxMax.x) * 0.5f;
+    const scalar cy = (boxMin.y + boxMax.y) * 0.5f;
+    const scalar cz = (boxMin.z + boxMax.z) * 0.5f;
+    const scalar ex = (boxMax.x - boxMin.x) * 0.5f;
+    const scalar ey = (boxMax.y - boxMin.y) * 0.5f;
+    const scalar ez = (boxMax.z - boxMin.z) * 0.5f;
+    for (int i = 0; i < 6; ++i) {
+        if (!(planeMask & (1u << i))) continue;
+        scalar dist = nx[i] * cx + ny[i] * cy + nz[i] * cz + nd[i];
+        scalar r = std::abs(nx[i]) * ex + std::abs(ny[i]) * ey + std::abs(nz[i]) * ez;
+        if (dist < -r) return OUTSIDE;
+        if (dist >= r) planeMask &= static_cast<uint8_t>(~(1u << i));
+    }
+    return (planeMask == 0) ? INSIDE : INTERSECT;
+}
+
+size_t Frustum::cullAABBs(const Vector3* boxMin, const Vector3* boxMax, size_t n, uint64_t* visible) const {
+    const size_t words = (n + 63) / 64;
+    scalar ax[6], ay[6], az[6];
+    for (int i = 0; i < 6; ++i) {
+        ax[i] = std::abs(nx[i]);
+        ay[i] = std::abs(ny[i]);
+        az[i] = std::abs(nz[i]);
+    }
+    std::vector<size_t> counts(words);
+    parallelFor(0, words, CULL_GRAIN, [&](size_t lo, size_t hi) {
+        unsigned char vis[64];
+        for (size_t w = lo; w < hi; ++w) {
+            const size_t base = w * 64;
+            const size_t cnt = std::min<size_t>(64, n - base);
+            // branch-free over the boxes of one word so that the loop vectorizes
+            for (size_t j = 0; j < cnt; ++j) {
+                const Vector3& a = boxMin[base + j];
+                const Vector3& b = boxMax[base + j];
+                const scalar cx = (a.x + b.x) * 0.5f, ex = (b.x - a.x) * 0.5f;
+                const scalar cy = (a.y + b.y) * 0.5f, ey = (b.y - a.y) * 0.5f;
+                const scalar cz = (a.z + b.z) * 0.5f, ez = (b.z - a.z) * 0.5f;
+                bool v = true;
+                for (int i = 0; i < 6; ++i) {
+                    v &= (nx[i] * cx + ny[i] * cy + nz[i] * cz + nd[i]
+                          + ax[i] * ex + ay[i] * ey + az[i] * ez) >= 0;
+                }
+                vis[j] = v;
+            }
+            uint64_t bits = 0;
+            size_t count = 0;
+            for (size_t j = 0; j < cnt; ++j) {
+                bits |= static_cast<uint64_t>(vis[j]) << j;
+                count += vis[j];
+            }
+            visible[w] = bits;
+            counts[w] = count;
+        }
+    });
+    size_t total = 0;
+    for (size_t c : counts) total += c;
+    return total;
+}
+
+size_t Frustum::cullSpheres(const Vector3* center, const scalar* radius, size_t n, uint64_t* visible) const {
+    const size_t words = (n + 63) / 64;
+    std::vector<size_t> counts(words);
+    parallelFor(0, words, CULL_GRAIN, [&](size_t lo, size_t hi) {
+        unsigned char vis[64];
+        for (size_t w = lo; w < hi; ++w) {
+            const size_t base = w * 64;
+            const size_t cnt = std::min<size_t>(64, n - base);
+            for (size_t j = 0; j < cnt; ++j) {
+                const Vector3& c = center[base + j];
+                const scalar r = radius[base + j];
+                bool v = true;
+                for (int i = 0; i < 6; ++i) {
+                    v &= (nx[i] * c.x + ny[i] * c.y + nz[i] * c.z + nd[i] + r) >= 0;
+                }
+                vis[j] = v;
+            }
+            uint64_t bits = 0;
+            size_t count = 0;
+            for (size_t j = 0; j < cnt; ++j) {
+                bits |= static_cast<uint64_t>(vis[j]) << j;
+                count += vis[j];
+            }
+            visible[w] = bits;
+            counts[w] = count;
+        }
+    });
+    size_t total = 0;
+    for (size_t c : counts) total += c;
+    return total;
+}
+
+size_t Frustum::cullHierarchy(const Vector3* boxMin, const Vector3* boxMax, const int32_t* parent,
+                              size_t n, uint64_t* visible, uint64_t* inside) const {
+    // per node: planes still straddled, 0x80 marks OUTSIDE
+    const uint8_t CULLED = 0x80;
+    std::vector<uint8_t> mask(n);
+    const size_t words = (n + 63) / 64;
+    std::fill(visible, visible + words, 0);
+    if (inside) std::fill(inside, inside + words, 0);
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t m = (parent[i] < 0) ? uint8_t(0x3f) : mask[parent[i]];
+        if (m == CULLED) {
+            mask[i] = CULLED;
+            continue;
+        }
+        if ((m != 0) && (classifyAABB(boxMin[i], boxMax[i], m) == OUTSIDE)) {
+            mask[i] = CULLED;
+            continue;
+        }
+        mask[i] = m;
+        visible[i / 64] |= uint64_t(1) << (i % 64);
+        if (inside && (m == 0)) inside[i / 64] |= uint64_t(1) << (i % 64);
+        ++total;
+    }
+    return total;
+}
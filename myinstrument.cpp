@@ -0,0 +1,231 @@
+#include "myinstrument.hpp"
+
+#include <cstdio>
+
+#ifdef MYMATH_INSTRUMENT
+#include <mutex>
+#endif
+
+static const char* INSTRUMENT_NAMES[INSTR_POINT_COUNT] = {
+    "Matrix4::inverse", "Matrix4::computeInverse", "Matrix4::isInversed",
+    "Matrix4::matmul",  "Vector3::normalized",     "Vector3::normalize"};
+
+const char* getInstrumentName(INSTRUMENTPOINT point) {
+    return INSTRUMENT_NAMES[point];
+}
+
+#ifdef MYMATH_INSTRUMENT
+
+thread_local InstrumentBlock* instrument_block = nullptr;
+
+/** @brief plain totals, used for exited threads and the reset baseline. */
+struct InstrumentTotals {
+    uint64_t calls[INSTR_POINT_COUNT] = {};
+    uint64_t ticks[INSTR_POINT_COUNT] = {};
+    uint64_t errors[INSTR_MAX_ERROR_SITES] = {};
+
+    void add(const InstrumentBlock& b) {
+        for (int i = 0; i < INSTR_POINT_COUNT; ++i) {
+            calls[i] += b.calls[i].load(std::memory_order_relaxed);
+            ticks[i] += b.ticks[i].load(std::memory_order_relaxed);
+        }
+        for (int i = 0; i < INSTR_MAX_ERROR_SITES; ++i) errors[i] += b.errors[i].load(std::memory_order_relaxed);
+    }
+};
+
+struct InstrumentSite {
+    const char* file;
+    int line;
+    const char* function;
+};
+
+struct InstrumentRegistry {
+    std::mutex mutex;
+    std::vector<InstrumentBlock*> blocks;
+    std::vector<InstrumentSite> sites;
+    /** @brief counts of exited threads. */
+    InstrumentTotals retired;
+    /** @brief totals at the last reset. */
+    InstrumentTotals base;
+
+    /** @brief totals of all threads, call with the mutex held. */
+    InstrumentTotals sum() const {
+        InstrumentTotals t = retired;
+        for (const InstrumentBlock* b : blocks) t.add(*b);
+        return t;
+    }
+};
+
+/** @brief never destroyed, threads may exit after static destruction began. */
+static InstrumentRegistry& getRegistry() {
+    static InstrumentRegistry* registry = new InstrumentRegistry();
+    return *registry;
+}
+
+/** @brief folds the block of an exiting thread into the retired totals. */
+struct InstrumentOwner {
+    InstrumentBlock* block = nullptr;
+
+    ~InstrumentOwner() {
+        if (!block) return;
+        InstrumentRegistry& r = getRegistry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.retired.add(*block);
+            for (size_t i = 0; i < r.blocks.size(); ++i) {
+                if (r.blocks[i] == block) {
+                    r.blocks[i] = r.blocks.back();
+                    r.blocks.pop_back();
+                    break;
+                }
+            }
+        }
+        instrument_block = nullptr;
+        delete block;
+    }
+};
+
+InstrumentBlock& acquireInstrumentBlock() {
+    static thread_local InstrumentOwner owner;
+    InstrumentBlock* block = new InstrumentBlock();
+    for (int i = 0; i < INSTR_POINT_COUNT; ++i) {
+        block->calls[i].store(0, std::memory_order_relaxed);
+        block->ticks[i].store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < INSTR_MAX_ERROR_SITES; ++i) block->errors[i].store(0, std::memory_order_relaxed);
+    InstrumentRegistry& r = getRegistry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.blocks.push_back(block);
+    }
+    owner.block = block;
+    instrument_block = block;
+    return *block;
+}
+
+int registerInstrumentSite(const char* file, int line, const char* function) {
+    InstrumentRegistry& r = getRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.sites.size() >= static_cast<size_t>(INSTR_MAX_ERROR_SITES)) return INSTR_MAX_ERROR_SITES - 1;
+    InstrumentSite site = {file, line, function};
+    r.sites.push_back(site);
+    return static_cast<int>(r.sites.size()) - 1;
+}
+
+InstrumentSnapshot getInstrumentSnapshot() {
+    InstrumentRegistry& r = getRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const InstrumentTotals t = r.sum();
+    InstrumentSnapshot s;
+    s.enabled = true;
+#ifdef MYMATH_INSTRUMENT_CYCLES
+#if defined(__x86_64__) || defined(__i386__)
+    s.timer = "tsc";
+#else
+    s.timer = "ns";
+#endif
+#else
+    s.timer = "none";
+#endif
+    for (int i = 0; i < INSTR_POINT_COUNT; ++i) {
+        InstrumentCount c;
+        c.name = INSTRUMENT_NAMES[i];
+        c.calls = t.calls[i] - r.base.calls[i];
+        c.ticks = t.ticks[i] - r.base.ticks[i];
+        s.operations.push_back(c);
+    }
+    for (size_t i = 0; i < r.sites.size(); ++i) {
+        const uint64_t count = t.errors[i] - r.base.errors[i];
+        if (count == 0) continue;
+        InstrumentError e;
+        e.file = r.sites[i].file;
+        e.line = r.sites[i].line;
+        e.function = r.sites[i].function;
+        e.count = count;
+        s.errors.push_back(e);
+    }
+    return s;
+}
+
+void resetInstrumentCounters() {
+    InstrumentRegistry& r = getRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.base = r.sum();
+}
+
+#else
+
+InstrumentSnapshot getInstrumentSnapshot() {
+    InstrumentSnapshot s;
+    s.timer = "none";
+    for (int i = 0; i < INSTR_POINT_COUNT; ++i) {
+        InstrumentCount c;
+        c.name = INSTRUMENT_NAMES[i];
+        s.operations.push_back(c);
+    }
+    return s;
+}
+
+void resetInstrumentCounters() {}
+
+#endif
+
+/** @brief append a string literal, escaping quotes, backslashes and control characters. */
+static void appendString(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        if ((c == '"') || (c == '\\')) {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+            out += buffer;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+std::string getInstrumentJSON() {
+    const InstrumentSnapshot s = getInstrumentSnapshot();
+    std::string out = "{\n  \"enabled\": ";
+    out += s.enabled ? "true" : "false";
+    out += ",\n  \"timer\": ";
+    appendString(out, s.timer);
+    out += ",\n  \"operations\": [";
+    for (size_t i = 0; i < s.operations.size(); ++i) {
+        const InstrumentCount& c = s.operations[i];
+        out += (i > 0) ? ",\n    {\"name\": " : "\n    {\"name\": ";
+        appendString(out, c.name);
+        out += ", \"calls\": " + std::to_string(c.calls) + ", \"ticks\": " + std::to_string(c.ticks) + "}";
+    }
+    out += "\n  ],\n  \"errors\": [";
+    for (size_t i = 0; i < s.errors.size(); ++i) {
+        const InstrumentError& e = s.errors[i];
+        out += (i > 0) ? ",\n    {\"file\": " : "\n    {\"file\": ";
+        appendString(out, e.file);
+        out += ", \"line\": " + std::to_string(e.line) + ", \"function\": ";
+        appendString(out, e.function);
+        out += ", \"count\": " + std::to_string(e.count) + "}";
+    }
+    out += s.errors.empty() ? "]\n}\n" : "\n  ]\n}\n";
+    return out;
+}
+
+void writeInstrumentJSON(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot open %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        throw "Cannot open file!";
+    }
+    const std::string json = getInstrumentJSON();
+    fwrite(json.data(), 1, json.size(), file);
+    if (fclose(file) != 0) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Write error on %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        throw "Write error!";
+    }
+}
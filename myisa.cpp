@@ -0,0 +1,508 @@
+#include "myisa.hpp"
+#include "myrotation.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && !defined(USING_FLOAT64)
+#define MYISA_X86
+#include <immintrin.h>
+#endif
+
+// AVX-512 has fused multiply-add, contracting a * b + c into it changes the rounding,
+// every variant has to round like the scalar one.
+#ifdef __clang__
+#pragma clang fp contract(off)
+#else
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+/** @brief out[i] = mat * in[i], the reference every variant rounds like. */
+static inline void transformScalar(const scalar* a, const Vector3* in, size_t n, Vector3* out) {
+    for (size_t i = 0; i < n; ++i) {
+        const scalar x = in[i].x, y = in[i].y, z = in[i].z;
+        out[i].set(a[0] * x + a[4] * y + a[8] * z + a[12],
+                   a[1] * x + a[5] * y + a[9] * z + a[13],
+                   a[2] * x + a[6] * y + a[10] * z + a[14]);
+    }
+}
+
+static inline void boundsScalar(const Vector3* points, size_t n, Vector3& boxMin, Vector3& boxMax) {
+    scalar x0 = boxMin.x, x1 = boxMax.x;
+    scalar y0 = boxMin.y, y1 = boxMax.y;
+    scalar z0 = boxMin.z, z1 = boxMax.z;
+    // (p < lo) ? p : lo, a NaN coordinate never replaces the bound
+    for (size_t i = 0; i < n; ++i) {
+        x0 = (points[i].x < x0) ? points[i].x : x0;
+        x1 = (points[i].x > x1) ? points[i].x : x1;
+        y0 = (points[i].y < y0) ? points[i].y : y0;
+        y1 = (points[i].y > y1) ? points[i].y : y1;
+        z0 = (points[i].z < z0) ? points[i].z : z0;
+        z1 = (points[i].z > z1) ? points[i].z : z1;
+    }
+    boxMin.set(x0, y0, z0);
+    boxMax.set(x1, y1, z1);
+}
+
+/** @brief write NaN to a matrix the batch inverse refused. */
+static inline void setNaN(scalar* m) {
+    for (int k = 0; k < 16; ++k) m[k] = std::numeric_limits<scalar>::quiet_NaN();
+}
+
+static inline size_t invertScalar(const Matrix4* in, size_t n, Matrix4* out) {
+    size_t inverted = 0;
+    for (size_t i = 0; i < n; ++i) {
+        // Laplace expansion over 2x2 minors of the first and last two columns
+        const scalar* m = in[i].constData();
+        const scalar s0 = m[0] * m[5] - m[4] * m[1];
+        const scalar s1 = m[0] * m[6] - m[4] * m[2];
+        const scalar s2 = m[0] * m[7] - m[4] * m[3];
+        const scalar s3 = m[1] * m[6] - m[5] * m[2];
+        const scalar s4 = m[1] * m[7] - m[5] * m[3];
+        const scalar s5 = m[2] * m[7] - m[6] * m[3];
+        const scalar c5 = m[10] * m[15] - m[14] * m[11];
+        const scalar c4 = m[9] * m[15] - m[13] * m[11];
+        const scalar c3 = m[9] * m[14] - m[13] * m[10];
+        const scalar c2 = m[8] * m[15] - m[12] * m[11];
+        const scalar c1 = m[8] * m[14] - m[12] * m[10];
+        const scalar c0 = m[8] * m[13] - m[12] * m[9];
+        const scalar det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        scalar r[16];
+        if (!(std::abs(det) >= MYEPSILON)) {
+            setNaN(out[i].data());
+            continue;
+        }
+        const scalar inv = 1 / det;
+        r[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * inv;
+        r[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * inv;
+        r[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * inv;
+        r[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * inv;
+        r[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * inv;
+        r[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * inv;
+        r[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * inv;
+        r[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * inv;
+        r[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * inv;
+        r[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * inv;
+        r[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * inv;
+        r[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * inv;
+        r[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * inv;
+        r[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * inv;
+        r[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * inv;
+        r[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * inv;
+        out[i].set(r);
+        ++inverted;
+    }
+    return inverted;
+}
+
+/** @brief same arithmetic as quaternionMatrix() of myrotation.cpp, every variant rounds like it. */
+static inline size_t toRotationsScalar(const Vector4* q, size_t n, Matrix3* out) {
+    size_t valid = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const scalar x = q[i].x, y = q[i].y, z = q[i].z, w = q[i].w;
+        const scalar n2 = x * x + y * y + z * z + w * w;
+        scalar* m = out[i].data();
+        const scalar s = 2 / n2;
+        const scalar xx = s * x * x, yy = s * y * y, zz = s * z * z;
+        const scalar xy = s * x * y, xz = s * x * z, yz = s * y * z;
+        const scalar wx = s * w * x, wy = s * w * y, wz = s * w * z;
+        m[0] = 1 - yy - zz;
+        m[1] = xy + wz;
+        m[2] = xz - wy;
+        m[3] = xy - wz;
+        m[4] = 1 - xx - zz;
+        m[5] = yz + wx;
+        m[6] = xz + wy;
+        m[7] = yz - wx;
+        m[8] = 1 - xx - yy;
+        bool finite = true;
+        for (int k = 0; k < 9; ++k) finite &= std::isfinite(m[k]);
+        if ((n2 >= MYEPSILON * MYEPSILON) && finite) {
+            ++valid;
+        } else {
+            for (int k = 0; k < 9; ++k) m[k] = std::numeric_limits<scalar>::quiet_NaN();
+        }
+    }
+    return valid;
+}
+
+/** @brief Shepperd's method in double by rotationToQuaternion(), non-finite matrices become NaN. */
+static inline size_t toQuaternionsScalar(const Matrix3* in, size_t n, Vector4* out) {
+    const scalar nan = std::numeric_limits<scalar>::quiet_NaN();
+    size_t finite = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const scalar* m = in[i].constData();
+        bool ok = true;
+        for (int k = 0; k < 9; ++k) ok &= std::isfinite(m[k]);
+        if (ok) {
+            out[i] = rotationToQuaternion(in[i]);
+            ++finite;
+        } else {
+            out[i].set(nan, nan, nan, nan);
+        }
+    }
+    return finite;
+}
+
+static const BatchKernels SCALAR_KERNELS = {ISA_SCALAR, transformScalar, boundsScalar, invertScalar,
+                                            toRotationsScalar, toQuaternionsScalar};
+
+#ifdef MYISA_X86
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 must be three packed floats");
+static_assert(sizeof(Matrix4) == 16 * sizeof(float), "Matrix4 must be sixteen packed floats");
+static_assert(sizeof(Vector4) == 4 * sizeof(float), "Vector4 must be four packed floats");
+
+// Every level defines an Ops struct of one register width and compiles the kernels of
+// myisakernels.hpp for it, in a namespace of its own. Ops and kernels of a level are in
+// one target region, so vectors only pass between functions of the same target, also
+// where the compiler does not inline (-O0). The AVX-512 intrinsics of GCC 12 fill unused
+// results from _mm512_undefined_ps(), which -Wmaybe-uninitialized reports.
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+#define MYISA_PRAGMA(x) _Pragma(#x)
+#ifdef __clang__
+#define MYISA_TARGET_BEGIN(isa) MYISA_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define MYISA_TARGET_END() MYISA_PRAGMA(clang attribute pop)
+#else
+#define MYISA_TARGET_BEGIN(isa) MYISA_PRAGMA(GCC push_options) MYISA_PRAGMA(GCC target(isa))
+#define MYISA_TARGET_END() MYISA_PRAGMA(GCC pop_options)
+#endif
+
+/** @brief immediate of a two source shuffle, lanes a[i0], a[i1], b[i2], b[i3] of every 128 bits. */
+#define MYISA_SHUFFLE(i0, i1, i2, i3) ((i0) | ((i1) << 2) | ((i2) << 4) | ((i3) << 6))
+
+MYISA_TARGET_BEGIN("sse2")
+
+struct SSE2Ops {
+    typedef __m128 V;
+    static const size_t WIDTH = 4;
+
+    static inline V load(const float* p) { return _mm_loadu_ps(p); }
+    static inline void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static inline V set1(float s) { return _mm_set1_ps(s); }
+    static inline V set4(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+    static inline V add(V a, V b) { return _mm_add_ps(a, b); }
+    static inline V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static inline V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static inline V div(V a, V b) { return _mm_div_ps(a, b); }
+    static inline V min(V a, V b) { return _mm_min_ps(a, b); }
+    static inline V max(V a, V b) { return _mm_max_ps(a, b); }
+    static inline V sqrt(V a) { return _mm_sqrt_ps(a); }
+    /** @brief (a > b) ? x : y per lane. */
+    static inline V selectGreater(V a, V b, V x, V y) {
+        const V mask = _mm_cmpgt_ps(a, b);
+        return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+    }
+    template <int IMM>
+    static inline V shuffle(V a, V b) { return _mm_shuffle_ps(a, b, IMM); }
+
+    /** @brief split 4 packed points into x, y and z. */
+    static inline void load3(const float* p, V& x, V& y, V& z) {
+        // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+        const V a = load(p), b = load(p + 4), c = load(p + 8);
+        x = shuffle<MYISA_SHUFFLE(0, 3, 0, 2)>(a, shuffle<MYISA_SHUFFLE(2, 2, 1, 1)>(b, c));
+        y = shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(shuffle<MYISA_SHUFFLE(1, 1, 0, 0)>(a, b),
+                                              shuffle<MYISA_SHUFFLE(3, 3, 2, 2)>(b, c));
+        z = shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(shuffle<MYISA_SHUFFLE(2, 2, 1, 1)>(a, b),
+                                              shuffle<MYISA_SHUFFLE(0, 0, 3, 3)>(c, c));
+    }
+    /** @brief pack x, y and z into 4 points. */
+    static inline void store3(float* p, V x, V y, V z) {
+        store(p, shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(shuffle<MYISA_SHUFFLE(0, 0, 0, 0)>(x, y),
+                                                    shuffle<MYISA_SHUFFLE(0, 0, 1, 1)>(z, x)));
+        store(p + 4, shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(shuffle<MYISA_SHUFFLE(1, 1, 1, 1)>(y, z),
+                                                        shuffle<MYISA_SHUFFLE(2, 2, 2, 2)>(x, y)));
+        store(p + 8, shuffle<MYISA_SHUFFLE(0, 2, 0, 2)>(shuffle<MYISA_SHUFFLE(2, 2, 3, 3)>(z, x),
+                                                        shuffle<MYISA_SHUFFLE(3, 3, 3, 3)>(y, z)));
+    }
+    /** @brief column k of WIDTH / 4 consecutive matrices, one matrix per 128 bits. */
+    static inline void loadColumns(const float* m, V c[4]) {
+        for (int k = 0; k < 4; ++k) c[k] = load(m + 4 * k);
+    }
+    static inline void storeColumns(float* m, const V c[4]) {
+        for (int k = 0; k < 4; ++k) store(m + 4 * k, c[k]);
+    }
+};
+
+namespace sse2 {
+#include "myisakernels.hpp"
+}
+
+static void transformSSE2(const float* a, const Vector3* in, size_t n, Vector3* out) {
+    sse2::transformKernel<SSE2Ops>(a, in, n, out);
+}
+static void boundsSSE2(const Vector3* points, size_t n, Vector3& boxMin, Vector3& boxMax) {
+    sse2::boundsKernel<SSE2Ops>(points, n, boxMin, boxMax);
+}
+static size_t invertSSE2(const Matrix4* in, size_t n, Matrix4* out) {
+    return sse2::invertKernel<SSE2Ops>(in, n, out);
+}
+static size_t toRotationsSSE2(const Vector4* q, size_t n, Matrix3* out) {
+    return sse2::toRotationsKernel<SSE2Ops>(q, n, out);
+}
+static size_t toQuaternionsSSE2(const Matrix3* in, size_t n, Vector4* out) {
+    return sse2::toQuaternionsKernel<SSE2Ops>(in, n, out);
+}
+
+MYISA_TARGET_END()
+
+MYISA_TARGET_BEGIN("avx2")
+
+struct AVX2Ops {
+    typedef __m256 V;
+    static const size_t WIDTH = 8;
+
+    static inline V load(const float* p) { return _mm256_loadu_ps(p); }
+    static inline void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static inline V set1(float s) { return _mm256_set1_ps(s); }
+    static inline V set4(float a, float b, float c, float d) {
+        return _mm256_setr_ps(a, b, c, d, a, b, c, d);
+    }
+    static inline V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static inline V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static inline V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static inline V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static inline V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static inline V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static inline V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    static inline V selectGreater(V a, V b, V x, V y) {
+        return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+    }
+    template <int IMM>
+    static inline V shuffle(V a, V b) { return _mm256_shuffle_ps(a, b, IMM); }
+
+    static inline V permute(V v, int i0, int i1, int i2, int i3, int i4, int i5, int i6, int i7) {
+        return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7));
+    }
+    /** @brief split 8 packed points into x, y and z. */
+    static inline void load3(const float* p, V& x, V& y, V& z) {
+        // a = x0 y0 z0 x1 y1 z1 x2 y2, b = z2 x3 y3 z3 x4 y4 z4 x5, c = y5 z5 x6 y6 z6 x7 y7 z7
+        const V a = load(p), b = load(p + 8), c = load(p + 16);
+        // blend the lanes holding one component, then sort them
+        x = permute(_mm256_blend_ps(_mm256_blend_ps(a, b, 0x92), c, 0x24), 0, 3, 6, 1, 4, 7, 2, 5);
+        y = permute(_mm256_blend_ps(_mm256_blend_ps(a, b, 0x24), c, 0x49), 1, 4, 7, 2, 5, 0, 3, 6);
+        z = permute(_mm256_blend_ps(_mm256_blend_ps(a, b, 0x49), c, 0x92), 2, 5, 0, 3, 6, 1, 4, 7);
+    }
+    /** @brief pack x, y and z into 8 points. */
+    static inline void store3(float* p, V x, V y, V z) {
+        const V xs = permute(x, 0, 3, 6, 1, 4, 7, 2, 5);
+        const V ys = permute(y, 5, 0, 3, 6, 1, 4, 7, 2);
+        const V zs = permute(z, 2, 5, 0, 3, 6, 1, 4, 7);
+        store(p, _mm256_blend_ps(_mm256_blend_ps(xs, ys, 0x92), zs, 0x24));
+        store(p + 8, _mm256_blend_ps(_mm256_blend_ps(xs, ys, 0x24), zs, 0x49));
+        store(p + 16, _mm256_blend_ps(_mm256_blend_ps(xs, ys, 0x49), zs, 0x92));
+    }
+    static inline void loadColumns(const float* m, V c[4]) {
+        for (int k = 0; k < 4; ++k) {
+            c[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(m + 4 * k)), _mm_loadu_ps(m + 16 + 4 * k), 1);
+        }
+    }
+    static inline void storeColumns(float* m, const V c[4]) {
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_ps(m + 4 * k, _mm256_castps256_ps128(c[k]));
+            _mm_storeu_ps(m + 16 + 4 * k, _mm256_extractf128_ps(c[k], 1));
+        }
+    }
+};
+
+namespace avx2 {
+#include "myisakernels.hpp"
+}
+
+static void transformAVX2(const float* a, const Vector3* in, size_t n, Vector3* out) {
+    avx2::transformKernel<AVX2Ops>(a, in, n, out);
+}
+static void boundsAVX2(const Vector3* points, size_t n, Vector3& boxMin, Vector3& boxMax) {
+    avx2::boundsKernel<AVX2Ops>(points, n, boxMin, boxMax);
+}
+static size_t invertAVX2(const Matrix4* in, size_t n, Matrix4* out) {
+    return avx2::invertKernel<AVX2Ops>(in, n, out);
+}
+static size_t toRotationsAVX2(const Vector4* q, size_t n, Matrix3* out) {
+    return avx2::toRotationsKernel<AVX2Ops>(q, n, out);
+}
+static size_t toQuaternionsAVX2(const Matrix3* in, size_t n, Vector4* out) {
+    return avx2::toQuaternionsKernel<AVX2Ops>(in, n, out);
+}
+
+MYISA_TARGET_END()
+
+/** @brief permutex2var indices of AVX512Ops::load3() and store3(), see there. */
+static const int SPLIT_X[2][16] = {{0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 0, 0, 0, 0, 0},
+                                   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 17, 20, 23, 26, 29}};
+static const int SPLIT_Y[2][16] = {{1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 0, 0, 0, 0, 0},
+                                   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 18, 21, 24, 27, 30}};
+static const int SPLIT_Z[2][16] = {{2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 0, 0, 0, 0, 0, 0},
+                                   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 19, 22, 25, 28, 31}};
+static const int MERGE[3][2][16] = {
+    {{0, 16, 0, 1, 17, 0, 2, 18, 0, 3, 19, 0, 4, 20, 0, 5}, {0, 1, 16, 3, 4, 17, 6, 7, 18, 9, 10, 19, 12, 13, 20, 15}},
+    {{21, 0, 6, 22, 0, 7, 23, 0, 8, 24, 0, 9, 25, 0, 10, 26}, {0, 21, 2, 3, 22, 5, 6, 23, 8, 9, 24, 11, 12, 25, 14, 15}},
+    {{0, 11, 27, 0, 12, 28, 0, 13, 29, 0, 14, 30, 0, 15, 31, 0}, {26, 1, 2, 27, 4, 5, 28, 7, 8, 29, 10, 11, 30, 13, 14, 31}}};
+
+MYISA_TARGET_BEGIN("avx512f")
+
+struct AVX512Ops {
+    typedef __m512 V;
+    static const size_t WIDTH = 16;
+
+    static inline V load(const float* p) { return _mm512_loadu_ps(p); }
+    static inline void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+    static inline V set1(float s) { return _mm512_set1_ps(s); }
+    static inline V set4(float a, float b, float c, float d) {
+        return _mm512_setr_ps(a, b, c, d, a, b, c, d, a, b, c, d, a, b, c, d);
+    }
+    static inline V add(V a, V b) { return _mm512_add_ps(a, b); }
+    static inline V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    static inline V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    static inline V div(V a, V b) { return _mm512_div_ps(a, b); }
+    static inline V min(V a, V b) { return _mm512_min_ps(a, b); }
+    static inline V max(V a, V b) { return _mm512_max_ps(a, b); }
+    static inline V sqrt(V a) { return _mm512_sqrt_ps(a); }
+    static inline V selectGreater(V a, V b, V x, V y) {
+        return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), y, x);
+    }
+    template <int IMM>
+    static inline V shuffle(V a, V b) { return _mm512_shuffle_ps(a, b, IMM); }
+
+    static inline V merge(V a, const int* index, V b) {
+        return _mm512_permutex2var_ps(a, _mm512_loadu_si512(index), b);
+    }
+    /** @brief split 16 packed points into x, y and z. */
+    static inline void load3(const float* p, V& x, V& y, V& z) {
+        // gather a component out of a and b, then fill in the remaining points out of c
+        const V a = load(p), b = load(p + 16), c = load(p + 32);
+        x = merge(merge(a, SPLIT_X[0], b), SPLIT_X[1], c);
+        y = merge(merge(a, SPLIT_Y[0], b), SPLIT_Y[1], c);
+        z = merge(merge(a, SPLIT_Z[0], b), SPLIT_Z[1], c);
+    }
+    /** @brief pack x, y and z into 16 points. */
+    static inline void store3(float* p, V x, V y, V z) {
+        for (int k = 0; k < 3; ++k) store(p + 16 * k, merge(merge(x, MERGE[k][0], y), MERGE[k][1], z));
+    }
+    static inline void loadColumns(const float* m, V c[4]) {
+        for (int k = 0; k < 4; ++k) {
+            V v = _mm512_castps128_ps512(_mm_loadu_ps(m + 4 * k));
+            v = _mm512_insertf32x4(v, _mm_loadu_ps(m + 16 + 4 * k), 1);
+            v = _mm512_insertf32x4(v, _mm_loadu_ps(m + 32 + 4 * k), 2);
+            c[k] = _mm512_insertf32x4(v, _mm_loadu_ps(m + 48 + 4 * k), 3);
+        }
+    }
+    static inline void storeColumns(float* m, const V c[4]) {
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_ps(m + 4 * k, _mm512_castps512_ps128(c[k]));
+            _mm_storeu_ps(m + 16 + 4 * k, _mm512_extractf32x4_ps(c[k], 1));
+            _mm_storeu_ps(m + 32 + 4 * k, _mm512_extractf32x4_ps(c[k], 2));
+            _mm_storeu_ps(m + 48 + 4 * k, _mm512_extractf32x4_ps(c[k], 3));
+        }
+    }
+};
+
+namespace avx512 {
+#include "myisakernels.hpp"
+}
+
+static void transformAVX512(const float* a, const Vector3* in, size_t n, Vector3* out) {
+    avx512::transformKernel<AVX512Ops>(a, in, n, out);
+}
+static void boundsAVX512(const Vector3* points, size_t n, Vector3& boxMin, Vector3& boxMax) {
+    avx512::boundsKernel<AVX512Ops>(points, n, boxMin, boxMax);
+}
+static size_t invertAVX512(const Matrix4* in, size_t n, Matrix4* out) {
+    return avx512::invertKernel<AVX512Ops>(in, n, out);
+}
+static size_t toRotationsAVX512(const Vector4* q, size_t n, Matrix3* out) {
+    return avx512::toRotationsKernel<AVX512Ops>(q, n, out);
+}
+static size_t toQuaternionsAVX512(const Matrix3* in, size_t n, Vector4* out) {
+    return avx512::toQuaternionsKernel<AVX512Ops>(in, n, out);
+}
+
+MYISA_TARGET_END()
+
+static const BatchKernels SSE2_KERNELS = {ISA_SSE2, transformSSE2, boundsSSE2, invertSSE2,
+                                        toRotationsSSE2, toQuaternionsSSE2};
+static const BatchKernels AVX2_KERNELS = {ISA_AVX2, transformAVX2, boundsAVX2, invertAVX2,
+                                          toRotationsAVX2, toQuaternionsAVX2};
+static const BatchKernels AVX512_KERNELS = {ISA_AVX512, transformAVX512, boundsAVX512, invertAVX512,
+                                            toRotationsAVX512, toQuaternionsAVX512};
+
+#endif
+
+static const char* ISA_NAMES[ISA_COUNT] = {"scalar", "sse2", "avx2", "avx512"};
+
+const char* getISAName(ISALEVEL isa) {
+    return ISA_NAMES[isa];
+}
+
+bool isISASupported(ISALEVEL isa) {
+    switch (isa) {
+    case ISA_SCALAR:
+        return true;
+#ifdef MYISA_X86
+    case ISA_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case ISA_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case ISA_AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+static const BatchKernels* kernelsOf(ISALEVEL isa) {
+#ifdef MYISA_X86
+    if (isa == ISA_AVX512) return &AVX512_KERNELS;
+    if (isa == ISA_AVX2) return &AVX2_KERNELS;
+    if (isa == ISA_SSE2) return &SSE2_KERNELS;
+#else
+    (void)isa;
+#endif
+    return &SCALAR_KERNELS;
+}
+
+/** @brief best supported level, or the one named by MYMATH_ISA. */
+static ISALEVEL selectISA() {
+    ISALEVEL best = ISA_SCALAR;
+    for (int isa = ISA_SCALAR; isa < ISA_COUNT; ++isa) {
+        if (isISASupported(static_cast<ISALEVEL>(isa))) best = static_cast<ISALEVEL>(isa);
+    }
+    const char* env = std::getenv("MYMATH_ISA");
+    if (!env || !*env) return best;
+    for (int isa = ISA_SCALAR; isa < ISA_COUNT; ++isa) {
+        if (std::strcmp(env, ISA_NAMES[isa]) != 0) continue;
+        if (isISASupported(static_cast<ISALEVEL>(isa))) return static_cast<ISALEVEL>(isa);
+        break;
+    }
+    fprintf(stderr, "File %s, Line %d, Function %s(): MYMATH_ISA=%s unsupported, using %s.\n",
+            __FILE__, __LINE__, __FUNCTION__, env, ISA_NAMES[best]);
+    return best;
+}
+
+static std::atomic<const BatchKernels*> g_kernels(nullptr);
+
+const BatchKernels& getBatchKernels() {
+    const BatchKernels* kernels = g_kernels.load(std::memory_order_acquire);
+    if (kernels) return *kernels;
+    // racing first calls select the same level
+    static const BatchKernels* selected = kernelsOf(selectISA());
+    const BatchKernels* expected = nullptr;
+    g_kernels.compare_exchange_strong(expected, selected);
+    return *g_kernels.load(std::memory_order_acquire);
+}
+
+ISALEVEL getISA() {
+    return getBatchKernels().isa;
+}
+
+bool setISA(ISALEVEL isa) {
+    if (!isISASupported(isa)) return false;
+    g_kernels.store(kernelsOf(isa), std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,385 @@
+#include "mylie.hpp"
+#include "myinstrument.hpp"
+#include "myparallel.hpp"
+#include "mytrace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+/** @brief poses handled by one parallel task, an exp or log costs about a hundred flops. */
+static const size_t LIE_GRAIN = 1 << 10;
+/** @brief squared angle below which the coefficients use their Taylor series. */
+static const double LIE_TAYLOR_ANGLE2 = 1e-2;
+
+/** @brief sin(t) / t, (1 - cos t) / t^2 and (t - sin t) / t^3 of t^2. */
+static void rotationCoefficients(double theta2, double& a, double& b, double& c) {
+    if (theta2 < LIE_TAYLOR_ANGLE2) {
+        // through t^8, the first omitted term is below 1e-16 relative at t = 0.1
+        a = 1 - theta2 / 6 * (1 - theta2 / 20 * (1 - theta2 / 42 * (1 - theta2 / 72)));
+        b = 0.5 - theta2 / 24 * (1 - theta2 / 30 * (1 - theta2 / 56 * (1 - theta2 / 90)));
+        c = 1.0 / 6 - theta2 / 120 * (1 - theta2 / 42 * (1 - theta2 / 72 * (1 - theta2 / 110)));
+        return;
+    }
+    // 1 - cos t lost at most 1e-14 relative in double above the Taylor range
+    const double theta = std::sqrt(theta2);
+    const double s = std::sin(theta), co = std::cos(theta);
+    a = s / theta;
+    b = (1 - co) / theta2;
+    c = (theta - s) / (theta2 * theta);
+}
+
+/** @brief 1 / t^2 - (1 + cos t) / (2 t sin t) of t^2, the W^2 coefficient of J_l^{-1}. */
+static double inverseCoefficient(double theta2) {
+    if (theta2 < LIE_TAYLOR_ANGLE2) {
+        return 1.0 / 12 + theta2 / 720 * (1 + theta2 / 42 * (1 + theta2 / 40));
+    }
+    // (1 + cos t) / sin t = cot(t / 2) stays finite at pi
+    const double theta = std::sqrt(theta2);
+    return 1 / theta2 - 1 / (2 * theta * std::tan(theta / 2));
+}
+
+/** @brief (t^2 + 2 cos t - 2) / (2 t^4) and (2 t - 3 sin t + t cos t) / (2 t^5) of t^2, used by Q. */
+static void translationCoefficients(double theta2, double& d, double& e) {
+    if (theta2 < LIE_TAYLOR_ANGLE2) {
+        d = 1.0 / 24 - theta2 / 720 * (1 - theta2 / 56 * (1 - theta2 / 90));
+        e = 1.0 / 120 - theta2 / 2520 * (1 - theta2 / 48 * (1 - theta2 / 82.5));
+        return;
+    }
+    const double theta = std::sqrt(theta2);
+    const double s = std::sin(theta), c = std::cos(theta);
+    d = (theta2 + 2 * c - 2) / (2 * theta2 * theta2);
+    e = (2 * theta - 3 * s + theta * c) / (2 * theta2 * theta2 * theta);
+}
+
+/** @brief I + b * W + c * W^2 with W = hat(w), expanded by W^2 = w w^T - |w|^2 I. */
+static Matrix3 polynomial(const Vector3& w, double b, double c) {
+    const scalar x = w.x, y = w.y, z = w.z;
+    const scalar sb = static_cast<scalar>(b), sc = static_cast<scalar>(c);
+    const scalar d = 1 - sc * (x * x + y * y + z * z);
+    return Matrix3(d + sc * x * x, sc * x * y + sb * z, sc * x * z - sb * y,
+                   sc * x * y - sb * z, d + sc * y * y, sc * y * z + sb * x,
+                   sc * x * z + sb * y, sc * y * z - sb * x, d + sc * z * z);
+}
+
+static double squaredNorm(const Vector3& w) {
+    return static_cast<double>(w.x) * w.x + static_cast<double>(w.y) * w.y + static_cast<double>(w.z) * w.z;
+}
+
+SO3::SO3(const Matrix3& mat) {
+    if (!mat.isRotationMatrix()) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Not a rotation matrix.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Not a rotation matrix!";
+    }
+    R = mat;
+}
+
+Matrix3 SO3::hat(const Vector3& w) {
+    return Matrix3(0, w.z, -w.y,
+                   -w.z, 0, w.x,
+                   w.y, -w.x, 0);
+}
+
+Vector3 SO3::vee(const Matrix3& mat) {
+    const scalar* m = mat.constData();
+    return Vector3((m[5] - m[7]) / 2, (m[6] - m[2]) / 2, (m[1] - m[3]) / 2);
+}
+
+SO3 SO3::exp(const Vector3& w) {
+    double a, b, c;
+    rotationCoefficients(squaredNorm(w), a, b, c);
+    SO3 ret;
+    ret.R = polynomial(w, a, b);
+    return ret;
+}
+
+SO3 SO3::rotation(const Vector3& axis, scalar angle) {
+    // I + sin(a) * K + (1 - cos(a)) * K^2, K = hat(axis)
+    SO3 ret;
+    ret.R = polynomial(axis, std::sin(angle), 1 - std::cos(angle));
+    return ret;
+}
+
+Vector3 SO3::log() const {
+    const scalar* m = R.constData();
+    // v = 2 sin(t) * axis, trace = 1 + 2 cos(t)
+    const double vx = m[5] - m[7], vy = m[6] - m[2], vz = m[1] - m[3];
+    const double s = std::sqrt(vx * vx + vy * vy + vz * vz) / 2;
+    const double c = (static_cast<double>(m[0]) + m[4] + m[8] - 1) / 2;
+    // atan2 keeps the angle accurate where acos of the trace is not, near 0 and pi
+    const double theta = std::atan2(s, c);
+    const double theta2 = theta * theta;
+    if (c > 0) {
+        double f;
+        if (theta2 < LIE_TAYLOR_ANGLE2) {
+            // t / sin(t) through t^10
+            f = 1 + theta2 / 6 * (1 + theta2 * 7 / 60 * (1 + theta2 * 31 / 294 * (1 + theta2 * 127 / 1240
+                * (1 + theta2 * 2555 / 25146))));
+        } else {
+            f = theta / s;
+        }
+        return Vector3(static_cast<scalar>(vx * f / 2), static_cast<scalar>(vy * f / 2),
+                       static_cast<scalar>(vz * f / 2));
+    }
+    // sin(t) is small near pi, recover w from the symmetric part (R + R^T) / 2 = I + b * (w w^T - t^2 I)
+    const double b = (1 - c) / theta2;
+    int i = 0;
+    if (m[4] > m[i * 4]) i = 1;
+    if (m[8] > m[i * 4]) i = 2;
+    const double v[3] = {vx, vy, vz};
+    double w[3];
+    w[i] = std::sqrt(std::max(0.0, (m[i * 4] - 1) / b + theta2));
+    if (v[i] < 0) w[i] = -w[i];
+    for (int j = 0; j < 3; ++j) {
+        if (j == i) continue;
+        w[j] = (static_cast<double>(m[i + 3 * j]) + m[j + 3 * i]) / (2 * b * w[i]);
+    }
+    return Vector3(static_cast<scalar>(w[0]), static_cast<scalar>(w[1]), static_cast<scalar>(w[2]));
+}
+
+Matrix3 SO3::leftJacobian(const Vector3& w) {
+    double a, b, c;
+    rotationCoefficients(squaredNorm(w), a, b, c);
+    return polynomial(w, b, c);
+}
+
+Matrix3 SO3::leftJacobianInverse(const Vector3& w) {
+    return polynomial(w, -0.5, inverseCoefficient(squaredNorm(w)));
+}
+
+Matrix3 SO3::rightJacobian(const Vector3& w) {
+    double a, b, c;
+    rotationCoefficients(squaredNorm(w), a, b, c);
+    return polynomial(w, -b, c);
+}
+
+Matrix3 SO3::rightJacobianInverse(const Vector3& w) {
+    return polynomial(w, 0.5, inverseCoefficient(squaredNorm(w)));
+}
+
+SO3 SO3::inverse() const {
+    SO3 ret;
+    ret.R = R.transposed();
+    return ret;
+}
+
+void SO3::normalize() {
+    Vector3 x = R.getColumn(0);
+    Vector3 y = R.getColumn(1);
+    x.normalize();
+    y -= x * x.dot(y);
+    y.normalize();
+    R.setColumn(0, x);
+    R.setColumn(1, y);
+    R.setColumn(2, x.cross(y));
+}
+
+SO3 SO3::operator*(const SO3& rhs) const {
+    SO3 ret;
+    ret.R = R.matmul(rhs.R);
+    return ret;
+}
+
+SO3& SO3::operator*=(const SO3& rhs) {
+    R = R.matmul(rhs.R);
+    return *this;
+}
+
+SE3::SE3(const Matrix4& mat) :
+    t(mat[12], mat[13], mat[14]) {
+    const Matrix3 rot(mat[0], mat[1], mat[2], mat[4], mat[5], mat[6], mat[8], mat[9], mat[10]);
+    if ((std::abs(mat[3]) > MYEPSILON) || (std::abs(mat[7]) > MYEPSILON) || (std::abs(mat[11]) > MYEPSILON)
+        || (std::abs(mat[15] - 1) > MYEPSILON) || !rot.isRotationMatrix()) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Not a rigid transformation.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Not a rigid transformation!";
+    }
+    R.R = rot;
+}
+
+/** @brief Q(rho, phi) of Barfoot (7.86), the upper right block of the SE(3) left Jacobian. */
+static Matrix3 barfootQ(const Vector3& rho, const Vector3& phi, double theta2) {
+    double a, b, c, d, e;
+    rotationCoefficients(theta2, a, b, c);
+    translationCoefficients(theta2, d, e);
+    const Matrix3 P = SO3::hat(rho), F = SO3::hat(phi);
+    const Matrix3 FP = F.matmul(P), PF = P.matmul(F);
+    const Matrix3 FPF = FP.matmul(F), FFP = F.matmul(FP), PFF = PF.matmul(F);
+    const Matrix3 FPFF = FPF.matmul(F), FFPF = F.matmul(FPF);
+    return static_cast<scalar>(0.5) * P + static_cast<scalar>(c) * (FP + PF + FPF)
+           + static_cast<scalar>(d) * (FFP + PFF - static_cast<scalar>(3) * FPF)
+           + static_cast<scalar>(e) * (FPFF + FFPF);
+}
+
+static Vector3 rhoOf(const VectorN<6>& xi) {
+    const scalar* v = xi.constData();
+    return Vector3(v[0], v[1], v[2]);
+}
+
+static Vector3 phiOf(const VectorN<6>& xi) {
+    const scalar* v = xi.constData();
+    return Vector3(v[3], v[4], v[5]);
+}
+
+static VectorN<6> tangent(const Vector3& rho, const Vector3& phi) {
+    const scalar v[6] = {rho.x, rho.y, rho.z, phi.x, phi.y, phi.z};
+    return VectorN<6>(v);
+}
+
+/** @brief copy a 3x3 block to rows [row, row + 3) and columns [col, col + 3). */
+static void setBlock(MatrixN<6, 6>& mat, int row, int col, const Matrix3& block) {
+    scalar* m = mat.data();
+    const scalar* b = block.constData();
+    for (int j = 0; j < 3; ++j) {
+        for (int i = 0; i < 3; ++i) m[(col + j) * 6 + row + i] = b[j * 3 + i];
+    }
+}
+
+/** @brief | J -J * Q * J |, | 0 J | for J = J_l^{-1}(phi). */
+static MatrixN<6, 6> jacobianInverse(const Matrix3& J, const Matrix3& Q) {
+    MatrixN<6, 6> ret;
+    setBlock(ret, 0, 0, J);
+    setBlock(ret, 0, 3, -(J.matmul(Q).matmul(J)));
+    setBlock(ret, 3, 3, J);
+    return ret;
+}
+
+SE3 SE3::exp(const VectorN<6>& xi) {
+    const Vector3 rho = rhoOf(xi), phi = phiOf(xi);
+    double a, b, c;
+    rotationCoefficients(squaredNorm(phi), a, b, c);
+    SE3 ret;
+    ret.R.R = polynomial(phi, a, b);
+    ret.t = polynomial(phi, b, c) * rho;
+    return ret;
+}
+
+VectorN<6> SE3::log() const {
+    const Vector3 phi = R.log();
+    return tangent(SO3::leftJacobianInverse(phi) * t, phi);
+}
+
+MatrixN<6, 6> SE3::leftJacobian(const VectorN<6>& xi) {
+    const Vector3 rho = rhoOf(xi), phi = phiOf(xi);
+    const Matrix3 J = SO3::leftJacobian(phi);
+    MatrixN<6, 6> ret;
+    setBlock(ret, 0, 0, J);
+    setBlock(ret, 0, 3, barfootQ(rho, phi, squaredNorm(phi)));
+    setBlock(ret, 3, 3, J);
+    return ret;
+}
+
+MatrixN<6, 6> SE3::leftJacobianInverse(const VectorN<6>& xi) {
+    const Vector3 rho = rhoOf(xi), phi = phiOf(xi);
+    return jacobianInverse(SO3::leftJacobianInverse(phi), barfootQ(rho, phi, squaredNorm(phi)));
+}
+
+MatrixN<6, 6> SE3::rightJacobian(const VectorN<6>& xi) {
+    return leftJacobian(-xi);
+}
+
+MatrixN<6, 6> SE3::rightJacobianInverse(const VectorN<6>& xi) {
+    return leftJacobianInverse(-xi);
+}
+
+Matrix4 SE3::matrix() const {
+    const scalar* r = R.R.constData();
+    return Matrix4(r[0], r[1], r[2], 0,
+                   r[3], r[4], r[5], 0,
+                   r[6], r[7], r[8], 0,
+                   t.x, t.y, t.z, 1);
+}
+
+SE3 SE3::inverse() const {
+    SE3 ret;
+    ret.R.R = R.R.transposed();
+    ret.t = -(ret.R.R * t);
+    return ret;
+}
+
+MatrixN<6, 6> SE3::adjoint() const {
+    MatrixN<6, 6> ret;
+    setBlock(ret, 0, 0, R.R);
+    setBlock(ret, 0, 3, SO3::hat(t).matmul(R.R));
+    setBlock(ret, 3, 3, R.R);
+    return ret;
+}
+
+VectorN<6> SE3::adjoint(const VectorN<6>& xi) const {
+    const Vector3 phi = R.R * phiOf(xi);
+    return tangent(R.R * rhoOf(xi) + t.cross(phi), phi);
+}
+
+SE3 SE3::operator*(const SE3& rhs) const {
+    SE3 ret;
+    ret.R.R = R.R.matmul(rhs.R.R);
+    ret.t = R.R * rhs.t + t;
+    return ret;
+}
+
+SE3& SE3::operator*=(const SE3& rhs) {
+    t = R.R * rhs.t + t;
+    R.R = R.R.matmul(rhs.R.R);
+    return *this;
+}
+
+void perturbPoses(const SE3* in, const VectorN<6>* delta, size_t n, SE3* out, PERTURBATION side) {
+    MYMATH_TRACE_SPAN("perturbPoses", n);
+    parallelFor(0, n, LIE_GRAIN, [&](size_t lo, size_t hi) {
+        if (side == PERTURB_LEFT) {
+            for (size_t i = lo; i < hi; ++i) out[i] = SE3::exp(delta[i]) * in[i];
+        } else {
+            for (size_t i = lo; i < hi; ++i) out[i] = in[i] * SE3::exp(delta[i]);
+        }
+    });
+}
+
+void perturbRotations(const SO3* in, const Vector3* delta, size_t n, SO3* out, PERTURBATION side) {
+    MYMATH_TRACE_SPAN("perturbRotations", n);
+    parallelFor(0, n, LIE_GRAIN, [&](size_t lo, size_t hi) {
+        if (side == PERTURB_LEFT) {
+            for (size_t i = lo; i < hi; ++i) out[i] = SO3::exp(delta[i]) * in[i];
+        } else {
+            for (size_t i = lo; i < hi; ++i) out[i] = in[i] * SO3::exp(delta[i]);
+        }
+    });
+}
+
+void expPoses(const VectorN<6>* xi, size_t n, SE3* out) {
+    MYMATH_TRACE_SPAN("expPoses", n);
+    parallelFor(0, n, LIE_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) out[i] = SE3::exp(xi[i]);
+    });
+}
+
+void logPoses(const SE3* in, size_t n, VectorN<6>* xi) {
+    MYMATH_TRACE_SPAN("logPoses", n);
+    parallelFor(0, n, LIE_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) xi[i] = in[i].log();
+    });
+}
+
+void composePoses(const SE3* a, const SE3* b, size_t n, SE3* out) {
+    MYMATH_TRACE_SPAN("composePoses", n);
+    // a composition is a few dozen flops, like a matrix inverse
+    parallelFor(0, n, LIE_GRAIN * 4, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) out[i] = a[i] * b[i];
+    });
+}
+
+void invertPoses(const SE3* in, size_t n, SE3* out) {
+    MYMATH_TRACE_SPAN("invertPoses", n);
+    parallelFor(0, n, LIE_GRAIN * 4, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) out[i] = in[i].inverse();
+    });
+}
+
+void adjointPoses(const SE3* poses, const VectorN<6>* xi, size_t n, VectorN<6>* out) {
+    MYMATH_TRACE_SPAN("adjointPoses", n);
+    parallelFor(0, n, LIE_GRAIN * 4, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) out[i] = poses[i].adjoint(xi[i]);
+    });
+}
@@ -1,24 +1,5 @@
 #include "mymatrix.hpp"
-
-Matrix2::Matrix2() {
-    setIdentity();
-}
-
-Matrix2::Matrix2(const scalar src[4]) {
-    set(src);
-}
-
-Matrix2::Matrix2(scalar m0, scalar m1, scalar m2, scalar m3) {
-    set(m0, m1, m2, m3);
-}
-
-Matrix2::Matrix2(const Matrix2& mat2) {
-    //    std::cout << "invoke ctor aka copy constructor" << std::endl;
-    m[0] = mat2[0];
-    m[1] = mat2[1];
-    m[2] = mat2[2];
-    m[3] = mat2[3];
-}
+#include "myinstrument.hpp"
 
 Matrix2& Matrix2::operator=(const Matrix2& mat2) {
     //    std::cout << "invoke copy assignment operator" << std::endl;
@@ -50,6 +31,7 @@ void Matrix2::setRow(int index, const scalar row[2]) {
     if ((index > 1) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     m[index] = row[0];
@@ -60,6 +42,7 @@ void Matrix2::setRow(int index, const Vector2& v) {
     if ((index > 1) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     m[index] = v.x;
@@ -70,6 +53,7 @@ void Matrix2::setColumn(int index, const scalar col[2]) {
     if ((index > 1) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     m[index * 2] = col[0];
@@ -80,6 +64,7 @@ void Matrix2::setColumn(int index, const Vector2& v) {
     if ((index > 1) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     m[index * 2] = v.x;
@@ -113,6 +98,7 @@ Vector2 Matrix2::getRow(int index) const {
     if ((index > 1) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return Vector2(m[index], m[index + 2]);
@@ -122,6 +108,7 @@ Vector2 Matrix2::getColumn(int index) const {
     if ((index > 1) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return Vector2(m[index * 2], m[index * 2 + 1]);
@@ -139,6 +126,7 @@ scalar Matrix2::getAngle(ANGLEUNIT unit) const {
     if (!this->isRotationMatrix()) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Not a rotation matrix.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Not a rotation matrix!";
     }
     scalar u = (unit == RAD) ? 1 : (RAD2DEG);
@@ -165,6 +153,7 @@ void Matrix2::inverse() {
     if (std::abs(det) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Inverse matrix not exists.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Inverse matrix not exists!";
     }
     std::swap(m[0], m[3]);
@@ -182,6 +171,7 @@ Matrix2 Matrix2::computeInverse() const {
     if (std::abs(det) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Inverse matrix not exists.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Inverse matrix not exists!";
     }
     Matrix2 tmp(m[3], -m[1], -m[2], m[0]);
@@ -224,16 +214,6 @@ Matrix2& Matrix2::operator-=(const Matrix2& rhs) {
     return *this;
 }
 
-Matrix2 Matrix2::matmul(const Matrix2& rhs) const {
-    return Matrix2(m[0] * rhs[0] + m[2] * rhs[1], m[1] * rhs[0] + m[3] * rhs[1],
-                   m[0] * rhs[2] + m[2] * rhs[3], m[1] * rhs[2] + m[3] * rhs[3]);
-}
-
-Vector2 Matrix2::operator*(const Vector2& rhs) const {
-    return Vector2(m[0] * rhs.x + m[2] * rhs.y,
-                   m[1] * rhs.x + m[3] * rhs.y);
-}
-
 Matrix2 Matrix2::operator*(const Matrix2& rhs) const {
     return Matrix2(m[0] * rhs[0], m[1] * rhs[1],
                    m[2] * rhs[2], m[3] * rhs[3]);
@@ -252,6 +232,7 @@ Matrix2 Matrix2::operator/(const scalar& rhs) const {
     if (std::abs(rhs) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     Matrix2 ret(m[0], m[1], m[2], m[3]);
@@ -262,6 +243,7 @@ Matrix2& Matrix2::operator/=(const scalar& rhs) {
     if (std::abs(rhs) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     *this = (*this) / rhs;
@@ -289,6 +271,7 @@ scalar Matrix2::operator[](int index) const {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[index];
@@ -298,6 +281,7 @@ scalar& Matrix2::operator[](int index) {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[index];
@@ -307,6 +291,7 @@ scalar Matrix2::operator()(int i, int j) const {
     if ((i < 0) || (i > 1) || (j < 0) || (j > 1)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[j * 2 + i];
@@ -316,6 +301,7 @@ scalar& Matrix2::operator()(int i, int j) {
     if ((i < 0) || (i > 1) || (j < 0) || (j > 1)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[j * 2 + i];
@@ -343,27 +329,6 @@ std::ostream& operator<<(std::ostream& os, const Matrix2& mat2) {
     return os;
 }
 
-Matrix3::Matrix3() {
-    setIdentity();
-}
-
-Matrix3::Matrix3(const scalar src[9]) {
-    set(src);
-}
-
-Matrix3::Matrix3(scalar m0, scalar m1, scalar m2,
-                 scalar m3, scalar m4, scalar m5,
-                 scalar m6, scalar m7, scalar m8) {
-    set(m0, m1, m2,
-        m3, m4, m5,
-        m6, m7, m8);
-}
-
-Matrix3::Matrix3(const Matrix3& mat3) {
-    for (int i = 0; i < 9; i++)
-        m[i] = mat3[i];
-}
-
 Matrix3& Matrix3::operator=(const Matrix3& mat3) {
     if (this == &mat3) {
         return *this;
@@ -396,6 +361,7 @@ void Matrix3::setRow(int index, const scalar data[3]) {
     if ((index > 2) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     m[index] = data[0];
@@ -407,6 +373,7 @@ void Matrix3::setRow(int index, const Vector3& v) {
     if ((index > 2) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     m[index] = v[0];
@@ -418,6 +385,7 @@ void Matrix3::setColumn(int index, const scalar data[3]) {
     if ((index > 2) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     m[index * 3] = data[0];
@@ -429,6 +397,7 @@ void Matrix3::setColumn(int index, const Vector3& v) {
     if ((index > 2) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     m[index * 3] = v[0];
@@ -500,6 +469,7 @@ Vector3 Matrix3::getRow(int index) const {
     if ((index > 2) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return Vector3(m[index], m[index + 3], m[index + 6]);
@@ -509,6 +479,7 @@ Vector3 Matrix3::getColumn(int index) const {
     if ((index > 2) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return Vector3(m[index * 3], m[index * 3 + 1], m[index * 3 + 2]);
@@ -542,10 +513,6 @@ void Matrix3::transpose() {
     std::swap(m[5], m[7]);
 }
 
-Matrix3 Matrix3::transposed() const {
-    return Matrix3(m[0], m[3], m[6], m[1], m[4], m[7], m[2], m[5], m[8]);
-}
-
 void Matrix3::inverse() {
     // M^-1 = adj(M) / det(M)
     //        | m4m8-m5m7  m5m6-m3m8  m3m7-m4m6 |
@@ -555,6 +522,7 @@ void Matrix3::inverse() {
     if (std::abs(det) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Determinant is zero.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Determinant is zero!";
     }
     scalar inv_det = 1.f / det;
@@ -584,6 +552,7 @@ Matrix3 Matrix3::computeInverse() const {
     if (std::abs(det) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Determinant is zero.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Determinant is zero!";
     }
     scalar inv_det = 1.f / det;
@@ -658,21 +627,6 @@ Matrix3& Matrix3::operator-=(const Matrix3& rhs) {
     return *this;
 }
 
-Matrix3 Matrix3::matmul(const Matrix3& rhs) const {
-    // | 0 3 6 |   | 0 3 6 |
-    // | 1 4 7 | * | 1 4 7 |
-    // | 2 5 8 |   | 2 5 8 |
-    return Matrix3(m[0] * rhs[0] + m[3] * rhs[1] + m[6] * rhs[2], m[1] * rhs[0] + m[4] * rhs[1] + m[7] * rhs[2], m[2] * rhs[0] + m[5] * rhs[1] + m[8] * rhs[2],
-                   m[0] * rhs[3] + m[3] * rhs[4] + m[6] * rhs[5], m[1] * rhs[3] + m[4] * rhs[4] + m[7] * rhs[5], m[2] * rhs[3] + m[5] * rhs[4] + m[8] * rhs[5],
-                   m[0] * rhs[6] + m[3] * rhs[7] + m[6] * rhs[8], m[1] * rhs[6] + m[4] * rhs[7] + m[7] * rhs[8], m[2] * rhs[6] + m[5] * rhs[7] + m[8] * rhs[8]);
-}
-
-Vector3 Matrix3::operator*(const Vector3& rhs) const {
-    return Vector3(m[0] * rhs.x + m[3] * rhs.y + m[6] * rhs.z,
-                   m[1] * rhs.x + m[4] * rhs.y + m[7] * rhs.z,
-                   m[2] * rhs.x + m[5] * rhs.y + m[8] * rhs.z);
-}
-
 Matrix3 Matrix3::operator*(const Matrix3& rhs) const {
     return Matrix3(m[0] * rhs[0], m[1] * rhs[1], m[2] * rhs[2],
                    m[3] * rhs[3], m[4] * rhs[4], m[5] * rhs[5],
@@ -715,6 +669,7 @@ Matrix3 Matrix3::operator/(const scalar& rhs) const {
     if (std::abs(rhs) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     return Matrix3(m[0] / rhs, m[1] / rhs, m[2] / rhs,
@@ -726,6 +681,7 @@ Matrix3& Matrix3::operator/=(const scalar& rhs) {
     if (std::abs(rhs) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     m[0] /= rhs;
@@ -774,6 +730,7 @@ scalar Matrix3::operator[](int index) const {
     if ((index > 8) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[index];
@@ -783,6 +740,7 @@ scalar& Matrix3::operator[](int index) {
     if ((index > 8) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[index];
@@ -792,6 +750,7 @@ scalar Matrix3::operator()(int i, int j) const {
     if ((i < 0) || (i > 2) || (j < 0) || (j > 2)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[j * 3 + i];
@@ -801,6 +760,7 @@ scalar& Matrix3::operator()(int i, int j) {
     if ((i < 0) || (i > 2) || (j < 0) || (j > 2)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[j * 3 + i];
@@ -837,29 +797,6 @@ scalar Matrix4::getCofactor(scalar m0, scalar m1, scalar m2,
     return m0 * (m4 * m8 - m5 * m7) - m1 * (m3 * m8 - m5 * m6) + m2 * (m3 * m7 - m4 * m6);
 }
 
-Matrix4::Matrix4() {
-    setIdentity();
-}
-
-Matrix4::Matrix4(const scalar src[16]) {
-    set(src);
-}
-
-Matrix4::Matrix4(scalar m0, scalar m1, scalar m2, scalar m3,
-                 scalar m4, scalar m5, scalar m6, scalar m7,
-                 scalar m8, scalar m9, scalar m10, scalar m11,
-                 scalar m12, scalar m13, scalar m14, scalar m15) {
-    set(m0, m1, m2, m3,
-        m4, m5, m6, m7,
-        m8, m9, m10, m11,
-        m12, m13, m14, m15);
-}
-
-Matrix4::Matrix4(const Matrix4& mat4) {
-    for (int i = 0; i < 16; i++)
-        m[i] = mat4[i];
-}
-
 Matrix4& Matrix4::operator=(const Matrix4& mat4) {
     if (this == &mat4) {
         return *this;
@@ -900,6 +837,7 @@ void Matrix4::setRow(int index, const scalar data[4]) {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     for (int i = 0; i < 4; ++i) {
@@ -911,6 +849,7 @@ void Matrix4::setRow(int index, const Vector4& v) {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     for (int i = 0; i < 4; ++i) {
@@ -922,6 +861,7 @@ void Matrix4::setColumn(int index, const scalar data[4]) {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     for (int i = 0; i < 4; ++i) {
@@ -933,6 +873,7 @@ void Matrix4::setColumn(int index, const Vector4& v) {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     for (int i = 0; i < 4; ++i) {
@@ -945,6 +886,143 @@ void Matrix4::setIdentity() {
     m[1] = m[2] = m[3] = m[4] = m[6] = m[7] = m[8] = m[9] = m[11] = m[12] = m[13] = m[14] = 0.0f;
 }
 
+void Matrix4::setFrustum(scalar left, scalar right, scalar bottom, scalar top,
+                         scalar zNear, scalar zFar) {
+    if ((left == right) || (bottom == top) || (zNear == zFar)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Invalid frustum.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid frustum!";
+    }
+    // | 2n/(r-l)     0     (r+l)/(r-l)       0      |
+    // |    0      2n/(t-b) (t+b)/(t-b)       0      |
+    // |    0         0     -(f+n)/(f-n) -2fn/(f-n)  |
+    // |    0         0         -1            0      |
+    setIdentity();
+    m[0] = 2 * zNear / (right - left);
+    m[5] = 2 * zNear / (top - bottom);
+    m[8] = (right + left) / (right - left);
+    m[9] = (top + bottom) / (top - bottom);
+    m[10] = -(zFar + zNear) / (zFar - zNear);
+    m[11] = -1;
+    m[14] = -2 * zFar * zNear / (zFar - zNear);
+    m[15] = 0;
+}
+
+void Matrix4::setPerspective(scalar fovY, scalar aspect, scalar zNear, scalar zFar,
+                             ANGLEUNIT unit) {
+    if ((fovY <= 0) || (aspect == 0) || (zNear <= 0) || (zFar <= 0)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Invalid perspective.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid perspective!";
+    }
+    scalar u = (unit == RAD) ? 1 : (DEG2RAD);
+    scalar top = zNear * std::tan(fovY * u * 0.5f);
+    scalar right = top * aspect;
+    setFrustum(-right, right, -top, top, zNear, zFar);
+}
+
+void Matrix4::setInfinitePerspective(scalar fovY, scalar aspect, scalar zNear, ANGLEUNIT unit) {
+    if ((fovY <= 0) || (aspect == 0) || (zNear <= 0)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Invalid perspective.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid perspective!";
+    }
+    // limit of setPerspective() for zFar -> infinity
+    scalar u = (unit == RAD) ? 1 : (DEG2RAD);
+    scalar f = 1 / std::tan(fovY * u * 0.5f);
+    setIdentity();
+    m[0] = f / aspect;
+    m[5] = f;
+    m[10] = -1;
+    m[11] = -1;
+    m[14] = -2 * zNear;
+    m[15] = 0;
+}
+
+void Matrix4::setReversedZPerspective(scalar fovY, scalar aspect, scalar zNear, scalar zFar,
+                                      ANGLEUNIT unit) {
+    if ((fovY <= 0) || (aspect == 0) || (zNear <= 0) || (zNear == zFar)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Invalid perspective.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid perspective!";
+    }
+    // z_ndc = (A * z + B) / -z, z = -n maps to 1 and z = -f maps to 0
+    scalar u = (unit == RAD) ? 1 : (DEG2RAD);
+    scalar f = 1 / std::tan(fovY * u * 0.5f);
+    setIdentity();
+    m[0] = f / aspect;
+    m[5] = f;
+    if (std::isinf(zFar)) {
+        m[10] = 0;
+        m[14] = zNear;
+    } else {
+        m[10] = zNear / (zFar - zNear);
+        m[14] = zFar * zNear / (zFar - zNear);
+    }
+    m[11] = -1;
+    m[15] = 0;
+}
+
+void Matrix4::setOrthographic(scalar left, scalar right, scalar bottom, scalar top,
+                              scalar zNear, scalar zFar) {
+    if ((left == right) || (bottom == top) || (zNear == zFar)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Invalid frustum.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid frustum!";
+    }
+    setIdentity();
+    m[0] = 2 / (right - left);
+    m[5] = 2 / (top - bottom);
+    m[10] = -2 / (zFar - zNear);
+    m[12] = -(right + left) / (right - left);
+    m[13] = -(top + bottom) / (top - bottom);
+    m[14] = -(zFar + zNear) / (zFar - zNear);
+}
+
+void Matrix4::setLookAt(const Vector3& eye, const Vector3& target, const Vector3& up) {
+    // rows of the rotation are the camera axes in world space
+    // | sx  sy  sz  -s.eye |
+    // | ux  uy  uz  -u.eye |
+    // |-fx -fy -fz   f.eye |
+    // |  0   0   0     1   |
+    const Vector3 d = target - eye;
+    if (d.length() < MYEPSILON) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Eye and target coincide.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid view!";
+    }
+    Vector3 f = d.normalized();
+    Vector3 s = f.cross(up);
+    // |f x up| = |up| * sin(angle), below 1e-3 the side axis is mostly rounding noise
+    if (!(s.length() > 1e-3f * up.length())) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Up is parallel to the view direction.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid view!";
+    }
+    s = s.normalized();
+    Vector3 u = s.cross(f);
+    setIdentity();
+    m[0] = s.x;
+    m[4] = s.y;
+    m[8] = s.z;
+    m[1] = u.x;
+    m[5] = u.y;
+    m[9] = u.z;
+    m[2] = -f.x;
+    m[6] = -f.y;
+    m[10] = -f.z;
+    m[12] = -s.dot(eye);
+    m[13] = -u.dot(eye);
+    m[14] = f.dot(eye);
+}
+
 scalar* Matrix4::data() {
     return m;
 }
@@ -957,6 +1035,7 @@ Vector4 Matrix4::getRow(int index) const {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return Vector4(m[index], m[index + 4], m[index + 8], m[index + 12]);
@@ -966,6 +1045,7 @@ Vector4 Matrix4::getColumn(int index) const {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return Vector4(m[index * 4], m[index * 4 + 1], m[index * 4 + 2], m[index * 4 + 3]);
@@ -1007,12 +1087,12 @@ bool Matrix4::isAffineMatrix() const {
     if (std::abs(m[11]) > MYEPSILON) return false;
     if (std::abs(m[15] - 1) > MYEPSILON) return false;
     Matrix3 tmp(m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10]);
-    if (std::abs(tmp.getDeterminant()) > MYEPSILON) return false;
+    if (std::abs(tmp.getDeterminant()) < MYEPSILON) return false;
     return true;
 }
 
 bool Matrix4::isPeojectiveMatrix() const {
-    if (std::abs(m[0] * m[5] - m[1] * m[4]) > MYEPSILON) return false;
+    if (std::abs(m[0] * m[5] - m[1] * m[4]) < MYEPSILON) return false;
     return true;
 }
 
@@ -1025,17 +1105,12 @@ void Matrix4::transpose() {
     std::swap(m[11], m[14]);
 }
 
-Matrix4 Matrix4::transposed() const {
-    return Matrix4(m[0], m[4], m[8], m[12],
-                   m[1], m[5], m[9], m[13],
-                   m[2], m[6], m[10], m[14],
-                   m[3], m[7], m[11], m[15]);
-}
-
 void Matrix4::inverse() {
+    MYMATH_INSTRUMENT_SCOPE(INSTR_MATRIX4_INVERSE);
     if (!this->isInversed()) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Inverse matrix not exists.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Inverse matrix not exists!";
     }
     scalar cofactor0 = getCofactor(m[5], m[6], m[7], m[9], m[10], m[11], m[13], m[14], m[15]);
@@ -1087,9 +1162,11 @@ void Matrix4::inverse() {
 }
 
 Matrix4 Matrix4::computeInverse() const {
+    MYMATH_INSTRUMENT_SCOPE(INSTR_MATRIX4_COMPUTE_INVERSE);
     if (!this->isInversed()) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Inverse matrix not exists.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Inverse matrix not exists!";
     }
     scalar cofactor0 = getCofactor(m[5], m[6], m[7], m[9], m[10], m[11], m[13], m[14], m[15]);
@@ -1146,6 +1223,7 @@ Matrix4 Matrix4::computeInverse() const {
 }
 
 bool Matrix4::isInversed() const {
+    MYMATH_INSTRUMENT_SCOPE(INSTR_MATRIX4_IS_INVERSED);
     if (this->isRotationMatrix()) return true;
     if (this->isEuclideanMatrix()) return true;
     if (this->isAffineMatrix()) return true;
@@ -1158,12 +1236,13 @@ Matrix4 Matrix4::computeRotationInverse() const {
     if (!this->isRotationMatrix()) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Not a rotation matrix.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Not a rotation matrix.";
     }
     Matrix4 ret;
     ret.setIdentity();
     Matrix3 R(m[0], m[1], m[2],
-              m[4], m[5], m[5],
+              m[4], m[5], m[6],
               m[8], m[9], m[10]);
     R.transpose();
     // the first column
@@ -1185,12 +1264,13 @@ Matrix4 Matrix4::computeEuclideanInverse() const {
     if (!this->isEuclideanMatrix()) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Not a eudlidean matrix.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Not a eudlidean matrix.";
     }
     Matrix4 ret;
     ret.setIdentity();
     Matrix3 R(m[0], m[1], m[2],
-              m[4], m[5], m[5],
+              m[4], m[5], m[6],
               m[8], m[9], m[10]);
     R.transpose();
     Vector3 t(m[12], m[13], m[14]);
@@ -1218,12 +1298,13 @@ Matrix4 Matrix4::computeAffineInverse() const {
     if (!this->isAffineMatrix()) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Not a affine matrix.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Not a affine matrix.";
     }
     Matrix4 ret;
     ret.setIdentity();
     Matrix3 R(m[0], m[1], m[2],
-              m[4], m[5], m[5],
+              m[4], m[5], m[6],
               m[8], m[9], m[10]);
     R.inverse();
     Vector3 t(m[12], m[13], m[14]);
@@ -1251,6 +1332,7 @@ Matrix4 Matrix4::computeProjectiveInverse() const {
     if (!this->isPeojectiveMatrix()) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Not a projective matrix.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Not a projective matrix.";
     }
     // partition
@@ -1261,18 +1343,19 @@ Matrix4 Matrix4::computeProjectiveInverse() const {
 
     // pre-compute repeated parts
     a.inverse();            // A^-1
-    Matrix2 ab = a * b;     // A^-1 * B
-    Matrix2 ca = c * a;     // C * A^-1
-    Matrix2 cab = ca * b;   // C * A^-1 * B
-    Matrix2 dcab = d - cab; // D - C * A^-1 * B
+    Matrix2 ab = a.matmul(b);    // A^-1 * B
+    Matrix2 ca = c.matmul(a);    // C * A^-1
+    Matrix2 cab = ca.matmul(b);  // C * A^-1 * B
+    Matrix2 dcab = d - cab;      // D - C * A^-1 * B
 
     // check determinant if |D - C * A^-1 * B| = 0
     //NOTE: this function assumes det(A) is already checked. if |A|=0 then,
     //      cannot use this function.
     scalar determinant = dcab[0] * dcab[3] - dcab[1] * dcab[2];
-    if (std::abs(determinant) > MYEPSILON) {
+    if (std::abs(determinant) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Projective matrix is not reversible.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Projective matrix is not reversible.";
     }
     // compute D' and -D'
@@ -1281,13 +1364,13 @@ Matrix4 Matrix4::computeProjectiveInverse() const {
     Matrix2 d2 = -d1;  // -(D - C * A^-1 * B)^-1
 
     // compute C'
-    Matrix2 c1 = d2 * ca; // -D' * (C * A^-1)
+    Matrix2 c1 = d2.matmul(ca); // -D' * (C * A^-1)
 
     // compute B'
-    Matrix2 b1 = ab * d2; // (A^-1 * B) * -D'
+    Matrix2 b1 = ab.matmul(d2); // (A^-1 * B) * -D'
 
     // compute A'
-    Matrix2 a1 = a - (ab * c1); // A^-1 - (A^-1 * B) * C'
+    Matrix2 a1 = a - ab.matmul(c1); // A^-1 - (A^-1 * B) * C'
 
     Matrix4 ret;
     // assemble inverse matrix
@@ -1311,16 +1394,56 @@ Matrix4 Matrix4::computeProjectiveInverse() const {
     return ret;
 }
 
+Matrix4 Matrix4::computePerspectiveInverse() const {
+    if ((std::abs(m[1]) > MYEPSILON) || (std::abs(m[2]) > MYEPSILON) || (std::abs(m[3]) > MYEPSILON)
+        || (std::abs(m[4]) > MYEPSILON) || (std::abs(m[6]) > MYEPSILON) || (std::abs(m[7]) > MYEPSILON)
+        || (std::abs(m[11] + 1) > MYEPSILON)
+        || (std::abs(m[12]) > MYEPSILON) || (std::abs(m[13]) > MYEPSILON) || (std::abs(m[15]) > MYEPSILON)
+        || (std::abs(m[0]) < MYEPSILON) || (std::abs(m[5]) < MYEPSILON) || (std::abs(m[14]) < MYEPSILON)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Not a perspective matrix.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Not a perspective matrix.";
+    }
+    // | a 0 e 0 |^{-1}   | 1/a  0   0   e/a |
+    // | 0 b f 0 |      = |  0  1/b  0   f/b |
+    // | 0 0 c d |        |  0   0   0   -1  |
+    // | 0 0 -1 0|        |  0   0  1/d  c/d |
+    scalar inv_a = 1 / m[0];
+    scalar inv_b = 1 / m[5];
+    scalar inv_d = 1 / m[14];
+    return Matrix4(inv_a, 0, 0, 0,
+                   0, inv_b, 0, 0,
+                   0, 0, 0, inv_d,
+                   m[8] * inv_a, m[9] * inv_b, -1, m[10] * inv_d);
+}
+
+Matrix4 Matrix4::computeOrthographicInverse() const {
+    if ((std::abs(m[1]) > MYEPSILON) || (std::abs(m[2]) > MYEPSILON) || (std::abs(m[3]) > MYEPSILON)
+        || (std::abs(m[4]) > MYEPSILON) || (std::abs(m[6]) > MYEPSILON) || (std::abs(m[7]) > MYEPSILON)
+        || (std::abs(m[8]) > MYEPSILON) || (std::abs(m[9]) > MYEPSILON) || (std::abs(m[11]) > MYEPSILON)
+        || (std::abs(m[15] - 1) > MYEPSILON)
+        || (std::abs(m[0]) < MYEPSILON) || (std::abs(m[5]) < MYEPSILON) || (std::abs(m[10]) < MYEPSILON)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Not a orthographic matrix.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Not a orthographic matrix.";
+    }
+    scalar inv_a = 1 / m[0];
+    scalar inv_b = 1 / m[5];
+    scalar inv_c = 1 / m[10];
+    return Matrix4(inv_a, 0, 0, 0,
+                   0, inv_b, 0, 0,
+                   0, 0, inv_c, 0,
+                   -m[12] * inv_a, -m[13] * inv_b, -m[14] * inv_c, 1);
+}
+
 Matrix4& Matrix4::translate(scalar x, scalar y, scalar z) {
     // |  1  0  0  x |        |  0  4  8 12 |
     // |  0  1  0  y |        |  1  5  9 13 |
     // |  0  0  1  z | matmul |  2  6 10 14 |
     // |  0  0  0  1 |        |  3  7 11 15 |
-    Matrix4 t;
-    t(0, 3) = x;
-    t(1, 3) = y;
-    t(2, 3) = z;
-    *this = t.matmul(*this);
+    *this = translation(x, y, z).matmul(*this);
     return *this;
 }
 
@@ -1393,11 +1516,7 @@ Matrix4& Matrix4::scale(scalar sx, scalar sy, scalar sz) {
     // |  0  sy   0  0 |        |  1  5  9 13 |
     // |  0   0  sz  0 | matmul |  2  6 10 14 |
     // |  0   0   0  1 |        |  3  7 11 15 |
-    Matrix4 t;
-    t(0, 0) = sx;
-    t(1, 1) = sy;
-    t(2, 2) = sz;
-    *this = t.matmul(*this);
+    *this = scaling(sx, sy, sz).matmul(*this);
     return *this;
 }
 
@@ -1435,27 +1554,12 @@ Matrix4& Matrix4::operator-=(const Matrix4& rhs) {
     return *this;
 }
 
-Matrix4 Matrix4::matmul(const Matrix4& rhs) const {
-    // |  0  4  8 12 | |  0  4  8 12 |
-    // |  1  5  9 13 | |  1  5  9 13 |
-    // |  2  6 10 14 | |  2  6 10 14 |
-    // |  3  7 11 15 | |  3  7 11 15 |
-    Matrix4 ret;
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            ret(i, j) = this->getRow(i).dot(rhs.getColumn(j));
-        }
-    }
-    return ret;
-}
-
-Vector4 Matrix4::operator*(const Vector4& rhs) const {
-    Vector4 ret;
-    for (int i = 0; i < 4; ++i) {
-        ret[i] = this->getRow(i).dot(rhs);
-    }
-    return ret;
+#ifdef MYMATH_INSTRUMENT
+void Matrix4::countMatmul() {
+    // a count only, a timer around a 4x4 product would cost more than the product
+    bumpInstrumentCounter(getInstrumentBlock().calls[INSTR_MATRIX4_MATMUL], 1);
 }
+#endif
 
 Matrix4 Matrix4::operator*(const Matrix4& rhs) const {
     Matrix4 ret;
@@ -1489,6 +1593,7 @@ Matrix4 Matrix4::operator/(const scalar& rhs) const {
     if (std::abs(rhs) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     Matrix4 ret;
@@ -1502,6 +1607,7 @@ Matrix4& Matrix4::operator/=(const scalar& rhs) {
     if (std::abs(rhs) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     for (int i = 0; i < 16; ++i) {
@@ -1541,6 +1647,7 @@ scalar Matrix4::operator[](int index) const {
     if ((index > 15) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[index];
@@ -1550,6 +1657,7 @@ scalar& Matrix4::operator[](int index) {
     if ((index > 15) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[index];
@@ -1559,6 +1667,7 @@ scalar Matrix4::operator()(int i, int j) const {
     if ((i < 0) || (i > 3) || (j < 0) || (j > 3)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[j * 4 + i];
@@ -1568,6 +1677,7 @@ scalar& Matrix4::operator()(int i, int j) {
     if ((i < 0) || (i > 3) || (j < 0) || (j > 3)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return m[j * 4 + i];
@@ -0,0 +1,177 @@
+#include "mymorton.hpp"
+#include "mybatch.hpp"
+#include "myarena.hpp"
+
+#include <algorithm>
+
+/** @brief elements handled by one parallel task. */
+static const size_t SORT_GRAIN = 1 << 16;
+
+void hilbertDecode(uint64_t code, int bits, uint32_t& x, uint32_t& y, uint32_t& z) {
+    uint32_t X[3];
+    X[2] = static_cast<uint32_t>(mortonCompact21(code));
+    X[1] = static_cast<uint32_t>(mortonCompact21(code >> 1));
+    X[0] = static_cast<uint32_t>(mortonCompact21(code >> 2));
+    // gray decode
+    uint32_t t = X[2] >> 1;
+    X[2] ^= X[1];
+    X[1] ^= X[0];
+    X[0] ^= t;
+    // undo excess work
+    const uint32_t last = uint32_t(2) << (bits - 1);
+    for (uint32_t q = 2; q != last; q <<= 1) {
+        const uint32_t p = q - 1;
+        for (int i = 2; i >= 0; --i) {
+            if (X[i] & q) {
+                X[0] ^= p;
+            } else {
+                t = (X[0] ^ X[i]) & p;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    x = X[0];
+    y = X[1];
+    z = X[2];
+}
+
+/** @brief scale from box coordinates to cell coordinates on a 2^bits grid. */
+static Vector3 gridScale(const Vector3& boxMin, const Vector3& boxMax, int bits) {
+    const scalar cells = static_cast<scalar>(uint32_t(1) << bits);
+    Vector3 e = boxMax - boxMin;
+    return Vector3((e.x > 0) ? cells / e.x : 0,
+                   (e.y > 0) ? cells / e.y : 0,
+                   (e.z > 0) ? cells / e.z : 0);
+}
+
+/** @brief clamp a cell coordinate into [0, last], branch-free. */
+static inline uint32_t quantize(scalar v, scalar last) {
+    return static_cast<uint32_t>(std::min(std::max(v, scalar(0)), last));
+}
+
+void computeSpatialCodes(const Vector3* points, size_t n,
+                         const Vector3& boxMin, const Vector3& boxMax,
+                         uint64_t* codes, CURVETYPE curve) {
+    const Vector3 s = gridScale(boxMin, boxMax, MORTON63_BITS);
+    const scalar last = static_cast<scalar>((uint32_t(1) << MORTON63_BITS) - 1);
+    parallelFor(0, n, SORT_GRAIN, [&](size_t lo, size_t hi) {
+        if (curve == HILBERT) {
+            for (size_t i = lo; i < hi; ++i) {
+                codes[i] = hilbertEncode(quantize((points[i].x - boxMin.x) * s.x, last),
+                                         quantize((points[i].y - boxMin.y) * s.y, last),
+                                         quantize((points[i].z - boxMin.z) * s.z, last),
+                                         MORTON63_BITS);
+            }
+        } else {
+            for (size_t i = lo; i < hi; ++i) {
+                codes[i] = mortonEncode63(quantize((points[i].x - boxMin.x) * s.x, last),
+                                          quantize((points[i].y - boxMin.y) * s.y, last),
+                                          quantize((points[i].z - boxMin.z) * s.z, last));
+            }
+        }
+    });
+}
+
+void computeSpatialCodes30(const Vector3* points, size_t n,
+                           const Vector3& boxMin, const Vector3& boxMax,
+                           uint32_t* codes, CURVETYPE curve) {
+    const Vector3 s = gridScale(boxMin, boxMax, MORTON30_BITS);
+    const scalar last = static_cast<scalar>((uint32_t(1) << MORTON30_BITS) - 1);
+    parallelFor(0, n, SORT_GRAIN, [&](size_t lo, size_t hi) {
+        if (curve == HILBERT) {
+            for (size_t i = lo; i < hi; ++i) {
+                codes[i] = static_cast<uint32_t>(hilbertEncode(quantize((points[i].x - boxMin.x) * s.x, last),
+                                                               quantize((points[i].y - boxMin.y) * s.y, last),
+                                                               quantize((points[i].z - boxMin.z) * s.z, last),
+                                                               MORTON30_BITS));
+            }
+        } else {
+            for (size_t i = lo; i < hi; ++i) {
+                codes[i] = mortonEncode30(quantize((points[i].x - boxMin.x) * s.x, last),
+                                          quantize((points[i].y - boxMin.y) * s.y, last),
+                                          quantize((points[i].z - boxMin.z) * s.z, last));
+            }
+        }
+    });
+}
+
+template <typename Key>
+static void radixSortImpl(Key* keys, uint32_t* perm, size_t n) {
+    parallelFor(0, n, SORT_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) perm[i] = static_cast<uint32_t>(i);
+    });
+    if (n < 2) return;
+
+    // fixed partition: chunk c owns one histogram row, scatter stays stable
+    const size_t chunks = std::min<size_t>(getThreadCount(), (n + SORT_GRAIN - 1) / SORT_GRAIN);
+    ArenaScope scratch(getThreadArena());
+    size_t* hist = scratch.allocateUninitialized<size_t>(chunks * 256);
+    Key* src_key = keys;
+    Key* dst_key = scratch.allocateUninitialized<Key>(n);
+    uint32_t* src_perm = perm;
+    uint32_t* dst_perm = scratch.allocateUninitialized<uint32_t>(n);
+
+    for (unsigned int shift = 0; shift < 8 * sizeof(Key); shift += 8) {
+        parallelFor(0, chunks, 1, [&](size_t first, size_t last) {
+            for (size_t c = first; c < last; ++c) {
+                size_t* h = hist + c * 256;
+                std::fill(h, h + 256, 0);
+                const size_t end = (c + 1) * n / chunks;
+                for (size_t i = c * n / chunks; i < end; ++i) {
+                    ++h[(src_key[i] >> shift) & 0xff];
+                }
+            }
+        });
+        // digit-major, chunk-minor exclusive scan
+        size_t offset = 0;
+        bool trivial = false;
+        for (size_t d = 0; d < 256; ++d) {
+            size_t start = offset;
+            for (size_t c = 0; c < chunks; ++c) {
+                size_t count = hist[c * 256 + d];
+                hist[c * 256 + d] = offset;
+                offset += count;
+            }
+            if (offset - start == n) trivial = true;
+        }
+        if (trivial) continue;
+        parallelFor(0, chunks, 1, [&](size_t first, size_t last) {
+            for (size_t c = first; c < last; ++c) {
+                size_t* h = hist + c * 256;
+                const size_t end = (c + 1) * n / chunks;
+                for (size_t i = c * n / chunks; i < end; ++i) {
+                    size_t pos = h[(src_key[i] >> shift) & 0xff]++;
+                    dst_key[pos] = src_key[i];
+                    dst_perm[pos] = src_perm[i];
+                }
+            }
+        });
+        std::swap(src_key, dst_key);
+        std::swap(src_perm, dst_perm);
+    }
+    if (src_key != keys) {
+        parallelFor(0, n, SORT_GRAIN, [&](size_t lo, size_t hi) {
+            std::copy(src_key + lo, src_key + hi, keys + lo);
+            std::copy(src_perm + lo, src_perm + hi, perm + lo);
+        });
+    }
+}
+
+void radixSortByKey(uint64_t* keys, uint32_t* perm, size_t n) {
+    radixSortImpl(keys, perm, n);
+}
+
+void radixSortByKey(uint32_t* keys, uint32_t* perm, size_t n) {
+    radixSortImpl(keys, perm, n);
+}
+
+void spatialSort(Vector3* points, size_t n, std::vector<uint32_t>& perm, CURVETYPE curve) {
+    Vector3 lo, hi;
+    computeBounds(points, n, lo, hi);
+    std::vector<uint64_t> codes(n);
+    computeSpatialCodes(points, n, lo, hi, codes.data(), curve);
+    perm.resize(n);
+    radixSortByKey(codes.data(), perm.data(), n);
+    reorderByPermutation(points, perm.data(), n);
+}
@@ -0,0 +1,252 @@
+#include "myoctree.hpp"
+#include "mymorton.hpp"
+#include "myparallel.hpp"
+#include "myinstrument.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Octree::Octree(const Vector3& boundsMin, scalar boundsSize, int maxDepth) :
+    origin(boundsMin), extent(boundsSize), max_depth(maxDepth) {
+    if (!(boundsSize > 0) || (maxDepth < 0) || (maxDepth > MORTON63_BITS)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Invalid octree bounds or depth.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid octree bounds or depth!";
+    }
+    levels.resize(max_depth + 1);
+    leaf_start.assign(1, 0);
+}
+
+uint64_t Octree::size() const {
+    return levels[0].nodes.empty() ? 0 : levels[0].nodes[0].count;
+}
+
+size_t Octree::nodeCount(int level) const {
+    if ((level < 0) || (level > max_depth)) return 0;
+    return levels[level].keys.size();
+}
+
+void Octree::clear() {
+    for (auto& level : levels) {
+        level.keys.clear();
+        level.nodes.clear();
+    }
+    sorted_points.clear();
+    leaf_start.assign(1, 0);
+}
+
+bool Octree::leafCode(const Vector3& p, uint64_t& code) const {
+    const scalar cells = static_cast<scalar>(uint64_t(1) << max_depth);
+    const scalar u = cells / extent;
+    scalar fx = (p.x - origin.x) * u;
+    scalar fy = (p.y - origin.y) * u;
+    scalar fz = (p.z - origin.z) * u;
+    // the negated test also rejects NaN
+    if (!((fx >= 0) && (fy >= 0) && (fz >= 0) && (fx <= cells) && (fy <= cells) && (fz <= cells))) {
+        return false;
+    }
+    // points on the max faces belong to the last cell
+    const uint32_t last = (uint32_t(1) << max_depth) - 1;
+    uint32_t x = std::min(static_cast<uint32_t>(fx), last);
+    uint32_t y = std::min(static_cast<uint32_t>(fy), last);
+    uint32_t z = std::min(static_cast<uint32_t>(fz), last);
+    code = mortonEncode63(x, y, z);
+    return true;
+}
+
+void Octree::insertCode(uint64_t code, const Vector3& p) {
+    for (int level = max_depth; level >= 0; --level) {
+        OctreeLevel& lv = levels[level];
+        const uint64_t key = code >> (3 * (max_depth - level));
+        const size_t i = lv.lowerBound(key);
+        if ((i == lv.keys.size()) || (lv.keys[i] != key)) {
+            lv.keys.insert(lv.keys.begin() + i, key);
+            lv.nodes.insert(lv.nodes.begin() + i, OctreeNode());
+            if (level == max_depth) {
+                // an empty range where the new leaf starts
+                const size_t start = leaf_start[i];
+                leaf_start.insert(leaf_start.begin() + i, start);
+            }
+        }
+        OctreeNode& node = lv.nodes[i];
+        node.sum[0] += p.x;
+        node.sum[1] += p.y;
+        node.sum[2] += p.z;
+        node.count += 1;
+        if (level < max_depth) {
+            node.children |= static_cast<uint8_t>(1u << ((code >> (3 * (max_depth - level - 1))) & 7));
+        } else {
+            sorted_points.insert(sorted_points.begin() + leaf_start[i + 1], p);
+            for (size_t k = i + 1; k < leaf_start.size(); ++k) ++leaf_start[k];
+        }
+    }
+}
+
+void Octree::buildLevel(int level) {
+    const OctreeLevel& next = levels[level + 1];
+    OctreeLevel& lv = levels[level];
+    lv.keys.clear();
+    lv.nodes.clear();
+    for (size_t i = 0; i < next.keys.size(); ++i) {
+        const uint64_t key = next.keys[i] >> 3;
+        // children of a node are adjacent in the sorted level below
+        if (lv.keys.empty() || (lv.keys.back() != key)) {
+            lv.keys.push_back(key);
+            lv.nodes.push_back(OctreeNode());
+        }
+        OctreeNode& node = lv.nodes.back();
+        const OctreeNode& child = next.nodes[i];
+        node.sum[0] += child.sum[0];
+        node.sum[1] += child.sum[1];
+        node.sum[2] += child.sum[2];
+        node.count += child.count;
+        node.children |= static_cast<uint8_t>(1u << (next.keys[i] & 7));
+    }
+}
+
+bool Octree::insert(const Vector3& p) {
+    uint64_t code;
+    if (!leafCode(p, code)) return false;
+    insertCode(code, p);
+    return true;
+}
+
+size_t Octree::insert(const Vector3* points, size_t n) {
+    const uint64_t INVALID = ~uint64_t(0);
+    std::vector<uint64_t> codes(n);
+    parallelFor(0, n, 1 << 14, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            if (!leafCode(points[i], codes[i])) codes[i] = INVALID;
+        }
+    });
+    std::vector<uint32_t> index;
+    index.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (codes[i] != INVALID) index.push_back(static_cast<uint32_t>(i));
+    }
+    const size_t m = index.size();
+    if (m == 0) return 0;
+    std::vector<uint64_t> keys(m);
+    for (size_t k = 0; k < m; ++k) keys[k] = codes[index[k]];
+    // stable, points of a leaf keep the batch order
+    std::vector<uint32_t> perm(m);
+    radixSortByKey(keys.data(), perm.data(), m);
+
+    // merge the sorted batch into the leaves, old points of a leaf come first
+    const OctreeLevel& old_leaves = levels[max_depth];
+    OctreeLevel leaves;
+    std::vector<Vector3> merged_points;
+    std::vector<size_t> merged_start;
+    leaves.keys.reserve(old_leaves.keys.size() + m);
+    leaves.nodes.reserve(old_leaves.keys.size() + m);
+    merged_points.reserve(sorted_points.size() + m);
+    merged_start.reserve(old_leaves.keys.size() + m + 1);
+    size_t i = 0, k = 0;
+    while ((i < old_leaves.keys.size()) || (k < m)) {
+        const uint64_t key = (k == m) ? old_leaves.keys[i]
+                             : (i == old_leaves.keys.size()) ? keys[k] : std::min(old_leaves.keys[i], keys[k]);
+        OctreeNode node;
+        merged_start.push_back(merged_points.size());
+        if ((i < old_leaves.keys.size()) && (old_leaves.keys[i] == key)) {
+            node = old_leaves.nodes[i];
+            merged_points.insert(merged_points.end(), sorted_points.begin() + leaf_start[i],
+                                 sorted_points.begin() + leaf_start[i + 1]);
+            ++i;
+        }
+        for (; (k < m) && (keys[k] == key); ++k) {
+            const Vector3& p = points[index[perm[k]]];
+            node.sum[0] += p.x;
+            node.sum[1] += p.y;
+            node.sum[2] += p.z;
+            node.count += 1;
+            merged_points.push_back(p);
+        }
+        leaves.keys.push_back(key);
+        leaves.nodes.push_back(node);
+    }
+    merged_start.push_back(merged_points.size());
+    levels[max_depth] = std::move(leaves);
+    sorted_points = std::move(merged_points);
+    leaf_start = std::move(merged_start);
+    for (int level = max_depth - 1; level >= 0; --level) buildLevel(level);
+    return m;
+}
+
+bool Octree::remove(const Vector3& p) {
+    uint64_t code;
+    if (!leafCode(p, code)) return false;
+    const size_t leaf = levels[max_depth].find(code);
+    if (leaf == levels[max_depth].keys.size()) return false;
+    auto begin = sorted_points.begin() + leaf_start[leaf];
+    auto end = sorted_points.begin() + leaf_start[leaf + 1];
+    auto found = std::find(begin, end, p);
+    if (found == end) return false;
+    sorted_points.erase(found);
+    for (size_t k = leaf + 1; k < leaf_start.size(); ++k) --leaf_start[k];
+
+    bool child_erased = false;
+    for (int level = max_depth; level >= 0; --level) {
+        OctreeLevel& lv = levels[level];
+        const size_t i = lv.find(code >> (3 * (max_depth - level)));
+        OctreeNode& node = lv.nodes[i];
+        if (child_erased) {
+            node.children &= static_cast<uint8_t>(~(1u << ((code >> (3 * (max_depth - level - 1))) & 7)));
+        }
+        node.sum[0] -= p.x;
+        node.sum[1] -= p.y;
+        node.sum[2] -= p.z;
+        node.count -= 1;
+        child_erased = (node.count == 0);
+        if (child_erased) {
+            lv.keys.erase(lv.keys.begin() + i);
+            lv.nodes.erase(lv.nodes.begin() + i);
+            if (level == max_depth) leaf_start.erase(leaf_start.begin() + i + 1);
+        }
+    }
+    return true;
+}
+
+const OctreeNode* Octree::getNode(int level, uint64_t key) const {
+    if ((level < 0) || (level > max_depth)) return nullptr;
+    const size_t i = levels[level].find(key);
+    return (i == levels[level].keys.size()) ? nullptr : &levels[level].nodes[i];
+}
+
+void Octree::getNodeBounds(int level, uint64_t key, Vector3& boxMin, Vector3& boxMax) const {
+    uint32_t x, y, z;
+    mortonDecode63(key, x, y, z);
+    const scalar cell = extent / static_cast<scalar>(uint64_t(1) << level);
+    boxMin.set(origin.x + x * cell, origin.y + y * cell, origin.z + z * cell);
+    boxMax.set(boxMin.x + cell, boxMin.y + cell, boxMin.z + cell);
+}
+
+void Octree::exportLevel(int level, std::vector<OctreeNodeRecord>& out) const {
+    if ((level < 0) || (level > max_depth)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Index out of bounds!";
+    }
+    const OctreeLevel& lv = levels[level];
+    out.clear();
+    out.reserve(lv.keys.size());
+    for (size_t i = 0; i < lv.keys.size(); ++i) {
+        out.push_back(OctreeNodeRecord{lv.keys[i], lv.nodes[i].centroid(), lv.nodes[i].count});
+    }
+}
+
+CONTAINMENT Octree::classifyBox(const Vector3& boxMin, const Vector3& boxMax,
+                                const Vector3& lo, const Vector3& hi) {
+    if ((hi.x < boxMin.x) || (lo.x > boxMax.x)
+        || (hi.y < boxMin.y) || (lo.y > boxMax.y)
+        || (hi.z < boxMin.z) || (lo.z > boxMax.z)) {
+        return OUTSIDE;
+    }
+    if ((lo.x >= boxMin.x) && (hi.x <= boxMax.x)
+        && (lo.y >= boxMin.y) && (hi.y <= boxMax.y)
+        && (lo.z >= boxMin.z) && (hi.z <= boxMax.z)) {
+        return INSIDE;
+    }
+    return INTERSECT;
+}
@@ -0,0 +1,292 @@
+#include "myparallel.hpp"
+#include "mytrace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @brief one parallelFor() call, shared by all of its tasks. */
+struct ParallelJob {
+    const std::function<void(size_t, size_t)>* body;
+    size_t grain;
+    /** @brief tasks pushed but not finished yet. */
+    std::atomic<size_t> pending;
+    /** @brief set after the first exception, remaining tasks are skipped. */
+    std::atomic<bool> failed;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+/** @brief a sub-range of a job. */
+struct ParallelTask {
+    ParallelJob* job;
+    size_t lo;
+    size_t hi;
+};
+
+/** @brief double ended ring buffer of tasks, it only grows, so a steady state does not allocate. */
+class TaskRing {
+  private:
+    /** @brief power of two slots, the tasks are slots[head .. head + count) modulo the size. */
+    std::vector<ParallelTask> slots;
+    size_t head = 0;
+    size_t count = 0;
+
+    void grow() {
+        std::vector<ParallelTask> bigger(2 * slots.size());
+        for (size_t i = 0; i < count; ++i) bigger[i] = slots[(head + i) & (slots.size() - 1)];
+        slots.swap(bigger);
+        head = 0;
+    }
+
+  public:
+    /** @brief a task pushes one task per halving of its range, 64 slots hold the splits of nested loops. */
+    TaskRing() : slots(64) {}
+
+    bool empty() const { return count == 0; }
+    void pushBack(const ParallelTask& task) {
+        if (count == slots.size()) grow();
+        slots[(head + count) & (slots.size() - 1)] = task;
+        ++count;
+    }
+    ParallelTask popBack() {
+        --count;
+        return slots[(head + count) & (slots.size() - 1)];
+    }
+    ParallelTask popFront() {
+        const ParallelTask task = slots[head];
+        head = (head + 1) & (slots.size() - 1);
+        --count;
+        return task;
+    }
+};
+
+struct WorkStealingPool::State {
+    /** @brief queue of worker i is queues[i], queues[0] is shared by threads outside the pool. */
+    struct Queue {
+        std::mutex queue_mutex;
+        TaskRing tasks;
+    };
+
+    unsigned int thread_count;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    /** @brief number of tasks in all queues. */
+    std::atomic<size_t> queued;
+    /** @brief number of workers waiting on sleep_cv. */
+    std::atomic<unsigned int> sleeping;
+    std::atomic<bool> stop;
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+
+    /** @brief pool of the current thread, nullptr outside of any pool. */
+    static thread_local State* current;
+    /** @brief queue index of the current thread in current. */
+    static thread_local size_t slot;
+
+    /** @brief queue used by the calling thread. */
+    size_t callerSlot() const { return (current == this) ? slot : 0; }
+
+    void push(size_t q, const ParallelTask& task) {
+        {
+            std::lock_guard<std::mutex> lock(queues[q]->queue_mutex);
+            queues[q]->tasks.pushBack(task);
+        }
+        queued.fetch_add(1);
+        // pairs with the sleeping increment in workerLoop(), one of both sees the other
+        if (sleeping.load() > 0) {
+            { std::lock_guard<std::mutex> lock(sleep_mutex); }
+            sleep_cv.notify_one();
+        }
+    }
+
+    /** @brief newest task of the own queue, else oldest task of another queue. */
+    bool take(size_t own, ParallelTask& task) {
+        if (queued.load(std::memory_order_relaxed) == 0) return false;
+        {
+            Queue& q = *queues[own];
+            std::lock_guard<std::mutex> lock(q.queue_mutex);
+            if (!q.tasks.empty()) {
+                task = q.tasks.popBack();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); ++k) {
+            Queue& q = *queues[(own + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.queue_mutex);
+            if (!q.tasks.empty()) {
+                task = q.tasks.popFront();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** @brief split off upper halves for thieves, run the rest. */
+    void execute(size_t own, ParallelTask task) {
+        ParallelJob& job = *task.job;
+        for (;;) {
+            const size_t chunks = (task.hi - task.lo + job.grain - 1) / job.grain;
+            if (chunks <= 1) break;
+            const size_t mid = task.lo + (chunks / 2) * job.grain;
+            job.pending.fetch_add(1);
+            push(own, ParallelTask{&job, mid, task.hi});
+            task.hi = mid;
+        }
+        if (!job.failed.load(std::memory_order_relaxed)) {
+            try {
+                MYMATH_TRACE_SPAN("parallelFor task", task.hi - task.lo);
+                (*job.body)(task.lo, task.hi);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.error_mutex);
+                if (!job.error) job.error = std::current_exception();
+                job.failed.store(true);
+            }
+        }
+        job.pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    void workerLoop(size_t index) {
+        current = this;
+        slot = index;
+#ifdef MYMATH_TRACE
+        setTraceThreadName("mymath worker " + std::to_string(index));
+#endif
+        ParallelTask task;
+        while (!stop.load(std::memory_order_relaxed)) {
+            bool found = false;
+            for (int spin = 0; (spin < 64) && !found; ++spin) {
+                found = take(index, task);
+                if (!found) std::this_thread::yield();
+            }
+            if (found) {
+                execute(index, task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleeping.fetch_add(1);
+            sleep_cv.wait(lock, [&]() { return (queued.load() > 0) || stop.load(); });
+            sleeping.fetch_sub(1);
+        }
+        current = nullptr;
+    }
+};
+
+thread_local WorkStealingPool::State* WorkStealingPool::State::current = nullptr;
+thread_local size_t WorkStealingPool::State::slot = 0;
+
+WorkStealingPool::WorkStealingPool(unsigned int threads) :
+    state(new State) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    state->thread_count = threads;
+    state->queued.store(0);
+    state->sleeping.store(0);
+    state->stop.store(false);
+    for (unsigned int i = 0; i < threads; ++i) {
+        state->queues.emplace_back(new State::Queue);
+    }
+    // the calling thread is the remaining worker
+    for (unsigned int i = 1; i < threads; ++i) {
+        state->threads.emplace_back([this, i]() { state->workerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(state->sleep_mutex);
+        state->stop.store(true);
+    }
+    state->sleep_cv.notify_all();
+    for (auto& t : state->threads) {
+        t.join();
+    }
+}
+
+unsigned int WorkStealingPool::concurrency() const {
+    return state->thread_count;
+}
+
+void WorkStealingPool::parallelFor(size_t begin, size_t end, size_t grain,
+                                   const std::function<void(size_t, size_t)>& body) {
+    if (end <= begin) return;
+    if (grain == 0) grain = 1;
+    if ((state->thread_count <= 1) || (end - begin <= grain)) {
+        body(begin, end);
+        return;
+    }
+
+    ParallelJob job;
+    job.body = &body;
+    job.grain = grain;
+    job.pending.store(1);
+    job.failed.store(false);
+    const size_t own = state->callerSlot();
+    state->execute(own, ParallelTask{&job, begin, end});
+    // help with any pending work, ours or not, until our tasks are done
+    ParallelTask task;
+    while (job.pending.load(std::memory_order_acquire) != 0) {
+        if (state->take(own, task)) {
+            state->execute(own, task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    if (job.error) std::rethrow_exception(job.error);
+}
+
+static std::atomic<unsigned int> g_thread_count(0);
+static std::mutex g_pool_mutex;
+static std::unique_ptr<WorkStealingPool> g_pool;
+static std::atomic<Executor*> g_executor(nullptr);
+
+/** @brief thread count requested for the built-in pool. */
+static unsigned int requestedThreadCount() {
+    unsigned int n = g_thread_count.load(std::memory_order_relaxed);
+    if (n == 0) {
+        n = std::thread::hardware_concurrency();
+    }
+    return (n == 0) ? 1 : n;
+}
+
+void setExecutor(Executor* executor) {
+    g_executor.store(executor);
+}
+
+Executor& getExecutor() {
+    Executor* executor = g_executor.load();
+    if (executor) return *executor;
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+    const unsigned int n = requestedThreadCount();
+    if (!g_pool || (g_pool->concurrency() != n)) {
+        g_pool.reset();
+        g_pool.reset(new WorkStealingPool(n));
+    }
+    return *g_pool;
+}
+
+unsigned int getThreadCount() {
+    Executor* executor = g_executor.load();
+    return executor ? executor->concurrency() : requestedThreadCount();
+}
+
+void setThreadCount(unsigned int n) {
+    g_thread_count.store(n, std::memory_order_relaxed);
+}
+
+void parallelFor(size_t begin, size_t end, size_t grain,
+                 const std::function<void(size_t, size_t)>& body) {
+    if (end <= begin) return;
+    if (grain == 0) grain = 1;
+    if ((end - begin <= grain) || (getThreadCount() <= 1)) {
+        body(begin, end);
+        return;
+    }
+    getExecutor().parallelFor(begin, end, grain, body);
+}
@@ -0,0 +1,577 @@
+#include "myreader.hpp"
+#include "myparallel.hpp"
+#include "myinstrument.hpp"
+#include "mytrace.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <clocale>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+/** @brief bytes read from the file at once. */
+static const size_t READ_CHUNK = size_t(1) << 24;
+/** @brief bytes of text parsed by one parallel task. */
+static const size_t PARSE_GRAIN = size_t(1) << 18;
+/** @brief binary vertices converted by one parallel task. */
+static const size_t VERTEX_GRAIN = size_t(1) << 15;
+
+/** @brief true if [p, last) starts with word, ignoring case. */
+static inline bool startsWith(const char* p, const char* last, const char* word) {
+    for (; *word; ++p, ++word) {
+        if ((p == last) || (std::tolower(static_cast<unsigned char>(*p)) != *word)) return false;
+    }
+    return true;
+}
+
+/** @brief "inf", "infinity", "nan" or "nan(chars)" after the sign, like strtod() in the C locale. */
+static const char* parseSpecial(const char* p, const char* last, bool negative, scalar& value) {
+    if (startsWith(p, last, "inf")) {
+        p += startsWith(p, last, "infinity") ? 8 : 3;
+        value = negative ? -std::numeric_limits<scalar>::infinity() : std::numeric_limits<scalar>::infinity();
+        return p;
+    }
+    if (!startsWith(p, last, "nan")) return nullptr;
+    p += 3;
+    if ((p < last) && (*p == '(')) {
+        const char* q = p + 1;
+        while ((q < last) && (std::isalnum(static_cast<unsigned char>(*q)) || (*q == '_'))) ++q;
+        if ((q < last) && (*q == ')')) p = q + 1;
+    }
+    value = negative ? -std::numeric_limits<scalar>::quiet_NaN() : std::numeric_limits<scalar>::quiet_NaN();
+    return p;
+}
+
+const char* parseScalar(const char* first, const char* last, scalar& value) {
+    static const double POW10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* p = first;
+    bool negative = false;
+    if ((p < last) && ((*p == '-') || (*p == '+'))) {
+        negative = (*p == '-');
+        ++p;
+    }
+    // mantissa of at most 19 significant digits and its decimal exponent
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false, exact = true;
+    for (; (p < last) && (*p >= '0') && (*p <= '9'); ++p) {
+        any = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += (mantissa != 0);
+        } else {
+            ++exponent;
+            exact &= (*p == '0');
+        }
+    }
+    if ((p < last) && (*p == '.')) {
+        for (++p; (p < last) && (*p >= '0') && (*p <= '9'); ++p) {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += (mantissa != 0);
+                --exponent;
+            } else {
+                exact &= (*p == '0');
+            }
+        }
+    }
+    if (any && (p < last) && ((*p == 'e') || (*p == 'E'))) {
+        const char* q = p + 1;
+        bool negative_exp = false;
+        if ((q < last) && ((*q == '-') || (*q == '+'))) {
+            negative_exp = (*q == '-');
+            ++q;
+        }
+        if ((q < last) && (*q >= '0') && (*q <= '9')) {
+            int e = 0;
+            for (; (q < last) && (*q >= '0') && (*q <= '9'); ++q) {
+                if (e < 100000) e = e * 10 + (*q - '0');
+            }
+            exponent += negative_exp ? -e : e;
+            p = q;
+        }
+    }
+    // Clinger's fast path, both operands are exact doubles so the result is correctly rounded
+    if (any && exact && (mantissa < (uint64_t(1) << 53)) && (exponent >= -22) && (exponent <= 22)) {
+        double d = static_cast<double>(mantissa);
+        d = (exponent < 0) ? d / POW10[-exponent] : d * POW10[exponent];
+        value = static_cast<scalar>(negative ? -d : d);
+        return p;
+    }
+
+    if (!any) return parseSpecial(p, last, negative, value);
+
+    // long mantissas and huge exponents, strtod() of the whole token, [first, p) is a valid
+    // strtod() number, only its decimal point has to be the one of the current locale
+    const char* point = localeconv()->decimal_point;
+    const size_t point_len = std::strlen(point);
+    const size_t len = static_cast<size_t>(p - first);
+    char stack[128];
+    std::vector<char> heap;
+    char* buffer = stack;
+    if (len * point_len + 1 > sizeof(stack)) {
+        heap.resize(len * point_len + 1);
+        buffer = heap.data();
+    }
+    char* q = buffer;
+    for (const char* c = first; c < p; ++c) {
+        if (*c == '.') {
+            std::memcpy(q, point, point_len);
+            q += point_len;
+        } else {
+            *q++ = *c;
+        }
+    }
+    *q = 0;
+    char* end = nullptr;
+    const double d = strtod(buffer, &end);
+    if (end != q) return nullptr;
+    value = static_cast<scalar>(d);
+    return p;
+}
+
+/** @brief growing structure of arrays output. */
+struct Coords {
+    std::vector<scalar> x, y, z;
+
+    size_t size() const { return x.size(); }
+    void append(const Coords& other) {
+        x.insert(x.end(), other.x.begin(), other.x.end());
+        y.insert(y.end(), other.y.begin(), other.y.end());
+        z.insert(z.end(), other.z.begin(), other.z.end());
+    }
+};
+
+static inline bool isSeparator(char c) {
+    return (c == ' ') || (c == '\t') || (c == ',') || (c == ';') || (c == '\r');
+}
+
+static inline const char* skipSeparators(const char* p, const char* end) {
+    while ((p < end) && isSeparator(*p)) ++p;
+    return p;
+}
+
+/** @brief parse up to three separated numbers. */
+static inline bool parseTriple(const char* p, const char* end, scalar v[3]) {
+    for (int k = 0; k < 3; ++k) {
+        p = skipSeparators(p, end);
+        p = parseScalar(p, end, v[k]);
+        if (!p || ((p < end) && !isSeparator(*p))) return false;
+    }
+    return true;
+}
+
+/** @brief print a read error with the location of its site, count it and throw the message. */
+#define THROW_READ_ERROR(what)                                                                     \
+    do {                                                                                           \
+        fprintf(stderr, "File %s, Line %d, Function %s(): %s\n", __FILE__, __LINE__, __FUNCTION__, what); \
+        MYMATH_COUNT_ERROR();                                                                      \
+        throw what;                                                                                \
+    } while (0)
+
+/** @brief points written into a Vector3SoABuffer. */
+struct SoASink {
+    Vector3SoABuffer& out;
+    Vector3SoA view;
+
+    explicit SoASink(Vector3SoABuffer& buffer) : out(buffer) {}
+    void resize(size_t n) {
+        out.resize(n);
+        view = out.view();
+    }
+    void set(size_t i, scalar x, scalar y, scalar z) {
+        view.x[i] = x;
+        view.y[i] = y;
+        view.z[i] = z;
+    }
+};
+
+/** @brief points written into a Vector3 array. */
+struct AoSSink {
+    std::vector<Vector3>& out;
+
+    explicit AoSSink(std::vector<Vector3>& points) : out(points) {}
+    void resize(size_t n) { out.resize(n); }
+    void set(size_t i, scalar x, scalar y, scalar z) { out[i].set(x, y, z); }
+};
+
+/** @brief copy parsed text points into a sink. */
+template <typename Sink>
+static void copyCoords(const Coords& coords, Sink& sink) {
+    sink.resize(coords.size());
+    parallelFor(0, coords.size(), VERTEX_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) sink.set(i, coords.x[i], coords.y[i], coords.z[i]);
+    });
+}
+
+/**
+ * @brief parse the whole lines of [begin, end) in parallel, append the points in line order.
+ * @param maxLines lines after the first maxLines are ignored.
+ * @param pieces scratch kept by the caller between chunks.
+ * @return number of lines, at most maxLines.
+ */
+template <typename LineParser>
+static size_t parseLines(const char* begin, const char* end, size_t maxLines, LineParser parse,
+                         std::vector<Coords>& pieces, Coords& out) {
+    const size_t bytes = end - begin;
+    const size_t count = std::max<size_t>(1, bytes / PARSE_GRAIN);
+    // piece boundaries moved forward to the next line start
+    std::vector<const char*> bound(count + 1);
+    bound[0] = begin;
+    bound[count] = end;
+    for (size_t i = 1; i < count; ++i) {
+        const char* p = std::max(begin + i * bytes / count, bound[i - 1]);
+        const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+        bound[i] = nl ? nl + 1 : end;
+    }
+    std::vector<size_t> first_line(count + 1, 0);
+    parallelFor(0, count, 1, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            size_t lines = 0;
+            for (const char* p = bound[i]; p < bound[i + 1]; ++lines) {
+                const char* nl = static_cast<const char*>(memchr(p, '\n', bound[i + 1] - p));
+                p = nl ? nl + 1 : bound[i + 1];
+            }
+            first_line[i + 1] = lines;
+        }
+    });
+    for (size_t i = 0; i < count; ++i) first_line[i + 1] += first_line[i];
+
+    if (pieces.size() < count) pieces.resize(count);
+    parallelFor(0, count, 1, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            Coords& c = pieces[i];
+            c.x.clear();
+            c.y.clear();
+            c.z.clear();
+            size_t line = first_line[i];
+            scalar v[3];
+            for (const char* p = bound[i]; (p < bound[i + 1]) && (line < maxLines); ++line) {
+                const char* nl = static_cast<const char*>(memchr(p, '\n', bound[i + 1] - p));
+                const char* e = nl ? nl : bound[i + 1];
+                if (parse(p, e, v)) {
+                    c.x.push_back(v[0]);
+                    c.y.push_back(v[1]);
+                    c.z.push_back(v[2]);
+                }
+                p = nl ? nl + 1 : bound[i + 1];
+            }
+        }
+    });
+    for (size_t i = 0; i < count; ++i) out.append(pieces[i]);
+    return std::min(first_line[count], maxLines);
+}
+
+/**
+ * @brief feed the rest of a text file to parseLines() chunk by chunk.
+ * @param buffer holds filled bytes already read from the file.
+ * @param skipLines lines dropped before parsing.
+ * @param maxLines lines parsed at most.
+ */
+template <typename LineParser>
+static void parseText(FILE* file, std::vector<char>& buffer, size_t filled, size_t skipLines,
+                      size_t maxLines, LineParser parse, Coords& out) {
+    std::vector<Coords> pieces;
+    for (;;) {
+        if (filled < buffer.size()) filled += fread(buffer.data() + filled, 1, buffer.size() - filled, file);
+        if (ferror(file)) THROW_READ_ERROR("Read error!");
+        const bool eof = (filled < buffer.size());
+        const char* b = buffer.data();
+        const char* e = b + filled;
+        const char* cut = e;
+        if (!eof) {
+            while ((cut > b) && (cut[-1] != '\n')) --cut;
+            if (cut == b) {
+                // a line longer than the buffer
+                buffer.resize(buffer.size() * 2);
+                continue;
+            }
+        }
+        while ((skipLines > 0) && (b < cut)) {
+            const char* nl = static_cast<const char*>(memchr(b, '\n', cut - b));
+            b = nl ? nl + 1 : cut;
+            --skipLines;
+        }
+        if (b < cut) maxLines -= parseLines(b, cut, maxLines, parse, pieces, out);
+        if (eof || (maxLines == 0)) return;
+        std::memmove(buffer.data(), cut, e - cut);
+        filled = e - cut;
+    }
+}
+
+/** @brief PLY property value types. */
+enum PLYTYPE { PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64, PLY_INVALID };
+
+static PLYTYPE plyType(const std::string& name) {
+    if ((name == "char") || (name == "int8")) return PLY_INT8;
+    if ((name == "uchar") || (name == "uint8")) return PLY_UINT8;
+    if ((name == "short") || (name == "int16")) return PLY_INT16;
+    if ((name == "ushort") || (name == "uint16")) return PLY_UINT16;
+    if ((name == "int") || (name == "int32")) return PLY_INT32;
+    if ((name == "uint") || (name == "uint32")) return PLY_UINT32;
+    if ((name == "float") || (name == "float32")) return PLY_FLOAT32;
+    if ((name == "double") || (name == "float64")) return PLY_FLOAT64;
+    return PLY_INVALID;
+}
+
+static size_t plySize(PLYTYPE t) {
+    static const size_t SIZE[] = {1, 1, 2, 2, 4, 4, 4, 8, 0};
+    return SIZE[t];
+}
+
+struct PlyProperty {
+    std::string name;
+    PLYTYPE type;
+    bool list;
+};
+
+struct PlyElement {
+    std::string name;
+    size_t count;
+    std::vector<PlyProperty> properties;
+};
+
+/** @brief load one binary value, byte swapped if the file endianness differs. */
+template <typename T>
+static inline T loadSwapped(const unsigned char* p, bool swap) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    if (swap) {
+        unsigned char b[sizeof(T)];
+        std::memcpy(b, &v, sizeof(T));
+        std::reverse(b, b + sizeof(T));
+        std::memcpy(&v, b, sizeof(T));
+    }
+    return v;
+}
+
+static inline scalar loadPly(const unsigned char* p, PLYTYPE t, bool swap) {
+    switch (t) {
+        case PLY_INT8: return static_cast<scalar>(static_cast<int8_t>(*p));
+        case PLY_UINT8: return static_cast<scalar>(*p);
+        case PLY_INT16: return static_cast<scalar>(loadSwapped<int16_t>(p, swap));
+        case PLY_UINT16: return static_cast<scalar>(loadSwapped<uint16_t>(p, swap));
+        case PLY_INT32: return static_cast<scalar>(loadSwapped<int32_t>(p, swap));
+        case PLY_UINT32: return static_cast<scalar>(loadSwapped<uint32_t>(p, swap));
+        case PLY_FLOAT32: return static_cast<scalar>(loadSwapped<float>(p, swap));
+        default: return static_cast<scalar>(loadSwapped<double>(p, swap));
+    }
+}
+
+/** @brief read the vertices of a PLY file, binary vertices are converted straight into the sink. */
+template <typename Sink>
+static void readPly(FILE* file, Sink& sink) {
+    std::vector<char> buffer(READ_CHUNK);
+    size_t filled = fread(buffer.data(), 1, buffer.size(), file);
+    if (ferror(file)) THROW_READ_ERROR("Read error!");
+
+    // header
+    const char* b = buffer.data();
+    const char* e = b + filled;
+    const char* tag = "end_header";
+    const char* h = std::search(b, e, tag, tag + strlen(tag));
+    const char* body = (h == e) ? e : static_cast<const char*>(memchr(h, '\n', e - h));
+    if ((filled < 4) || (std::strncmp(b, "ply", 3) != 0) || !body || (body == e)) {
+        THROW_READ_ERROR("Not a PLY file!");
+    }
+    ++body;
+    std::istringstream header(std::string(b, body));
+    std::string line, word, format;
+    std::vector<PlyElement> elements;
+    while (std::getline(header, line)) {
+        std::istringstream tokens(line);
+        tokens >> word;
+        if (word == "format") {
+            tokens >> format;
+        } else if (word == "element") {
+            PlyElement element;
+            tokens >> element.name >> element.count;
+            elements.push_back(element);
+        } else if ((word == "property") && !elements.empty()) {
+            PlyProperty prop;
+            std::string type;
+            tokens >> type;
+            prop.list = (type == "list");
+            if (prop.list) {
+                std::string count_type;
+                tokens >> count_type >> type;
+            }
+            prop.type = plyType(type);
+            tokens >> prop.name;
+            if (prop.type == PLY_INVALID) THROW_READ_ERROR("Unknown PLY property type!");
+            elements.back().properties.push_back(prop);
+        }
+    }
+    size_t vertex = 0;
+    while ((vertex < elements.size()) && (elements[vertex].name != "vertex")) ++vertex;
+    if (vertex == elements.size()) THROW_READ_ERROR("PLY file without vertex element!");
+    const PlyElement& v = elements[vertex];
+    int index[3] = {-1, -1, -1};
+    for (size_t i = 0; i < v.properties.size(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            if (v.properties[i].name == std::string(1, char('x' + k))) index[k] = static_cast<int>(i);
+        }
+    }
+    if ((index[0] < 0) || (index[1] < 0) || (index[2] < 0)) THROW_READ_ERROR("PLY vertex without x, y, z!");
+
+    const size_t header_bytes = body - buffer.data();
+    std::memmove(buffer.data(), body, filled - header_bytes);
+    filled -= header_bytes;
+
+    if (format == "ascii") {
+        size_t skip = 0;
+        for (size_t i = 0; i < vertex; ++i) skip += elements[i].count;
+        const int last = std::max(index[0], std::max(index[1], index[2]));
+        Coords out;
+        out.x.reserve(v.count);
+        out.y.reserve(v.count);
+        out.z.reserve(v.count);
+        parseText(file, buffer, filled, skip, v.count, [&](const char* p, const char* end, scalar xyz[3]) {
+            scalar value;
+            for (int i = 0; i <= last; ++i) {
+                p = parseScalar(skipSeparators(p, end), end, value);
+                if (!p) return false;
+                for (int k = 0; k < 3; ++k) {
+                    if (i == index[k]) xyz[k] = value;
+                }
+            }
+            return true;
+        }, out);
+        copyCoords(out, sink);
+        return;
+    }
+    if ((format != "binary_little_endian") && (format != "binary_big_endian")) {
+        THROW_READ_ERROR("Unknown PLY format!");
+    }
+    const uint16_t one = 1;
+    const bool little = (*reinterpret_cast<const unsigned char*>(&one) == 1);
+    const bool swap = little != (format == "binary_little_endian");
+
+    // fixed size elements before the vertices are skipped
+    uint64_t skip = 0;
+    for (size_t i = 0; i <= vertex; ++i) {
+        size_t stride = 0;
+        for (const PlyProperty& prop : elements[i].properties) {
+            if (prop.list) THROW_READ_ERROR("PLY list property before or in vertex element!");
+            stride += plySize(prop.type);
+        }
+        if (i < vertex) skip += static_cast<uint64_t>(stride) * elements[i].count;
+    }
+    size_t stride = 0, offset[3] = {0, 0, 0};
+    PLYTYPE type[3] = {PLY_INVALID, PLY_INVALID, PLY_INVALID};
+    for (size_t i = 0; i < v.properties.size(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            if (static_cast<int>(i) == index[k]) {
+                offset[k] = stride;
+                type[k] = v.properties[i].type;
+            }
+        }
+        stride += plySize(v.properties[i].type);
+    }
+    sink.resize(v.count);
+    const bool all_float = (type[0] == PLY_FLOAT32) && (type[1] == PLY_FLOAT32) && (type[2] == PLY_FLOAT32);
+
+    size_t done = 0;
+    while (done < v.count) {
+        if (skip > 0) {
+            const size_t drop = static_cast<size_t>(std::min<uint64_t>(skip, filled));
+            std::memmove(buffer.data(), buffer.data() + drop, filled - drop);
+            filled -= drop;
+            skip -= drop;
+        }
+        if (filled < buffer.size()) filled += fread(buffer.data() + filled, 1, buffer.size() - filled, file);
+        if (ferror(file)) THROW_READ_ERROR("Read error!");
+        if (skip > 0) {
+            if (filled == 0) THROW_READ_ERROR("Unexpected end of PLY file!");
+            continue;
+        }
+        const size_t n = std::min(v.count - done, filled / stride);
+        if (n == 0) THROW_READ_ERROR("Unexpected end of PLY file!");
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(buffer.data());
+        parallelFor(0, n, VERTEX_GRAIN, [&](size_t lo, size_t hi) {
+            if (all_float && !swap) {
+                for (size_t i = lo; i < hi; ++i) {
+                    float f[3];
+                    for (int k = 0; k < 3; ++k) std::memcpy(f + k, src + i * stride + offset[k], sizeof(float));
+                    sink.set(done + i, static_cast<scalar>(f[0]), static_cast<scalar>(f[1]), static_cast<scalar>(f[2]));
+                }
+                return;
+            }
+            for (size_t i = lo; i < hi; ++i) {
+                const unsigned char* p = src + i * stride;
+                sink.set(done + i, loadPly(p + offset[0], type[0], swap), loadPly(p + offset[1], type[1], swap),
+                         loadPly(p + offset[2], type[2], swap));
+            }
+        });
+        done += n;
+        std::memmove(buffer.data(), buffer.data() + n * stride, filled - n * stride);
+        filled -= n * stride;
+    }
+}
+
+static POINTFORMAT guessFormat(const std::string& path) {
+    std::string ext;
+    const size_t dot = path.find_last_of('.');
+    if (dot != std::string::npos) ext = path.substr(dot + 1);
+    for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (ext == "ply") return PLY_FORMAT;
+    if (ext == "obj") return OBJ_FORMAT;
+    return XYZ_FORMAT;
+}
+
+template <typename Sink>
+static void readPoints(const std::string& path, Sink& sink, POINTFORMAT format) {
+    if (format == AUTO_FORMAT) format = guessFormat(path);
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot open %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        MYMATH_COUNT_ERROR();
+        throw "Cannot open file!";
+    }
+    try {
+        if (format == PLY_FORMAT) {
+            readPly(file, sink);
+        } else {
+            std::vector<char> buffer(READ_CHUNK);
+            const size_t all = ~size_t(0);
+            Coords out;
+            if (format == OBJ_FORMAT) {
+                parseText(file, buffer, 0, 0, all, [](const char* p, const char* end, scalar xyz[3]) {
+                    p = skipSeparators(p, end);
+                    if ((end - p < 2) || (p[0] != 'v') || ((p[1] != ' ') && (p[1] != '\t'))) return false;
+                    return parseTriple(p + 2, end, xyz);
+                }, out);
+            } else {
+                parseText(file, buffer, 0, 0, all, [](const char* p, const char* end, scalar xyz[3]) {
+                    return parseTriple(p, end, xyz);
+                }, out);
+            }
+            copyCoords(out, sink);
+        }
+    } catch (...) {
+        fclose(file);
+        throw;
+    }
+    fclose(file);
+}
+
+size_t readPointCloud(const std::string& path, Vector3SoABuffer& out, POINTFORMAT format) {
+    MYMATH_TRACE_SPAN("readPointCloud", 0);
+    SoASink sink(out);
+    readPoints(path, sink, format);
+    return out.size();
+}
+
+size_t readPointCloud(const std::string& path, std::vector<Vector3>& out, POINTFORMAT format) {
+    MYMATH_TRACE_SPAN("readPointCloud", 0);
+    AoSSink sink(out);
+    readPoints(path, sink, format);
+    return out.size();
+}
@@ -0,0 +1,404 @@
+#include "myrotation.hpp"
+#include "myinstrument.hpp"
+#include "myisa.hpp"
+#include "myparallel.hpp"
+#include "mytrace.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+
+/** @brief rotations handled by one parallel task, a conversion costs a few trigonometric calls. */
+static const size_t ROTATION_GRAIN = 1 << 11;
+
+/** @brief axes of the three Euler rotations, indexed by EULERORDER. */
+static const int EULER_AXES[12][3] = {
+    {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0},
+    {0, 1, 0}, {0, 2, 0}, {1, 0, 1}, {1, 2, 1}, {2, 0, 2}, {2, 1, 2}};
+
+/** @brief next axis in the cyclic order x, y, z, x. */
+static const int NEXT_AXIS[4] = {1, 2, 0, 1};
+
+/** @brief axes of an Euler order, k is the axis missing from i and j. */
+struct EulerAxes {
+    int i, j, k;
+    /** @brief third axis, i for proper orders, k otherwise. */
+    int last;
+    /** @brief first axis repeated. */
+    bool proper;
+    /** @brief (i, j, k) is not a cyclic permutation of (x, y, z). */
+    bool odd;
+};
+
+static EulerAxes eulerAxes(EULERORDER order) {
+    if ((order < EULER_XYZ) || (order > EULER_ZYZ)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Euler order %d does not exist.\n",
+                __FILE__, __LINE__, __FUNCTION__, static_cast<int>(order));
+        MYMATH_COUNT_ERROR();
+        throw "Invalid Euler order!";
+    }
+    EulerAxes e;
+    e.i = EULER_AXES[order][0];
+    e.j = EULER_AXES[order][1];
+    e.k = 3 - e.i - e.j;
+    e.last = EULER_AXES[order][2];
+    e.proper = (e.last == e.i);
+    e.odd = (e.j != NEXT_AXIS[e.i]);
+    return e;
+}
+
+/** @brief m = m * R_axis(angle) on a column major 3x3, only the two other columns change. */
+static inline void rotateColumns(scalar* m, int axis, scalar angle) {
+    const scalar s = std::sin(angle), c = std::cos(angle);
+    scalar* p = m + 3 * NEXT_AXIS[axis];
+    scalar* q = m + 3 * NEXT_AXIS[axis + 1];
+    for (int r = 0; r < 3; ++r) {
+        const scalar a = p[r], b = q[r];
+        p[r] = c * a + s * b;
+        q[r] = c * b - s * a;
+    }
+}
+
+static inline void eulerMatrix(const EulerAxes& e, const Vector3& angles, scalar* m) {
+    m[0] = m[4] = m[8] = 1;
+    m[1] = m[2] = m[3] = m[5] = m[6] = m[7] = 0;
+    rotateColumns(m, e.i, angles.x);
+    rotateColumns(m, e.j, angles.y);
+    rotateColumns(m, e.last, angles.z);
+}
+
+/** @brief q = q * (sin(angle / 2) * axis, cos(angle / 2)), q as (x, y, z, w). */
+static inline void rotateQuaternion(scalar* q, int axis, scalar angle) {
+    const scalar s = std::sin(angle / 2), c = std::cos(angle / 2);
+    const int p = NEXT_AXIS[axis], r = NEXT_AXIS[axis + 1];
+    const scalar v[4] = {q[0], q[1], q[2], q[3]};
+    q[axis] = c * v[axis] + s * v[3];
+    q[p] = c * v[p] + s * v[r];
+    q[r] = c * v[r] - s * v[p];
+    q[3] = c * v[3] - s * v[axis];
+}
+
+static inline Vector4 eulerQuaternion(const EulerAxes& e, const Vector3& angles) {
+    scalar q[4] = {0, 0, 0, 1};
+    rotateQuaternion(q, e.i, angles.x);
+    rotateQuaternion(q, e.j, angles.y);
+    rotateQuaternion(q, e.last, angles.z);
+    return Vector4(q[0], q[1], q[2], q[3]);
+}
+
+/**
+ * @brief Euler angles of a column major rotation matrix.
+ * @note the formulas are those of the cyclic orders, an odd order (i, j, k) is the cyclic
+ * @note order (i, k, j) of the matrix mirrored by swapping j and k, which negates the angles.
+ * @note proper odd orders take the other root of b, so b stays in [0, pi] after negation.
+ */
+static inline Vector3 eulerAngles(const EulerAxes& e, const scalar* m) {
+    const int i = e.i, j = e.j, k = e.k;
+    const scalar rii = m[i + 3 * i], rij = m[i + 3 * j], rik = m[i + 3 * k];
+    const scalar rji = m[j + 3 * i], rjj = m[j + 3 * j], rjk = m[j + 3 * k];
+    const scalar rki = m[k + 3 * i], rkj = m[k + 3 * j], rkk = m[k + 3 * k];
+    // cos b, or sin b for proper orders, below which a and c are not separable
+    const scalar lock = 4 * std::numeric_limits<scalar>::epsilon();
+    scalar a, b, c;
+    if (!e.proper) {
+        const scalar cb = std::sqrt(rii * rii + rij * rij);
+        b = std::atan2(rik, cb);
+        if (cb > lock) {
+            a = std::atan2(-rjk, rkk);
+            // (-rjk, rkk) is cos b * (sin a, cos a), R_j(b) * R_k(c) = R_i(-a) * R has row j (sin c, cos c, 0)
+            const scalar inv = 1 / std::sqrt(rjk * rjk + rkk * rkk);
+            const scalar sa = -rjk * inv, ca = rkk * inv;
+            c = std::atan2(ca * rji + sa * rki, ca * rjj + sa * rkj);
+        } else {
+            a = std::atan2(rkj, rjj);
+            c = 0;
+        }
+    } else {
+        const scalar s = e.odd ? -1 : 1;
+        const scalar sb = std::sqrt(rij * rij + rik * rik);
+        b = std::atan2(s * sb, rii);
+        if (sb > lock) {
+            a = std::atan2(s * rji, -s * rki);
+            // (s * rji, -s * rki) is |sin b| * (sin a, cos a), R_j(b) * R_i(c) = R_i(-a) * R has row j (0, cos c, -sin c)
+            const scalar inv = 1 / std::sqrt(rji * rji + rki * rki);
+            const scalar sa = s * rji * inv, ca = -s * rki * inv;
+            c = std::atan2(-(ca * rjk + sa * rkk), ca * rjj + sa * rkj);
+        } else {
+            a = std::atan2(rkj, rjj);
+            c = 0;
+        }
+    }
+    return e.odd ? Vector3(-a, -b, -c) : Vector3(a, b, c);
+}
+
+/** @brief column major rotation of a quaternion, false if |q| < MYEPSILON or NaN, same arithmetic as toRotationsScalar() of myisa. */
+static inline bool quaternionMatrix(const Vector4& q, scalar* m) {
+    const scalar n2 = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+    if (!(n2 >= MYEPSILON * MYEPSILON)) return false;
+    const scalar s = 2 / n2;
+    const scalar xx = s * q.x * q.x, yy = s * q.y * q.y, zz = s * q.z * q.z;
+    const scalar xy = s * q.x * q.y, xz = s * q.x * q.z, yz = s * q.y * q.z;
+    const scalar wx = s * q.w * q.x, wy = s * q.w * q.y, wz = s * q.w * q.z;
+    m[0] = 1 - yy - zz;
+    m[1] = xy + wz;
+    m[2] = xz - wy;
+    m[3] = xy - wz;
+    m[4] = 1 - xx - zz;
+    m[5] = yz + wx;
+    m[6] = xz + wy;
+    m[7] = yz - wx;
+    m[8] = 1 - xx - yy;
+    return true;
+}
+
+/** @brief unit quaternion (x, y, z, w) with w >= 0 of a column major rotation, Shepperd's method. */
+static inline Vector4 matrixQuaternion(const scalar* m) {
+    const double r00 = m[0], r10 = m[1], r20 = m[2];
+    const double r01 = m[3], r11 = m[4], r21 = m[5];
+    const double r02 = m[6], r12 = m[7], r22 = m[8];
+    const double trace = r00 + r11 + r22;
+    double x, y, z, w;
+    if (trace > 0) {
+        const double s = 2.0 * std::sqrt(trace + 1.0);
+        w = 0.25 * s;
+        x = (r21 - r12) / s;
+        y = (r02 - r20) / s;
+        z = (r10 - r01) / s;
+    } else if ((r00 > r11) && (r00 > r22)) {
+        const double s = 2.0 * std::sqrt(1.0 + r00 - r11 - r22);
+        w = (r21 - r12) / s;
+        x = 0.25 * s;
+        y = (r01 + r10) / s;
+        z = (r02 + r20) / s;
+    } else if (r11 > r22) {
+        const double s = 2.0 * std::sqrt(1.0 + r11 - r00 - r22);
+        w = (r02 - r20) / s;
+        x = (r01 + r10) / s;
+        y = 0.25 * s;
+        z = (r12 + r21) / s;
+    } else {
+        const double s = 2.0 * std::sqrt(1.0 + r22 - r00 - r11);
+        w = (r10 - r01) / s;
+        x = (r02 + r20) / s;
+        y = (r12 + r21) / s;
+        z = 0.25 * s;
+    }
+    const double sign = (w < 0) ? -1.0 : 1.0;
+    return Vector4(static_cast<scalar>(sign * x), static_cast<scalar>(sign * y),
+                   static_cast<scalar>(sign * z), static_cast<scalar>(sign * w));
+}
+
+static inline Vector4 vectorQuaternion(const Vector3& w) {
+    const scalar t = w.length();
+    // sin(t / 2) / t has no cancellation, only t = 0 needs its limit
+    const scalar k = (t > 0) ? std::sin(t / 2) / t : scalar(0.5);
+    return Vector4(w.x * k, w.y * k, w.z * k, std::cos(t / 2));
+}
+
+/** @brief rotation vector of a quaternion, false if |q| < MYEPSILON or NaN. */
+static inline bool quaternionVector(const Vector4& q, Vector3& w) {
+    const scalar n2 = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+    if (!(n2 >= MYEPSILON * MYEPSILON)) return false;
+    // the shorter of q and -q, so the angle is in [0, pi]
+    const scalar sign = (q.w < 0) ? -1 : 1;
+    const scalar s = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+    const scalar c = sign * q.w;
+    // 2 * atan2(s, c) / s, tending to 2 / c for small s
+    const scalar k = sign * ((s > 0) ? 2 * std::atan2(s, c) / s : 2 / c);
+    w.set(q.x * k, q.y * k, q.z * k);
+    return true;
+}
+
+static void checkQuaternion(bool valid) {
+    if (!valid) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Quaternion is zero or not finite.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid quaternion!";
+    }
+}
+
+Matrix3 eulerToRotation(const Vector3& angles, EULERORDER order) {
+    Matrix3 rot;
+    eulerMatrix(eulerAxes(order), angles, rot.data());
+    return rot;
+}
+
+Vector3 rotationToEuler(const Matrix3& rot, EULERORDER order) {
+    return eulerAngles(eulerAxes(order), rot.constData());
+}
+
+Vector4 eulerToQuaternion(const Vector3& angles, EULERORDER order) {
+    return eulerQuaternion(eulerAxes(order), angles);
+}
+
+Vector3 quaternionToEuler(const Vector4& q, EULERORDER order) {
+    const EulerAxes e = eulerAxes(order);
+    scalar m[9];
+    checkQuaternion(quaternionMatrix(q, m));
+    return eulerAngles(e, m);
+}
+
+Vector4 rotationToQuaternion(const Matrix3& rot) {
+    return matrixQuaternion(rot.constData());
+}
+
+Matrix3 quaternionToRotation(const Vector4& q) {
+    Matrix3 rot;
+    checkQuaternion(quaternionMatrix(q, rot.data()));
+    return rot;
+}
+
+Vector4 axisAngleToQuaternion(const Vector3& axis, scalar angle) {
+    const scalar len = axis.length();
+    if (!(len >= MYEPSILON)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Axis is zero or not finite.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid axis!";
+    }
+    const scalar k = std::sin(angle / 2) / len;
+    return Vector4(axis.x * k, axis.y * k, axis.z * k, std::cos(angle / 2));
+}
+
+void quaternionToAxisAngle(const Vector4& q, Vector3& axis, scalar& angle) {
+    Vector3 w;
+    checkQuaternion(quaternionVector(q, w));
+    angle = w.length();
+    if (angle > 0) {
+        axis = w * (1 / angle);
+    } else {
+        axis.set(1, 0, 0);
+    }
+}
+
+void rotationToAxisAngle(const Matrix3& rot, Vector3& axis, scalar& angle) {
+    quaternionToAxisAngle(matrixQuaternion(rot.constData()), axis, angle);
+}
+
+Vector4 rotationVectorToQuaternion(const Vector3& w) {
+    return vectorQuaternion(w);
+}
+
+Vector3 quaternionToRotationVector(const Vector4& q) {
+    Vector3 w;
+    checkQuaternion(quaternionVector(q, w));
+    return w;
+}
+
+static inline bool isFinite(const scalar* v, int n) {
+    bool finite = true;
+    for (int i = 0; i < n; ++i) finite &= std::isfinite(v[i]);
+    return finite;
+}
+
+size_t eulerToRotations(const Vector3* angles, size_t n, EULERORDER order, Matrix3* out) {
+    MYMATH_TRACE_SPAN("eulerToRotations", n);
+    const EulerAxes e = eulerAxes(order);
+    return parallelReduce(size_t(0), n, ROTATION_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            // NaN and infinite angles propagate NaN through sin and cos
+            eulerMatrix(e, angles[i], out[i].data());
+            count += isFinite(&angles[i].x, 3);
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
+
+size_t rotationsToEuler(const Matrix3* in, size_t n, EULERORDER order, Vector3* out) {
+    MYMATH_TRACE_SPAN("rotationsToEuler", n);
+    const EulerAxes e = eulerAxes(order);
+    const scalar nan = std::numeric_limits<scalar>::quiet_NaN();
+    return parallelReduce(size_t(0), n, ROTATION_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            const scalar* m = in[i].constData();
+            if (isFinite(m, 9)) {
+                out[i] = eulerAngles(e, m);
+                ++count;
+            } else {
+                // the gimbal lock branch would turn a NaN matrix into c = 0
+                out[i].set(nan, nan, nan);
+            }
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
+
+size_t eulerToQuaternions(const Vector3* angles, size_t n, EULERORDER order, Vector4* out) {
+    MYMATH_TRACE_SPAN("eulerToQuaternions", n);
+    const EulerAxes e = eulerAxes(order);
+    return parallelReduce(size_t(0), n, ROTATION_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            out[i] = eulerQuaternion(e, angles[i]);
+            count += isFinite(&angles[i].x, 3);
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
+
+size_t quaternionsToEuler(const Vector4* q, size_t n, EULERORDER order, Vector3* out) {
+    MYMATH_TRACE_SPAN("quaternionsToEuler", n);
+    const EulerAxes e = eulerAxes(order);
+    const scalar nan = std::numeric_limits<scalar>::quiet_NaN();
+    return parallelReduce(size_t(0), n, ROTATION_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            scalar m[9];
+            if (quaternionMatrix(q[i], m) && isFinite(m, 9)) {
+                out[i] = eulerAngles(e, m);
+                ++count;
+            } else {
+                out[i].set(nan, nan, nan);
+            }
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
+
+size_t rotationsToQuaternions(const Matrix3* in, size_t n, Vector4* out) {
+    MYMATH_TRACE_SPAN("rotationsToQuaternions", n);
+    const BatchKernels& kernels = getBatchKernels();
+    return parallelReduce(size_t(0), n, ROTATION_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        total += kernels.toQuaternions(in + lo, hi - lo, out + lo);
+    }, std::plus<size_t>());
+}
+
+size_t quaternionsToRotations(const Vector4* q, size_t n, Matrix3* out) {
+    MYMATH_TRACE_SPAN("quaternionsToRotations", n);
+    const BatchKernels& kernels = getBatchKernels();
+    return parallelReduce(size_t(0), n, ROTATION_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        total += kernels.toRotations(q + lo, hi - lo, out + lo);
+    }, std::plus<size_t>());
+}
+
+size_t rotationVectorsToQuaternions(const Vector3* w, size_t n, Vector4* out) {
+    MYMATH_TRACE_SPAN("rotationVectorsToQuaternions", n);
+    return parallelReduce(size_t(0), n, ROTATION_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            out[i] = vectorQuaternion(w[i]);
+            count += isFinite(&out[i].x, 4);
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
+
+size_t quaternionsToRotationVectors(const Vector4* q, size_t n, Vector3* out) {
+    MYMATH_TRACE_SPAN("quaternionsToRotationVectors", n);
+    const scalar nan = std::numeric_limits<scalar>::quiet_NaN();
+    return parallelReduce(size_t(0), n, ROTATION_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            if (quaternionVector(q[i], out[i]) && isFinite(&out[i].x, 3)) {
+                ++count;
+            } else {
+                out[i].set(nan, nan, nan);
+            }
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
@@ -0,0 +1,58 @@
+#include "mysoa.hpp"
+
+#include <algorithm>
+#include <utility>
+
+Vector3SoABuffer::Vector3SoABuffer(Vector3SoABuffer&& buffer) noexcept :
+    storage(std::move(buffer.storage)), capacity(buffer.capacity), count(buffer.count) {
+    buffer.capacity = 0;
+    buffer.count = 0;
+}
+
+Vector3SoABuffer& Vector3SoABuffer::operator=(Vector3SoABuffer&& buffer) noexcept {
+    if (this != &buffer) {
+        storage = std::move(buffer.storage);
+        capacity = buffer.capacity;
+        count = buffer.count;
+        buffer.capacity = 0;
+        buffer.count = 0;
+    }
+    return *this;
+}
+
+void Vector3SoABuffer::resize(size_t n) {
+    if (n > capacity) {
+        storage.reset(new scalar[3 * n]);
+        capacity = n;
+    }
+    count = n;
+}
+
+Vector3SoABuffer Vector3SoAPool::acquire(size_t n) {
+    Vector3SoABuffer buffer;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!free_list.empty()) {
+            // prefer the largest buffer, the stream usually asks for the same size again
+            auto it = std::max_element(free_list.begin(), free_list.end(),
+                                       [](const Vector3SoABuffer& a, const Vector3SoABuffer& b) {
+                                           return a.getCapacity() < b.getCapacity();
+                                       });
+            std::iter_swap(it, free_list.end() - 1);
+            buffer = std::move(free_list.back());
+            free_list.pop_back();
+        }
+    }
+    buffer.resize(n);
+    return buffer;
+}
+
+void Vector3SoAPool::release(Vector3SoABuffer&& buffer) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    free_list.push_back(std::move(buffer));
+}
+
+size_t Vector3SoAPool::available() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    return free_list.size();
+}
@@ -0,0 +1,188 @@
+#include "myspatialhash.hpp"
+#include "myparallel.hpp"
+#include "myinstrument.hpp"
+#include "mytrace.hpp"
+
+#include <algorithm>
+
+/** @brief elements handled by one parallel task. */
+static const size_t GRID_GRAIN = 1 << 14;
+
+SpatialHashGrid::SpatialHashGrid(scalar cellSize) {
+    setCellSize(cellSize);
+}
+
+void SpatialHashGrid::setCellSize(scalar cellSize) {
+    if (!(cellSize > 0)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cell size must be positive.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Cell size must be positive!";
+    }
+    cell_size = cellSize;
+    inv_cell_size = 1 / cellSize;
+}
+
+void SpatialHashGrid::prepareTable(size_t n) {
+    size_t want = 64;
+    while (want < 2 * n) want <<= 1;
+    // hysteresis, a shrinking frame does not reallocate unless the table is far too big
+    if ((want > table_size) || (want * 4 < table_size)) {
+        table_size = want;
+        bucket_count.reset(new std::atomic<uint32_t>[table_size]);
+        bucket_head.reset(new std::atomic<int32_t>[table_size]);
+        bucket_start.resize(table_size + 1);
+    }
+    parallelFor(0, table_size, GRID_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            bucket_count[b].store(0, std::memory_order_relaxed);
+        }
+    });
+}
+
+void SpatialHashGrid::computeBucketStart() {
+    // two level scan: block sums in parallel, serial scan over blocks, local scans in parallel
+    const size_t num_blocks = (table_size + GRID_GRAIN - 1) / GRID_GRAIN;
+    std::vector<uint32_t> block_sum(num_blocks + 1, 0);
+    parallelFor(0, num_blocks, 1, [&](size_t lo, size_t hi) {
+        for (size_t blk = lo; blk < hi; ++blk) {
+            size_t end = std::min(table_size, (blk + 1) * GRID_GRAIN);
+            uint32_t sum = 0;
+            for (size_t b = blk * GRID_GRAIN; b < end; ++b) {
+                sum += bucket_count[b].load(std::memory_order_relaxed);
+            }
+            block_sum[blk + 1] = sum;
+        }
+    });
+    for (size_t blk = 0; blk < num_blocks; ++blk) {
+        block_sum[blk + 1] += block_sum[blk];
+    }
+    parallelFor(0, num_blocks, 1, [&](size_t lo, size_t hi) {
+        for (size_t blk = lo; blk < hi; ++blk) {
+            size_t end = std::min(table_size, (blk + 1) * GRID_GRAIN);
+            uint32_t start = block_sum[blk];
+            for (size_t b = blk * GRID_GRAIN; b < end; ++b) {
+                uint32_t count = bucket_count[b].load(std::memory_order_relaxed);
+                bucket_start[b] = start;
+                // the counter becomes the scatter cursor of the bucket
+                bucket_count[b].store(start, std::memory_order_relaxed);
+                start += count;
+            }
+        }
+    });
+    bucket_start[table_size] = block_sum[num_blocks];
+    num_points = block_sum[num_blocks];
+}
+
+void SpatialHashGrid::finalizeBuckets(const Vector3* points) {
+    // the scatter order inside a bucket depends on thread timing, sort it back
+    // to make the layout deterministic, buckets hold only a few points
+    parallelFor(0, table_size, GRID_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            uint32_t* first = sorted_indices.data() + bucket_start[b];
+            uint32_t* last = sorted_indices.data() + bucket_start[b + 1];
+            for (uint32_t* i = first + 1; i < last; ++i) {
+                uint32_t v = *i;
+                uint32_t* j = i;
+                for (; (j > first) && (*(j - 1) > v); --j) {
+                    *j = *(j - 1);
+                }
+                *j = v;
+            }
+        }
+    });
+    sorted_points.resize(num_points);
+    sorted_cells.resize(num_points);
+    parallelFor(0, num_points, GRID_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t k = lo; k < hi; ++k) {
+            uint32_t idx = sorted_indices[k];
+            sorted_points[k] = points[idx];
+            sorted_cells[k] = point_cell[idx];
+        }
+    });
+}
+
+void SpatialHashGrid::build(const Vector3* points, size_t n) {
+    MYMATH_TRACE_SPAN("SpatialHashGrid::build", n);
+    prepareTable(n);
+    point_bucket.resize(n);
+    point_cell.resize(n);
+    // pass 1: quantize and count
+    parallelFor(0, n, GRID_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            GridCell c = cellOf(points[i]);
+            uint32_t b = static_cast<uint32_t>(bucketOf(c));
+            point_cell[i] = c;
+            point_bucket[i] = b;
+            bucket_count[b].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    computeBucketStart();
+    // pass 2: scatter indices into their buckets
+    sorted_indices.resize(n);
+    parallelFor(0, n, GRID_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            uint32_t pos = bucket_count[point_bucket[i]].fetch_add(1, std::memory_order_relaxed);
+            sorted_indices[pos] = static_cast<uint32_t>(i);
+        }
+    });
+    finalizeBuckets(points);
+}
+
+void SpatialHashGrid::beginConcurrentInsert(size_t capacity) {
+    prepareTable(capacity);
+    point_input.resize(capacity);
+    point_cell.resize(capacity);
+    point_next.resize(capacity);
+    parallelFor(0, table_size, GRID_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            bucket_head[b].store(-1, std::memory_order_relaxed);
+        }
+    });
+    num_points = 0;
+    std::fill(bucket_start.begin(), bucket_start.end(), 0);
+}
+
+void SpatialHashGrid::insertConcurrent(uint32_t index, const Vector3& p) {
+    GridCell c = cellOf(p);
+    point_input[index] = p;
+    point_cell[index] = c;
+    std::atomic<int32_t>& head = bucket_head[bucketOf(c)];
+    int32_t old = head.load(std::memory_order_relaxed);
+    do {
+        point_next[index] = old;
+    } while (!head.compare_exchange_weak(old, static_cast<int32_t>(index),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+}
+
+void SpatialHashGrid::endConcurrentInsert() {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    parallelFor(0, table_size, GRID_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            uint32_t count = 0;
+            for (int32_t i = bucket_head[b].load(std::memory_order_relaxed); i >= 0; i = point_next[i]) {
+                ++count;
+            }
+            bucket_count[b].store(count, std::memory_order_relaxed);
+        }
+    });
+    computeBucketStart();
+    sorted_indices.resize(num_points);
+    parallelFor(0, table_size, GRID_GRAIN, [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            uint32_t pos = bucket_start[b];
+            for (int32_t i = bucket_head[b].load(std::memory_order_relaxed); i >= 0; i = point_next[i]) {
+                sorted_indices[pos++] = static_cast<uint32_t>(i);
+            }
+        }
+    });
+    finalizeBuckets(point_input.data());
+}
+
+void SpatialHashGrid::radiusSearch(const Vector3& q, scalar radius, std::vector<uint32_t>& out) const {
+    out.clear();
+    forEachNeighbor(q, radius, [&](uint32_t index, const Vector3&, scalar) {
+        out.push_back(index);
+    });
+}
@@ -0,0 +1,163 @@
+#include "myspline.hpp"
+#include "myinstrument.hpp"
+#include "myparallel.hpp"
+#include "mytrace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+
+/** @brief times handled by one parallel task. */
+static const size_t SPLINE_GRAIN = 1 << 12;
+
+TrajectorySpline::TrajectorySpline(const SE3* controlPoints, size_t n, double startTime, double interval) :
+    t0(startTime), dt(interval), start_time(0), end_time(0), inv_dt(0) {
+    build(controlPoints, n);
+}
+
+TrajectorySpline::TrajectorySpline(const Matrix4* controlPoints, size_t n, double startTime, double interval) :
+    t0(startTime), dt(interval), start_time(0), end_time(0), inv_dt(0) {
+    std::vector<SE3> poses;
+    poses.reserve(n);
+    for (size_t i = 0; i < n; ++i) poses.push_back(SE3(controlPoints[i]));
+    build(poses.data(), n);
+}
+
+void TrajectorySpline::build(const SE3* controlPoints, size_t n) {
+    if ((n < 4) || !(dt > 0)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Need 4 control points and a positive interval.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid spline!";
+    }
+    segments.resize(n - 3);
+    start_time = t0 + dt;
+    end_time = t0 + (n - 2) * dt;
+    inv_dt = 1 / dt;
+    for (size_t k = 0; k < n - 3; ++k) {
+        Segment& s = segments[k];
+        const SE3* p = controlPoints + k;
+        s.rotation = p[0].rotation();
+        for (int j = 0; j < 3; ++j) {
+            const Vector3 d = (p[j].rotation().inverse() * p[j + 1].rotation()).log();
+            s.angle[j] = d.length();
+            // scale by the reciprocal, Vector3 division rejects divisors below MYEPSILON
+            s.axis[j] = (s.angle[j] > 0) ? d * (1 / s.angle[j]) : Vector3(0, 0, 0);
+        }
+        // uniform cubic B-spline basis in powers of u
+        const Vector3& a = p[0].translation();
+        const Vector3& b = p[1].translation();
+        const Vector3& c = p[2].translation();
+        const Vector3& d = p[3].translation();
+        s.coefficient[0] = (a + b * 4 + c) / 6;
+        s.coefficient[1] = (c - a) / 2;
+        s.coefficient[2] = (a - b * 2 + c) / 2;
+        s.coefficient[3] = (d - a + (b - c) * 3) / 6;
+    }
+}
+
+/** @brief exp(angle * axis) for a unit axis, I + sin * K + (1 - cos) * K^2, inlined into the evaluation. */
+static inline Matrix3 rodrigues(const Vector3& axis, scalar angle) {
+    const scalar s = std::sin(angle), c = 1 - std::cos(angle);
+    const scalar x = axis.x, y = axis.y, z = axis.z;
+    return Matrix3(1 - c * (y * y + z * z), c * x * y + s * z, c * x * z - s * y,
+                   c * x * y - s * z, 1 - c * (x * x + z * z), c * y * z + s * x,
+                   c * x * z + s * y, c * y * z - s * x, 1 - c * (x * x + y * y));
+}
+
+SE3 TrajectorySpline::evaluateSegment(const Segment& s, scalar u, scalar invDt,
+                                      Vector3* angularVelocity, Vector3* linearVelocity) {
+    // cumulative basis B_1, B_2, B_3 of the relative rotations
+    const scalar u2 = u * u, u3 = u2 * u;
+    const scalar b1 = (5 + 3 * u - 3 * u2 + u3) / 6;
+    const scalar b2 = (1 + 3 * u + 3 * u2 - 2 * u3) / 6;
+    const scalar b3 = u3 / 6;
+    const Matrix3 a2 = rodrigues(s.axis[1], b2 * s.angle[1]);
+    const Matrix3 a3 = rodrigues(s.axis[2], b3 * s.angle[2]);
+    SO3 r;
+    r.R = s.rotation.R.matmul(rodrigues(s.axis[0], b1 * s.angle[0])).matmul(a2).matmul(a3);
+    const Vector3* c = s.coefficient;
+    if (angularVelocity) {
+        // omega_j = A_j^T * omega_{j-1} + B_j' * d_j
+        const scalar d1 = (1 - u) * (1 - u) / 2;
+        const scalar d2 = (1 + 2 * u - 2 * u2) / 2;
+        const scalar d3 = u2 / 2;
+        Vector3 w = s.axis[0] * (d1 * s.angle[0]);
+        w = a2.transposed() * w + s.axis[1] * (d2 * s.angle[1]);
+        w = a3.transposed() * w + s.axis[2] * (d3 * s.angle[2]);
+        *angularVelocity = w * invDt;
+    }
+    if (linearVelocity) *linearVelocity = (c[1] + (c[2] * 2 + c[3] * (3 * u)) * u) * invDt;
+    return SE3(r, c[0] + (c[1] + (c[2] + c[3] * u) * u) * u);
+}
+
+inline bool TrajectorySpline::locate(double time, double& x) const {
+    // compare times, not x: (time - t0) / dt - 1 rounds below 0 at start_time when t0 is an epoch time
+    if (!((time >= start_time) && (time <= end_time))) return false;
+    x = std::min((time - start_time) * inv_dt, static_cast<double>(segments.size()));
+    return true;
+}
+
+SE3 TrajectorySpline::evaluate(double time) const {
+    double x;
+    if (!locate(time, x)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Time %f out of range.\n",
+                __FILE__, __LINE__, __FUNCTION__, time);
+        MYMATH_COUNT_ERROR();
+        throw "Time out of range!";
+    }
+    const size_t k = std::min(static_cast<size_t>(x), segments.size() - 1);
+    return evaluateSegment(segments[k], static_cast<scalar>(x - k), static_cast<scalar>(inv_dt), nullptr, nullptr);
+}
+
+SE3 TrajectorySpline::evaluate(double time, Vector3& angularVelocity, Vector3& linearVelocity) const {
+    double x;
+    if (!locate(time, x)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Time %f out of range.\n",
+                __FILE__, __LINE__, __FUNCTION__, time);
+        MYMATH_COUNT_ERROR();
+        throw "Time out of range!";
+    }
+    const size_t k = std::min(static_cast<size_t>(x), segments.size() - 1);
+    return evaluateSegment(segments[k], static_cast<scalar>(x - k), static_cast<scalar>(inv_dt),
+                           &angularVelocity, &linearVelocity);
+}
+
+size_t TrajectorySpline::evaluate(const double* times, size_t n, SE3* poses,
+                                  Vector3* angularVelocity, Vector3* linearVelocity) const {
+    MYMATH_TRACE_SPAN("TrajectorySpline::evaluate", n);
+    const scalar nan = std::numeric_limits<scalar>::quiet_NaN();
+    const SE3 invalid(SO3::rotation(Vector3(nan, nan, nan), nan), Vector3(nan, nan, nan));
+    const double last = static_cast<double>(segments.size());
+    return parallelReduce(size_t(0), n, SPLINE_GRAIN, size_t(0), [&](size_t lo, size_t hi, size_t& total) {
+        size_t count = 0;
+        size_t i = lo;
+        while (i < hi) {
+            double x;
+            if (!locate(times[i], x)) {
+                poses[i] = invalid;
+                if (angularVelocity) angularVelocity[i].set(nan, nan, nan);
+                if (linearVelocity) linearVelocity[i].set(nan, nan, nan);
+                ++i;
+                continue;
+            }
+            // a run of times in one segment, every time of a sorted batch joins the run of its segment
+            const size_t k = std::min(static_cast<size_t>(x), segments.size() - 1);
+            const Segment s = segments[k];
+            // x == last only belongs to the last segment, an earlier one would extrapolate to it
+            const bool lastSegment = (k + 1 == segments.size());
+            do {
+                const scalar u = static_cast<scalar>(x - k);
+                poses[i] = evaluateSegment(s, u, static_cast<scalar>(inv_dt),
+                                           angularVelocity ? angularVelocity + i : nullptr,
+                                           linearVelocity ? linearVelocity + i : nullptr);
+                ++count;
+                // a time outside the spline ends the run, the outer loop marks it
+                if ((++i == hi) || !locate(times[i], x)) break;
+            } while ((x >= k) && ((x < k + 1) || (lastSegment && (x == last))));
+        }
+        total += count;
+    }, std::plus<size_t>());
+}
@@ -0,0 +1,197 @@
+#include "mytrace.hpp"
+#include "myinstrument.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> trace_enabled(false);
+
+/** @brief one finished span. */
+struct TraceEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    uint64_t count;
+};
+
+/**
+ *  @brief TraceBuffer struct, single-producer ring of one thread.
+ *  @note the owning thread writes events and head, flushTrace() reads them and writes tail.
+ */
+struct TraceBuffer {
+    /** @brief allocated by the first span, published by the head increment that follows. */
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    /** @brief set when the thread exits, the buffer is freed after its last flush. */
+    std::atomic<bool> retired;
+    /** @brief trace thread id, in order of the first span or naming. */
+    uint32_t tid;
+    /** @brief thread name, guarded by the registry mutex. */
+    std::string name;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<TraceBuffer*> buffers;
+    uint32_t next_tid = 1;
+    std::atomic<uint64_t> dropped;
+
+    TraceRegistry() { dropped.store(0); }
+};
+
+/** @brief never destroyed, threads may exit after static destruction began. */
+static TraceRegistry& getRegistry() {
+    static TraceRegistry* registry = new TraceRegistry();
+    return *registry;
+}
+
+static thread_local TraceBuffer* trace_buffer = nullptr;
+
+/** @brief retires the buffer of an exiting thread. */
+struct TraceOwner {
+    TraceBuffer* buffer = nullptr;
+
+    ~TraceOwner() {
+        if (!buffer) return;
+        trace_buffer = nullptr;
+        buffer->retired.store(true, std::memory_order_release);
+    }
+};
+
+/** @brief buffer of the calling thread, created and registered on first use. */
+static TraceBuffer& getTraceBuffer() {
+    if (trace_buffer) return *trace_buffer;
+    static thread_local TraceOwner owner;
+    TraceBuffer* buffer = new TraceBuffer();
+    buffer->head.store(0);
+    buffer->tail.store(0);
+    buffer->retired.store(false);
+    TraceRegistry& r = getRegistry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        buffer->tid = r.next_tid++;
+        r.buffers.push_back(buffer);
+    }
+    owner.buffer = buffer;
+    trace_buffer = buffer;
+    return *buffer;
+}
+
+void startTracing() {
+    getTraceTime();
+    trace_enabled.store(true);
+}
+
+void stopTracing() {
+    trace_enabled.store(false);
+}
+
+void setTraceThreadName(const std::string& name) {
+    TraceBuffer& buffer = getTraceBuffer();
+    std::lock_guard<std::mutex> lock(getRegistry().mutex);
+    buffer.name = name;
+}
+
+uint64_t getTraceDropped() {
+    return getRegistry().dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t getTraceTime() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void recordTraceSpan(const char* name, uint64_t start, uint64_t end, uint64_t count) {
+    TraceBuffer& buffer = getTraceBuffer();
+    if (!buffer.events) buffer.events.reset(new TraceEvent[TRACE_BUFFER_EVENTS]);
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= TRACE_BUFFER_EVENTS) {
+        getRegistry().dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TraceEvent& e = buffer.events[head & (TRACE_BUFFER_EVENTS - 1)];
+    e.name = name;
+    e.start = start;
+    e.end = end;
+    e.count = count;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+/** @brief write a string literal, escaping quotes, backslashes and control characters. */
+static void writeString(FILE* file, const char* s) {
+    fputc('"', file);
+    for (; *s; ++s) {
+        const char c = *s;
+        if ((c == '"') || (c == '\\')) {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            fprintf(file, "\\u%04x", static_cast<unsigned char>(c));
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+size_t flushTrace(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Cannot open %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        MYMATH_COUNT_ERROR();
+        throw "Cannot open file!";
+    }
+    TraceRegistry& r = getRegistry();
+    size_t written = 0;
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t b = 0; b < r.buffers.size();) {
+            TraceBuffer* buffer = r.buffers[b];
+            // read retired first, a retired thread has published all of its spans
+            const bool retired = buffer->retired.load(std::memory_order_acquire);
+            if (!buffer->name.empty()) {
+                fprintf(file, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ",
+                        first ? "" : ",", buffer->tid);
+                writeString(file, buffer->name.c_str());
+                fprintf(file, "}}");
+                first = false;
+            }
+            const uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+            const uint64_t head = buffer->head.load(std::memory_order_acquire);
+            for (uint64_t i = tail; i < head; ++i) {
+                const TraceEvent& e = buffer->events[i & (TRACE_BUFFER_EVENTS - 1)];
+                fprintf(file, "%s\n{\"name\": ", first ? "" : ",");
+                writeString(file, e.name);
+                fprintf(file, ", \"cat\": \"mymath\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f",
+                        buffer->tid, e.start * 1e-3, (e.end - e.start) * 1e-3);
+                if (e.count) fprintf(file, ", \"args\": {\"n\": %llu}", static_cast<unsigned long long>(e.count));
+                fprintf(file, "}");
+                first = false;
+            }
+            written += head - tail;
+            buffer->tail.store(head, std::memory_order_release);
+            if (retired) {
+                r.buffers[b] = r.buffers.back();
+                r.buffers.pop_back();
+                delete buffer;
+            } else {
+                ++b;
+            }
+        }
+    }
+    fprintf(file, "\n], \"otherData\": {\"dropped\": %llu}}\n", static_cast<unsigned long long>(getTraceDropped()));
+    if (fclose(file) != 0) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Write error on %s.\n",
+                __FILE__, __LINE__, __FUNCTION__, path.c_str());
+        MYMATH_COUNT_ERROR();
+        throw "Write error!";
+    }
+    return written;
+}
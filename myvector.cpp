@@ -1,4 +1,5 @@
 #include "myvector.hpp"
+#include "myinstrument.hpp"
 
 void Vector2::set(scalar _x, scalar _y) {
     this->x = _x;
@@ -30,6 +31,7 @@ Vector2 Vector2::normalized() const {
     if (len < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     } else {
         return Vector2(x / len, y / len);
@@ -41,6 +43,7 @@ void Vector2::normalize() {
     if (len < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     } else {
         this->x = x / len;
@@ -104,6 +107,7 @@ Vector2 Vector2::operator/(const scalar scale) const {
     if (std::abs(scale) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     return Vector2(x / scale, y / scale);
@@ -113,6 +117,7 @@ Vector2& Vector2::operator/=(const scalar scale) {
     if (std::abs(scale) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     x /= scale;
@@ -145,6 +150,7 @@ scalar Vector2::operator[](int index) const {
     if ((index > 1) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return (&x)[index];
@@ -156,6 +162,7 @@ scalar& Vector2::operator[](int index) {
     if ((index > 1) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return (&x)[index];
@@ -203,6 +210,7 @@ scalar Vector3::angle(const Vector3& vec, ANGLEUNIT unit) const {
     if (len < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     } else {
         scalar u = (unit == RAD) ? 1 : (RAD2DEG);
@@ -216,10 +224,12 @@ scalar Vector3::angle(const Vector3& vec, ANGLEUNIT unit) const {
 }
 
 Vector3 Vector3::normalized() const {
+    MYMATH_INSTRUMENT_SCOPE(INSTR_VECTOR3_NORMALIZED);
     scalar len = length();
     if (len < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     } else {
         return Vector3(x / len, y / len, z / len);
@@ -227,10 +237,12 @@ Vector3 Vector3::normalized() const {
 }
 
 void Vector3::normalize() {
+    MYMATH_INSTRUMENT_SCOPE(INSTR_VECTOR3_NORMALIZE);
     scalar len = length();
     if (len < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     } else {
         this->x = x / len;
@@ -304,6 +316,7 @@ Vector3 Vector3::operator/(const scalar scale) const {
     if (std::abs(scale) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     return Vector3(x / scale, y / scale, z / scale);
@@ -313,6 +326,7 @@ Vector3& Vector3::operator/=(const scalar scale) {
     if (std::abs(scale) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     x /= scale;
@@ -349,6 +363,7 @@ scalar Vector3::operator[](int index) const {
     if ((index > 2) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return (&x)[index];
@@ -360,6 +375,7 @@ scalar& Vector3::operator[](int index) {
     if ((index > 2) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return (&x)[index];
@@ -408,6 +424,7 @@ Vector4 Vector4::normalized() const {
     if (len < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     } else {
         return Vector4(x / len, y / len, z / len, w / len);
@@ -419,6 +436,7 @@ void Vector4::normalize() {
     if (len < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     } else {
         this->x = x / len;
@@ -481,6 +499,7 @@ Vector4 Vector4::operator/(const scalar scale) const {
     if (std::abs(scale) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     return Vector4(x / scale, y / scale, z / scale, w / scale);
@@ -490,6 +509,7 @@ Vector4& Vector4::operator/=(const scalar scale) {
     if (std::abs(scale) < MYEPSILON) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Division by zero condition.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Division by zero condition!";
     }
     x /= scale;
@@ -541,6 +561,7 @@ scalar Vector4::operator[](int index) const {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return (&x)[index];
@@ -552,6 +573,7 @@ scalar& Vector4::operator[](int index) {
     if ((index > 3) || (index < 0)) {
         fprintf(stderr, "File %s, Line %d, Function %s(): Index out of bounds.\n",
                 __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
         throw "Index out of bounds!";
     }
     return (&x)[index];
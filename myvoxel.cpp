@@ -0,0 +1,158 @@
+#include "myvoxel.hpp"
+#include "myarena.hpp"
+#include "mybatch.hpp"
+#include "mymorton.hpp"
+#include "myparallel.hpp"
+#include "mytrace.hpp"
+#include "myinstrument.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/** @brief elements handled by one parallel task. */
+static const size_t VOXEL_GRAIN = 1 << 14;
+
+/** @brief splitmix64 finalizer, picks the random point of a voxel. */
+static inline uint64_t mixBits(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+VoxelGridFilter::VoxelGridFilter(scalar voxelSize, VOXELREDUCE mode, uint64_t seed) :
+    voxel_size(voxelSize), reduce(mode), seed(seed) {
+    if (!(voxelSize > 0)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Invalid voxel size.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Invalid voxel size!";
+    }
+}
+
+size_t VoxelGridFilter::group(const Vector3* points, size_t n) {
+    perm.clear();
+    representative.clear();
+    voxel_start.assign(1, 0);
+    if (n == 0) return 0;
+
+    Vector3 lo, hi;
+    computeBounds(points, n, lo, hi);
+    // voxels are anchored at the world origin, codes count from the lowest voxel of the call
+    const scalar inv = 1 / voxel_size;
+    const Vector3 base(std::floor(lo.x * inv), std::floor(lo.y * inv), std::floor(lo.z * inv));
+    const scalar cells = static_cast<scalar>(uint32_t(1) << MORTON63_BITS);
+    if ((std::floor(hi.x * inv) - base.x >= cells) || (std::floor(hi.y * inv) - base.y >= cells)
+        || (std::floor(hi.z * inv) - base.z >= cells)) {
+        fprintf(stderr, "File %s, Line %d, Function %s(): Voxel size too small for the bounds.\n",
+                __FILE__, __LINE__, __FUNCTION__);
+        MYMATH_COUNT_ERROR();
+        throw "Voxel size too small!";
+    }
+
+    // voxel codes, then sort input indices by code
+    codes.resize(n);
+    perm.resize(n);
+    parallelFor(0, n, VOXEL_GRAIN, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            codes[i] = mortonEncode63(static_cast<uint32_t>(std::floor(points[i].x * inv) - base.x),
+                                      static_cast<uint32_t>(std::floor(points[i].y * inv) - base.y),
+                                      static_cast<uint32_t>(std::floor(points[i].z * inv) - base.z));
+        }
+    });
+    radixSortByKey(codes.data(), perm.data(), n);
+
+    // run starts, fixed blocks count their starts, scan, then write
+    const size_t blocks = (n + VOXEL_GRAIN - 1) / VOXEL_GRAIN;
+    ArenaScope scratch(getThreadArena());
+    size_t* block_offset = scratch.allocate<size_t>(blocks + 1);
+    parallelFor(0, blocks, 1, [&](size_t first, size_t last) {
+        for (size_t blk = first; blk < last; ++blk) {
+            const size_t end = std::min(n, (blk + 1) * VOXEL_GRAIN);
+            size_t count = 0;
+            for (size_t i = blk * VOXEL_GRAIN; i < end; ++i) {
+                count += (i == 0) || (codes[i] != codes[i - 1]);
+            }
+            block_offset[blk + 1] = count;
+        }
+    });
+    for (size_t blk = 0; blk < blocks; ++blk) block_offset[blk + 1] += block_offset[blk];
+    const size_t voxels = block_offset[blocks];
+    voxel_start.resize(voxels + 1);
+    parallelFor(0, blocks, 1, [&](size_t first, size_t last) {
+        for (size_t blk = first; blk < last; ++blk) {
+            const size_t end = std::min(n, (blk + 1) * VOXEL_GRAIN);
+            size_t k = block_offset[blk];
+            for (size_t i = blk * VOXEL_GRAIN; i < end; ++i) {
+                if ((i == 0) || (codes[i] != codes[i - 1])) voxel_start[k++] = static_cast<uint32_t>(i);
+            }
+        }
+    });
+    voxel_start[voxels] = static_cast<uint32_t>(n);
+    representative.resize(voxels);
+    return voxels;
+}
+
+void VoxelGridFilter::reduceVoxels(const Vector3* points, Vector3* out) {
+    const size_t voxels = voxelCount();
+    parallelFor(0, voxels, VOXEL_GRAIN / 8, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            const uint32_t s = voxel_start[v], e = voxel_start[v + 1];
+            uint32_t pick = s;
+            if (reduce == RANDOM_POINT) {
+                pick = s + static_cast<uint32_t>(mixBits(seed ^ codes[s]) % (e - s));
+            }
+            representative[v] = perm[pick];
+            if (reduce == CENTROID) {
+                double sx = 0, sy = 0, sz = 0;
+                for (uint32_t k = s; k < e; ++k) {
+                    const Vector3& p = points[perm[k]];
+                    sx += p.x;
+                    sy += p.y;
+                    sz += p.z;
+                }
+                const double w = 1.0 / (e - s);
+                out[v].set(static_cast<scalar>(sx * w), static_cast<scalar>(sy * w), static_cast<scalar>(sz * w));
+            } else {
+                out[v] = points[perm[pick]];
+            }
+        }
+    });
+}
+
+size_t VoxelGridFilter::filter(const Vector3* points, size_t n, std::vector<Vector3>& out) {
+    MYMATH_TRACE_SPAN("VoxelGridFilter::filter", n);
+    const size_t voxels = group(points, n);
+    out.resize(voxels);
+    reduceVoxels(points, out.data());
+    return voxels;
+}
+
+const Vector3* VoxelGridFilter::filter(const Vector3* points, size_t n, Arena& arena, size_t& count) {
+    MYMATH_TRACE_SPAN("VoxelGridFilter::filter", n);
+    count = group(points, n);
+    Vector3* out = arena.allocateUninitialized<Vector3>(count);
+    reduceVoxels(points, out);
+    return out;
+}
+
+void VoxelGridFilter::filterAttribute(const scalar* attributes, size_t dim, std::vector<scalar>& out) const {
+    const size_t voxels = voxelCount();
+    out.resize(voxels * dim);
+    parallelFor(0, voxels, VOXEL_GRAIN / 8, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            scalar* dst = out.data() + v * dim;
+            if (reduce != CENTROID) {
+                std::copy(attributes + representative[v] * dim, attributes + (representative[v] + 1) * dim, dst);
+                continue;
+            }
+            const uint32_t s = voxel_start[v], e = voxel_start[v + 1];
+            const double w = 1.0 / (e - s);
+            for (size_t d = 0; d < dim; ++d) {
+                double sum = 0;
+                for (uint32_t k = s; k < e; ++k) sum += attributes[perm[k] * dim + d];
+                dst[d] = static_cast<scalar>(sum * w);
+            }
+        }
+    });
+}
@@ -0,0 +1,99 @@
+#include "myarena.hpp"
+#include "mybatch.hpp"
+#include "myparallel.hpp"
+#include "myvoxel.hpp"
+#include "test_check.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/** @brief heap allocations of the whole program. */
+static std::atomic<size_t> g_allocations(0);
+
+// Every form of new and delete is replaced, so all of them pair malloc() with free(). GCC
+// inlines the deletes into their callers and then reports free() on the result of the
+// operator new it did not inline as -Wmismatched-new-delete.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+/** @brief counted malloc(), every replaced operator new goes through it. */
+static void* allocate(size_t bytes) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(bytes ? bytes : 1);
+}
+
+void* operator new(size_t bytes) {
+    void* p = allocate(bytes);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t bytes) { return operator new(bytes); }
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept { return allocate(bytes); }
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept { return allocate(bytes); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+/** @brief frames after the first ones of a voxel filter and a reduction do not touch the heap. */
+static void testSteadyState(unsigned int threads) {
+    setThreadCount(threads);
+    const size_t n = 1 << 18;
+    std::vector<Vector3> points(n);
+    uint64_t s = 1;
+    for (size_t i = 0; i < n; ++i) {
+        s = s * 6364136223846793005ull + 1442695040888963407ull;
+        points[i].set(static_cast<scalar>((s >> 40) % 4096) * 0.01f, static_cast<scalar>((s >> 20) % 4096) * 0.01f,
+                      static_cast<scalar>((s >> 8) % 256) * 0.01f);
+    }
+    VoxelGridFilter filter(0.1f, CENTROID);
+    std::vector<Vector3> out;
+    size_t allocations = 0;
+    for (int frame = 0; frame < 6; ++frame) {
+        nextFrame();
+        const size_t before = g_allocations.load();
+        filter.filter(points.data(), n, out);
+        size_t count = 0;
+        filter.filter(points.data(), n, getThreadArena(), count);
+        Vector3 lo, hi;
+        computeBounds(points.data(), n, lo, hi);
+        // the first frames size the buffers, the arenas and the pool
+        if (frame >= 3) allocations += g_allocations.load() - before;
+    }
+    check(allocations == 0, (threads == 1) ? "steady state allocates, 1 thread" : "steady state allocates, 4 threads");
+}
+
+/** @brief the array and nothrow forms are counted too. */
+static void testReplacedForms() {
+    const size_t before = g_allocations.load();
+    // volatile keeps the compiler from omitting the allocations
+    int* volatile one = new int(1);
+    int* volatile array = new int[16];
+    int* volatile quiet = new (std::nothrow) int(2);
+    int* volatile quietArray = new (std::nothrow) int[16];
+    const size_t allocations = g_allocations.load() - before;
+    check(allocations == 4, "every form of operator new is counted");
+    delete one;
+    delete[] array;
+    delete quiet;
+    delete[] quietArray;
+}
+
+int main() {
+    testReplacedForms();
+    testSteadyState(1);
+    testSteadyState(4);
+    return failures;
+}
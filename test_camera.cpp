@@ -0,0 +1,175 @@
+#include "mycamera.hpp"
+#include "mylie.hpp"
+#include "myparallel.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief skewed camera looking roughly at the origin from negative z. */
+static PinholeCamera makeCamera(int width, int height) {
+    const scalar k[9] = {180.f, 0, 0, 0.8f, 175.f, 0, 0.47f * width, 0.52f * height, 1};
+    Matrix3 K;
+    K.set(k);
+    const SE3 T_cw(SO3::exp(Vector3(0.05f, -0.1f, 0.02f)), Vector3(0.3f, -0.2f, 6.f));
+    return PinholeCamera(K, T_cw.matrix(), width, height);
+}
+
+/** @brief points in front of and behind the camera, some stacked on the same pixel. */
+static std::vector<Vector3> makePoints(size_t n) {
+    std::vector<Vector3> points(n);
+    uint64_t s = 21;
+    for (size_t i = 0; i < n; ++i) {
+        points[i] = Vector3(4 * uniform(s), 3 * uniform(s), 5 * uniform(s) + 1);
+        if (i % 50 == 9) points[i].z = -20;
+        // the same ray at another depth
+        if ((i % 7 == 3) && (i > 0)) points[i] = points[i - 1] * 1.25f;
+    }
+    return points;
+}
+
+/** @brief projectPoints() agrees with project() and with K * T_cw * p in double. */
+static void testProjectPoints() {
+    const PinholeCamera camera = makeCamera(160, 120);
+    const std::vector<Vector3> points = makePoints(40000 + 3);
+    const size_t n = points.size();
+    std::vector<Vector2> pixels(n);
+    std::vector<scalar> depth(n);
+    const size_t front = camera.projectPoints(points.data(), n, pixels.data(), depth.data());
+    const Matrix3& K = camera.getIntrinsics();
+    const scalar* t = camera.getExtrinsics().constData();
+    size_t expectedFront = 0;
+    bool single = true, reference = true, behind = true;
+    for (size_t i = 0; i < n; ++i) {
+        const Vector3& p = points[i];
+        double c[3];
+        for (int r = 0; r < 3; ++r) {
+            c[r] = static_cast<double>(t[r]) * p.x + static_cast<double>(t[4 + r]) * p.y +
+                   static_cast<double>(t[8 + r]) * p.z + t[12 + r];
+        }
+        Vector2 px;
+        scalar z;
+        const bool inFront = camera.project(p, px, z);
+        expectedFront += inFront;
+        if (!inFront) {
+            behind &= (c[2] <= 0) && std::isnan(pixels[i].x) && std::isnan(pixels[i].y);
+            continue;
+        }
+        const double u = (K[0] * c[0] + K[3] * c[1]) / c[2] + K[6];
+        const double v = K[4] * c[1] / c[2] + K[7];
+        single &= (std::abs(pixels[i].x - px.x) < 1e-3f) && (std::abs(pixels[i].y - px.y) < 1e-3f) &&
+                  (std::abs(depth[i] - z) < 1e-5f);
+        reference &= (std::abs(pixels[i].x - u) < 1e-3) && (std::abs(pixels[i].y - v) < 1e-3) &&
+                     (std::abs(depth[i] - c[2]) < 1e-5);
+    }
+    check(front == expectedFront, "projectPoints() counts the points in front");
+    check(single, "projectPoints() matches project()");
+    check(reference, "projectPoints() matches K * T_cw * p");
+    check(behind, "points behind the camera get NaN pixels");
+
+    // the depth output is optional
+    std::vector<Vector2> again(n);
+    check(camera.projectPoints(points.data(), n, again.data()) == front, "projectPoints() without depth");
+
+    // unproject() inverts project() in camera frame
+    bool inverse = true;
+    const SE3 T_cw(camera.getExtrinsics());
+    for (size_t i = 0; i < 1000; ++i) {
+        Vector2 px;
+        scalar z;
+        if (!camera.project(points[i], px, z)) continue;
+        inverse &= (camera.unproject(px, z) - T_cw * points[i]).length() < 1e-4f;
+    }
+    check(inverse, "unproject(project(p)) is p in camera frame");
+}
+
+/** @brief serial z-buffer over the pixels of projectPoints(), 0 where no point lands. */
+static size_t serialDepth(const PinholeCamera& camera, const std::vector<Vector3>& points, std::vector<scalar>& image) {
+    const int w = camera.getWidth(), h = camera.getHeight();
+    std::vector<Vector2> pixels(points.size());
+    std::vector<scalar> depth(points.size());
+    camera.projectPoints(points.data(), points.size(), pixels.data(), depth.data());
+    image.assign(static_cast<size_t>(w) * h, 0);
+    size_t inside = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Vector2& px = pixels[i];
+        if (!((px.x >= 0) && (px.x < w) && (px.y >= 0) && (px.y < h))) continue;
+        scalar& d = image[static_cast<size_t>(px.y) * w + static_cast<size_t>(px.x)];
+        if ((d == 0) || (depth[i] < d)) d = depth[i];
+        ++inside;
+    }
+    return inside;
+}
+
+/** @brief renderDepth() is the serial z-buffer, for image sizes around the tile size and any thread count. */
+static void testRenderDepth() {
+    const std::vector<Vector3> points = makePoints(60000);
+    const unsigned int threads = getThreadCount();
+    const int sizes[][2] = {{160, 120}, {31, 33}, {1, 1}, {97, 64}};
+    for (const auto& size : sizes) {
+        const PinholeCamera camera = makeCamera(size[0], size[1]);
+        std::vector<scalar> expected;
+        const size_t inside = serialDepth(camera, points, expected);
+        size_t hits = 0;
+        for (scalar d : expected) hits += (d > 0);
+        check(hits > 0, "renderDepth " + std::to_string(size[0]) + "x" + std::to_string(size[1]) + ": points hit the image");
+        for (unsigned int t : {1u, 3u, 8u}) {
+            setThreadCount(t);
+            const std::string what = "renderDepth " + std::to_string(size[0]) + "x" + std::to_string(size[1]) +
+                                     ", " + std::to_string(t) + " threads";
+            // stale content must be overwritten, also by the empty value
+            std::vector<scalar> image(expected.size(), -7);
+            const size_t count = camera.renderDepth(points.data(), points.size(), image.data());
+            check(count == inside, what + ": number of points inside the image");
+            check(image == expected, what + ": matches the serial z-buffer");
+        }
+    }
+    setThreadCount(threads);
+
+    const PinholeCamera camera = makeCamera(64, 48);
+    std::vector<scalar> image(64 * 48, -7);
+    check((camera.renderDepth(points.data(), 0, image.data()) == 0) &&
+          std::all_of(image.begin(), image.end(), [](scalar d) { return d == 0; }), "renderDepth of no point clears the image");
+    const PinholeCamera empty = makeCamera(0, 0);
+    check(empty.renderDepth(points.data(), points.size(), nullptr) == 0, "renderDepth of an empty image");
+}
+
+static void testInvalid() {
+    int thrown = 0;
+    try {
+        PinholeCamera camera(0, 100, 10, 10, 20, 20);
+    } catch (const char*) {
+        ++thrown;
+    }
+    try {
+        PinholeCamera camera(100, 100, 10, 10, -1, 20);
+    } catch (const char*) {
+        ++thrown;
+    }
+    try {
+        PinholeCamera camera(100, 100, 10, 10, 20, 20);
+        Matrix3 K = camera.getIntrinsics();
+        K[2] = 0.5f;
+        camera.setIntrinsics(K);
+    } catch (const char*) {
+        ++thrown;
+    }
+    check(thrown == 3, "zero focal length, negative size and a non camera matrix throw");
+}
+
+int main() {
+    testProjectPoints();
+    testRenderDepth();
+    testInvalid();
+    return failures;
+}
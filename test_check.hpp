@@ -0,0 +1,25 @@
+/**
+ *  Copyright (C) All rights reserved.
+ *  @file test_check.hpp
+ *  @brief check() of the test programs, included once by every test_*.cpp.
+ *  @author haofan ren, yqykrhf@163.com
+ *  @version beta 0.0
+ *  @date 22-4-12
+ *  @note a failed check prints its description and the test goes on, main() returns the
+ *  @note number of failures, so ctest reports any failure as a non-zero exit code.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+static int failures = 0;
+
+/** @brief count and report a failed check, the exit code is the number of failures. */
+static inline void check(bool ok, const std::string& what) {
+    if (!ok) {
+        ++failures;
+        std::cout << "FAILED: " << what << std::endl;
+    }
+}
@@ -0,0 +1,200 @@
+#include "mycloud.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <unistd.h>
+
+/** @brief true if opening the file throws. */
+static bool rejected(const std::string& path) {
+    try {
+        MappedCloud cloud(path);
+    } catch (const char*) {
+        return true;
+    }
+    return false;
+}
+
+/** @brief a chunk offset close to 2^64 wraps offset + payload size below the chunk table, open must reject it. */
+static void testWrappingOffset(CLOUDLAYOUT layout, const char* what) {
+    const std::string path = "test_cloud.bin";
+    std::vector<Vector3> points(100);
+    for (size_t i = 0; i < points.size(); ++i) points[i].set(i * 1.f, i * 2.f, i * 3.f);
+    {
+        CloudWriter writer(path, layout);
+        writer.writeChunk(points.data(), points.size());
+        writer.close();
+    }
+    check(!rejected(path), what);
+
+    CloudFileHeader header;
+    FILE* file = fopen(path.c_str(), "r+b");
+    check(file && (fread(&header, sizeof(header), 1, file) == 1), what);
+    if (!file) return;
+    CloudChunkInfo info;
+    fseek(file, static_cast<long>(header.chunk_table), SEEK_SET);
+    check(fread(&info, sizeof(info), 1, file) == 1, what);
+    // 2^64 - 512, offset plus the 1200 payload bytes wraps past zero
+    info.offset = ~uint64_t(0) - 511;
+    fseek(file, static_cast<long>(header.chunk_table), SEEK_SET);
+    fwrite(&info, sizeof(info), 1, file);
+    fclose(file);
+    check(rejected(path), what);
+    remove(path.c_str());
+}
+
+/** @brief point i of the round trip clouds. */
+static Vector3 pointAt(size_t i) {
+    return Vector3(i * 0.5f, -1.f * i, 1000.f + i);
+}
+
+/** @brief true if calling f throws. */
+template <typename F>
+static bool throws(F f) {
+    try {
+        f();
+    } catch (const char*) {
+        return true;
+    }
+    return false;
+}
+
+/** @brief chunks written by CloudWriter come back through views and copies, with the table filled in. */
+static void testRoundTrip(CLOUDLAYOUT layout, const std::string& what) {
+    const std::string path = "test_cloud.bin";
+    const size_t sizes[3] = {100, 1, 37};
+    std::vector<Vector3> points(138);
+    for (size_t i = 0; i < points.size(); ++i) points[i] = pointAt(i);
+    {
+        CloudWriter writer(path, layout);
+        writer.writeChunk(points.data(), sizes[0]);
+        // an empty chunk is skipped
+        writer.writeChunk(points.data(), 0);
+        std::vector<scalar> x(sizes[1]), y(sizes[1]), z(sizes[1]);
+        x[0] = points[100].x;
+        y[0] = points[100].y;
+        z[0] = points[100].z;
+        writer.writeChunk(ConstVector3SoA(x.data(), y.data(), z.data(), sizes[1]));
+        writer.writeChunk(points.data() + 101, sizes[2]);
+        check(writer.size() == points.size(), what + ": writer size");
+        writer.close();
+    }
+    MappedCloud cloud(path);
+    check(cloud.isOpen() && (cloud.getLayout() == layout), what + ": layout");
+    check((cloud.size() == points.size()) && (cloud.chunkCount() == 3), what + ": point and chunk counts");
+    check(cloud.isZeroCopy(), what + ": zero copy");
+    size_t first = 0;
+    for (size_t c = 0; c < 3; ++c) {
+        const CloudChunkInfo& info = cloud.getChunk(c);
+        check((info.count == sizes[c]) && (info.first == first), what + ": chunk table");
+        check(info.offset % CLOUD_ALIGNMENT == 0, what + ": payload alignment");
+        Vector3 lo = points[first], hi = points[first];
+        for (size_t i = first; i < first + sizes[c]; ++i) {
+            lo.set(std::min(lo.x, points[i].x), std::min(lo.y, points[i].y), std::min(lo.z, points[i].z));
+            hi.set(std::max(hi.x, points[i].x), std::max(hi.y, points[i].y), std::max(hi.z, points[i].z));
+        }
+        check((info.bounds_min[0] == lo.x) && (info.bounds_min[1] == lo.y) && (info.bounds_min[2] == lo.z) &&
+                  (info.bounds_max[0] == hi.x) && (info.bounds_max[1] == hi.y) && (info.bounds_max[2] == hi.z),
+              what + ": chunk bounds");
+        std::vector<Vector3> copy(sizes[c]);
+        cloud.copyChunk(c, copy.data());
+        bool same = true;
+        for (size_t i = 0; i < sizes[c]; ++i) same &= copy[i].equal(points[first + i]);
+        check(same, what + ": copyChunk");
+        same = true;
+        if (layout == AOS) {
+            const Vector3* view = cloud.points(c);
+            for (size_t i = 0; i < sizes[c]; ++i) same &= view[i].equal(points[first + i]);
+            check(throws([&]() { cloud.pointsSoA(c); }), what + ": no SOA view of an AOS file");
+        } else {
+            const ConstVector3SoA view = cloud.pointsSoA(c);
+            same = (view.size == sizes[c]);
+            for (size_t i = 0; same && (i < sizes[c]); ++i) same &= view.get(i).equal(points[first + i]);
+            check(reinterpret_cast<uintptr_t>(view.y) % CLOUD_ALIGNMENT == 0, what + ": SOA plane alignment");
+            check(throws([&]() { cloud.points(c); }), what + ": no AOS view of a SOA file");
+        }
+        check(same, what + ": view");
+        first += sizes[c];
+    }
+    check(throws([&]() { cloud.getChunk(3); }), what + ": chunk index out of bounds");
+    cloud.close();
+    check(!cloud.isOpen(), what + ": close");
+    remove(path.c_str());
+}
+
+/** @brief write a small cloud, change it with f and check that open rejects it. */
+template <typename F>
+static void checkRejected(F f, const std::string& what) {
+    const std::string path = "test_cloud.bin";
+    std::vector<Vector3> points(10);
+    for (size_t i = 0; i < points.size(); ++i) points[i] = pointAt(i);
+    {
+        CloudWriter writer(path, SOA);
+        writer.writeChunk(points.data(), points.size());
+        writer.close();
+    }
+    check(!rejected(path), what + ": unchanged file opens");
+    f(path);
+    check(rejected(path), what);
+    remove(path.c_str());
+}
+
+/** @brief change the header of a file. */
+template <typename F>
+static void editHeader(const std::string& path, F f) {
+    CloudFileHeader header;
+    FILE* file = fopen(path.c_str(), "r+b");
+    if (!file) return;
+    if (fread(&header, sizeof(header), 1, file) == 1) {
+        f(header);
+        fseek(file, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, file);
+    }
+    fclose(file);
+}
+
+static void testInvalidFiles() {
+    check(rejected("test_cloud_missing.bin"), "missing file");
+    checkRejected([](const std::string& path) { check(truncate(path.c_str(), 32) == 0, "truncate"); },
+                  "file shorter than the header");
+    checkRejected([](const std::string& path) {
+        FILE* file = fopen(path.c_str(), "rb");
+        fseek(file, 0, SEEK_END);
+        const long size = ftell(file);
+        fclose(file);
+        // cut into the chunk table
+        check(truncate(path.c_str(), size - 8) == 0, "truncate");
+    }, "truncated chunk table");
+    checkRejected([](const std::string& path) {
+        CloudFileHeader header;
+        FILE* file = fopen(path.c_str(), "rb");
+        check(fread(&header, sizeof(header), 1, file) == 1, "read header");
+        fclose(file);
+        // keep the table, drop the end of the payload before it
+        check(truncate(path.c_str(), static_cast<off_t>(header.chunk_table) - 64) == 0, "truncate");
+    }, "truncated payload");
+    checkRejected([](const std::string& path) { editHeader(path, [](CloudFileHeader& h) { h.magic[0] = 'X'; }); },
+                  "bad magic");
+    checkRejected([](const std::string& path) { editHeader(path, [](CloudFileHeader& h) { h.version = 2; }); },
+                  "bad version");
+    checkRejected([](const std::string& path) { editHeader(path, [](CloudFileHeader& h) { h.layout = 7; }); },
+                  "bad layout");
+    checkRejected([](const std::string& path) { editHeader(path, [](CloudFileHeader& h) { h.scalar_size = 2; }); },
+                  "bad scalar size");
+    checkRejected([](const std::string& path) { editHeader(path, [](CloudFileHeader& h) { h.point_count += 1; }); },
+                  "point count not the sum of the chunks");
+    checkRejected([](const std::string& path) { editHeader(path, [](CloudFileHeader& h) { h.chunk_count = 1000; }); },
+                  "chunk count beyond the file");
+}
+
+int main() {
+    testRoundTrip(AOS, "AOS round trip");
+    testRoundTrip(SOA, "SOA round trip");
+    testInvalidFiles();
+    testWrappingOffset(AOS, "AOS chunk offset");
+    testWrappingOffset(SOA, "SOA chunk offset");
+    return failures;
+}
@@ -0,0 +1,141 @@
+#include "mydepth.hpp"
+#include "mylie.hpp"
+#include "test_check.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+static const int WIDTH = 37;
+static const int HEIGHT = 29;
+
+/** @brief depth of pixel i, every 7th missing and a few non finite or negative. */
+static scalar depthAt(size_t i) {
+    if (i % 7 == 3) return 0;
+    if (i == 40) return std::numeric_limits<scalar>::quiet_NaN();
+    if (i == 41) return std::numeric_limits<scalar>::infinity();
+    if (i == 42) return -1;
+    return 0.5f + static_cast<scalar>(i % 101) * 0.037f;
+}
+
+/** @brief expected point of pixel i, by unproject() at the pixel center and the optional transform. */
+static Vector3 expectedPoint(const PinholeCamera& camera, size_t i, scalar depth, const SE3* camToWorld) {
+    const Vector2 pixel(static_cast<scalar>(i % WIDTH) + 0.5f, static_cast<scalar>(i / WIDTH) + 0.5f);
+    const Vector3 p = camera.unproject(pixel, depth);
+    return camToWorld ? (*camToWorld) * p : p;
+}
+
+/** @brief number of pixels with a positive finite depth. */
+static size_t validCount(const std::vector<scalar>& depth) {
+    size_t n = 0;
+    for (scalar d : depth) n += (d > 0) && std::isfinite(d);
+    return n;
+}
+
+/** @brief largest error of a back-projection relative to the expected points, 1 for a wrong layout or count. */
+static scalar backProjectionError(const PinholeCamera& camera, const std::vector<scalar>& depth,
+                                  const Vector3SoA& out, size_t count, const SE3* camToWorld, bool organized) {
+    scalar error = 0;
+    size_t k = 0;
+    for (size_t i = 0; i < depth.size(); ++i) {
+        const bool valid = (depth[i] > 0) && std::isfinite(depth[i]);
+        if (!valid) {
+            if (organized && !(std::isnan(out.x[i]) && std::isnan(out.y[i]) && std::isnan(out.z[i]))) return 1;
+            continue;
+        }
+        const size_t j = organized ? i : k++;
+        if (j >= count) return 1;
+        const Vector3 e = expectedPoint(camera, i, depth[i], camToWorld);
+        const scalar d = (out.get(j) - e).length() / (1 + e.length());
+        if (!(d <= error)) error = d;  // a NaN point also lands here and fails the check
+    }
+    if (!organized && (k != count)) return 1;
+    return error;
+}
+
+/** @brief organized and compact output of scalar and 16 bit depth, with and without transform. */
+static void testBackProject() {
+    Matrix3 K;
+    const scalar k[9] = {420.f, 0, 0, 1.5f, 410.f, 0, 18.3f, 14.1f, 1};
+    K.set(k);
+    PinholeCamera camera(K, Matrix4(), WIDTH, HEIGHT);
+    const SE3 T_cw(SO3::exp(Vector3(0.1f, -0.3f, 0.2f)), Vector3(1.f, -2.f, 0.5f));
+    const SE3 T_wc = T_cw.inverse();
+    camera.setExtrinsics(T_cw.matrix());
+    const Matrix4 camToWorld = T_wc.matrix();
+
+    const size_t pixels = static_cast<size_t>(WIDTH) * HEIGHT;
+    std::vector<scalar> depth(pixels);
+    std::vector<uint16_t> raw(pixels);
+    std::vector<scalar> rawDepth(pixels);
+    for (size_t i = 0; i < pixels; ++i) {
+        depth[i] = depthAt(i);
+        raw[i] = static_cast<uint16_t>((i % 11 == 5) ? 0 : 300 + (i * 37) % 4000);
+        rawDepth[i] = raw[i] * 0.001f;
+    }
+
+    DepthBackProjector projector(camera);
+    check((projector.getWidth() == WIDTH) && (projector.getHeight() == HEIGHT) && (projector.pixelCount() == pixels),
+          "image size of the table");
+    Vector3SoABuffer buffer(pixels);
+    for (int organized = 0; organized < 2; ++organized) {
+        for (int transform = 0; transform < 2; ++transform) {
+            const std::string what = std::string(organized ? "organized" : "compact") + (transform ? ", T_cw" : "");
+            const Matrix4* m = transform ? &camToWorld : nullptr;
+            const SE3* t = transform ? &T_wc : nullptr;
+            size_t count = projector.backProject(depth.data(), buffer.view(), m, organized != 0);
+            check(count == (organized ? pixels : validCount(depth)), what + ": count");
+            check(backProjectionError(camera, depth, buffer.view(), count, t, organized != 0) < 1e-5f,
+                  what + ": points match unproject()");
+            count = projector.backProject(raw.data(), 0.001f, buffer.view(), m, organized != 0);
+            check(backProjectionError(camera, rawDepth, buffer.view(), count, t, organized != 0) < 1e-5f,
+                  what + ": 16 bit depth with scale");
+        }
+    }
+
+    Vector3SoABuffer small(pixels - 1);
+    bool thrown = false;
+    try {
+        projector.backProject(depth.data(), small.view());
+    } catch (const char*) {
+        thrown = true;
+    }
+    check(thrown, "output smaller than the image throws");
+}
+
+/** @brief the ray table is rebuilt when the intrinsics or the image size change, not for extrinsics. */
+static void testCameraChange() {
+    PinholeCamera camera(300.f, 310.f, 16.f, 12.f, WIDTH, HEIGHT);
+    DepthBackProjector projector;
+    check(projector.setCamera(camera), "first setCamera builds the table");
+    camera.setExtrinsics(SE3(SO3::exp(Vector3(0.f, 0.5f, 0.f)), Vector3(1.f, 0.f, 0.f)).matrix());
+    check(!projector.setCamera(camera), "extrinsics keep the table");
+
+    const size_t pixels = static_cast<size_t>(WIDTH) * HEIGHT;
+    std::vector<scalar> depth(pixels);
+    for (size_t i = 0; i < pixels; ++i) depth[i] = depthAt(i);
+    Vector3SoABuffer buffer(pixels);
+    projector.backProject(depth.data(), buffer.view(), nullptr, true);
+    // unproject() works in camera frame, the extrinsics do not matter to it
+    check(backProjectionError(camera, depth, buffer.view(), pixels, nullptr, true) < 1e-5f, "first intrinsics");
+
+    Matrix3 K = camera.getIntrinsics();
+    K[0] = 250.f;
+    K[6] = 20.f;
+    camera.setIntrinsics(K);
+    check(projector.setCamera(camera), "new intrinsics rebuild the table");
+    check(!projector.setCamera(camera), "same intrinsics keep the table");
+    projector.backProject(depth.data(), buffer.view(), nullptr, true);
+    check(backProjectionError(camera, depth, buffer.view(), pixels, nullptr, true) < 1e-5f, "rays of the new intrinsics");
+
+    camera.setImageSize(WIDTH + 3, HEIGHT);
+    check(projector.setCamera(camera) && (projector.pixelCount() == pixels + 3 * HEIGHT), "new image size rebuilds the table");
+}
+
+int main() {
+    testBackProject();
+    testCameraChange();
+    return failures;
+}
@@ -0,0 +1,118 @@
+#include "mydeskew.hpp"
+#include "test_check.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+/** @brief a scan spanning a whole spline at an epoch start time, points at both ends and in between. */
+static void testTrajectoryEnds() {
+    const size_t n = 8;
+    std::vector<SE3> control(n);
+    for (size_t k = 0; k < n; ++k) {
+        const scalar s = static_cast<scalar>(k);
+        control[k] = SE3(SO3::exp(Vector3(0.05f * s, -0.02f * s * s, 0.1f * std::sin(s))),
+                         Vector3(0.5f * s, std::cos(s), 0.01f * s * s));
+    }
+    const TrajectorySpline spline(control.data(), n, 1.7e9, 0.1);
+    const double start = spline.getStartTime(), end = spline.getEndTime();
+
+    ScanDeskewer deskewer;
+    try {
+        deskewer.setTrajectory(spline, start, end, start);
+    } catch (const char*) {
+        check(false, "setTrajectory over the whole spline");
+        return;
+    }
+
+    const double times[5] = {start, start + (end - start) * 0.25, start + (end - start) * 0.5, end - 1e-3, end};
+    const Vector3 p(2.f, -1.f, 0.5f);
+    Vector3 points[5] = {p, p, p, p, p};
+    check(deskewer.deskew(points, times, 5) == 5, "deskew counts the interval ends");
+
+    const SE3 inv = spline.evaluate(start).inverse();
+    scalar error = 0;
+    for (int i = 0; i < 5; ++i) {
+        const Vector3 expected = inv * (spline.evaluate(times[i]) * p);
+        // NaN compares false, so a NaN point fails the check below
+        const scalar e = (points[i] - expected).length();
+        error = (e <= error) ? error : e;
+    }
+    check(error < 1e-3f, "deskew at the interval ends matches the trajectory");
+
+    bool thrown = false;
+    try {
+        deskewer.setTrajectory(spline, start, end + 1e-3, start);
+    } catch (const char*) {
+        thrown = true;
+    }
+    check(thrown, "setTrajectory past the end throws");
+}
+
+/**
+ * @brief buckets wider than spline segments, down to one bucket for the whole spline.
+ * @note at a bucket boundary a point moves with the trajectory, in between with the linear
+ * @note blend of the two boundary transforms, i.e. the blend of the two moved points.
+ */
+static void testCoarseBuckets(int buckets) {
+    const size_t n = 10;
+    std::vector<SE3> control(n);
+    for (size_t k = 0; k < n; ++k) {
+        const scalar s = static_cast<scalar>(k);
+        control[k] = SE3(SO3::exp(Vector3(0.3f * std::sin(s), 0.2f * std::cos(s), 0.05f * s * s)),
+                         Vector3(3 * std::sin(s), 0.5f * s * s, std::cos(0.7f * s)));
+    }
+    const TrajectorySpline spline(control.data(), n, 1.7e9, 0.1);
+    const double start = spline.getStartTime(), end = spline.getEndTime();
+    const double reference = start + (end - start) / 3;
+    const std::string what = "deskew with " + std::to_string(buckets) + " buckets";
+
+    ScanDeskewer deskewer(buckets);
+    try {
+        deskewer.setTrajectory(spline, start, end, reference);
+    } catch (const char*) {
+        check(false, what + ": setTrajectory over the whole spline");
+        return;
+    }
+    const SE3 inv = spline.evaluate(reference).inverse();
+    const Vector3 p(2.f, -1.f, 0.5f);
+    std::vector<double> times;
+    std::vector<Vector3> expected;
+    for (int k = 0; k < buckets; ++k) {
+        const double t0 = (k == 0) ? start : start + (end - start) * k / buckets;
+        const double t1 = (k + 1 == buckets) ? end : start + (end - start) * (k + 1) / buckets;
+        const Vector3 p0 = inv * (spline.evaluate(t0) * p), p1 = inv * (spline.evaluate(t1) * p);
+        for (int j = 0; j < 4; ++j) {
+            const scalar f = j / 4.f;
+            times.push_back(t0 + (t1 - t0) * f);
+            expected.push_back(p0 * (1 - f) + p1 * f);
+        }
+    }
+    times.push_back(end);
+    expected.push_back(inv * (spline.evaluate(end) * p));
+
+    std::vector<Vector3> points(times.size(), p);
+    check(deskewer.deskew(points.data(), times.data(), points.size()) == points.size(), what + ": count");
+    std::vector<scalar> x(times.size(), p.x), y(times.size(), p.y), z(times.size(), p.z);
+    check(deskewer.deskew(Vector3SoA(x.data(), y.data(), z.data(), times.size()), times.data()) == times.size(),
+          what + ": SOA count");
+    scalar error = 0;
+    for (size_t i = 0; i < times.size(); ++i) {
+        const scalar e = std::max((points[i] - expected[i]).length(), (Vector3(x[i], y[i], z[i]) - expected[i]).length());
+        // NaN compares false, so a NaN point fails the check below
+        error = (e <= error) ? error : e;
+    }
+    check(error < 1e-3f, what + ": points match the trajectory at the boundaries and blend in between");
+}
+
+int main() {
+    testTrajectoryEnds();
+    // 7 spline segments
+    testCoarseBuckets(1);
+    testCoarseBuckets(2);
+    testCoarseBuckets(3);
+    testCoarseBuckets(5);
+    testCoarseBuckets(7);
+    testCoarseBuckets(64);
+    return failures;
+}
@@ -0,0 +1,223 @@
+#include "myformat.hpp"
+#include "myparallel.hpp"
+#include "myrotation.hpp"
+#include "test_check.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+static std::string fixed(double value, int precision) {
+    char buffer[FORMAT_BUFFER_SIZE];
+    const char* end = formatFixed(buffer, buffer + sizeof(buffer), value, precision);
+    return end ? std::string(buffer, end - buffer) : "(null)";
+}
+
+template <typename T>
+static std::string shortest(T value) {
+    char buffer[FORMAT_BUFFER_SIZE];
+    const char* end = formatShortest(buffer, buffer + sizeof(buffer), value);
+    return end ? std::string(buffer, end - buffer) : "(null)";
+}
+
+static std::string printed(const char* format, int precision, double value) {
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer), format, precision, value);
+    return buffer;
+}
+
+static double readBack(const std::string& text, double) {
+    return strtod(text.c_str(), nullptr);
+}
+
+static float readBack(const std::string& text, float) {
+    return strtof(text.c_str(), nullptr);
+}
+
+/** @brief reads back to the same bits, and is no longer than printf with the fewest digits that read back. */
+template <typename T>
+static bool isShortest(T value) {
+    const std::string text = shortest(value);
+    const T back = readBack(text, value);
+    if (std::memcmp(&back, &value, sizeof(T)) != 0) return false;
+    for (int digits = 1; digits <= std::numeric_limits<T>::max_digits10; ++digits) {
+        const std::string fewest = printed("%.*g", digits, value);
+        if (readBack(fewest, value) == value) return text.size() <= fewest.size();
+    }
+    return false;
+}
+
+/** @brief the special values named by the review, exact strings valid for both implementations. */
+static void testSpecialValues() {
+    const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+    check((fixed(-0.0, 3) == "-0.000") && (fixed(-0.0004, 3) == "-0.000") && (fixed(-0.0, 0) == "-0"),
+          "formatFixed keeps the sign of zero and of values rounding to zero");
+    check((shortest(-0.0) == "-0") && (shortest(-0.0f) == "-0") && (shortest(0.0) == "0"), "formatShortest of signed zero");
+    check((shortest(std::numeric_limits<double>::denorm_min()) == "5e-324") && (shortest(1e-310) == "1e-310") &&
+          (shortest(std::numeric_limits<float>::denorm_min()) == "1e-45") && (shortest(3e-40f) == "3e-40"),
+          "formatShortest of subnormals");
+    check((fixed(std::numeric_limits<double>::denorm_min(), 3) == "0.000") && (fixed(-1e-310, 2) == "-0.00"),
+          "formatFixed of subnormals");
+    check((shortest(std::numeric_limits<double>::max()) == "1.7976931348623157e+308") &&
+          (shortest(std::numeric_limits<float>::max()) == "3.4028235e+38") && (shortest(1e23) == "1e+23"),
+          "formatShortest of huge exponents");
+    check((fixed(std::numeric_limits<double>::max(), 2) == printed("%.*f", 2, std::numeric_limits<double>::max())) &&
+          (fixed(-std::numeric_limits<double>::max(), 40) == printed("%.*f", 40, -std::numeric_limits<double>::max())) &&
+          (fixed(1e22, 0) == "10000000000000000000000"), "formatFixed of huge exponents");
+    check((fixed(inf, 3) == "inf") && (fixed(-inf, 0) == "-inf") && (fixed(nan, 2) == "nan"), "formatFixed of inf and nan");
+    check((shortest(inf) == "inf") && (shortest(-inf) == "-inf") && (shortest(nan) == "nan") &&
+          (shortest(static_cast<float>(-inf)) == "-inf"), "formatShortest of inf and nan");
+    // binary ties round to even, 2.675 is below the tie in binary
+    check((fixed(0.5, 0) == "0") && (fixed(1.5, 0) == "2") && (fixed(2.5, 0) == "2") && (fixed(-2.5, 0) == "-2") &&
+          (fixed(0.125, 2) == "0.12") && (fixed(0.375, 2) == "0.38") && (fixed(2.675, 2) == "2.67") &&
+          (fixed(1e15 + 0.5, 0) == "1000000000000000"), "formatFixed rounds ties to even");
+    check((fixed(0.1, 20) == "0.10000000000000000555") && (fixed(2.7, -3) == "3") && (fixed(0.1, 50) == fixed(0.1, 40)),
+          "formatFixed prints the binary value, clamps the precision");
+}
+
+/** @brief formatFixed() is printf "%.*f", formatShortest() is shortest, on values of every magnitude. */
+static void testRandomValues() {
+    uint64_t s = 1;
+    bool fixedSame = true, doubleShortest = true, floatShortest = true;
+    std::string firstMismatch;
+    for (int k = 0; k < 20000; ++k) {
+        s = s * 6364136223846793005ull + 1442695040888963407ull;
+        double bits;
+        const uint64_t pattern = s;
+        std::memcpy(&bits, &pattern, sizeof(bits));
+        const float fbits = static_cast<float>(bits);
+        if (std::isfinite(bits)) doubleShortest &= isShortest(bits);
+        if (std::isfinite(fbits)) floatShortest &= isShortest(fbits);
+
+        // mantissas with few digits and halves at the last printed digit
+        const int exponent = static_cast<int>((s >> 8) % 41) - 20;
+        double value = static_cast<double>(uniform(s)) * std::pow(10.0, exponent);
+        if (k % 3 == 0) value = std::round(value * 1e3) / 1e3 + 5e-4;
+        const int precision = static_cast<int>((s >> 20) % 41);
+        if (fixed(value, precision) != printed("%.*f", precision, value)) {
+            if (fixedSame) firstMismatch = printed("%.*g", 17, value) + " precision " + std::to_string(precision);
+            fixedSame = false;
+        }
+    }
+    check(fixedSame, "formatFixed matches printf " + firstMismatch);
+    check(doubleShortest, "formatShortest of doubles reads back and is shortest");
+    check(floatShortest, "formatShortest of floats reads back and is shortest");
+}
+
+static void testBuffers() {
+    char buffer[32];
+    const std::string text = fixed(-12.375, 3);
+    check(formatFixed(buffer, buffer + text.size() - 1, -12.375, 3) == nullptr, "formatFixed into a buffer one short");
+    check(formatFixed(buffer, buffer + text.size(), -12.375, 3) == buffer + text.size(), "formatFixed into an exact buffer");
+    check((formatShortest(buffer, buffer + 2, 0.125) == nullptr) && (formatShortest(buffer, buffer + 5, 0.125) == buffer + 5),
+          "formatShortest into short and exact buffers");
+    check(formatScalar(nullptr, nullptr, 1) == nullptr, "formatScalar passes nullptr on");
+
+    char* end = formatVector(buffer, buffer + sizeof(buffer), Vector3(1, -0.5f, 0.25f));
+    check(std::string(buffer, end) == "(1, -0.5, 0.25)", "formatVector shortest");
+    check(formatVector(buffer, buffer + 10, Vector3(1, -0.5f, 0.25f)) == nullptr, "formatVector into a short buffer");
+    char matrix[64];
+    end = formatMatrix(matrix, matrix + sizeof(matrix), Matrix2(), 2);
+    check(std::string(matrix, end) == "[      1.00       0.00]\n[      0.00       1.00]\n", "formatMatrix layout");
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+/** @brief parse a shortest scalar back to its type, a fixed one to double. */
+static double parseScalar(const char* text, char** end, bool shortest) {
+    return (shortest && (sizeof(scalar) == sizeof(float))) ? strtof(text, end) : strtod(text, end);
+}
+
+/** @brief TUM and KITTI files read back to the written poses, in more batches than one. */
+static void testTrajectories() {
+    const size_t n = 16 * 4096 + 4103;
+    std::vector<Matrix4> poses(n);
+    std::vector<double> stamps(n);
+    uint64_t s = 2;
+    for (size_t i = 0; i < n; ++i) {
+        const Matrix3 r = eulerToRotation(Vector3(3 * uniform(s), 1.5f * uniform(s), 3 * uniform(s)), EULER_ZYX);
+        const scalar* m = r.constData();
+        poses[i] = Matrix4(m[0], m[1], m[2], 0, m[3], m[4], m[5], 0, m[6], m[7], m[8], 0,
+                           100 * uniform(s), 100 * uniform(s), 0.001f * uniform(s), 1);
+        stamps[i] = 1.6e9 + 0.0333 * i + 1e-7 * (i % 10);
+    }
+    const unsigned int threads = getThreadCount();
+    const std::string tum = "test_format.tum", kitti = "test_format.kitti";
+
+    for (int precision : {-1, 9}) {
+        const std::string what = (precision < 0) ? "shortest" : "precision 9";
+        setThreadCount(1);
+        writeTUM(tum, stamps.data(), poses.data(), n, precision);
+        writeKITTI(kitti, poses.data(), n, precision);
+        const std::string tumText = readFile(tum), kittiText = readFile(kitti);
+        setThreadCount(4);
+        writeTUM(tum, stamps.data(), poses.data(), n, precision);
+        writeKITTI(kitti, poses.data(), n, precision);
+        check((readFile(tum) == tumText) && (readFile(kitti) == kittiText), what + ": same files for any thread count");
+
+        // shortest reads back exactly, fixed within half a unit of the last digit
+        const double tolerance = (precision < 0) ? 0 : 5.01e-10;
+        bool tumOk = true, kittiOk = true;
+        size_t lines = 0;
+        char* p = const_cast<char*>(tumText.c_str());
+        for (size_t i = 0; tumOk && (i < n); ++i, ++lines) {
+            const Matrix4& m = poses[i];
+            const Vector4 q = rotationToQuaternion(Matrix3(m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10]));
+            const double stamp = strtod(p, &p);
+            tumOk &= std::abs(stamp - stamps[i]) < 5.01e-7;
+            const scalar expected[7] = {m[12], m[13], m[14], q.x, q.y, q.z, q.w};
+            for (int k = 0; k < 7; ++k) tumOk &= std::abs(parseScalar(p, &p, precision < 0) - expected[k]) <= tolerance;
+            tumOk &= (*p == '\n');
+            ++p;
+        }
+        check(tumOk && (lines == n) && (*p == 0), what + ": TUM file reads back");
+        p = const_cast<char*>(kittiText.c_str());
+        for (size_t i = 0; kittiOk && (i < n); ++i) {
+            for (int r = 0; r < 3; ++r) {
+                for (int c = 0; c < 4; ++c) {
+                    kittiOk &= std::abs(parseScalar(p, &p, precision < 0) - poses[i][c * 4 + r]) <= tolerance;
+                }
+            }
+            kittiOk &= (*p == '\n');
+            ++p;
+        }
+        check(kittiOk && (*p == 0), what + ": KITTI file reads back");
+    }
+    setThreadCount(threads);
+    remove(tum.c_str());
+    remove(kitti.c_str());
+
+    bool thrown = false;
+    try {
+        writeKITTI("no_such_directory/test_format.kitti", poses.data(), 1);
+    } catch (const char*) {
+        thrown = true;
+    }
+    check(thrown, "writing into a missing directory throws");
+}
+
+int main() {
+    testSpecialValues();
+    testRandomValues();
+    testBuffers();
+    testTrajectories();
+    return failures;
+}
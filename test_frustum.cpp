@@ -0,0 +1,251 @@
+#include "myfrustum.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** @brief distances closer to a plane than this are not compared, float rounding decides them. */
+static const double MARGIN = 1e-3;
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief reference classification of a box by its 8 corners against the 6 planes, in double. */
+struct BoxReference {
+    /** @brief the box is on the negative side of one plane. */
+    bool outside = false;
+    /** @brief the box is on the positive side of every plane. */
+    bool inside = true;
+    /** @brief a corner lies within MARGIN of a deciding plane. */
+    bool ambiguous = false;
+};
+
+static BoxReference classifyCorners(const Frustum& f, const Vector3& lo, const Vector3& hi, uint8_t planes = 0x3f) {
+    BoxReference ref;
+    for (int i = 0; i < 6; ++i) {
+        if (!(planes & (1u << i))) continue;
+        const Vector4& p = f.getPlane(i);
+        double lowest = 1e30, highest = -1e30;
+        for (int c = 0; c < 8; ++c) {
+            const double x = (c & 1) ? hi.x : lo.x, y = (c & 2) ? hi.y : lo.y, z = (c & 4) ? hi.z : lo.z;
+            const double d = p.x * x + p.y * y + p.z * z + p.w;
+            lowest = std::min(lowest, d);
+            highest = std::max(highest, d);
+        }
+        ref.outside |= (highest < 0);
+        ref.inside &= (lowest >= 0);
+        ref.ambiguous |= (std::abs(highest) < MARGIN) || (std::abs(lowest) < MARGIN);
+    }
+    return ref;
+}
+
+static bool bit(const std::vector<uint64_t>& mask, size_t i) {
+    return ((mask[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+/** @brief number of set bits, false if a bit past n is set. */
+static bool popcount(const std::vector<uint64_t>& mask, size_t n, size_t& count) {
+    count = 0;
+    for (size_t i = 0; i < mask.size() * 64; ++i) {
+        if (!bit(mask, i)) continue;
+        if (i >= n) return false;
+        ++count;
+    }
+    return true;
+}
+
+/** @brief view-projection matrices of the supported projections, with the clip depth range. */
+struct Camera {
+    std::string name;
+    Matrix4 viewProjection;
+    CLIPDEPTH depth;
+};
+
+static std::vector<Camera> makeCameras() {
+    Matrix4 view, proj;
+    view.setLookAt(Vector3(1, 2, 12), Vector3(0, 0, 0), Vector3(0, 1, 0));
+    std::vector<Camera> cameras;
+    proj.setPerspective(60, 1.5f, 0.5f, 30);
+    cameras.push_back(Camera{"perspective", proj.matmul(view), NEGATIVE_ONE_TO_ONE});
+    proj.setFrustum(-0.3f, 0.5f, -0.2f, 0.4f, 1, 25);
+    cameras.push_back(Camera{"off-center frustum", proj.matmul(view), NEGATIVE_ONE_TO_ONE});
+    proj.setOrthographic(-6, 4, -3, 5, 2, 20);
+    cameras.push_back(Camera{"orthographic", proj.matmul(view), NEGATIVE_ONE_TO_ONE});
+    proj.setReversedZPerspective(70, 1, 0.5f, 30);
+    cameras.push_back(Camera{"reversed-Z", proj.matmul(view), ZERO_TO_ONE});
+    proj.setInfinitePerspective(50, 1.2f, 0.5f);
+    cameras.push_back(Camera{"infinite", proj.matmul(view), NEGATIVE_ONE_TO_ONE});
+    return cameras;
+}
+
+/** @brief a point is inside the frustum if its clip coordinates are inside the clip volume. */
+static void testPlanes(const Camera& cam) {
+    const Frustum f(cam.viewProjection, cam.depth);
+    uint64_t s = 11;
+    bool same = true;
+    for (int k = 0; k < 20000; ++k) {
+        const Vector3 p(20 * uniform(s), 20 * uniform(s), 20 * uniform(s) - 8);
+        const Vector4 c = cam.viewProjection * Vector4(p.x, p.y, p.z, 1);
+        const double zMin = (cam.depth == ZERO_TO_ONE) ? 0 : -c.w;
+        const double margin = std::min<double>({c.w - std::abs(c.x), c.w - std::abs(c.y), c.z - zMin, c.w - c.z});
+        // the planes are normalized, clip distances are not, so only clear cases are compared
+        if (std::abs(margin) < 1e-2) continue;
+        same &= (f.containsPoint(p) == (margin > 0));
+    }
+    check(same, cam.name + ": containsPoint() matches the clip volume");
+    bool unit = true;
+    for (int i = 0; i < 6; ++i) {
+        const Vector4& p = f.getPlane(i);
+        unit &= std::abs(Vector3(p.x, p.y, p.z).length() - 1) < 1e-5f;
+    }
+    // the degenerated far plane of the infinite projection is (0, 0, 0, 1)
+    check(unit || (cam.name == "infinite"), cam.name + ": plane normals have unit length");
+}
+
+/** @brief cullAABBs() and classifyAABB() against the corner test, on lengths around the mask words. */
+static void testBoxes(const Camera& cam) {
+    const Frustum f(cam.viewProjection, cam.depth);
+    uint64_t s = 12;
+    for (size_t n : {size_t(0), size_t(1), size_t(63), size_t(64), size_t(65), size_t(1000), size_t(40000)}) {
+        const std::string what = cam.name + ", " + std::to_string(n) + " boxes";
+        std::vector<Vector3> lo(n), hi(n);
+        for (size_t i = 0; i < n; ++i) {
+            lo[i] = Vector3(25 * uniform(s), 25 * uniform(s), 25 * uniform(s) - 10);
+            const scalar e = (i % 5 == 0) ? 0 : 3 * (uniform(s) + 1);
+            hi[i] = lo[i] + Vector3(e, e * 0.5f, e * 2);
+        }
+        std::vector<uint64_t> visible((n + 63) / 64, ~uint64_t(0));
+        const size_t count = f.cullAABBs(lo.data(), hi.data(), n, visible.data());
+        size_t bits;
+        check(popcount(visible, n, bits) && (bits == count), what + ": count is the number of set bits");
+        bool same = true, single = true;
+        for (size_t i = 0; i < n; ++i) {
+            const BoxReference ref = classifyCorners(f, lo[i], hi[i]);
+            if (ref.ambiguous) continue;
+            same &= (bit(visible, i) == !ref.outside);
+            const CONTAINMENT c = f.classifyAABB(lo[i], hi[i]);
+            single &= (c == (ref.outside ? OUTSIDE : ref.inside ? INSIDE : INTERSECT));
+        }
+        check(same, what + ": cullAABBs() matches the corner test");
+        check(single, what + ": classifyAABB() matches the corner test");
+    }
+}
+
+static void testSpheres(const Camera& cam) {
+    const Frustum f(cam.viewProjection, cam.depth);
+    uint64_t s = 13;
+    const size_t n = 20000 + 7;
+    std::vector<Vector3> center(n);
+    std::vector<scalar> radius(n);
+    for (size_t i = 0; i < n; ++i) {
+        center[i] = Vector3(25 * uniform(s), 25 * uniform(s), 25 * uniform(s) - 10);
+        radius[i] = (i % 4 == 0) ? 0 : 2 * (uniform(s) + 1);
+    }
+    std::vector<uint64_t> visible((n + 63) / 64);
+    const size_t count = f.cullSpheres(center.data(), radius.data(), n, visible.data());
+    size_t bits;
+    check(popcount(visible, n, bits) && (bits == count), cam.name + ": sphere count is the number of set bits");
+    bool same = true, single = true;
+    for (size_t i = 0; i < n; ++i) {
+        bool outside = false, inside = true, ambiguous = false;
+        for (int k = 0; k < 6; ++k) {
+            const Vector4& p = f.getPlane(k);
+            const double d = p.x * center[i].x + p.y * center[i].y + p.z * center[i].z + p.w;
+            outside |= (d < -radius[i]);
+            inside &= (d >= radius[i]);
+            ambiguous |= (std::abs(d + radius[i]) < MARGIN) || (std::abs(d - radius[i]) < MARGIN);
+        }
+        if (ambiguous) continue;
+        same &= (bit(visible, i) == !outside);
+        single &= (f.classifySphere(center[i], radius[i]) == (outside ? OUTSIDE : inside ? INSIDE : INTERSECT));
+    }
+    check(same, cam.name + ": cullSpheres() matches the plane distances");
+    check(single, cam.name + ": classifySphere() matches the plane distances");
+}
+
+/** @brief a box tree of octants, every parent before its children. */
+static void makeTree(std::vector<Vector3>& lo, std::vector<Vector3>& hi, std::vector<int32_t>& parent,
+                     const Vector3& a, const Vector3& b, int32_t up, int depth) {
+    const int32_t self = static_cast<int32_t>(lo.size());
+    lo.push_back(a);
+    hi.push_back(b);
+    parent.push_back(up);
+    if (depth == 0) return;
+    const Vector3 m = (a + b) * 0.5f;
+    for (int c = 0; c < 8; ++c) {
+        const Vector3 ca((c & 1) ? m.x : a.x, (c & 2) ? m.y : a.y, (c & 4) ? m.z : a.z);
+        const Vector3 cb((c & 1) ? b.x : m.x, (c & 2) ? b.y : m.y, (c & 4) ? b.z : m.z);
+        makeTree(lo, hi, parent, ca, cb, self, depth - 1);
+    }
+}
+
+/** @brief cullHierarchy() and the plane mask passed from parent to child match the flat test. */
+static void testHierarchy(const Camera& cam) {
+    const Frustum f(cam.viewProjection, cam.depth);
+    std::vector<Vector3> lo, hi;
+    std::vector<int32_t> parent;
+    makeTree(lo, hi, parent, Vector3(-16, -12, -30), Vector3(16, 12, 10), -1, 4);
+    makeTree(lo, hi, parent, Vector3(-3.1f, -2.3f, -5.7f), Vector3(2.9f, 1.7f, 6.1f), -1, 3);
+    makeTree(lo, hi, parent, Vector3(40, 40, 40), Vector3(50, 50, 50), -1, 2);
+    const size_t n = lo.size();
+    std::vector<uint64_t> visible((n + 63) / 64, ~uint64_t(0)), inside((n + 63) / 64, ~uint64_t(0));
+    const size_t count = f.cullHierarchy(lo.data(), hi.data(), parent.data(), n, visible.data(), inside.data());
+    size_t bits, insideBits;
+    check(popcount(visible, n, bits) && (bits == count) && popcount(inside, n, insideBits),
+          cam.name + ": hierarchy count is the number of set bits");
+
+    // the mask of every node as classifyAABB() passes it down
+    std::vector<uint8_t> mask(n);
+    bool same = true, masks = true;
+    for (size_t i = 0; i < n; ++i) {
+        const BoxReference ref = classifyCorners(f, lo[i], hi[i]);
+        uint8_t m = (parent[i] < 0) ? uint8_t(0x3f) : mask[parent[i]];
+        const bool culled = (parent[i] >= 0) && !bit(visible, parent[i]);
+        CONTAINMENT c = culled ? OUTSIDE : (m == 0) ? INSIDE : f.classifyAABB(lo[i], hi[i], m);
+        mask[i] = m;
+        if (ref.ambiguous) continue;
+        same &= (bit(visible, i) == !ref.outside) && (bit(inside, i) == (!ref.outside && ref.inside));
+        if (culled || (c == OUTSIDE)) continue;
+        // the planes left in the mask are exactly the straddled ones
+        for (int k = 0; k < 6; ++k) {
+            const BoxReference plane = classifyCorners(f, lo[i], hi[i], static_cast<uint8_t>(1u << k));
+            masks &= (((m >> k) & 1) != 0) == !plane.inside;
+        }
+    }
+    check(same, cam.name + ": cullHierarchy() matches the flat corner test");
+    check(masks, cam.name + ": plane mask keeps the straddled planes");
+    check((bits < n) && (insideBits > 0), cam.name + ": the tree has culled and inside nodes");
+
+    // planes left out of the mask are not tested
+    const Vector3 far(1000, 1000, 1000);
+    uint8_t none = 0;
+    check(f.classifyAABB(far, far + Vector3(1, 1, 1), none) == INSIDE, cam.name + ": empty mask tests no plane");
+    uint8_t all = 0x3f;
+    check(f.classifyAABB(far, far + Vector3(1, 1, 1), all) == OUTSIDE, cam.name + ": full mask culls");
+}
+
+int main() {
+    for (const Camera& cam : makeCameras()) {
+        testPlanes(cam);
+        testBoxes(cam);
+        testSpheres(cam);
+        testHierarchy(cam);
+    }
+    const Frustum everything;
+    check(everything.classifyAABB(Vector3(-1e6f, -1e6f, -1e6f), Vector3(1e6f, 1e6f, 1e6f)) == INSIDE,
+          "default frustum contains everything");
+    bool thrown = false;
+    try {
+        everything.getPlane(6);
+    } catch (const char*) {
+        thrown = true;
+    }
+    check(thrown, "getPlane(6) throws");
+    return failures;
+}
@@ -0,0 +1,187 @@
+#include "mybatch.hpp"
+#include "myisa.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief kernel lengths around every register width, and one with a remainder on each. */
+static const size_t LENGTHS[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 47, 1013};
+
+/** @brief points of mixed magnitudes, with NaN and infinite coordinates. */
+static std::vector<Vector3> makePoints(size_t n) {
+    std::vector<Vector3> p(n);
+    uint64_t s = 11;
+    for (size_t i = 0; i < n; ++i) {
+        const scalar scale = static_cast<scalar>(std::pow(10.0, static_cast<int>(i % 7) - 3));
+        p[i] = Vector3(uniform(s) * scale, uniform(s) * scale, uniform(s) * scale);
+    }
+    const scalar nan = std::numeric_limits<scalar>::quiet_NaN(), inf = std::numeric_limits<scalar>::infinity();
+    for (size_t i = 5; i < n; i += 37) (&p[i].x)[i % 3] = nan;
+    for (size_t i = 12; i < n; i += 53) (&p[i].x)[i % 3] = (i % 2) ? inf : -inf;
+    return p;
+}
+
+/** @brief well conditioned matrices, with singular ones, a NaN one and the zero matrix. */
+static std::vector<Matrix4> makeMatrices(size_t n) {
+    std::vector<Matrix4> m(n);
+    uint64_t s = 12;
+    for (size_t i = 0; i < n; ++i) {
+        scalar* a = m[i].data();
+        for (int k = 0; k < 16; ++k) a[k] = uniform(s);
+        for (int k = 0; k < 4; ++k) a[k * 5] += (uniform(s) < 0) ? -3 : 3;
+    }
+    for (size_t i = 3; i < n; i += 29) {
+        scalar* a = m[i].data();
+        // two equal columns
+        for (int k = 0; k < 4; ++k) a[4 + k] = a[k];
+    }
+    if (n > 10) m[10] = Matrix4(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    if (n > 20) m[20].data()[6] = std::numeric_limits<scalar>::quiet_NaN();
+    return m;
+}
+
+/** @brief quaternions of mixed norms, with zero and non-finite ones. */
+static std::vector<Vector4> makeQuaternions(size_t n) {
+    std::vector<Vector4> q(n);
+    uint64_t s = 13;
+    for (size_t i = 0; i < n; ++i) {
+        q[i] = Vector4(uniform(s), uniform(s), uniform(s), uniform(s));
+        (&q[i].x)[i % 4] *= 8;
+    }
+    if (n > 3) q[3] = Vector4(0, 0, 0, 0);
+    if (n > 9) q[9].z = std::numeric_limits<scalar>::quiet_NaN();
+    return q;
+}
+
+static const scalar* entries(const Vector3& v) { return &v.x; }
+static const scalar* entries(const Vector4& v) { return &v.x; }
+static const scalar* entries(const Matrix3& m) { return m.constData(); }
+static const scalar* entries(const Matrix4& m) { return m.constData(); }
+
+/** @brief the K entries of every element have the same bits, padding is not compared. */
+template <int K, typename T>
+static bool sameBits(const std::vector<T>& a, const std::vector<T>& b) {
+    bool same = (a.size() == b.size());
+    for (size_t i = 0; same && (i < a.size()); ++i) {
+        same = (std::memcmp(entries(a[i]), entries(b[i]), K * sizeof(scalar)) == 0);
+    }
+    return same;
+}
+
+/** @brief NaN where the reference is NaN, else within tolerance times the largest entry of the reference element. */
+template <int K, typename T>
+static bool closeTo(const std::vector<T>& a, const std::vector<T>& ref, double tolerance) {
+    for (size_t i = 0; i < ref.size(); ++i) {
+        const scalar *x = entries(a[i]), *r = entries(ref[i]);
+        double size = 0;
+        for (int k = 0; k < K; ++k) size = std::max(size, std::abs(static_cast<double>(r[k])));
+        for (int k = 0; k < K; ++k) {
+            if (std::isnan(r[k]) != std::isnan(x[k])) return false;
+            if (!std::isnan(r[k]) && (std::abs(static_cast<double>(x[k]) - r[k]) > tolerance * size)) return false;
+        }
+    }
+    return true;
+}
+
+/** @brief the kernels of every level against the scalar ones, on each length. */
+static void testKernels(const BatchKernels& ref, const BatchKernels& kernels, const std::string& name) {
+    uint64_t s = 14;
+    bool transform = true, inPlace = true, bounds = true, invert = true, rotations = true, quaternions = true;
+    for (size_t n : LENGTHS) {
+        const std::vector<Vector3> points = makePoints(n);
+        Matrix4 affine = Matrix4(uniform(s), uniform(s), uniform(s), 0, uniform(s), uniform(s), uniform(s), 0,
+                                 uniform(s), uniform(s), uniform(s), 0, 10 * uniform(s), 10 * uniform(s), 10 * uniform(s), 1);
+        std::vector<Vector3> refOut(n), out(n), same = points;
+        ref.transform(affine.constData(), points.data(), n, refOut.data());
+        kernels.transform(affine.constData(), points.data(), n, out.data());
+        kernels.transform(affine.constData(), same.data(), n, same.data());
+        transform &= sameBits<3>(out, refOut);
+        inPlace &= sameBits<3>(same, refOut);
+
+        // boxes already holding values, NaN coordinates must not reach them
+        Vector3 refMin(0.5f, -2, 0), refMax(0.5f, -1, 0), lo = refMin, hi = refMax;
+        ref.bounds(points.data(), n, refMin, refMax);
+        kernels.bounds(points.data(), n, lo, hi);
+        bounds &= sameBits<3>(std::vector<Vector3>{lo, hi}, std::vector<Vector3>{refMin, refMax});
+
+        const std::vector<Matrix4> matrices = makeMatrices(n);
+        std::vector<Matrix4> refInv(n), inv(n);
+        invert &= (kernels.invert(matrices.data(), n, inv.data()) == ref.invert(matrices.data(), n, refInv.data()));
+        invert &= closeTo<16>(inv, refInv, 1e-5);
+
+        const std::vector<Vector4> q = makeQuaternions(n);
+        std::vector<Matrix3> refRot(n), rot(n);
+        rotations &= (kernels.toRotations(q.data(), n, rot.data()) == ref.toRotations(q.data(), n, refRot.data()));
+        rotations &= sameBits<9>(rot, refRot);
+
+        std::vector<Vector4> refQuat(n), quat(n);
+        quaternions &= (kernels.toQuaternions(refRot.data(), n, quat.data()) ==
+                        ref.toQuaternions(refRot.data(), n, refQuat.data()));
+        quaternions &= closeTo<4>(quat, refQuat, 1e-6);
+    }
+    check(transform, name + ": transform bitwise equal to scalar");
+    check(inPlace, name + ": transform in place bitwise equal to scalar");
+    check(bounds, name + ": bounds bitwise equal to scalar");
+    check(invert, name + ": invert within 1e-5 of scalar, same singular ones");
+    check(rotations, name + ": toRotations bitwise equal to scalar");
+    check(quaternions, name + ": toQuaternions within 1e-6 of scalar");
+}
+
+/** @brief the batch functions dispatch to the level set last. */
+static void testDispatch(const std::string& name, const std::vector<Vector3>& refOut, const Vector3& refMin,
+                         const Vector3& refMax, const std::vector<Matrix4>& refInv, const Matrix4& affine) {
+    const size_t n = refOut.size();
+    const std::vector<Vector3> points = makePoints(n);
+    const std::vector<Matrix4> matrices = makeMatrices(n);
+    std::vector<Vector3> out(n);
+    std::vector<Matrix4> inv(n);
+    transformPoints(affine, points.data(), n, out.data());
+    Vector3 lo, hi;
+    computeBounds(points.data(), n, lo, hi);
+    invertMatrices(matrices.data(), n, inv.data());
+    check(sameBits<3>(out, refOut) && sameBits<3>(std::vector<Vector3>{lo, hi}, std::vector<Vector3>{refMin, refMax}),
+          name + ": transformPoints and computeBounds as scalar");
+    check(closeTo<16>(inv, refInv, 1e-5), name + ": invertMatrices as scalar");
+}
+
+int main() {
+    const ISALEVEL isa = getISA();
+    check(isISASupported(ISA_SCALAR) && !isISASupported(ISA_COUNT), "scalar is always supported");
+    check(!setISA(ISA_COUNT) && (getISA() == isa), "an unsupported level changes nothing");
+
+    setISA(ISA_SCALAR);
+    const BatchKernels ref = getBatchKernels();
+    check(ref.isa == ISA_SCALAR, "setISA() selects the scalar kernels");
+    const size_t n = 100000 + 7;
+    const Matrix4 affine(0.36f, 0.48f, -0.8f, 0, -0.8f, 0.6f, 0, 0, 0.48f, 0.64f, 0.6f, 0, 1.5f, -2, 30, 1);
+    const std::vector<Vector3> points = makePoints(n);
+    const std::vector<Matrix4> matrices = makeMatrices(n);
+    std::vector<Vector3> refOut(n);
+    std::vector<Matrix4> refInv(n);
+    Vector3 refMin, refMax;
+    transformPoints(affine, points.data(), n, refOut.data());
+    computeBounds(points.data(), n, refMin, refMax);
+    invertMatrices(matrices.data(), n, refInv.data());
+
+    for (int level = ISA_SCALAR; level < ISA_COUNT; ++level) {
+        const ISALEVEL l = static_cast<ISALEVEL>(level);
+        if (!setISA(l)) continue;
+        check((getISA() == l) && (getBatchKernels().isa == l), std::string(getISAName(l)) + ": setISA() selects it");
+        testKernels(ref, getBatchKernels(), getISAName(l));
+        testDispatch(getISAName(l), refOut, refMin, refMax, refInv, affine);
+    }
+    setISA(isa);
+    return failures;
+}
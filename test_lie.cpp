@@ -0,0 +1,252 @@
+#include "mylie.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/** @brief double build, where the finite differences are checked to 1e-7. */
+static const bool DOUBLE = sizeof(scalar) == sizeof(double);
+/** @brief central difference step. */
+static const scalar STEP = static_cast<scalar>(DOUBLE ? 1e-5 : 1e-2);
+/** @brief tolerance of the finite differences. */
+static const double DIFF_TOLERANCE = DOUBLE ? 1e-7 : 2e-3;
+/** @brief tolerance of closed forms against double references. */
+static const double TOLERANCE = DOUBLE ? 1e-14 : 2e-6;
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief random direction times angle. */
+static Vector3 rotationVector(uint64_t& s, double angle) {
+    const Vector3 axis = Vector3(uniform(s), uniform(s), uniform(s)).normalized();
+    return axis * static_cast<scalar>(angle);
+}
+
+static VectorN<6> tangent(const Vector3& rho, const Vector3& phi) {
+    const scalar v[6] = {rho.x, rho.y, rho.z, phi.x, phi.y, phi.z};
+    return VectorN<6>(v);
+}
+
+static VectorN<3> toN(const Vector3& v) {
+    const scalar a[3] = {v.x, v.y, v.z};
+    return VectorN<3>(a);
+}
+
+/** @brief largest element difference of two column major arrays. */
+static double maxDiff(const scalar* a, const scalar* b, int n) {
+    double d = 0;
+    for (int i = 0; i < n; ++i) d = std::max(d, std::abs(static_cast<double>(a[i]) - b[i]));
+    return d;
+}
+
+/** @brief central differences of f at 0, column k is (f(h e_k) - f(-h e_k)) / 2h. */
+template <int N, typename F>
+static MatrixN<N, N> numericJacobian(F f) {
+    MatrixN<N, N> ret;
+    for (int k = 0; k < N; ++k) {
+        VectorN<N> d;
+        d.data()[k] = STEP;
+        const VectorN<N> fp = f(d), fm = f(-d);
+        for (int i = 0; i < N; ++i) {
+            ret(i, k) = static_cast<scalar>((static_cast<double>(fp[i]) - fm[i]) / (2 * static_cast<double>(STEP)));
+        }
+    }
+    return ret;
+}
+
+/** @brief exp of an n x n column major matrix by its power series in double. */
+static void seriesExp(const double* a, int n, double* out) {
+    double term[16], next[16];
+    for (int i = 0; i < n * n; ++i) out[i] = term[i] = (i % (n + 1) == 0) ? 1 : 0;
+    for (int k = 1; k < 60; ++k) {
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                double s = 0;
+                for (int l = 0; l < n; ++l) s += term[l * n + i] * a[j * n + l];
+                next[j * n + i] = s / k;
+            }
+        }
+        for (int i = 0; i < n * n; ++i) out[i] += (term[i] = next[i]);
+    }
+}
+
+/** @brief hat(w) in double, column major. */
+static void hatDouble(const Vector3& w, int n, double* m) {
+    m[0] = 0, m[1] = w.z, m[2] = -w.y;
+    m[n] = -w.z, m[n + 1] = 0, m[n + 2] = w.x;
+    m[2 * n] = w.y, m[2 * n + 1] = -w.x, m[2 * n + 2] = 0;
+}
+
+/** @brief rotation angles of the Jacobian checks, Taylor branch included. */
+static const double ANGLES[] = {1e-3, 0.05, 0.099, 0.101, 0.5, 1.5, 2.5, 2.9};
+
+/** @brief SO3 exp against the power series and d/ds exp(s w) = hat(w) exp(s w). */
+static void testSO3Exp() {
+    uint64_t s = 1;
+    double series = 0, ode = 0, orthogonal = 0;
+    for (double angle : ANGLES) {
+        const Vector3 w = rotationVector(s, angle);
+        double a[9], e[9];
+        hatDouble(w, 3, a);
+        seriesExp(a, 3, e);
+        const Matrix3 R = SO3::exp(w).matrix();
+        for (int i = 0; i < 9; ++i) series = std::max(series, std::abs(R[i] - e[i]));
+        const Matrix3 d = (SO3::exp(w * (1 + STEP)).matrix() - SO3::exp(w * (1 - STEP)).matrix()) * (1 / (2 * STEP));
+        ode = std::max(ode, maxDiff(d.constData(), SO3::hat(w).matmul(R).constData(), 9));
+        orthogonal = std::max(orthogonal, maxDiff(R.transposed().matmul(R).constData(), Matrix3::identity().constData(), 9));
+    }
+    check(series < TOLERANCE, "SO3::exp matches the power series");
+    check(ode < DIFF_TOLERANCE * 10, "SO3::exp solves d/ds exp(s w) = hat(w) exp(s w)");
+    check(orthogonal < TOLERANCE, "SO3::exp is orthogonal");
+}
+
+/** @brief SO3 Jacobians and their inverses against central differences of exp and log. */
+static void testSO3Jacobians() {
+    uint64_t s = 2;
+    double left = 0, right = 0, leftInv = 0, rightInv = 0, adjoint = 0, products = 0;
+    for (double angle : ANGLES) {
+        const Vector3 w = rotationVector(s, angle);
+        const SO3 R = SO3::exp(w);
+        auto vec = [](const SO3& r) { return toN(r.log()); };
+        const auto diffLeft = numericJacobian<3>([&](const VectorN<3>& d) {
+            return vec(SO3::exp(w + Vector3(d[0], d[1], d[2])) * R.inverse());
+        });
+        const auto diffRight = numericJacobian<3>([&](const VectorN<3>& d) {
+            return vec(R.inverse() * SO3::exp(w + Vector3(d[0], d[1], d[2])));
+        });
+        // log(exp(d) R) ~ log(R) + J_l^{-1} d
+        const auto diffLeftInv = numericJacobian<3>([&](const VectorN<3>& d) {
+            return vec(SO3::exp(Vector3(d[0], d[1], d[2])) * R);
+        });
+        const auto diffRightInv = numericJacobian<3>([&](const VectorN<3>& d) {
+            return vec(R * SO3::exp(Vector3(d[0], d[1], d[2])));
+        });
+        const auto diffAdjoint = numericJacobian<3>([&](const VectorN<3>& d) {
+            return vec(R * SO3::exp(Vector3(d[0], d[1], d[2])) * R.inverse());
+        });
+        left = std::max(left, maxDiff(SO3::leftJacobian(w).constData(), diffLeft.constData(), 9));
+        right = std::max(right, maxDiff(SO3::rightJacobian(w).constData(), diffRight.constData(), 9));
+        leftInv = std::max(leftInv, maxDiff(SO3::leftJacobianInverse(w).constData(), diffLeftInv.constData(), 9));
+        rightInv = std::max(rightInv, maxDiff(SO3::rightJacobianInverse(w).constData(), diffRightInv.constData(), 9));
+        adjoint = std::max(adjoint, maxDiff(R.adjoint().constData(), diffAdjoint.constData(), 9));
+        const Matrix3 I = Matrix3::identity();
+        products = std::max(products, maxDiff(SO3::leftJacobian(w).matmul(SO3::leftJacobianInverse(w)).constData(), I.constData(), 9));
+        products = std::max(products, maxDiff(SO3::rightJacobian(w).matmul(SO3::rightJacobianInverse(w)).constData(), I.constData(), 9));
+        products = std::max(products, maxDiff(SO3::rightJacobian(w).constData(), SO3::leftJacobian(-w).constData(), 9));
+    }
+    check(left < DIFF_TOLERANCE, "SO3::leftJacobian matches central differences");
+    check(right < DIFF_TOLERANCE, "SO3::rightJacobian matches central differences");
+    check(leftInv < DIFF_TOLERANCE, "SO3::leftJacobianInverse matches central differences of log");
+    check(rightInv < DIFF_TOLERANCE, "SO3::rightJacobianInverse matches central differences of log");
+    check(adjoint < DIFF_TOLERANCE, "SO3::adjoint matches central differences");
+    check(products < TOLERANCE * 10, "Jacobians times their inverses are the identity, J_r(w) = J_l(-w)");
+}
+
+/** @brief SE3 exp against the power series of the 4x4 twist. */
+static void testSE3Exp() {
+    uint64_t s = 3;
+    double series = 0;
+    for (double angle : ANGLES) {
+        const Vector3 phi = rotationVector(s, angle);
+        const Vector3 rho(2 * uniform(s), 2 * uniform(s), 2 * uniform(s));
+        double a[16] = {0}, e[16];
+        hatDouble(phi, 4, a);
+        a[12] = rho.x, a[13] = rho.y, a[14] = rho.z;
+        seriesExp(a, 4, e);
+        const Matrix4 T = SE3::exp(tangent(rho, phi)).matrix();
+        for (int i = 0; i < 16; ++i) series = std::max(series, std::abs(T[i] - e[i]));
+    }
+    check(series < TOLERANCE * 4, "SE3::exp matches the power series");
+}
+
+/** @brief SE3 Jacobians, their inverses and the adjoint against central differences. */
+static void testSE3Jacobians() {
+    uint64_t s = 4;
+    double left = 0, right = 0, leftInv = 0, rightInv = 0, adjoint = 0, applied = 0, products = 0;
+    for (double angle : ANGLES) {
+        const Vector3 phi = rotationVector(s, angle);
+        const Vector3 rho(2 * uniform(s), 2 * uniform(s), 2 * uniform(s));
+        const VectorN<6> xi = tangent(rho, phi);
+        const SE3 T = SE3::exp(xi);
+        // the upper right block of the left Jacobian is Barfoot's Q
+        const auto diffLeft = numericJacobian<6>([&](const VectorN<6>& d) { return (SE3::exp(xi + d) * T.inverse()).log(); });
+        const auto diffRight = numericJacobian<6>([&](const VectorN<6>& d) { return (T.inverse() * SE3::exp(xi + d)).log(); });
+        const auto diffLeftInv = numericJacobian<6>([&](const VectorN<6>& d) { return (SE3::exp(d) * T).log(); });
+        const auto diffRightInv = numericJacobian<6>([&](const VectorN<6>& d) { return (T * SE3::exp(d)).log(); });
+        const auto diffAdjoint = numericJacobian<6>([&](const VectorN<6>& d) { return (T * SE3::exp(d) * T.inverse()).log(); });
+        left = std::max(left, maxDiff(SE3::leftJacobian(xi).constData(), diffLeft.constData(), 36));
+        right = std::max(right, maxDiff(SE3::rightJacobian(xi).constData(), diffRight.constData(), 36));
+        leftInv = std::max(leftInv, maxDiff(SE3::leftJacobianInverse(xi).constData(), diffLeftInv.constData(), 36));
+        rightInv = std::max(rightInv, maxDiff(SE3::rightJacobianInverse(xi).constData(), diffRightInv.constData(), 36));
+        adjoint = std::max(adjoint, maxDiff(T.adjoint().constData(), diffAdjoint.constData(), 36));
+        const VectorN<6> v = tangent(Vector3(uniform(s), uniform(s), uniform(s)), Vector3(uniform(s), uniform(s), uniform(s)));
+        applied = std::max(applied, maxDiff(T.adjoint(v).constData(), T.adjoint().matmul(v).constData(), 6));
+        const MatrixN<6, 6> I = MatrixN<6, 6>::identity();
+        products = std::max(products, maxDiff(SE3::leftJacobian(xi).matmul(SE3::leftJacobianInverse(xi)).constData(), I.constData(), 36));
+        products = std::max(products, maxDiff(SE3::rightJacobian(xi).matmul(SE3::rightJacobianInverse(xi)).constData(), I.constData(), 36));
+    }
+    check(left < DIFF_TOLERANCE, "SE3::leftJacobian and Q match central differences");
+    check(right < DIFF_TOLERANCE, "SE3::rightJacobian matches central differences");
+    check(leftInv < DIFF_TOLERANCE, "SE3::leftJacobianInverse matches central differences of log");
+    check(rightInv < DIFF_TOLERANCE, "SE3::rightJacobianInverse matches central differences of log");
+    check(adjoint < DIFF_TOLERANCE, "SE3::adjoint matches central differences");
+    check(applied < TOLERANCE * 10, "SE3::adjoint(xi) applies the adjoint matrix");
+    check(products < TOLERANCE * 100, "SE3 Jacobians times their inverses are the identity");
+}
+
+/** @brief log(exp(w)) = w for tiny angles, across the Taylor switch and up to pi. */
+static void testLogRoundTrips() {
+    uint64_t s = 5;
+    const double eps = std::numeric_limits<scalar>::epsilon();
+    double small = 0;
+    for (double angle : {1e-12, 1e-8, 1e-5, 1e-3, 0.0999, 0.1001, 0.7}) {
+        for (int k = 0; k < 8; ++k) {
+            const Vector3 w = rotationVector(s, angle);
+            small = std::max(small, (SO3::exp(w).log() - w).length() / angle);
+            const VectorN<6> xi = tangent(Vector3(uniform(s), uniform(s), uniform(s)), w);
+            small = std::max(small, maxDiff(SE3::exp(xi).log().constData(), xi.constData(), 6));
+        }
+    }
+    check(small < 8 * eps, "log(exp(w)) for small angles, relative");
+
+    // every component dominant once, signs mixed, pi - 10^-k up to the precision of the angle
+    const Vector3 axes[] = {Vector3(0.9f, 0.3f, -0.2f), Vector3(-0.1f, -0.95f, 0.3f), Vector3(0.2f, -0.4f, -0.9f),
+                            Vector3(1, 1, 1), Vector3(-1, 0, 0)};
+    double nearPi = 0, rotation = 0, range = 0;
+    for (const Vector3& a : axes) {
+        const Vector3 axis = a.normalized();
+        for (int k = 1; k <= (DOUBLE ? 7 : 3); ++k) {
+            const double angle = M_PI - std::pow(10.0, -k);
+            const Vector3 w = axis * static_cast<scalar>(angle);
+            const SO3 R = SO3::exp(w);
+            nearPi = std::max(nearPi, static_cast<double>((R.log() - w).length()) / angle);
+            rotation = std::max(rotation, maxDiff(SO3::exp(R.log()).matrix().constData(), R.matrix().constData(), 9));
+            const VectorN<6> xi = tangent(Vector3(0.5f, -1, 2), w);
+            rotation = std::max(rotation, maxDiff(SE3::exp(SE3::exp(xi).log()).matrix().constData(),
+                                                  SE3::exp(xi).matrix().constData(), 16));
+        }
+        // a half turn, w and -w are the same rotation
+        const SO3 R = SO3::rotation(axis, static_cast<scalar>(M_PI));
+        const Vector3 w = R.log();
+        rotation = std::max(rotation, maxDiff(SO3::exp(w).matrix().constData(), R.matrix().constData(), 9));
+        const Vector3 half = axis * static_cast<scalar>(M_PI);
+        range = std::max(range, static_cast<double>(std::min((w - half).length(), (w + half).length())) / M_PI);
+    }
+    check(nearPi < 10 * eps, "log(exp(w)) near pi");
+    check(rotation < 10 * eps, "exp(log(R)) = R near pi");
+    check(range < 10 * eps, "log of a half turn is pi times the axis, either sign");
+}
+
+int main() {
+    testSO3Exp();
+    testSO3Jacobians();
+    testSE3Exp();
+    testSE3Jacobians();
+    testLogRoundTrips();
+    return failures;
+}
@@ -1,4 +1,15 @@
+#include "mybatch.hpp"
 #include "mymatrix.hpp"
+#include "myinstrument.hpp"
+#include "myparallel.hpp"
+#include "test_check.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
@@ -6,6 +17,255 @@
 using std::cout;
 using std::endl;
 
+/** @brief inverses that read the rotation block must use m[6], not m[5] twice. */
+static void testInverses() {
+    Matrix4 r;
+    r.rotate(30, Vector3(1.f, 2.f, 3.f));
+    check(r.matmul(r.computeRotationInverse()).equal(Matrix4(), 1e-5f), "computeRotationInverse");
+    Matrix4 e = r;
+    e.translate(1.f, -2.f, 0.5f);
+    check(e.matmul(e.computeEuclideanInverse()).equal(Matrix4(), 1e-5f), "computeEuclideanInverse");
+}
+
+/** @brief the affine and projective predicates accept invertible blocks and reject singular ones. */
+static void testPredicates() {
+    Matrix4 a;
+    a.rotate(40, Vector3(0.f, 1.f, 1.f));
+    a.scale(2.f, 0.5f, 3.f);
+    a.translate(4.f, 5.f, -6.f);
+    check(a.isAffineMatrix(), "isAffineMatrix of an invertible affine matrix");
+    check(a.matmul(a.computeAffineInverse()).equal(Matrix4(), 1e-5f), "computeAffineInverse");
+    Matrix4 flat = a;
+    flat.scale(1.f, 0.f, 1.f);
+    check(!flat.isAffineMatrix(), "isAffineMatrix of a singular linear part");
+
+    // upper left 2x2 block A invertible, D - C * A^-1 * B invertible
+    Matrix4 p(2.f, 0.f, 0.f, 0.f,
+              0.f, 3.f, 0.f, 0.f,
+              0.5f, 0.25f, -1.2f, -1.f,
+              0.f, 0.f, -2.2f, 0.f);
+    check(p.isPeojectiveMatrix(), "isPeojectiveMatrix of an invertible A block");
+    check(p.matmul(p.computeProjectiveInverse()).equal(Matrix4(), 1e-5f), "computeProjectiveInverse");
+    Matrix4 q(0.f, 0.f, 0.f, 0.f,
+              0.f, 3.f, 0.f, 0.f,
+              0.f, 0.f, 1.f, 0.f,
+              0.f, 0.f, 0.f, 1.f);
+    check(!q.isPeojectiveMatrix(), "isPeojectiveMatrix of a singular A block");
+    Matrix4 s(1.f, 0.f, 0.f, 0.f,
+              0.f, 1.f, 0.f, 0.f,
+              0.f, 0.f, 1.f, 1.f,
+              0.f, 0.f, 1.f, 1.f);
+    bool thrown = false;
+    try {
+        s.computeProjectiveInverse();
+    } catch (const char*) {
+        thrown = true;
+    }
+    check(thrown, "computeProjectiveInverse of a singular D - C * A^-1 * B");
+}
+
+/** @brief true if setLookAt() rejects its arguments. */
+static bool lookAtThrows(const Vector3& eye, const Vector3& target, const Vector3& up) {
+    Matrix4 v;
+    try {
+        v.setLookAt(eye, target, up);
+    } catch (const char*) {
+        return true;
+    }
+    return false;
+}
+
+/** @brief setLookAt() maps eye to the origin and target onto -z, degenerate views throw. */
+static void testLookAt() {
+    const Vector3 eye(1.f, 2.f, 3.f), target(4.f, -2.f, 3.f);
+    Matrix4 v;
+    v.setLookAt(eye, target, Vector3(0.f, 0.f, 1.f));
+    check(v.isEuclideanMatrix(), "setLookAt is euclidean");
+    const Vector4 e = v * Vector4(eye.x, eye.y, eye.z, 1.f);
+    const Vector4 t = v * Vector4(target.x, target.y, target.z, 1.f);
+    check(e.equal(Vector4(0.f, 0.f, 0.f, 1.f), 1e-5f) && t.equal(Vector4(0.f, 0.f, -5.f, 1.f), 1e-5f), "setLookAt axes");
+    check(lookAtThrows(eye, eye, Vector3(0.f, 0.f, 1.f)), "setLookAt with eye == target");
+    check(lookAtThrows(eye, target, Vector3(-3.f, 4.f, 0.f)), "setLookAt with up parallel to the view");
+    check(lookAtThrows(eye, target, Vector3(3.f, -4.f, 1e-3f)), "setLookAt with up nearly parallel to the view");
+    check(lookAtThrows(eye, target, Vector3(0.f, 0.f, 0.f)), "setLookAt with zero up");
+    check(!lookAtThrows(eye, target, Vector3(3.f, -4.f, 0.1f)), "setLookAt with up at 0.02 rad");
+}
+
+/** @brief the composition of the header example folds at compile time, MYMATH_INSTRUMENT counts only run time products. */
+static void testConstexprMatmul() {
+    constexpr Matrix4 t = Matrix4::translation(0, 0, 1.2f).matmul(Matrix4::scaling(0.001f));
+    check((t[0] == 0.001f) && (t[10] == 0.001f) && (t[14] == 1.2f) && (t[15] == 1), "constexpr matmul");
+    resetInstrumentCounters();
+    Matrix4 r;
+    r.rotate(10, Vector3(0.f, 0.f, 1.f));
+    const Matrix4 product = t.matmul(r);
+    check(product.equal(t.matmul(r)), "run time matmul");
+#if defined(MYMATH_INSTRUMENT) && defined(MYMATH_IS_CONSTANT_EVALUATED)
+    // rotate() multiplies once, then the two products above
+    check(getInstrumentSnapshot().operations[INSTR_MATRIX4_MATMUL].calls == 3, "run time matmul count");
+#endif
+}
+
+/** @brief normalized device coordinates of a view space point. */
+static Vector3 toNdc(const Matrix4& projection, scalar x, scalar y, scalar z) {
+    const Vector4 c = projection * Vector4(x, y, z, 1.f);
+    return Vector3(c.x / c.w, c.y / c.w, c.z / c.w);
+}
+
+/** @brief true if a projection builder rejects its arguments. */
+template <typename Build>
+static bool projectionThrows(Build build) {
+    Matrix4 p;
+    try {
+        build(p);
+    } catch (const char*) {
+        return true;
+    }
+    return false;
+}
+
+/** @brief the corners of the view volume land on the corners of the clip volume. */
+static void testProjections() {
+    // asymmetric frustum, far corners are the near corners scaled by f / n
+    const scalar l = -0.3f, r = 0.5f, b = -0.2f, t = 0.4f, n = 0.5f, f = 40.f;
+    Matrix4 p;
+    p.setFrustum(l, r, b, t, n, f);
+    check(toNdc(p, l, b, -n).equal(Vector3(-1.f, -1.f, -1.f), 1e-5f) && toNdc(p, r, t, -n).equal(Vector3(1.f, 1.f, -1.f), 1e-5f),
+          "setFrustum maps the near corners to z = -1");
+    check(toNdc(p, l * f / n, b * f / n, -f).equal(Vector3(-1.f, -1.f, 1.f), 1e-4f) &&
+          toNdc(p, r * f / n, t * f / n, -f).equal(Vector3(1.f, 1.f, 1.f), 1e-4f), "setFrustum maps the far corners to z = 1");
+    check(p.matmul(p.computePerspectiveInverse()).equal(Matrix4(), 1e-5f) &&
+          p.computePerspectiveInverse().matmul(p).equal(Matrix4(), 1e-5f), "computePerspectiveInverse of setFrustum");
+
+    // 60 degrees vertical, the top edge of the near plane is at n * tan(30)
+    const scalar aspect = 1.5f, h = std::tan(static_cast<scalar>(M_PI / 6));
+    for (ANGLEUNIT unit : {DEG, RAD}) {
+        const std::string name = (unit == DEG) ? "setPerspective in degrees" : "setPerspective in radians";
+        p.setPerspective((unit == DEG) ? 60.f : static_cast<scalar>(M_PI / 3), aspect, n, f, unit);
+        check(toNdc(p, 0, n * h, -n).equal(Vector3(0.f, 1.f, -1.f), 1e-5f) &&
+              toNdc(p, -aspect * n * h, 0, -n).equal(Vector3(-1.f, 0.f, -1.f), 1e-5f), name + " near plane");
+        check(toNdc(p, aspect * f * h, -f * h, -f).equal(Vector3(1.f, -1.f, 1.f), 1e-4f), name + " far plane");
+        check(p.matmul(p.computePerspectiveInverse()).equal(Matrix4(), 1e-5f), "computePerspectiveInverse of " + name);
+    }
+
+    // depth goes from -1 at the near plane to 1 at infinity
+    p.setInfinitePerspective(60.f, aspect, n);
+    check(toNdc(p, aspect * n * h, n * h, -n).equal(Vector3(1.f, 1.f, -1.f), 1e-5f), "setInfinitePerspective near plane");
+    const scalar farDepth = toNdc(p, 0, 0, -1e6f).z;
+    check((farDepth < 1) && (farDepth > 1 - 1e-5f) && (toNdc(p, 0, 0, -2 * n).z == 0),
+          "setInfinitePerspective depth tends to 1, 0 at twice the near distance");
+    check(p.matmul(p.computePerspectiveInverse()).equal(Matrix4(), 1e-5f), "computePerspectiveInverse of setInfinitePerspective");
+
+    // near plane at depth 1 and far plane at depth 0
+    p.setReversedZPerspective(60.f, aspect, n, f);
+    check(toNdc(p, -aspect * n * h, -n * h, -n).equal(Vector3(-1.f, -1.f, 1.f), 1e-5f) &&
+          toNdc(p, aspect * f * h, f * h, -f).equal(Vector3(1.f, 1.f, 0.f), 1e-5f), "setReversedZPerspective near and far planes");
+    check(p.matmul(p.computePerspectiveInverse()).equal(Matrix4(), 1e-5f), "computePerspectiveInverse of setReversedZPerspective");
+    p.setReversedZPerspective(60.f, aspect, n, std::numeric_limits<scalar>::infinity());
+    check((toNdc(p, 0, 0, -n).z == 1) && (toNdc(p, 0, 0, -1e6f).z > 0) && (toNdc(p, 0, 0, -1e6f).z < 1e-6f),
+          "setReversedZPerspective with an infinite far plane");
+    check(p.matmul(p.computePerspectiveInverse()).equal(Matrix4(), 1e-5f), "computePerspectiveInverse of an infinite reversed Z");
+
+    p.setOrthographic(l, r, b, t, n, f);
+    check(toNdc(p, l, b, -n).equal(Vector3(-1.f, -1.f, -1.f), 1e-5f) && toNdc(p, r, t, -f).equal(Vector3(1.f, 1.f, 1.f), 1e-5f),
+          "setOrthographic maps the box corners");
+    check(p.matmul(p.computeOrthographicInverse()).equal(Matrix4(), 1e-5f) &&
+          p.computeOrthographicInverse().matmul(p).equal(Matrix4(), 1e-5f), "computeOrthographicInverse of setOrthographic");
+    check(projectionThrows([&](Matrix4& q) { q = p.computePerspectiveInverse(); }), "computePerspectiveInverse of an orthographic matrix");
+    p.setPerspective(60.f, aspect, n, f);
+    check(projectionThrows([&](Matrix4& q) { q = p.computeOrthographicInverse(); }), "computeOrthographicInverse of a perspective matrix");
+
+    check(projectionThrows([](Matrix4& q) { q.setPerspective(60.f, 1.f, 0.f, 10.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setPerspective(60.f, 1.f, -1.f, 10.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setPerspective(60.f, 1.f, 1.f, 0.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setPerspective(60.f, 1.f, 1.f, -10.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setPerspective(60.f, 1.f, 1.f, 1.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setPerspective(0.f, 1.f, 1.f, 10.f); }), "setPerspective rejects near and far <= 0");
+    check(projectionThrows([](Matrix4& q) { q.setInfinitePerspective(60.f, 1.f, 0.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setReversedZPerspective(60.f, 1.f, 0.f, 10.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setReversedZPerspective(60.f, 1.f, 2.f, 2.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setFrustum(1.f, 1.f, -1.f, 1.f, 1.f, 10.f); }) &&
+          projectionThrows([](Matrix4& q) { q.setOrthographic(-1.f, 1.f, -1.f, 1.f, 3.f, 3.f); }), "degenerate projections throw");
+}
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief projectPoints() and projectToPixels() match the per-point matrix product for any thread count. */
+static void testBatchProjection() {
+    Matrix4 projection, view;
+    projection.setPerspective(70.f, 4.f / 3, 0.1f, 50.f);
+    view.setLookAt(Vector3(0.5f, -0.3f, 4.f), Vector3(0.f, 0.2f, 0.f), Vector3(0.f, 1.f, 0.f));
+    const Matrix4 vp = projection.matmul(view);
+    // more than one parallel block, a tenth behind the camera
+    const size_t n = 40000 + 7;
+    std::vector<Vector3> points(n);
+    uint64_t seed = 3;
+    for (size_t i = 0; i < n; ++i) {
+        points[i] = Vector3(3 * uniform(seed), 3 * uniform(seed), 3 * uniform(seed));
+        if (i % 10 == 4) points[i].z = 4.5f + uniform(seed);
+    }
+    std::vector<Vector3> expected(n);
+    std::vector<char> inFront(n);
+    size_t front = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Vector4 c = vp * Vector4(points[i].x, points[i].y, points[i].z, 1.f);
+        inFront[i] = (c.w > 0);
+        front += inFront[i];
+        expected[i] = Vector3(c.x / c.w, c.y / c.w, c.z / c.w);
+    }
+    check((front > n / 2) && (front < n), "projected points in front of and behind the camera");
+
+    const unsigned int threads = getThreadCount();
+    const scalar width = 640, height = 480;
+    std::vector<Vector3> first;
+    for (unsigned int t : {1u, 4u}) {
+        setThreadCount(t);
+        const std::string what = std::to_string(t) + " threads";
+        std::vector<Vector3> ndc(n);
+        check(projectPoints(vp, points.data(), n, ndc.data()) == front, "projectPoints count, " + what);
+        bool same = true;
+        for (size_t i = 0; i < n; ++i) {
+            same &= inFront[i] ? ndc[i].equal(expected[i], 1e-4f)
+                               : (std::isnan(ndc[i].x) && std::isnan(ndc[i].y) && std::isnan(ndc[i].z));
+        }
+        check(same, "projectPoints matches the matrix product, " + what);
+        if (first.empty()) first = ndc;
+        check(std::memcmp(first.data(), ndc.data(), n * sizeof(Vector3)) == 0, "projectPoints bitwise for any thread count");
+
+        // in place
+        std::vector<Vector3> inPlace = points;
+        projectPoints(vp, inPlace.data(), n, inPlace.data());
+        check(std::memcmp(inPlace.data(), ndc.data(), n * sizeof(Vector3)) == 0, "projectPoints in place, " + what);
+
+        // fused projection is projectPoints() then ndcToPixels()
+        std::vector<Vector2> pixels(n), separate(n);
+        std::vector<scalar> depth(n);
+        ndcToPixels(ndc.data(), n, width, height, separate.data());
+        check(projectToPixels(vp, points.data(), n, width, height, pixels.data(), depth.data()) == front,
+              "projectToPixels count, " + what);
+        bool fused = true;
+        for (size_t i = 0; i < n; ++i) {
+            if (std::isnan(ndc[i].x)) {
+                fused &= std::isnan(pixels[i].x) && std::isnan(pixels[i].y) && std::isnan(depth[i]);
+            } else {
+                fused &= (pixels[i] == separate[i]) && (depth[i] == ndc[i].z) &&
+                         (std::abs(pixels[i].x - (ndc[i].x + 1) * width / 2) < 1e-3f) &&
+                         (std::abs(pixels[i].y - (1 - ndc[i].y) * height / 2) < 1e-3f);
+            }
+        }
+        check(fused, "projectToPixels matches projectPoints and ndcToPixels, " + what);
+        std::vector<Vector2> noDepth(n);
+        check((projectToPixels(vp, points.data(), n, width, height, noDepth.data()) == front) &&
+              (std::memcmp(noDepth.data(), pixels.data(), n * sizeof(Vector2)) == 0), "projectToPixels without depth, " + what);
+    }
+    setThreadCount(threads);
+    check(projectPoints(vp, points.data(), 0, nullptr) == 0, "projectPoints of no point");
+}
+
 int main() {
     scalar data[]{0.f, 1.f, 2.f, 3.f,
                   4.f, 5.f, 6.f, 7.f,
@@ -371,5 +631,11 @@ int main() {
     printf("mm data: %p\n", mm.data());
 */
 
-    return 0;
+    testInverses();
+    testPredicates();
+    testConstexprMatmul();
+    testLookAt();
+    testProjections();
+    testBatchProjection();
+    return failures;
 }
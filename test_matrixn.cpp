@@ -0,0 +1,217 @@
+#include "mymatrixn.hpp"
+#include "test_check.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+template <int R, int C>
+static MatrixN<R, C> randomMatrix(uint64_t& s) {
+    MatrixN<R, C> a;
+    for (int i = 0; i < R * C; ++i) a.data()[i] = uniform(s);
+    return a;
+}
+
+/** @brief largest difference to a double product of a^T (transposeA) or a with b. */
+template <int R, int C, int RB, int K>
+static double productError(const MatrixN<R, C>& a, const MatrixN<RB, K>& b, bool transposeA, const scalar* product) {
+    const int rows = transposeA ? C : R, inner = transposeA ? R : C;
+    double error = 0;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < K; ++j) {
+            double s = 0;
+            for (int k = 0; k < inner; ++k) s += static_cast<double>(transposeA ? a(k, i) : a(i, k)) * b(k, j);
+            error = std::max(error, std::abs(s - product[j * rows + i]));
+        }
+    }
+    return error;
+}
+
+/** @brief products against the double triple loop, transposed() against operator(). */
+static void testProducts() {
+    uint64_t s = 1;
+    const MatrixN<3, 6> j = randomMatrix<3, 6>(s);
+    const MatrixN<6, 4> b = randomMatrix<6, 4>(s);
+    const MatrixN<3, 1> r = randomMatrix<3, 1>(s);
+    const MatrixN<3, 4> jb = j.matmul(b);
+    check(productError(j, b, false, jb.constData()) < 1e-5, "matmul 3x6 * 6x4");
+    const MatrixN<6, 6> h = j.transposeMatmul(j);
+    check(productError(j, j, true, h.constData()) < 1e-5, "transposeMatmul J^T J");
+    const VectorN<6> g = j.transposeMatmul(r);
+    check(productError(j, r, true, g.constData()) < 1e-5, "transposeMatmul J^T r");
+    check(h.equal(j.transposed().matmul(j), 1e-5f) && g.equal(j.transposed().matmul(r), 1e-5f),
+          "transposeMatmul equals transposed().matmul()");
+    const MatrixN<6, 6> sq = h.matmul(h);
+    check(productError(h, h, false, sq.constData()) < 1e-4, "matmul 6x6 * 6x6");
+
+    const MatrixN<6, 3> jt = j.transposed();
+    bool layout = true;
+    for (int i = 0; i < 3; ++i) {
+        for (int k = 0; k < 6; ++k) layout &= (jt(k, i) == j(i, k)) && (jt[i * 6 + k] == j[k * 3 + i]);
+    }
+    check(layout, "transposed() swaps rows and columns");
+    check(jt.transposed().equal(j, 0) && (MatrixN<6, 6>::identity().matmul(jt).equal(jt, 0)), "transposing twice, identity product");
+    check((g.dot(g) > 0) && (std::abs(g.norm() * g.norm() - g.dot(g)) < 1e-4f * g.dot(g)), "dot() and norm()");
+
+    int thrown = 0;
+    MatrixN<3, 6> a = j;
+    for (int index : {-1, 18}) {
+        try {
+            a[index] = 0;
+        } catch (const char*) {
+            ++thrown;
+        }
+    }
+    try {
+        a(3, 0) = 0;
+    } catch (const char*) {
+        ++thrown;
+    }
+    try {
+        a(0, 6) = 0;
+    } catch (const char*) {
+        ++thrown;
+    }
+    check((thrown == 4) && a.equal(j, 0), "out of bounds elements throw");
+}
+
+/** @brief largest |A x - b| of every column, relative to |A| |x| + |b|. */
+template <int N, int K>
+static double residual(const MatrixN<N, N>& a, const MatrixN<N, K>& x, const MatrixN<N, K>& b) {
+    double error = 0;
+    for (int c = 0; c < K; ++c) {
+        for (int i = 0; i < N; ++i) {
+            double s = -static_cast<double>(b(i, c)), size = std::abs(b(i, c));
+            for (int k = 0; k < N; ++k) {
+                s += static_cast<double>(a(i, k)) * x(k, c);
+                size += std::abs(static_cast<double>(a(i, k)) * x(k, c));
+            }
+            error = std::max(error, std::abs(s) / size);
+        }
+    }
+    return error;
+}
+
+/** @brief copy of a with garbage above the diagonal, which the solvers must not read. */
+template <int N>
+static MatrixN<N, N> lowerOnly(const MatrixN<N, N>& a) {
+    MatrixN<N, N> ret = a;
+    for (int j = 1; j < N; ++j) {
+        for (int i = 0; i < j; ++i) ret(i, j) = std::numeric_limits<scalar>::quiet_NaN();
+    }
+    return ret;
+}
+
+/** @brief Cholesky and LDLT solve a symmetric positive definite 6x6 system. */
+static void testPositiveDefinite() {
+    uint64_t s = 2;
+    const MatrixN<8, 6> j = randomMatrix<8, 6>(s);
+    const MatrixN<6, 6> h = j.transposeMatmul(j) + MatrixN<6, 6>::identity() * 0.1f;
+    const VectorN<6> b = randomMatrix<6, 1>(s);
+    const MatrixN<6, 3> bs = randomMatrix<6, 3>(s);
+
+    CholeskyN<6> llt(lowerOnly(h));
+    check(llt.isValid(), "Cholesky of a positive definite matrix");
+    const MatrixN<6, 6>& l = llt.matrixL();
+    bool lower = true;
+    for (int c = 1; c < 6; ++c) {
+        for (int i = 0; i < c; ++i) lower &= (l(i, c) == 0);
+    }
+    check(lower && l.matmul(l.transposed()).equal(h, 1e-5f), "L is lower triangular, L L^T = A");
+    const VectorN<6> x = llt.solve(b);
+    check(residual(h, x, b) < 1e-5, "Cholesky solve, residual");
+    check(residual(h, llt.solve(bs), bs) < 1e-5, "Cholesky solve of three right hand sides");
+
+    LDLTN<6> ldlt(lowerOnly(h));
+    check(ldlt.isValid() && ldlt.isPositive(), "LDLT of a positive definite matrix has positive pivots");
+    const VectorN<6> y = ldlt.solve(b);
+    check(residual(h, y, b) < 1e-5, "LDLT solve, residual");
+    check(residual(h, ldlt.solve(bs), bs) < 1e-5, "LDLT solve of three right hand sides");
+    check(y.equal(x, 1e-3f * x.norm()), "Cholesky and LDLT agree");
+    // D is the square of the diagonal of L
+    bool pivots = true;
+    for (int i = 0; i < 6; ++i) pivots &= std::abs(ldlt.vectorD()[i] - l(i, i) * l(i, i)) < 1e-4f * l(i, i) * l(i, i);
+    check(pivots, "D is the squared diagonal of L");
+}
+
+/** @brief LDLT solves an indefinite 6x6 system built as L0 D0 L0^T, Cholesky refuses it. */
+static void testIndefinite() {
+    uint64_t s = 3;
+    MatrixN<6, 6> l0 = MatrixN<6, 6>::identity();
+    for (int c = 0; c < 6; ++c) {
+        for (int i = c + 1; i < 6; ++i) l0(i, c) = 0.5f * uniform(s);
+    }
+    const scalar d0[6] = {3, -2, 1.5f, -4, 2.5f, -1};
+    MatrixN<6, 6> ld = l0;
+    for (int c = 0; c < 6; ++c) {
+        for (int i = 0; i < 6; ++i) ld(i, c) *= d0[c];
+    }
+    const MatrixN<6, 6> a = ld.matmul(l0.transposed());
+    const MatrixN<6, 2> b = randomMatrix<6, 2>(s);
+
+    LDLTN<6> ldlt(lowerOnly(a));
+    check(ldlt.isValid() && !ldlt.isPositive(), "LDLT of an indefinite matrix is valid, not positive");
+    bool pivots = true;
+    for (int i = 0; i < 6; ++i) pivots &= std::abs(ldlt.vectorD()[i] - d0[i]) < 1e-4f;
+    check(pivots, "LDLT recovers D0");
+    check(residual(a, ldlt.solve(b), b) < 1e-5, "LDLT solve of an indefinite system");
+
+    CholeskyN<6> llt;
+    check(!llt.compute(a) && !llt.isValid(), "Cholesky of an indefinite matrix fails");
+}
+
+/** @brief true if solve() throws. */
+template <typename Solver>
+static bool solveThrows(const Solver& solver) {
+    try {
+        solver.solve(VectorN<6>());
+    } catch (const char*) {
+        return true;
+    }
+    return false;
+}
+
+/** @brief failed and missing decompositions report it and refuse to solve. */
+static void testFailures() {
+    check(!CholeskyN<6>().isValid() && solveThrows(CholeskyN<6>()), "default Cholesky refuses to solve");
+    check(!LDLTN<6>().isValid() && !LDLTN<6>().isPositive() && solveThrows(LDLTN<6>()), "default LDLT refuses to solve");
+
+    // two equal rows, the second pivot is exactly zero
+    MatrixN<6, 6> singular = MatrixN<6, 6>::identity();
+    singular(1, 0) = singular(0, 1) = 1;
+    LDLTN<6> ldlt;
+    check(!ldlt.compute(singular) && !ldlt.isValid() && !ldlt.isPositive() && solveThrows(ldlt),
+          "LDLT of a singular matrix fails");
+    CholeskyN<6> llt;
+    check(!llt.compute(singular) && solveThrows(llt), "Cholesky of a singular matrix fails");
+    // the second pivot is 4 epsilon, below the rounding level of the diagonal
+    MatrixN<6, 6> nearly = singular;
+    nearly(1, 1) += 4 * std::numeric_limits<scalar>::epsilon();
+    check(!ldlt.compute(nearly) && solveThrows(ldlt), "LDLT of a nearly singular matrix fails");
+    MatrixN<6, 6> nan = MatrixN<6, 6>::identity();
+    nan(3, 3) = std::numeric_limits<scalar>::quiet_NaN();
+    check(!llt.compute(nan) && !ldlt.compute(nan), "a NaN pivot fails");
+    check(!llt.compute(MatrixN<6, 6>()) && !ldlt.compute(MatrixN<6, 6>()), "the zero matrix fails");
+
+    // a later successful decomposition solves again
+    uint64_t s = 4;
+    const VectorN<6> v = randomMatrix<6, 1>(s);
+    const MatrixN<6, 6> id = MatrixN<6, 6>::identity() * 4;
+    check(llt.compute(id) && ldlt.compute(id) && llt.solve(v).equal(v * 0.25f, 0) && ldlt.solve(v).equal(v * 0.25f, 0),
+          "compute() after a failure");
+}
+
+int main() {
+    testProducts();
+    testPositiveDefinite();
+    testIndefinite();
+    testFailures();
+    return failures;
+}
@@ -0,0 +1,199 @@
+#include "mybatch.hpp"
+#include "mymorton.hpp"
+#include "myparallel.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/** @brief 64 random bits. */
+static uint64_t next(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return (s >> 32) | ((s * 0x9e3779b97f4a7c15ull) & 0xffffffff00000000ull);
+}
+
+/** @brief bit by bit interleaving, bit i of x goes to bit 3 * i. */
+static uint64_t naiveMorton(uint32_t x, uint32_t y, uint32_t z, int bits) {
+    uint64_t code = 0;
+    for (int i = 0; i < bits; ++i) {
+        code |= static_cast<uint64_t>((x >> i) & 1) << (3 * i);
+        code |= static_cast<uint64_t>((y >> i) & 1) << (3 * i + 1);
+        code |= static_cast<uint64_t>((z >> i) & 1) << (3 * i + 2);
+    }
+    return code;
+}
+
+static void testMorton() {
+    uint64_t s = 1;
+    bool same30 = true, same63 = true;
+    for (int k = 0; k < 20000; ++k) {
+        uint32_t x = static_cast<uint32_t>(next(s)), y = static_cast<uint32_t>(next(s)), z = static_cast<uint32_t>(next(s));
+        // the corners of the grid among the random coordinates
+        if (k < 8) {
+            x = (k & 1) ? ~0u : 0;
+            y = (k & 2) ? ~0u : 0;
+            z = (k & 4) ? ~0u : 0;
+        }
+        const uint32_t x10 = x & 0x3ff, y10 = y & 0x3ff, z10 = z & 0x3ff;
+        const uint32_t c30 = mortonEncode30(x, y, z);
+        uint32_t a, b, c;
+        mortonDecode30(c30, a, b, c);
+        same30 &= (c30 == naiveMorton(x10, y10, z10, 10)) && (a == x10) && (b == y10) && (c == z10);
+
+        const uint32_t x21 = x & 0x1fffff, y21 = y & 0x1fffff, z21 = z & 0x1fffff;
+        const uint64_t c63 = mortonEncode63(x21, y21, z21);
+        mortonDecode63(c63, a, b, c);
+        same63 &= (c63 == naiveMorton(x21, y21, z21, 21)) && (a == x21) && (b == y21) && (c == z21);
+    }
+    check(same30, "30-bit Morton code interleaves bits and decodes back");
+    check(same63, "63-bit Morton code interleaves bits and decodes back");
+}
+
+/** @brief on small grids the Hilbert index is a bijection and consecutive cells are face neighbors. */
+static void testHilbertExhaustive() {
+    for (int bits = 1; bits <= 4; ++bits) {
+        const uint32_t side = 1u << bits;
+        const size_t cells = static_cast<size_t>(side) * side * side;
+        std::vector<int> cell(cells, -1);
+        bool roundTrip = true, inRange = true;
+        for (uint32_t z = 0; z < side; ++z) {
+            for (uint32_t y = 0; y < side; ++y) {
+                for (uint32_t x = 0; x < side; ++x) {
+                    const uint64_t h = hilbertEncode(x, y, z, bits);
+                    uint32_t a, b, c;
+                    hilbertDecode(h, bits, a, b, c);
+                    roundTrip &= (a == x) && (b == y) && (c == z);
+                    inRange &= (h < cells) && (cell[h] < 0);
+                    if (h < cells) cell[h] = static_cast<int>((z * side + y) * side + x);
+                }
+            }
+        }
+        const std::string what = "Hilbert " + std::to_string(bits) + " bits";
+        check(roundTrip, what + ": decode(encode) round trip");
+        check(inRange, what + ": indices are distinct and below 2^(3 * bits)");
+        bool adjacent = true;
+        for (uint64_t h = 1; h < cells; ++h) {
+            uint32_t x0, y0, z0, x1, y1, z1;
+            hilbertDecode(h - 1, bits, x0, y0, z0);
+            hilbertDecode(h, bits, x1, y1, z1);
+            const int step = std::abs(static_cast<int>(x1) - static_cast<int>(x0)) +
+                             std::abs(static_cast<int>(y1) - static_cast<int>(y0)) +
+                             std::abs(static_cast<int>(z1) - static_cast<int>(z0));
+            adjacent &= (step == 1);
+        }
+        check(adjacent, what + ": consecutive indices are neighbor cells");
+    }
+}
+
+static void testHilbertRandom() {
+    uint64_t s = 2;
+    for (int bits : {5, 10, 16, 21}) {
+        const uint32_t mask = (1u << bits) - 1;
+        bool roundTrip = true, inverse = true;
+        for (int k = 0; k < 5000; ++k) {
+            const uint32_t x = static_cast<uint32_t>(next(s)) & mask;
+            const uint32_t y = static_cast<uint32_t>(next(s)) & mask;
+            const uint32_t z = static_cast<uint32_t>(next(s)) & mask;
+            uint32_t a, b, c;
+            hilbertDecode(hilbertEncode(x, y, z, bits), bits, a, b, c);
+            roundTrip &= (a == x) && (b == y) && (c == z);
+            // and the other way round, from a random index
+            const uint64_t h = next(s) & ((uint64_t(1) << (3 * bits)) - 1);
+            hilbertDecode(h, bits, a, b, c);
+            inverse &= (hilbertEncode(a, b, c, bits) == h);
+        }
+        const std::string what = "Hilbert " + std::to_string(bits) + " bits";
+        check(roundTrip, what + ": decode(encode) round trip");
+        check(inverse, what + ": encode(decode) round trip");
+    }
+}
+
+/** @brief radixSortByKey() gives the keys and the permutation of std::stable_sort(). */
+template <typename Key>
+static void checkRadixSort(std::vector<Key> keys, const std::string& what) {
+    const size_t n = keys.size();
+    std::vector<uint32_t> expected(n);
+    for (size_t i = 0; i < n; ++i) expected[i] = static_cast<uint32_t>(i);
+    std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    std::vector<Key> sorted = keys;
+    std::vector<uint32_t> perm(n);
+    radixSortByKey(sorted.data(), perm.data(), n);
+    bool same = (perm == expected);
+    for (size_t i = 0; same && (i < n); ++i) same = (sorted[i] == keys[expected[i]]);
+    check(same, what + ": keys and permutation of std::stable_sort");
+}
+
+template <typename Key>
+static void testRadixSort(const std::string& name) {
+    uint64_t s = 3;
+    const unsigned int threads = getThreadCount();
+    for (unsigned int t : {1u, 4u}) {
+        setThreadCount(t);
+        for (size_t n : {size_t(0), size_t(1), size_t(2), size_t(1000), size_t(300000)}) {
+            const std::string what = name + ", n = " + std::to_string(n) + ", " + std::to_string(t) + " threads";
+            std::vector<Key> keys(n);
+            // full width keys
+            for (Key& k : keys) k = static_cast<Key>(next(s));
+            checkRadixSort(keys, what + ", random");
+            // many duplicates, the order of equal keys shows stability
+            for (Key& k : keys) k = static_cast<Key>(next(s) % 50);
+            checkRadixSort(keys, what + ", duplicates");
+            // the middle digits are equal for all keys, their passes are skipped
+            for (Key& k : keys) k = static_cast<Key>((next(s) & 0xff) | (Key(0xa5) << (8 * sizeof(Key) - 8)));
+            checkRadixSort(keys, what + ", constant digits");
+            // already sorted and reversed
+            for (size_t i = 0; i < n; ++i) keys[i] = static_cast<Key>(i * 2654435761u);
+            std::sort(keys.begin(), keys.end());
+            checkRadixSort(keys, what + ", sorted");
+            std::reverse(keys.begin(), keys.end());
+            checkRadixSort(keys, what + ", reversed");
+        }
+    }
+    setThreadCount(threads);
+}
+
+/** @brief spatialSort() permutes the points so that their codes increase. */
+static void testSpatialSort() {
+    uint64_t s = 4;
+    for (CURVETYPE curve : {MORTON, HILBERT}) {
+        const std::string what = (curve == MORTON) ? "spatialSort Morton" : "spatialSort Hilbert";
+        std::vector<Vector3> input(5000);
+        for (Vector3& p : input) {
+            p = Vector3(static_cast<scalar>(next(s) % 1000) - 300, static_cast<scalar>(next(s) % 1000) * 0.01f,
+                        static_cast<scalar>(next(s) % 1000) + 5);
+        }
+        Vector3 lo, hi;
+        computeBounds(input.data(), input.size(), lo, hi);
+        std::vector<Vector3> points = input;
+        std::vector<uint32_t> perm;
+        spatialSort(points.data(), points.size(), perm, curve);
+        bool permuted = (perm.size() == input.size());
+        std::vector<bool> seen(input.size(), false);
+        for (size_t k = 0; permuted && (k < perm.size()); ++k) {
+            permuted = (perm[k] < input.size()) && !seen[perm[k]] && (points[k] == input[perm[k]]);
+            if (permuted) seen[perm[k]] = true;
+        }
+        check(permuted, what + ": points[k] == input[perm[k]]");
+        std::vector<uint64_t> codes(points.size());
+        computeSpatialCodes(points.data(), points.size(), lo, hi, codes.data(), curve);
+        check(std::is_sorted(codes.begin(), codes.end()), what + ": codes increase");
+
+        std::vector<int> attribute(input.size());
+        for (size_t i = 0; i < attribute.size(); ++i) attribute[i] = static_cast<int>(i);
+        reorderByPermutation(attribute.data(), perm.data(), attribute.size());
+        check(std::equal(attribute.begin(), attribute.end(), perm.begin()), what + ": reorderByPermutation");
+    }
+}
+
+int main() {
+    testMorton();
+    testHilbertExhaustive();
+    testHilbertRandom();
+    testRadixSort<uint64_t>("radix sort 64");
+    testRadixSort<uint32_t>("radix sort 32");
+    testSpatialSort();
+    return failures;
+}
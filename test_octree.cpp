@@ -0,0 +1,233 @@
+#include "mymorton.hpp"
+#include "myoctree.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/** @brief root cube [-8, 8]^3, node bounds are exact in float. */
+static const Vector3 ORIGIN(-8, -8, -8);
+static const scalar EXTENT = 16;
+static const int DEPTH = 6;
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief clustered points, a few outside the root cube, on its max faces and duplicated. */
+static std::vector<Vector3> makePoints(size_t n, uint64_t seed) {
+    std::vector<Vector3> points(n);
+    for (size_t i = 0; i < n; ++i) {
+        const scalar spread = (i % 3 == 0) ? 8 : 1.5f;
+        points[i] = Vector3(spread * uniform(seed) + 2, spread * uniform(seed) - 1, spread * uniform(seed));
+        if (i % 101 == 7) points[i].z = 8;
+        if (i % 37 == 5) points[i] = points[i / 2];
+    }
+    points[10] = Vector3(9, 0, 0);
+    points[11] = Vector3(0, -8.5f, 0);
+    return points;
+}
+
+static bool isInside(const Vector3& p) {
+    return (p.x >= -8) && (p.x <= 8) && (p.y >= -8) && (p.y <= 8) && (p.z >= -8) && (p.z <= 8);
+}
+
+/** @brief leaf cell coordinate along one axis, the max face belongs to the last cell. */
+static uint32_t cellIndex(scalar v) {
+    const uint32_t cells = 1u << DEPTH;
+    return std::min(static_cast<uint32_t>(std::floor((v + 8) * cells / EXTENT)), cells - 1);
+}
+
+/** @brief reference node of a level. */
+struct RefNode {
+    double sum[3] = {0, 0, 0};
+    uint64_t count = 0;
+};
+
+/** @brief the nodes of every level are the occupied cells, with their counts and centroids. */
+static void checkLevels(const Octree& tree, const std::vector<Vector3>& points, const std::string& what) {
+    std::vector<std::map<uint64_t, RefNode>> ref(DEPTH + 1);
+    for (const Vector3& p : points) {
+        const uint32_t x = cellIndex(p.x), y = cellIndex(p.y), z = cellIndex(p.z);
+        for (int level = 0; level <= DEPTH; ++level) {
+            const int shift = DEPTH - level;
+            RefNode& node = ref[level][mortonEncode63(x >> shift, y >> shift, z >> shift)];
+            node.sum[0] += p.x;
+            node.sum[1] += p.y;
+            node.sum[2] += p.z;
+            node.count += 1;
+        }
+    }
+    check(tree.size() == points.size(), what + ": size");
+    std::vector<OctreeNodeRecord> records;
+    for (int level = 0; level <= DEPTH; ++level) {
+        const std::string at = what + ", level " + std::to_string(level);
+        tree.exportLevel(level, records);
+        check((tree.nodeCount(level) == ref[level].size()) && (records.size() == ref[level].size()), at + ": node count");
+        if (records.size() != ref[level].size()) continue;
+        bool same = true;
+        auto it = ref[level].begin();
+        for (size_t i = 0; i < records.size(); ++i, ++it) {
+            const RefNode& r = it->second;
+            const Vector3 c(static_cast<scalar>(r.sum[0] / r.count), static_cast<scalar>(r.sum[1] / r.count),
+                            static_cast<scalar>(r.sum[2] / r.count));
+            same &= (records[i].key == it->first) && (records[i].count == r.count) &&
+                    ((records[i].centroid - c).length() < 1e-4f);
+            const OctreeNode* node = tree.getNode(level, it->first);
+            same &= (node != nullptr) && (node->count == r.count);
+            // the children mask names exactly the occupied cells of the next level
+            if ((node != nullptr) && (level < DEPTH)) {
+                for (uint64_t child = 0; child < 8; ++child) {
+                    const bool occupied = (ref[level + 1].count((it->first << 3) | child) != 0);
+                    same &= (((node->children >> child) & 1) != 0) == occupied;
+                }
+            }
+        }
+        check(same, at + ": keys, counts, centroids and children");
+    }
+
+    std::vector<Vector3> sorted = tree.sortedPoints();
+    bool ordered = true;
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        const Vector3& a = sorted[i - 1];
+        const Vector3& b = sorted[i];
+        ordered &= mortonEncode63(cellIndex(a.x), cellIndex(a.y), cellIndex(a.z)) <=
+                   mortonEncode63(cellIndex(b.x), cellIndex(b.y), cellIndex(b.z));
+    }
+    check(ordered, what + ": sortedPoints() in leaf Morton order");
+}
+
+static bool lessPoint(const Vector3& a, const Vector3& b) {
+    if (a.x != b.x) return a.x < b.x;
+    if (a.y != b.y) return a.y < b.y;
+    return a.z < b.z;
+}
+
+/** @brief point and node queries of boxes agree with brute force. */
+static void checkQueries(const Octree& tree, const std::vector<Vector3>& points, const std::string& what) {
+    uint64_t s = 5;
+    bool samePoints = true, sameNodes = true;
+    for (int k = 0; k < 40; ++k) {
+        Vector3 lo(8 * uniform(s), 8 * uniform(s), 8 * uniform(s));
+        Vector3 hi = lo + Vector3(6 * (uniform(s) + 1), 6 * (uniform(s) + 1), 6 * (uniform(s) + 1));
+        if (k == 0) {
+            lo = Vector3(-20, -20, -20);
+            hi = Vector3(20, 20, 20);
+        }
+        std::vector<Vector3> found, expected;
+        tree.queryPoints([&](const Vector3& a, const Vector3& b) { return Octree::classifyBox(lo, hi, a, b); },
+                         [&](const Vector3& p) { found.push_back(p); });
+        for (const Vector3& p : points) {
+            if ((p.x >= lo.x) && (p.x <= hi.x) && (p.y >= lo.y) && (p.y <= hi.y) && (p.z >= lo.z) && (p.z <= hi.z)) {
+                expected.push_back(p);
+            }
+        }
+        std::sort(found.begin(), found.end(), lessPoint);
+        std::sort(expected.begin(), expected.end(), lessPoint);
+        samePoints &= (found == expected);
+
+        const int lod = k % (DEPTH + 2);
+        const int level = std::min(lod, DEPTH);
+        std::vector<uint64_t> keys, expectedKeys;
+        bool levelOk = true;
+        tree.queryBox(lo, hi, lod, [&](int l, uint64_t key, const OctreeNode&) {
+            levelOk &= (l == level);
+            keys.push_back(key);
+        });
+        std::vector<OctreeNodeRecord> records;
+        tree.exportLevel(level, records);
+        for (const OctreeNodeRecord& r : records) {
+            Vector3 a, b;
+            tree.getNodeBounds(level, r.key, a, b);
+            if (Octree::classifyBox(lo, hi, a, b) != OUTSIDE) expectedKeys.push_back(r.key);
+        }
+        std::sort(keys.begin(), keys.end());
+        sameNodes &= levelOk && (keys == expectedKeys);
+    }
+    check(samePoints, what + ": queryPoints() matches brute force");
+    check(sameNodes, what + ": queryBox() visits the overlapping nodes of the lod level");
+}
+
+/** @brief single and batch insertion, removal and clear against a reference point list. */
+static void testInsertRemove() {
+    const std::vector<Vector3> input = makePoints(4000, 3);
+    std::vector<Vector3> inside;
+    for (const Vector3& p : input) {
+        if (isInside(p)) inside.push_back(p);
+    }
+
+    Octree single(ORIGIN, EXTENT, DEPTH);
+    size_t accepted = 0;
+    for (const Vector3& p : input) accepted += single.insert(p);
+    check(accepted == inside.size(), "single insert skips points outside the root cube");
+    checkLevels(single, inside, "single insert");
+    checkQueries(single, inside, "single insert");
+
+    Octree batch(ORIGIN, EXTENT, DEPTH);
+    const size_t half = input.size() / 2;
+    size_t inserted = batch.insert(input.data(), half);
+    inserted += batch.insert(input.data() + half, input.size() - half);
+    check(inserted == inside.size(), "batch insert skips points outside the root cube");
+    checkLevels(batch, inside, "batch insert");
+    checkQueries(batch, inside, "batch insert");
+    // both keep the insertion order inside a leaf
+    check(batch.sortedPoints() == single.sortedPoints(), "batch and single insert store the same point order");
+
+    // remove every third point, duplicates lose one copy per call
+    std::vector<Vector3> kept;
+    bool removed = true;
+    for (size_t i = 0; i < inside.size(); ++i) {
+        if (i % 3 == 0) {
+            removed &= batch.remove(inside[i]);
+        } else {
+            kept.push_back(inside[i]);
+        }
+    }
+    check(removed, "remove finds inserted points");
+    check(!batch.remove(Vector3(9, 0, 0)) && !batch.remove(Vector3(0.123f, 0.456f, 0.789f)),
+          "remove of missing points returns false");
+    checkLevels(batch, kept, "after remove");
+    checkQueries(batch, kept, "after remove");
+
+    // a batch on top of a tree built by single inserts and removals
+    const std::vector<Vector3> more = makePoints(1500, 4);
+    batch.insert(more.data(), more.size());
+    for (const Vector3& p : more) {
+        if (isInside(p)) kept.push_back(p);
+    }
+    checkLevels(batch, kept, "batch after remove");
+    checkQueries(batch, kept, "batch after remove");
+
+    for (const Vector3& p : kept) batch.remove(p);
+    checkLevels(batch, std::vector<Vector3>(), "remove all");
+    bool empty = true;
+    batch.queryPoints([](const Vector3&, const Vector3&) { return INSIDE; }, [&](const Vector3&) { empty = false; });
+    check(empty && batch.sortedPoints().empty(), "empty tree visits no point");
+
+    single.clear();
+    checkLevels(single, std::vector<Vector3>(), "clear");
+    single.insert(inside.data(), inside.size());
+    checkLevels(single, inside, "insert after clear");
+}
+
+/** @brief a depth 0 tree is a single leaf. */
+static void testDepthZero() {
+    Octree tree(ORIGIN, EXTENT, 0);
+    const Vector3 p[3] = {Vector3(1, 2, 3), Vector3(-1, 0, 5), Vector3(20, 0, 0)};
+    check(tree.insert(p, 3) == 2, "depth 0: batch insert");
+    check((tree.nodeCount(0) == 1) && (tree.size() == 2) && (tree.sortedPoints().size() == 2), "depth 0: one leaf");
+    check(tree.getNode(0, 0)->centroid() == Vector3(0, 1, 4), "depth 0: centroid");
+    check(tree.remove(p[0]) && (tree.size() == 1), "depth 0: remove");
+}
+
+int main() {
+    testInsertRemove();
+    testDepthZero();
+    return failures;
+}
@@ -0,0 +1,216 @@
+#include "myparallel.hpp"
+#include "test_check.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const unsigned int THREAD_COUNTS[] = {1, 2, 4, 7};
+
+/** @brief every index visited once, every chunk at least grain long except the tail. */
+static void testCoverage() {
+    const size_t ranges[][3] = {{0, 0, 4}, {5, 5, 1}, {9, 3, 1}, {0, 1, 1}, {0, 1000, 0}, {17, 1017, 1},
+                                {3, 100003, 64}, {0, 100, 1000}, {1000, 70000, 4096}};
+    for (unsigned int t : THREAD_COUNTS) {
+        setThreadCount(t);
+        for (const auto& r : ranges) {
+            const size_t begin = r[0], end = r[1], grain = r[2];
+            const std::string what = "parallelFor [" + std::to_string(begin) + ", " + std::to_string(end) + ") grain " +
+                                     std::to_string(grain) + ", " + std::to_string(t) + " threads";
+            std::vector<std::atomic<int>> visits(end > begin ? end : begin);
+            for (auto& v : visits) v.store(0);
+            std::atomic<bool> chunks(true);
+            parallelFor(begin, end, grain, [&](size_t lo, size_t hi) {
+                const bool inside = (begin <= lo) && (lo < hi) && (hi <= end);
+                const bool longEnough = (hi - lo >= grain) || (hi == end);
+                if (!inside || !longEnough) {
+                    chunks.store(false);
+                    return;
+                }
+                for (size_t i = lo; i < hi; ++i) visits[i].fetch_add(1);
+            });
+            bool once = true;
+            for (size_t i = 0; i < visits.size(); ++i) once &= (visits[i].load() == ((i >= begin) && (i < end) ? 1 : 0));
+            check(once, what + ": every index once");
+            check(chunks.load(), what + ": chunks inside the range and at least grain long");
+        }
+    }
+}
+
+/** @brief the reduction is the serial block-order result, bitwise, for any thread count. */
+static void testReduce() {
+    const size_t n = 200000 + 11;
+    std::vector<float> data(n);
+    uint64_t s = 5;
+    for (float& x : data) {
+        s = s * 6364136223846793005ull + 1442695040888963407ull;
+        // mixed magnitudes make the float sum depend on the order
+        x = static_cast<float>((s >> 40) % 100000) * ((s >> 20) % 2 ? 1e-3f : 1e3f);
+    }
+    for (size_t grain : {size_t(0), size_t(1), size_t(1000), size_t(4096), n + 5}) {
+        const size_t g = (grain == 0) ? 1 : grain;
+        float expected = 0.5f;
+        for (size_t lo = 0; lo < n; lo += g) {
+            float partial = 0.5f;
+            for (size_t i = lo; i < std::min(n, lo + g); ++i) partial += data[i];
+            expected = expected + partial;
+        }
+        bool same = true;
+        for (unsigned int t : THREAD_COUNTS) {
+            setThreadCount(t);
+            const float sum = parallelReduce(size_t(0), n, grain, 0.5f, [&](size_t lo, size_t hi, float& partial) {
+                for (size_t i = lo; i < hi; ++i) partial += data[i];
+            }, [](float a, float b) { return a + b; });
+            same &= (sum == expected);
+        }
+        check(same, "parallelReduce grain " + std::to_string(grain) + ": serial block order for any thread count");
+    }
+    const int empty = parallelReduce(size_t(8), size_t(8), 4, 42, [](size_t, size_t, int& p) { p = 0; },
+                                     [](int a, int b) { return a + b; });
+    check(empty == 42, "parallelReduce of an empty range is the identity");
+    // a non commutative combination keeps the block order
+    setThreadCount(4);
+    const uint64_t order = parallelReduce(size_t(0), size_t(15), 1, uint64_t(0), [](size_t lo, size_t, uint64_t& p) {
+        p = lo + 1;
+    }, [](uint64_t a, uint64_t b) { return a * 16 + b; });
+    check(order == 0x123456789abcdefull, "parallelReduce combines the partials in block order");
+}
+
+/** @brief the first exception reaches the caller after every task finished, the pool keeps working. */
+static void testExceptions() {
+    for (unsigned int t : THREAD_COUNTS) {
+        setThreadCount(t);
+        const std::string what = std::to_string(t) + " threads";
+        std::atomic<int> running(0), after(0);
+        std::atomic<bool> returned(false);
+        std::string message;
+        try {
+            parallelFor(0, 10000, 10, [&](size_t lo, size_t hi) {
+                running.fetch_add(1);
+                if (returned.load()) after.fetch_add(1);
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+                const bool fail = (lo <= 5000) && (5000 < hi);
+                running.fetch_sub(1);
+                if (fail) throw std::runtime_error("index 5000");
+            });
+        } catch (const std::runtime_error& e) {
+            message = e.what();
+        }
+        returned.store(true);
+        check(message == "index 5000", what + ": exception rethrown in the caller");
+        check(running.load() == 0, what + ": no body is running after the throw");
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        check(after.load() == 0, what + ": no body starts after the throw");
+
+        bool caught = false;
+        try {
+            parallelFor(0, 100, 1, [](size_t, size_t hi) {
+                if (hi == 100) throw "string literal";
+            });
+        } catch (const char*) {
+            caught = true;
+        }
+        check(caught, what + ": const char* exceptions as thrown by the library");
+
+        std::atomic<size_t> sum(0);
+        parallelFor(0, 1000, 7, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) sum.fetch_add(i);
+        });
+        check(sum.load() == 999 * 1000 / 2, what + ": the pool works after an exception");
+    }
+}
+
+/** @brief loops inside loop bodies, the waiting threads run the inner tasks. */
+static void testNested() {
+    for (unsigned int t : THREAD_COUNTS) {
+        setThreadCount(t);
+        const std::string what = std::to_string(t) + " threads";
+        std::vector<uint64_t> rows(64);
+        parallelFor(0, rows.size(), 1, [&](size_t lo, size_t hi) {
+            for (size_t r = lo; r < hi; ++r) {
+                rows[r] = parallelReduce(size_t(0), size_t(5000), 100, uint64_t(0),
+                                         [&](size_t a, size_t b, uint64_t& p) {
+                                             for (size_t i = a; i < b; ++i) p += i * (r + 1);
+                                         },
+                                         [](uint64_t a, uint64_t b) { return a + b; });
+            }
+        });
+        bool same = true;
+        for (size_t r = 0; r < rows.size(); ++r) same &= (rows[r] == uint64_t(4999) * 5000 / 2 * (r + 1));
+        check(same, what + ": parallelReduce nested in parallelFor");
+
+        std::atomic<size_t> count(0);
+        parallelFor(0, 8, 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                parallelFor(0, 8, 1, [&](size_t a, size_t b) {
+                    for (size_t j = a; j < b; ++j) {
+                        parallelFor(0, 100, 3, [&](size_t x, size_t y) { count.fetch_add(y - x); });
+                    }
+                });
+            }
+        });
+        check(count.load() == 8 * 8 * 100, what + ": three nested parallelFor levels");
+    }
+}
+
+/** @brief a serial executor that records its calls. */
+class CountingExecutor : public Executor {
+  public:
+    std::atomic<int> calls{0};
+    unsigned int concurrency() const { return 3; }
+    void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        calls.fetch_add(1);
+        // chunks in reverse order, loops must not rely on any order
+        size_t hi = end;
+        while (hi > begin) {
+            const size_t lo = (hi - begin > grain) ? hi - grain : begin;
+            body(lo, hi);
+            hi = lo;
+        }
+    }
+};
+
+static void testExecutor() {
+    setThreadCount(4);
+    CountingExecutor executor;
+    setExecutor(&executor);
+    check((getThreadCount() == 3) && (&getExecutor() == &executor), "setExecutor() installs the executor");
+    std::vector<int> visits(1000, 0);
+    parallelFor(0, visits.size(), 10, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) ++visits[i];
+    });
+    bool once = true;
+    for (int v : visits) once &= (v == 1);
+    check(once && (executor.calls.load() == 1), "parallelFor() runs on the installed executor");
+    const uint64_t order = parallelReduce(size_t(0), size_t(15), 1, uint64_t(0), [](size_t lo, size_t, uint64_t& p) {
+        p = lo + 1;
+    }, [](uint64_t a, uint64_t b) { return a * 16 + b; });
+    check((order == 0x123456789abcdefull) && (executor.calls.load() == 2), "parallelReduce() keeps the block order on it");
+    // a range within one grain does not reach the executor
+    parallelFor(0, 5, 10, [](size_t, size_t) {});
+    check(executor.calls.load() == 2, "a single chunk runs inline");
+
+    setExecutor(nullptr);
+    check((getThreadCount() == 4) && (&getExecutor() != &executor), "setExecutor(nullptr) restores the built-in pool");
+    std::atomic<size_t> sum(0);
+    parallelFor(0, 1000, 1, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) sum.fetch_add(i);
+    });
+    check((sum.load() == 999 * 1000 / 2) && (executor.calls.load() == 2), "the built-in pool runs again");
+}
+
+int main() {
+    const unsigned int threads = getThreadCount();
+    testCoverage();
+    testReduce();
+    testExceptions();
+    testNested();
+    testExecutor();
+    setThreadCount(threads);
+    return failures;
+}
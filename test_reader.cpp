@@ -0,0 +1,257 @@
+#include "myreader.hpp"
+#include "test_check.hpp"
+
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/** @brief parse a whole token, true if it is one number equal to expected, NaN equal to NaN. */
+static bool parsesTo(const std::string& token, scalar expected) {
+    scalar value = 0;
+    const char* end = parseScalar(token.data(), token.data() + token.size(), value);
+    if (end != token.data() + token.size()) return false;
+    return (value == expected) || (std::isnan(value) && std::isnan(expected));
+}
+
+/** @brief strtod() of a token in the C locale, the reference of the long tokens. */
+static scalar reference(const std::string& token) {
+    return static_cast<scalar>(strtod(token.c_str(), nullptr));
+}
+
+static void testParseScalar() {
+    check(parsesTo("1.5", 1.5f) && parsesTo("-1.5e3", -1500) && parsesTo("+2", 2), "plain numbers");
+    check(parsesTo(".5", 0.5f) && parsesTo("5.", 5) && parsesTo("-0", 0), "numbers without integer or fraction digits");
+    check(parsesTo("2.5E-2", reference("2.5E-2")) && parsesTo("1e+3", 1000), "exponents");
+    check(parsesTo("1e30", reference("1e30")) && parsesTo("7e-30", reference("7e-30")), "exponents beyond 22");
+    check(parsesTo("1e400", INFINITY) && parsesTo("-1e400", -INFINITY) && parsesTo("1e-400", 0), "overflow and underflow");
+    check(parsesTo("12345678901234567890123", reference("12345678901234567890123")), "more than 19 digits");
+    check(parsesTo("nan", NAN) && parsesTo("NaN", NAN) && parsesTo("-nan", NAN) && parsesTo("nan(123)", NAN), "nan");
+    check(parsesTo("inf", INFINITY) && parsesTo("-Inf", -INFINITY) && parsesTo("infinity", INFINITY), "inf");
+
+    // tokens longer than any fixed buffer
+    const std::string big = "1" + std::string(130, '0');
+    check(parsesTo(big, reference(big)) && parsesTo(big + ".5", reference(big + ".5")), "long integer token");
+    const std::string tiny = "0." + std::string(30, '0') + "15" + std::string(100, '0');
+    check(parsesTo(tiny, reference(tiny)) && (reference(tiny) != 0), "long fraction token");
+    std::string digits = "0.";
+    for (int i = 0; i < 200; ++i) digits += char('0' + (i * 7 + 3) % 10);
+    check(parsesTo(digits, reference(digits)) && parsesTo(digits + "e2", reference(digits + "e2")), "long mantissa");
+
+    scalar value = 0;
+    const char* text = "1e";
+    check(parseScalar(text, text + 2, value) == text + 1 && (value == 1), "exponent without digits ends the number");
+    text = "3.25,4";
+    check(parseScalar(text, text + 6, value) == text + 4 && (value == 3.25f), "number followed by a separator");
+    const char* invalid[] = {"", "-", ".", "e5", "abc", "+.", "in", "na"};
+    bool rejected = true;
+    for (const char* t : invalid) rejected &= (parseScalar(t, t + std::strlen(t), value) == nullptr);
+    check(rejected, "no number");
+
+    // a locale with a decimal comma must not change the result
+    const char* locales[] = {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "de_DE"};
+    const std::string huge = big + ".5";
+    const scalar expectedDigits = reference(digits), expectedHuge = reference(huge);
+    for (const char* name : locales) {
+        if (!setlocale(LC_NUMERIC, name)) continue;
+        const bool ok = parsesTo(digits, expectedDigits) && parsesTo(huge, expectedHuge);
+        setlocale(LC_NUMERIC, "C");
+        check(ok, std::string("long tokens in locale ") + name);
+        break;
+    }
+}
+
+/** @brief write bytes to a file. */
+static void writeFile(const std::string& path, const std::string& bytes) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return;
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+}
+
+/** @brief read a file into both outputs and compare them with the expected points. */
+static void checkRead(const std::string& path, const std::vector<Vector3>& expected, const std::string& what,
+                      POINTFORMAT format = AUTO_FORMAT) {
+    std::vector<Vector3> aos;
+    Vector3SoABuffer soa;
+    try {
+        check(readPointCloud(path, aos, format) == expected.size(), what + ": AOS count");
+        check(readPointCloud(path, soa, format) == expected.size(), what + ": SOA count");
+    } catch (const char*) {
+        check(false, what + ": read");
+        return;
+    }
+    bool same = (aos.size() == expected.size()) && (soa.size() == expected.size());
+    for (size_t i = 0; same && (i < expected.size()); ++i) {
+        const Vector3 s = soa.view().get(i);
+        for (int k = 0; k < 3; ++k) {
+            const scalar e = (&expected[i].x)[k], a = (&aos[i].x)[k], b = (&s.x)[k];
+            same &= ((a == e) && (b == e)) || (std::isnan(e) && std::isnan(a) && std::isnan(b));
+        }
+    }
+    check(same, what + ": points");
+}
+
+/** @brief true if reading throws. */
+static bool readFails(const std::string& path) {
+    std::vector<Vector3> points;
+    try {
+        readPointCloud(path, points);
+    } catch (const char*) {
+        return true;
+    }
+    return false;
+}
+
+static void testXYZ() {
+    const std::string big = "1" + std::string(130, '0');
+    std::string text = "# header line\n"
+                       "1 2 3\n"
+                       "4,5,6\n"
+                       "7;8;9\r\n"
+                       "\t-1.5e3  2.5E-2 .5 255 0 0\n"
+                       "1 2\n"
+                       "a b c\n"
+                       "1 2 x\n"
+                       "1 2 3x\n"
+                       "\n"
+                       "nan inf -inf\n";
+    text += big + " 0." + std::string(130, '0') + "15 1e-3\n";
+    text += "10 11 12";
+    writeFile("test_reader.xyz", text);
+    const std::vector<Vector3> expected = {Vector3(1, 2, 3), Vector3(4, 5, 6), Vector3(7, 8, 9),
+                                           Vector3(-1500, reference("2.5E-2"), 0.5f),
+                                           Vector3(NAN, INFINITY, -INFINITY),
+                                           Vector3(reference(big), reference("0." + std::string(130, '0') + "15"),
+                                                   reference("1e-3")),
+                                           Vector3(10, 11, 12)};
+    checkRead("test_reader.xyz", expected, "XYZ");
+    checkRead("test_reader.xyz", expected, "XYZ by format", XYZ_FORMAT);
+    remove("test_reader.xyz");
+}
+
+static void testOBJ() {
+    writeFile("test_reader.obj", "# comment\n"
+                                 "o cube\n"
+                                 "v 1 2 3\n"
+                                 "vn 0 0 1\n"
+                                 "vt 0.5 0.5\n"
+                                 "  v\t-1 -2 -3 1.0\n"
+                                 "v 1 2\n"
+                                 "f 1 2 3\n"
+                                 "v 4.5 5.5 6.5\n");
+    checkRead("test_reader.obj", {Vector3(1, 2, 3), Vector3(-1, -2, -3), Vector3(4.5f, 5.5f, 6.5f)}, "OBJ");
+    remove("test_reader.obj");
+}
+
+/** @brief points of the PLY tests. */
+static std::vector<Vector3> plyPoints() {
+    std::vector<Vector3> points;
+    for (int i = 0; i < 50; ++i) points.push_back(Vector3(i * 0.25f, -i * 1.5f, 1000.f + i));
+    return points;
+}
+
+static void testAsciiPLY() {
+    const std::vector<Vector3> points = plyPoints();
+    std::string text = "ply\nformat ascii 1.0\ncomment made by hand\n"
+                       "element camera 2\nproperty float fx\nproperty float fy\n"
+                       "element vertex 50\nproperty uchar red\nproperty float z\nproperty float x\nproperty double y\n"
+                       "element face 1\nproperty list uchar int vertex_indices\nend_header\n";
+    text += "500 500\n501 501\n";
+    for (const Vector3& p : points) {
+        char line[128];
+        snprintf(line, sizeof(line), "255 %.9g %.9g %.9g\n", p.z, p.x, p.y);
+        text += line;
+    }
+    text += "3 0 1 2\n";
+    writeFile("test_reader.ply", text);
+    checkRead("test_reader.ply", points, "ASCII PLY");
+    remove("test_reader.ply");
+}
+
+/** @brief append a value in little or big endian byte order. */
+template <typename T>
+static void append(std::string& bytes, T value, bool little) {
+    unsigned char b[sizeof(T)];
+    std::memcpy(b, &value, sizeof(T));
+    const uint16_t one = 1;
+    const bool host_little = (*reinterpret_cast<const unsigned char*>(&one) == 1);
+    for (size_t i = 0; i < sizeof(T); ++i) bytes += static_cast<char>(b[(host_little == little) ? i : sizeof(T) - 1 - i]);
+}
+
+/** @brief binary PLY with a fixed size element before the vertices, mixed property types. */
+static std::string binaryPLY(const std::vector<Vector3>& points, bool little, bool floats, size_t count) {
+    std::string bytes = std::string("ply\nformat ") + (little ? "binary_little_endian" : "binary_big_endian") +
+                        " 1.0\nelement camera 1\nproperty int id\nproperty short flags\n"
+                        "element vertex " + std::to_string(count) + "\n";
+    bytes += floats ? "property float x\nproperty float y\nproperty float z\nproperty uchar red\n"
+                    : "property double z\nproperty ushort red\nproperty float x\nproperty int y\n";
+    bytes += "end_header\n";
+    append<int32_t>(bytes, 7, little);
+    append<int16_t>(bytes, -3, little);
+    for (const Vector3& p : points) {
+        if (floats) {
+            append<float>(bytes, p.x, little);
+            append<float>(bytes, p.y, little);
+            append<float>(bytes, p.z, little);
+            append<uint8_t>(bytes, 200, little);
+        } else {
+            append<double>(bytes, p.z, little);
+            append<uint16_t>(bytes, 40000, little);
+            append<float>(bytes, p.x, little);
+            append<int32_t>(bytes, static_cast<int32_t>(p.y), little);
+        }
+    }
+    return bytes;
+}
+
+static void testBinaryPLY() {
+    std::vector<Vector3> points = plyPoints();
+    std::vector<Vector3> integral = points;
+    for (Vector3& p : integral) p.y = std::floor(p.y);
+    for (int little = 0; little < 2; ++little) {
+        const std::string order = little ? "little endian" : "big endian";
+        writeFile("test_reader.ply", binaryPLY(points, little, true, points.size()));
+        checkRead("test_reader.ply", points, "binary PLY floats, " + order);
+        writeFile("test_reader.ply", binaryPLY(integral, little, false, integral.size()));
+        checkRead("test_reader.ply", integral, "binary PLY mixed types, " + order);
+        // vertices missing at the end
+        writeFile("test_reader.ply", binaryPLY(points, little, true, points.size() + 1));
+        check(readFails("test_reader.ply"), "truncated binary PLY, " + order);
+    }
+    remove("test_reader.ply");
+}
+
+static void testMalformedPLY() {
+    const char* files[] = {
+        "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\n",
+        "plx\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\nend_header\n1 2 3\n",
+        "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nend_header\n1 2\n",
+        "ply\nformat ascii 1.0\nelement face 1\nproperty float x\nend_header\n1\n",
+        "ply\nformat ascii 1.0\nelement vertex 1\nproperty quad x\nproperty float y\nproperty float z\nend_header\n1 2 3\n",
+        "ply\nformat binary_middle_endian 1.0\nelement vertex 1\nproperty float x\nproperty float y\n"
+        "property float z\nend_header\n",
+        "ply\nformat binary_little_endian 1.0\nelement face 1\nproperty list uchar int i\nelement vertex 1\n"
+        "property float x\nproperty float y\nproperty float z\nend_header\n",
+        ""};
+    for (const char* text : files) {
+        writeFile("test_reader.ply", text);
+        check(readFails("test_reader.ply"), std::string("malformed PLY: ") + std::string(text).substr(0, 40));
+    }
+    remove("test_reader.ply");
+    check(readFails("test_reader_missing.xyz"), "missing file");
+}
+
+int main() {
+    testParseScalar();
+    testXYZ();
+    testOBJ();
+    testAsciiPLY();
+    testBinaryPLY();
+    testMalformedPLY();
+    return failures;
+}
@@ -0,0 +1,197 @@
+#include "myisa.hpp"
+#include "myrotation.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief random quaternions of mixed norms, with zero and NaN ones and every Shepperd case. */
+static std::vector<Vector4> makeQuaternions(size_t n) {
+    std::vector<Vector4> q(n);
+    uint64_t s = 7;
+    for (size_t i = 0; i < n; ++i) {
+        q[i] = Vector4(uniform(s), uniform(s), uniform(s), uniform(s));
+        // one component dominates, so the largest diagonal entry selects the case
+        (&q[i].x)[i % 4] *= 8;
+    }
+    q[3] = Vector4(0, 0, 0, 0);
+    q[21].y = std::numeric_limits<scalar>::quiet_NaN();
+    q[38].w = std::numeric_limits<scalar>::infinity();
+    return q;
+}
+
+/** @brief every variant agrees with the scalar one, on a length that leaves remainders. */
+static void testVariants() {
+    const size_t n = 1000 + 13;
+    const std::vector<Vector4> q = makeQuaternions(n);
+    std::vector<Matrix3> refRot(n), rot(n);
+    std::vector<Vector4> refQuat(n), quat(n);
+    const ISALEVEL isa = getISA();
+    setISA(ISA_SCALAR);
+    const size_t refValid = quaternionsToRotations(q.data(), n, refRot.data());
+    const size_t refFinite = rotationsToQuaternions(refRot.data(), n, refQuat.data());
+    check(refValid == n - 3, "quaternionsToRotations counts zero and non-finite quaternions");
+    check(refFinite == n - 3, "rotationsToQuaternions counts NaN matrices");
+    for (int level = ISA_SCALAR; level < ISA_COUNT; ++level) {
+        if (!setISA(static_cast<ISALEVEL>(level))) continue;
+        const std::string name = getISAName(static_cast<ISALEVEL>(level));
+        check(quaternionsToRotations(q.data(), n, rot.data()) == refValid, name + ": valid rotations");
+        // NaN entries compare unequal, memcmp compares their bits
+        check(std::memcmp(rot.data(), refRot.data(), n * sizeof(Matrix3)) == 0, name + ": rotations bitwise equal");
+        check(rotationsToQuaternions(rot.data(), n, quat.data()) == refFinite, name + ": finite quaternions");
+        bool close = true, positive = true;
+        for (size_t i = 0; i < n; ++i) {
+            if (std::isnan(refQuat[i].x)) {
+                close &= std::isnan(quat[i].x) && std::isnan(quat[i].w);
+                continue;
+            }
+            positive &= (quat[i].w >= 0);
+            for (int k = 0; k < 4; ++k) close &= (std::abs((&quat[i].x)[k] - (&refQuat[i].x)[k]) < 1e-6f);
+        }
+        check(close, name + ": quaternions within 1e-6 of the scalar ones");
+        check(positive, name + ": quaternions have w >= 0");
+    }
+    setISA(isa);
+}
+
+/** @brief a rotation and back gives the normalized quaternion, or its negative. */
+static void testRoundTrip() {
+    const size_t n = 257;
+    std::vector<Vector4> q = makeQuaternions(n);
+    std::vector<Matrix3> rot(n);
+    std::vector<Vector4> back(n);
+    quaternionsToRotations(q.data(), n, rot.data());
+    rotationsToQuaternions(rot.data(), n, back.data());
+    bool close = true;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::isnan(back[i].x)) continue;
+        const Vector4& a = q[i];
+        const scalar len = std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z + a.w * a.w);
+        const scalar sign = (a.w < 0) ? -1 : 1;
+        close &= (std::abs(back[i].x - sign * a.x / len) < 1e-5f) && (std::abs(back[i].y - sign * a.y / len) < 1e-5f) &&
+                 (std::abs(back[i].z - sign * a.z / len) < 1e-5f) && (std::abs(back[i].w - sign * a.w / len) < 1e-5f);
+    }
+    check(close, "quaternion to rotation and back");
+}
+
+/** @brief rotation about coordinate axis 0, 1 or 2, written out. */
+static Matrix3 axisRotation(int axis, scalar angle) {
+    const scalar c = std::cos(angle), s = std::sin(angle);
+    if (axis == 0) return Matrix3(1, 0, 0, 0, c, s, 0, -s, c);
+    if (axis == 1) return Matrix3(c, 0, -s, 0, 1, 0, s, 0, c);
+    return Matrix3(c, s, 0, -s, c, 0, 0, 0, 1);
+}
+
+/** @brief axes of the orders in EULERORDER sequence. */
+static const int ORDER_AXES[12][3] = {
+    {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0},
+    {0, 1, 0}, {0, 2, 0}, {1, 0, 1}, {1, 2, 1}, {2, 0, 2}, {2, 1, 2}};
+static const char* const ORDER_NAMES[12] = {"XYZ", "XZY", "YXZ", "YZX", "ZXY", "ZYX",
+                                            "XYX", "XZX", "YXY", "YZY", "ZXZ", "ZYZ"};
+
+static scalar maxDiff(const Matrix3& a, const Matrix3& b) {
+    scalar d = 0;
+    for (int i = 0; i < 9; ++i) d = std::max(d, std::abs(a[i] - b[i]));
+    return d;
+}
+
+/** @brief the ranges of myrotation.hpp, a and c in [-pi, pi], b in [-pi/2, pi/2] or [0, pi]. */
+static bool inRange(const Vector3& e, bool proper) {
+    const scalar pi = static_cast<scalar>(M_PI);
+    const bool b = proper ? (e.y >= 0) && (e.y <= pi) : (e.y >= -pi / 2) && (e.y <= pi / 2);
+    return b && (std::abs(e.x) <= pi) && (std::abs(e.z) <= pi);
+}
+
+/** @brief every order: the matrix is the product of the axis rotations, angles in range round trip. */
+static void testEulerRoundTrip() {
+    uint64_t s = 11;
+    const scalar pi = static_cast<scalar>(M_PI);
+    for (int o = 0; o < 12; ++o) {
+        const EULERORDER order = static_cast<EULERORDER>(o);
+        const bool proper = (o >= EULER_XYX);
+        const std::string name = ORDER_NAMES[o];
+        scalar product = 0, matrix = 0, quaternion = 0, reconstructed = 0;
+        bool range = true;
+        for (int k = 0; k < 200; ++k) {
+            // inside the ranges, away from gimbal lock
+            const scalar b = proper ? (0.5f + 0.5f * uniform(s)) * (pi - 0.1f) + 0.05f : uniform(s) * (pi / 2 - 0.05f);
+            const Vector3 angles(uniform(s) * pi, b, uniform(s) * pi);
+            const Matrix3 R = eulerToRotation(angles, order);
+            const Matrix3 ref = axisRotation(ORDER_AXES[o][0], angles.x).matmul(axisRotation(ORDER_AXES[o][1], angles.y))
+                                    .matmul(axisRotation(ORDER_AXES[o][2], angles.z));
+            product = std::max(product, maxDiff(R, ref));
+            product = std::max(product, maxDiff(quaternionToRotation(eulerToQuaternion(angles, order)), R));
+            matrix = std::max(matrix, (rotationToEuler(R, order) - angles).length());
+            quaternion = std::max(quaternion, (quaternionToEuler(eulerToQuaternion(angles, order), order) - angles).length());
+
+            // any angles give angles in range for the same rotation
+            const Vector3 wide(3 * pi * uniform(s), 3 * pi * uniform(s), 3 * pi * uniform(s));
+            const Matrix3 W = eulerToRotation(wide, order);
+            const Vector3 e = rotationToEuler(W, order);
+            range &= inRange(e, proper);
+            reconstructed = std::max(reconstructed, maxDiff(eulerToRotation(e, order), W));
+        }
+        check(product < 1e-5f, name + ": R_first(a) * R_second(b) * R_third(c), also through the quaternion");
+        check(matrix < 1e-4f, name + ": rotationToEuler round trip");
+        check(quaternion < 1e-4f, name + ": quaternionToEuler round trip");
+        check(range, name + ": angles within the documented ranges");
+        check(reconstructed < 1e-5f, name + ": angles out of range come back in range for the same rotation");
+    }
+}
+
+/** @brief at exact gimbal lock c is 0, b is the lock angle and a carries the whole rotation. */
+static void testGimbalLock() {
+    uint64_t s = 12;
+    const scalar pi = static_cast<scalar>(M_PI);
+    for (int o = 0; o < 12; ++o) {
+        const EULERORDER order = static_cast<EULERORDER>(o);
+        const bool proper = (o >= EULER_XYX);
+        const std::string name = ORDER_NAMES[o];
+        bool zero = true, range = true;
+        scalar lock = 0, reconstructed = 0, sum = 0;
+        for (scalar b : proper ? std::vector<scalar>{0, pi} : std::vector<scalar>{pi / 2, -pi / 2}) {
+            for (int k = 0; k < 50; ++k) {
+                const Vector3 angles(uniform(s) * pi, b, uniform(s) * pi);
+                const Matrix3 R = eulerToRotation(angles, order);
+                const Vector3 e = rotationToEuler(R, order);
+                zero &= (e.z == 0);
+                range &= inRange(e, proper);
+                lock = std::max(lock, std::abs(e.y - b));
+                reconstructed = std::max(reconstructed, maxDiff(eulerToRotation(e, order), R));
+                // only a +- c is defined, compare the matrices
+                const Vector3 q = quaternionToEuler(eulerToQuaternion(angles, order), order);
+                sum = std::max(sum, maxDiff(eulerToRotation(q, order), R));
+            }
+        }
+        check(zero, name + ": c is 0 at gimbal lock");
+        check(range, name + ": gimbal lock angles within the documented ranges");
+        check(lock < 1e-3f, name + ": b is the lock angle");
+        check(reconstructed < 1e-5f, name + ": a carries the rotation at gimbal lock");
+        check(sum < 1e-5f, name + ": gimbal lock through the quaternion");
+    }
+    bool thrown = false;
+    try {
+        rotationToEuler(Matrix3::identity(), static_cast<EULERORDER>(12));
+    } catch (const char*) {
+        thrown = true;
+    }
+    check(thrown, "an order past EULER_ZYZ throws");
+}
+
+int main() {
+    testVariants();
+    testRoundTrip();
+    testEulerRoundTrip();
+    testGimbalLock();
+    return failures;
+}
@@ -0,0 +1,41 @@
+#include "mysoa.hpp"
+#include "test_check.hpp"
+
+#include <utility>
+
+/** @brief a moved-from buffer has no capacity, so its next resize() allocates. */
+static void testMove() {
+    Vector3SoABuffer a(100);
+    a.view().set(99, Vector3(1.f, 2.f, 3.f));
+    Vector3SoABuffer b(std::move(a));
+    check((a.size() == 0) && (a.getCapacity() == 0) && (a.view().size == 0), "move constructor empties the source");
+    check((b.size() == 100) && b.view().get(99).equal(Vector3(1.f, 2.f, 3.f)), "move constructor takes the points");
+    a.resize(10);
+    check((a.getCapacity() == 10) && (a.view().x != nullptr), "moved-from buffer allocates on resize");
+
+    Vector3SoABuffer c(5);
+    c = std::move(b);
+    check((b.size() == 0) && (b.getCapacity() == 0) && (b.view().size == 0), "move assignment empties the source");
+    check((c.size() == 100) && c.view().get(99).equal(Vector3(1.f, 2.f, 3.f)), "move assignment takes the points");
+    c = std::move(c);
+    check(c.size() == 100, "self move assignment keeps the points");
+}
+
+/** @brief buffers released to a pool come back with their storage. */
+static void testPool() {
+    Vector3SoAPool pool;
+    Vector3SoABuffer a = pool.acquire(64);
+    pool.release(std::move(a));
+    check((a.getCapacity() == 0) && (pool.available() == 1), "release empties the buffer");
+    a.resize(8);
+    a.view().set(7, Vector3(4.f, 5.f, 6.f));
+    check(a.view().get(7).equal(Vector3(4.f, 5.f, 6.f)), "released buffer is usable again");
+    Vector3SoABuffer b = pool.acquire(32);
+    check((b.size() == 32) && (b.getCapacity() == 64) && (pool.available() == 0), "acquire reuses the released storage");
+}
+
+int main() {
+    testMove();
+    testPool();
+    return failures;
+}
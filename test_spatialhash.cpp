@@ -0,0 +1,150 @@
+#include "myparallel.hpp"
+#include "myspatialhash.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief random points in a cube of half edge extent, some on cell boundaries and duplicated. */
+static std::vector<Vector3> makePoints(size_t n, scalar extent, uint64_t seed) {
+    std::vector<Vector3> points(n);
+    for (size_t i = 0; i < n; ++i) {
+        points[i] = Vector3(extent * uniform(seed), extent * uniform(seed), extent * uniform(seed));
+        // integer coordinates sit exactly on a cell face for the cell sizes used below
+        if (i % 17 == 0) points[i].x = static_cast<scalar>(static_cast<int>(points[i].x));
+        if (i % 29 == 0) points[i] = points[i / 2];
+    }
+    return points;
+}
+
+/** @brief indices within radius of q, by the same distance expression as forEachNeighbor(). */
+static std::vector<uint32_t> bruteForce(const std::vector<Vector3>& points, const Vector3& q, scalar radius) {
+    std::vector<uint32_t> out;
+    const scalar r2 = radius * radius;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const scalar dx = points[i].x - q.x;
+        const scalar dy = points[i].y - q.y;
+        const scalar dz = points[i].z - q.z;
+        if (dx * dx + dy * dy + dz * dz <= r2) out.push_back(static_cast<uint32_t>(i));
+    }
+    return out;
+}
+
+/** @brief the grid holds exactly points, and radiusSearch() agrees with brute force. */
+static void checkGrid(const SpatialHashGrid& grid, const std::vector<Vector3>& points, const std::string& what) {
+    check(grid.size() == points.size(), what + ": size");
+    const std::vector<Vector3>& sorted = grid.sortedPoints();
+    const std::vector<uint32_t>& indices = grid.sortedIndices();
+    bool layout = (sorted.size() == points.size()) && (indices.size() == points.size());
+    std::vector<bool> seen(points.size(), false);
+    for (size_t k = 0; layout && (k < indices.size()); ++k) {
+        const uint32_t i = indices[k];
+        layout = (i < points.size()) && !seen[i] && (sorted[k] == points[i]);
+        if (layout) seen[i] = true;
+    }
+    check(layout, what + ": sortedPoints()[k] is points[sortedIndices()[k]], every index once");
+
+    uint64_t s = 99;
+    const scalar cell = grid.getCellSize();
+    const scalar radii[] = {0, cell * 0.3f, cell, cell * 2.5f};
+    bool same = true;
+    std::vector<uint32_t> found;
+    for (int k = 0; k < 64; ++k) {
+        // half of the queries sit on a point, so radius 0 finds it and its duplicates
+        const Vector3 q = ((k % 2 == 0) && !points.empty()) ? points[(k * 131) % points.size()]
+                                                            : Vector3(12 * uniform(s), 12 * uniform(s), 12 * uniform(s));
+        for (scalar r : radii) {
+            grid.radiusSearch(q, r, found);
+            std::sort(found.begin(), found.end());
+            same &= (found == bruteForce(points, q, r));
+        }
+    }
+    check(same, what + ": radiusSearch() matches brute force");
+}
+
+/** @brief build, remove by rebuilding a subset, move and shrink. */
+static void testBuild() {
+    SpatialHashGrid grid(1.5f);
+    std::vector<Vector3> points = makePoints(3000, 10, 1);
+    grid.build(points);
+    checkGrid(grid, points, "build");
+
+    std::vector<Vector3> kept;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (i % 3 != 1) kept.push_back(points[i]);
+    }
+    grid.build(kept);
+    checkGrid(grid, kept, "remove every third point");
+
+    for (Vector3& p : kept) p += Vector3(0.4f, -0.7f, 0.25f);
+    grid.build(kept);
+    checkGrid(grid, kept, "rebuild of moved points");
+
+    grid.setCellSize(0.6f);
+    grid.build(kept);
+    checkGrid(grid, kept, "rebuild with a smaller cell");
+
+    points.resize(40);
+    grid.build(points);
+    checkGrid(grid, points, "shrink to a few points");
+
+    grid.build(std::vector<Vector3>());
+    checkGrid(grid, std::vector<Vector3>(), "empty");
+}
+
+/** @brief concurrent insertion gives the same grid as build(), for any thread count. */
+static void testConcurrentInsert() {
+    const std::vector<Vector3> points = makePoints(5000, 8, 2);
+    SpatialHashGrid built(1.f);
+    built.build(points);
+    const unsigned int threads = getThreadCount();
+    for (unsigned int n : {1u, 3u, 8u}) {
+        setThreadCount(n);
+        SpatialHashGrid grid(1.f);
+        grid.beginConcurrentInsert(points.size());
+        parallelFor(0, points.size(), 64, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) grid.insertConcurrent(static_cast<uint32_t>(i), points[i]);
+        });
+        grid.endConcurrentInsert();
+        const std::string what = "concurrent insert, " + std::to_string(n) + " threads";
+        checkGrid(grid, points, what);
+        check((grid.sortedIndices() == built.sortedIndices()) && (grid.sortedPoints() == built.sortedPoints()),
+              what + ": same layout as build()");
+
+        // a second round drops the previous content
+        grid.beginConcurrentInsert(100);
+        parallelFor(0, 100, 8, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) grid.insertConcurrent(static_cast<uint32_t>(i), points[i]);
+        });
+        grid.endConcurrentInsert();
+        checkGrid(grid, std::vector<Vector3>(points.begin(), points.begin() + 100), what + ": reinsert");
+    }
+    setThreadCount(threads);
+}
+
+static void testInvalidCellSize() {
+    int thrown = 0;
+    for (scalar c : {0.f, -1.f}) {
+        try {
+            SpatialHashGrid grid(c);
+        } catch (const char*) {
+            ++thrown;
+        }
+    }
+    check(thrown == 2, "non-positive cell size throws");
+}
+
+int main() {
+    testBuild();
+    testConcurrentInsert();
+    testInvalidCellSize();
+    return failures;
+}
@@ -0,0 +1,142 @@
+#include "myspline.hpp"
+#include "test_check.hpp"
+
+#include <cmath>
+#include <vector>
+
+/** @brief start time of a lidar log, seconds since the epoch. */
+static const double EPOCH = 1.7e9;
+/** @brief control point interval of the tests. */
+static const double INTERVAL = 0.1;
+
+/** @brief largest difference of the rotations and translations of two poses. */
+static scalar poseError(const SE3& a, const SE3& b) {
+    const scalar rotation = (a.rotation().inverse() * b.rotation()).log().length();
+    const scalar translation = (a.translation() - b.translation()).length();
+    return std::max(rotation, translation);
+}
+
+/** @brief control poses on a geodesic are reproduced exactly, including both ends of the spline. */
+static void testGeodesic() {
+    const Vector3 w(0.3f, -0.2f, 0.5f);
+    const Vector3 v(1.f, 2.f, -0.5f);
+    const size_t n = 12;
+    std::vector<SE3> control(n);
+    for (size_t k = 0; k < n; ++k) {
+        const scalar s = static_cast<scalar>(k * INTERVAL);
+        control[k] = SE3(SO3::exp(w * s), v * s);
+    }
+    const TrajectorySpline spline(control.data(), n, EPOCH, INTERVAL);
+
+    std::vector<double> times;
+    times.push_back(spline.getStartTime());
+    for (int i = 1; i < 64; ++i) times.push_back(spline.getStartTime() + (spline.getEndTime() - spline.getStartTime()) * i / 64);
+    times.push_back(spline.getEndTime());
+    std::vector<SE3> poses(times.size());
+    check(spline.evaluate(times.data(), times.size(), poses.data()) == times.size(), "batch evaluate at the bounds");
+
+    scalar scalarError = 0, batchError = 0;
+    for (size_t i = 0; i < times.size(); ++i) {
+        const scalar s = static_cast<scalar>(times[i] - EPOCH);
+        const SE3 expected(SO3::exp(w * s), v * s);
+        try {
+            scalarError = std::max(scalarError, poseError(spline.evaluate(times[i]), expected));
+        } catch (const char*) {
+            check(false, "evaluate at a time inside the spline");
+        }
+        // NaN compares false, so a NaN pose fails the check below
+        const scalar e = poseError(poses[i], expected);
+        batchError = (e <= batchError) ? batchError : e;
+    }
+    check(scalarError < 1e-4f, "evaluate reproduces a geodesic");
+    check(batchError < 1e-4f, "batch evaluate reproduces a geodesic");
+
+    bool thrown = false;
+    try {
+        spline.evaluate(spline.getEndTime() + 1e-3);
+    } catch (const char*) {
+        thrown = true;
+    }
+    check(thrown, "evaluate after the end throws");
+}
+
+/** @brief velocities match central differences of the poses on a curved trajectory. */
+static void testVelocity() {
+    const size_t n = 10;
+    std::vector<SE3> control(n);
+    for (size_t k = 0; k < n; ++k) {
+        const scalar s = static_cast<scalar>(k);
+        control[k] = SE3(SO3::exp(Vector3(0.1f * std::sin(s), 0.2f * std::cos(s), 0.03f * s * s)),
+                         Vector3(std::sin(s), 0.05f * s * s, std::cos(0.5f * s)));
+    }
+    const TrajectorySpline spline(control.data(), n, EPOCH, INTERVAL);
+
+    const double h = 1e-3;
+    scalar angularError = 0, linearError = 0;
+    for (int i = 0; i <= 40; ++i) {
+        const double t = spline.getStartTime() + h + (spline.getEndTime() - spline.getStartTime() - 2 * h) * i / 40;
+        Vector3 angular, linear;
+        spline.evaluate(t, angular, linear);
+        const SE3 before = spline.evaluate(t - h), after = spline.evaluate(t + h);
+        const scalar inv = static_cast<scalar>(1 / (2 * h));
+        const Vector3 angularDifference = (before.rotation().inverse() * after.rotation()).log() * inv;
+        const Vector3 linearDifference = (after.translation() - before.translation()) * inv;
+        angularError = std::max(angularError, (angular - angularDifference).length() / (1 + angular.length()));
+        linearError = std::max(linearError, (linear - linearDifference).length() / (1 + linear.length()));
+    }
+    check(angularError < 1e-2f, "angular velocity matches finite differences");
+    check(linearError < 1e-2f, "linear velocity matches finite differences");
+}
+
+/** @brief batch evaluation equals scalar evaluation, also when a sorted batch jumps across segments to the end. */
+static void testBatchMatchesScalar() {
+    const size_t n = 10;
+    std::vector<SE3> control(n);
+    for (size_t k = 0; k < n; ++k) {
+        const scalar s = static_cast<scalar>(k);
+        control[k] = SE3(SO3::exp(Vector3(0.4f * std::sin(s), 0.3f * std::cos(2 * s), 0.1f * s)),
+                         Vector3(3 * std::sin(s), 0.5f * s * s, std::cos(0.7f * s)));
+    }
+    const TrajectorySpline spline(control.data(), n, EPOCH, INTERVAL);
+    const double t0 = spline.getStartTime(), t1 = spline.getEndTime();
+    const std::vector<std::vector<double>> batches = {
+        {t0 + 0.1, t1},
+        {t0, t1},
+        {t0, t0 + 0.01, t0 + 0.35, t1 - 0.01, t1},
+        {t0 + 0.05, t0 + 0.05, t1, t1},
+        // unsorted, the runs restart
+        {t1, t0, t1, t0 + 0.2, t0 + 0.15},
+        // out of range times in between
+        {t0 + 0.05, t1 + 1, t1, t0 - 1, t0}};
+    for (const std::vector<double>& times : batches) {
+        std::vector<SE3> poses(times.size());
+        std::vector<Vector3> angular(times.size()), linear(times.size());
+        size_t inside = 0;
+        for (double t : times) inside += (t >= t0) && (t <= t1);
+        check(spline.evaluate(times.data(), times.size(), poses.data(), angular.data(), linear.data()) == inside,
+              "batch evaluate counts the times inside the spline");
+        scalar error = 0;
+        bool outside = true;
+        for (size_t i = 0; i < times.size(); ++i) {
+            if ((times[i] < t0) || (times[i] > t1)) {
+                outside &= std::isnan(poses[i].translation().x) && std::isnan(angular[i].x) && std::isnan(linear[i].x);
+                continue;
+            }
+            Vector3 w, v;
+            const SE3 expected = spline.evaluate(times[i], w, v);
+            // NaN compares false, so a NaN pose fails the check below
+            error = std::max(error, poseError(poses[i], expected));
+            error = std::max(error, std::max((angular[i] - w).length(), (linear[i] - v).length()));
+            if (!(error <= 1e-5f)) error = 1;
+        }
+        check(error <= 1e-5f, "batch evaluate equals scalar evaluate");
+        check(outside, "batch evaluate marks times outside the spline with NaN");
+    }
+}
+
+int main() {
+    testGeodesic();
+    testVelocity();
+    testBatchMatchesScalar();
+    return failures;
+}
@@ -0,0 +1,189 @@
+#include "myparallel.hpp"
+#include "myvoxel.hpp"
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+typedef std::tuple<int64_t, int64_t, int64_t> VoxelKey;
+
+/** @brief uniform in [-1, 1). */
+static scalar uniform(uint64_t& s) {
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<scalar>((s >> 40) % 65536) / 32768 - 1;
+}
+
+/** @brief points around negative and positive coordinates, some on voxel faces and duplicated. */
+static std::vector<Vector3> makePoints(size_t n, uint64_t seed) {
+    std::vector<Vector3> points(n);
+    for (size_t i = 0; i < n; ++i) {
+        points[i] = Vector3(3 * uniform(seed) - 1, 2 * uniform(seed) + 0.7f, 0.5f * uniform(seed));
+        if (i % 13 == 0) points[i].x = static_cast<scalar>(static_cast<int>(points[i].x * 4)) * 0.25f;
+        if (i % 31 == 0) points[i] = points[i / 3];
+    }
+    return points;
+}
+
+/** @brief voxel of p on the grid anchored at the origin. */
+static VoxelKey voxelOf(const Vector3& p, scalar size) {
+    const scalar inv = 1 / size;
+    return VoxelKey(static_cast<int64_t>(std::floor(p.x * inv)), static_cast<int64_t>(std::floor(p.y * inv)),
+                    static_cast<int64_t>(std::floor(p.z * inv)));
+}
+
+/** @brief input indices of every voxel, ascending. */
+static std::map<VoxelKey, std::vector<uint32_t>> groupPoints(const std::vector<Vector3>& points, scalar size) {
+    std::map<VoxelKey, std::vector<uint32_t>> voxels;
+    for (size_t i = 0; i < points.size(); ++i) voxels[voxelOf(points[i], size)].push_back(static_cast<uint32_t>(i));
+    return voxels;
+}
+
+/** @brief the output of the last filter() matches the std::map grouping. */
+static void checkFilter(const VoxelGridFilter& filter, const std::vector<Vector3>& points,
+                        const std::vector<Vector3>& out, const std::string& what) {
+    const std::map<VoxelKey, std::vector<uint32_t>> ref = groupPoints(points, filter.getVoxelSize());
+    check((out.size() == ref.size()) && (filter.voxelCount() == ref.size()), what + ": voxel count");
+    if (out.size() != ref.size()) return;
+    bool members = true, reduced = true;
+    std::map<VoxelKey, bool> seen;
+    for (size_t v = 0; v < out.size(); ++v) {
+        size_t count;
+        const uint32_t* idx = filter.voxelPoints(v, count);
+        const VoxelKey key = voxelOf(points[idx[0]], filter.getVoxelSize());
+        auto it = ref.find(key);
+        members &= (it != ref.end()) && !seen[key] && (std::vector<uint32_t>(idx, idx + count) == it->second);
+        seen[key] = true;
+        if (!members) break;
+        const uint32_t rep = filter.getRepresentatives()[v];
+        if (filter.getMode() == CENTROID) {
+            double sum[3] = {0, 0, 0};
+            for (uint32_t i : it->second) {
+                sum[0] += points[i].x;
+                sum[1] += points[i].y;
+                sum[2] += points[i].z;
+            }
+            const double w = 1.0 / it->second.size();
+            reduced &= (rep == it->second.front()) &&
+                       (out[v] == Vector3(static_cast<scalar>(sum[0] * w), static_cast<scalar>(sum[1] * w),
+                                          static_cast<scalar>(sum[2] * w)));
+        } else if (filter.getMode() == FIRST_POINT) {
+            reduced &= (rep == it->second.front()) && (out[v] == points[rep]);
+        } else {
+            reduced &= (voxelOf(points[rep], filter.getVoxelSize()) == key) && (out[v] == points[rep]);
+        }
+    }
+    check(members, what + ": every voxel holds the points of one map entry");
+    check(reduced, what + ": reduced point of every voxel");
+}
+
+static void testModes() {
+    const std::vector<Vector3> points = makePoints(70000, 1);
+    const unsigned int threads = getThreadCount();
+    for (VOXELREDUCE mode : {CENTROID, FIRST_POINT, RANDOM_POINT}) {
+        const std::string name = (mode == CENTROID) ? "centroid" : (mode == FIRST_POINT) ? "first point" : "random point";
+        for (scalar size : {0.05f, 0.25f, 1.f, 10.f}) {
+            VoxelGridFilter filter(size, mode, 42);
+            std::vector<Vector3> first;
+            for (unsigned int t : {1u, 4u}) {
+                setThreadCount(t);
+                const std::string what = name + ", voxel " + std::to_string(size) + ", " + std::to_string(t) + " threads";
+                std::vector<Vector3> out;
+                filter.filter(points.data(), points.size(), out);
+                checkFilter(filter, points, out, what);
+                if (first.empty()) first = out;
+                check(out == first, what + ": same output for any thread count");
+
+                size_t count = 0;
+                const Vector3* arena = filter.filter(points.data(), points.size(), getThreadArena(), count);
+                check((count == out.size()) && std::equal(out.begin(), out.end(), arena), what + ": arena output");
+            }
+        }
+    }
+    setThreadCount(threads);
+}
+
+/** @brief a point lands in the same voxel whatever else is in the cloud. */
+static void testOrigin() {
+    VoxelGridFilter filter(0.5f, FIRST_POINT);
+    std::vector<Vector3> points = {Vector3(0.1f, 0.1f, 0.1f), Vector3(0.4f, 0.2f, 0.3f), Vector3(0.6f, 0.1f, 0.1f),
+                                   Vector3(-0.1f, 0.1f, 0.1f)};
+    std::vector<Vector3> out;
+    check(filter.filter(points.data(), points.size(), out) == 3, "voxels split at multiples of the voxel size");
+    // the box minimum moves to a point that is not a multiple of the voxel size
+    points.push_back(Vector3(-0.37f, -10.3f, 7.1f));
+    check(filter.filter(points.data(), points.size(), out) == 4, "another point does not move the voxel faces");
+    checkFilter(filter, points, out, "shifted bounds");
+
+    points.assign(1, Vector3(1e5f, -1e5f, 3.25f));
+    check((filter.filter(points.data(), 1, out) == 1) && (out[0] == points[0]), "single point far from the origin");
+    points.push_back(Vector3(1e5f + 0.2f, -1e5f + 0.2f, 3.4f));
+    filter.filter(points.data(), points.size(), out);
+    checkFilter(filter, points, out, "two points far from the origin");
+}
+
+static void testAttributes() {
+    const std::vector<Vector3> points = makePoints(5000, 2);
+    std::vector<scalar> attributes(points.size() * 2);
+    for (size_t i = 0; i < points.size(); ++i) {
+        attributes[2 * i] = static_cast<scalar>(i % 17);
+        attributes[2 * i + 1] = points[i].x * 3;
+    }
+    for (VOXELREDUCE mode : {CENTROID, RANDOM_POINT}) {
+        VoxelGridFilter filter(0.3f, mode, 7);
+        std::vector<Vector3> out;
+        filter.filter(points.data(), points.size(), out);
+        std::vector<scalar> reduced;
+        filter.filterAttribute(attributes.data(), 2, reduced);
+        std::vector<uint32_t> gathered(out.size());
+        std::vector<uint32_t> index(points.size());
+        for (size_t i = 0; i < index.size(); ++i) index[i] = static_cast<uint32_t>(i);
+        filter.gatherAttribute(index.data(), gathered.data());
+        bool same = (reduced.size() == 2 * out.size()) && (gathered == filter.getRepresentatives());
+        for (size_t v = 0; same && (v < out.size()); ++v) {
+            size_t count;
+            const uint32_t* idx = filter.voxelPoints(v, count);
+            double sum[2] = {0, 0};
+            for (size_t k = 0; k < count; ++k) {
+                sum[0] += attributes[2 * idx[k]];
+                sum[1] += attributes[2 * idx[k] + 1];
+            }
+            const uint32_t rep = filter.getRepresentatives()[v];
+            const scalar a = (mode == CENTROID) ? static_cast<scalar>(sum[0] / count) : attributes[2 * rep];
+            const scalar b = (mode == CENTROID) ? static_cast<scalar>(sum[1] / count) : attributes[2 * rep + 1];
+            same = (std::abs(reduced[2 * v] - a) < 1e-5f) && (std::abs(reduced[2 * v + 1] - b) < 1e-5f);
+        }
+        check(same, (mode == CENTROID) ? "filterAttribute() averages" : "filterAttribute() copies the representative");
+    }
+}
+
+static void testInvalid() {
+    int thrown = 0;
+    try {
+        VoxelGridFilter filter(0);
+    } catch (const char*) {
+        ++thrown;
+    }
+    VoxelGridFilter filter(1e-4f);
+    const Vector3 points[2] = {Vector3(0, 0, 0), Vector3(1000, 0, 0)};
+    std::vector<Vector3> out;
+    try {
+        filter.filter(points, 2, out);
+    } catch (const char*) {
+        ++thrown;
+    }
+    check(thrown == 2, "zero voxel size and too many voxels along an axis throw");
+    check((filter.filter(points, 0, out) == 0) && out.empty() && (filter.voxelCount() == 0), "empty cloud");
+}
+
+int main() {
+    testModes();
+    testOrigin();
+    testAttributes();
+    testInvalid();
+    return failures;
+}